@@ -80,6 +80,66 @@ static struct wlf_gif_image *create_test_image(uint32_t width, uint32_t height,
 	return gif_image;
 }
 
+static unsigned char *read_file(const char *path, size_t *size) {
+	FILE *fp = fopen(path, "rb");
+	if (fp == NULL) {
+		wlf_log_errno(WLF_ERROR, "Open %s failed", path);
+		return NULL;
+	}
+
+	unsigned char *data = NULL;
+	long length = -1;
+	if (fseek(fp, 0, SEEK_END) == 0) {
+		length = ftell(fp);
+	}
+	if (length > 0 && fseek(fp, 0, SEEK_SET) == 0) {
+		data = malloc((size_t)length);
+	}
+	if (data == NULL || fread(data, 1, (size_t)length, fp) != (size_t)length) {
+		wlf_log(WLF_ERROR, "Failed to read %s", path);
+		free(data);
+		data = NULL;
+	}
+	fclose(fp);
+	*size = (size_t)length;
+	return data;
+}
+
+/* Streams the same file from memory and checks every frame against the
+ * file-backed stream. */
+static bool check_memory_stream(const char *path, struct wlf_gif_image *file_stream) {
+	size_t size = 0;
+	unsigned char *data = read_file(path, &size);
+	if (data == NULL) {
+		return false;
+	}
+
+	struct wlf_gif_image *memory_stream = wlf_gif_image_create();
+	if (memory_stream == NULL) {
+		free(data);
+		return false;
+	}
+	bool ok = wlf_gif_image_load_streaming_from_memory(memory_stream, data, size, NULL) &&
+		memory_stream->frame_count == file_stream->frame_count;
+	size_t canvas_size = (size_t)file_stream->base.stride * file_stream->base.height;
+	for (uint32_t i = 0; ok && i < file_stream->frame_count; i++) {
+		ok = wlf_gif_image_seek_frame(memory_stream, i, NULL) &&
+			wlf_gif_image_seek_frame(file_stream, i, NULL) &&
+			memcmp(memory_stream->base.data, file_stream->base.data, canvas_size) == 0;
+		if (!ok) {
+			wlf_log(WLF_ERROR, "Memory stream differs at frame %u", i);
+		}
+	}
+	if (ok) {
+		ok = wlf_gif_image_seek_frame(file_stream, 0, NULL);
+	}
+
+	wlf_image_finish(&memory_stream->base);
+	free(memory_stream);
+	free(data);
+	return ok;
+}
+
 static void print_usage(const char *program_name) {
 	printf("Usage: %s [OPTIONS]\n", program_name);
 	printf("   or: %s [INPUT.gif] [OUTPUT.gif|OUTPUT_DIR]\n", program_name);
@@ -89,12 +149,14 @@ static void print_usage(const char *program_name) {
 	printf("  -o, --output <path>     Output directory or output gif file path\n");
 	printf("  -w, --width <value>     Width for generated image (default: 256)\n");
 	printf("  -H, --height <value>    Height for generated image (default: 256)\n");
+	printf("  -s, --stream            Decode frames on demand, from the file and from memory\n");
 	printf("  -v, --verbose           Enable verbose logging\n");
 	printf("  -h, --help              Show this help message\\n\\n");
 	printf("Examples:\n");
 	printf("  %s                              # Create a test GIF in current directory\n", program_name);
 	printf("  %s -i in.gif                    # Load and inspect GIF metadata\n", program_name);
 	printf("  %s -i in.gif -o output/         # Save processed GIF to output directory\n", program_name);
+	printf("  %s -i in.gif -s                 # Stream frames and print their timestamps\n", program_name);
 	printf("  %s -w 320 -H 240 -v             # Generate 320x240 test GIF with verbose output\n", program_name);
 }
 
@@ -104,6 +166,7 @@ int main(int argc, char *argv[]) {
 	int width = 256;
 	int height = 256;
 	bool verbose = false;
+	bool stream = false;
 	bool show_help = false;
 
 	struct wlf_cmd_option options[] = {
@@ -112,10 +175,11 @@ int main(int argc, char *argv[]) {
 		{ WLF_OPTION_INTEGER, "width", 'w', &width },
 		{ WLF_OPTION_INTEGER, "height", 'H', &height },
 		{ WLF_OPTION_BOOLEAN, "verbose", 'v', &verbose },
+		{ WLF_OPTION_BOOLEAN, "stream", 's', &stream },
 		{ WLF_OPTION_BOOLEAN, "help", 'h', &show_help },
 	};
 
-	int remaining_args = wlf_cmd_parse_options(options, 6, &argc, argv);
+	int remaining_args = wlf_cmd_parse_options(options, 7, &argc, argv);
 	if (remaining_args < 0) {
 		fprintf(stderr, "Error parsing command line options\n");
 		return EXIT_FAILURE;
@@ -166,13 +230,35 @@ int main(int argc, char *argv[]) {
 
 	if (input_path) {
 		printf("\nTesting GIF load: %s\n", input_path);
-		struct wlf_image *loaded_image = wlf_image_load(input_path);
+		struct wlf_image *loaded_image = NULL;
+		if (stream) {
+			struct wlf_gif_image *gif_stream = wlf_gif_image_create();
+			if (gif_stream != NULL) {
+				if (wlf_gif_image_load_streaming(gif_stream, input_path, NULL)) {
+					loaded_image = &gif_stream->base;
+				} else {
+					wlf_image_finish(&gif_stream->base);
+					free(gif_stream);
+				}
+			}
+		} else {
+			loaded_image = wlf_image_load(input_path);
+		}
 		if (loaded_image == NULL) {
 			wlf_log(WLF_ERROR, "Failed to load GIF image: %s", input_path);
 			free(input_path);
 			free(output_path);
 			return EXIT_FAILURE;
 		}
+		if (stream && !check_memory_stream(input_path,
+				wlf_gif_image_from_image(loaded_image))) {
+			wlf_log(WLF_ERROR, "Streaming from memory does not match the file: %s", input_path);
+			wlf_image_finish(loaded_image);
+			free(loaded_image);
+			free(input_path);
+			free(output_path);
+			return EXIT_FAILURE;
+		}
 
 		printf("GIF image loaded successfully\n");
 		printf("  - Width: %u\n", loaded_image->width);
@@ -187,6 +273,21 @@ int main(int argc, char *argv[]) {
 			printf("  - Frame count: %u\n", gif_img->frame_count);
 			printf("  - Delay (first frame): %u ms\n", gif_img->delay_ms);
 			printf("  - Loop count: %u (0 means infinite/unknown)\n", gif_img->loop_count);
+			printf("  - Duration: %llu ms\n",
+				(unsigned long long)wlf_gif_image_get_duration(gif_img));
+			printf("  - Streaming: %s\n", wlf_gif_image_is_streaming(gif_img) ? "Yes" : "No");
+
+			for (uint32_t i = 1; i < gif_img->frame_count; i++) {
+				struct wlf_rect damage;
+				if (!wlf_gif_image_next_frame(gif_img, &damage)) {
+					wlf_log(WLF_ERROR, "Failed to advance to GIF frame %u", i);
+					break;
+				}
+				wlf_log(WLF_DEBUG, "  frame %u at %u ms, damage %dx%d+%d+%d", i,
+					gif_img->frames[i].timestamp_ms, damage.width, damage.height,
+					damage.x, damage.y);
+			}
+			wlf_gif_image_seek_frame(gif_img, 0, NULL);
 		}
 
 		char output_filename[PATH_MAX];
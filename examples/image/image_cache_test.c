@@ -0,0 +1,82 @@
+#include "wlf/image/wlf_image.h"
+#include "wlf/image/wlf_image_cache.h"
+#include "wlf/utils/wlf_cmd_parser.h"
+#include "wlf/utils/wlf_log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static void print_usage(const char *program_name) {
+	printf("Usage: %s [OPTIONS] IMAGE...\n", program_name);
+	printf("wlframe Image Cache Test Program\n\n");
+	printf("Looks up every IMAGE several times, as a UI showing the same icons in\n");
+	printf("many places would, and reports the cache statistics.\n\n");
+	printf("Options:\n");
+	printf("  -b, --budget <KiB>      Cache budget in KiB (default: 65536)\n");
+	printf("  -r, --rounds <n>        Number of lookup rounds (default: 4)\n");
+	printf("  -s, --size <px>         Display size to decode for (default: full)\n");
+	printf("  -h, --help              Show this help message\n");
+}
+
+int main(int argc, char *argv[]) {
+	uint32_t budget_kib = WLF_IMAGE_CACHE_DEFAULT_BUDGET / 1024;
+	uint32_t rounds = 4;
+	uint32_t size = 0;
+	bool show_help = false;
+
+	struct wlf_cmd_option options[] = {
+		{ WLF_OPTION_UNSIGNED_INTEGER, "budget", 'b', &budget_kib },
+		{ WLF_OPTION_UNSIGNED_INTEGER, "rounds", 'r', &rounds },
+		{ WLF_OPTION_UNSIGNED_INTEGER, "size", 's', &size },
+		{ WLF_OPTION_BOOLEAN, "help", 'h', &show_help },
+	};
+
+	if (wlf_cmd_parse_options(options, 4, &argc, argv) < 0) {
+		fprintf(stderr, "Error parsing command line options\n");
+		return EXIT_FAILURE;
+	}
+
+	if (show_help || argc < 2) {
+		print_usage(argv[0]);
+		return show_help ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	wlf_log_init(WLF_INFO, NULL);
+
+	struct wlf_image_cache *cache = wlf_image_cache_create((size_t)budget_kib * 1024);
+	if (cache == NULL) {
+		wlf_log(WLF_ERROR, "Failed to create image cache");
+		return EXIT_FAILURE;
+	}
+
+	for (uint32_t round = 0; round < rounds; round++) {
+		for (int i = 1; i < argc; i++) {
+			struct wlf_image_cache_entry *entry =
+				wlf_image_cache_load(cache, argv[i], size, size, 1.0f);
+			if (entry == NULL) {
+				wlf_log(WLF_ERROR, "Failed to load %s", argv[i]);
+				continue;
+			}
+
+			const struct wlf_image *image = wlf_image_cache_entry_get_image(entry);
+			if (round == 0) {
+				wlf_log(WLF_INFO, "%s: %ux%u %s", argv[i], image->width,
+					image->height, wlf_image_get_type_string(image));
+			}
+			wlf_image_cache_entry_unref(entry);
+		}
+	}
+
+	struct wlf_image_cache_stats stats;
+	wlf_image_cache_get_stats(cache, &stats);
+	wlf_log(WLF_INFO, "hits %llu, misses %llu, hit rate %.1f%%",
+		(unsigned long long)stats.hits, (unsigned long long)stats.misses,
+		stats.hit_rate * 100.0);
+	wlf_log(WLF_INFO, "%u entries, %zu of %zu bytes resident, %llu evictions",
+		stats.entry_count, stats.bytes_resident, stats.byte_budget,
+		(unsigned long long)stats.evictions);
+
+	wlf_image_cache_destroy(cache);
+
+	return EXIT_SUCCESS;
+}
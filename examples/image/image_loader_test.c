@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "wlf/image/wlf_image.h"
+#include "wlf/image/wlf_image_loader.h"
+#include "wlf/platform/wlf_backend.h"
+#include "wlf/utils/wlf_cmd_parser.h"
+#include "wlf/utils/wlf_log.h"
+#include "wlf/utils/wlf_time.h"
+
+struct loader_test {
+	struct wlf_backend *backend;
+	struct wlf_image_loader *loader;
+	char **files;
+	int remaining;
+	int64_t start_ms;
+};
+
+static void print_usage(const char *program_name) {
+	printf("Usage: %s [OPTIONS] IMAGE...\n", program_name);
+	printf("wlframe Asynchronous Image Loader Test Program\n\n");
+	printf("Decodes every IMAGE on the loader's worker threads. Later files get a\n");
+	printf("higher priority, and completions are reported from the event loop.\n\n");
+	printf("Options:\n");
+	printf("  -t, --threads <n>       Number of decoding threads (default: auto)\n");
+	printf("  -s, --size <px>         Decode for display at this size (default: full)\n");
+	printf("  -c, --cancel            Cancel every other request after queueing\n");
+	printf("  -h, --help              Show this help message\n");
+}
+
+static void handle_load_done(struct wlf_image_load_request *request,
+		struct wlf_image *image, void *data) {
+	struct loader_test *test = data;
+	(void)request;
+
+	int64_t elapsed = get_current_time_msec() - test->start_ms;
+	if (image != NULL) {
+		wlf_log(WLF_INFO, "[%4lld ms] loaded %ux%u %s image",
+			(long long)elapsed, image->width, image->height,
+			wlf_image_get_type_string(image));
+		/* A real client would upload the image to a texture here. */
+		wlf_image_finish(image);
+		free(image);
+	} else {
+		wlf_log(WLF_ERROR, "[%4lld ms] failed to load image", (long long)elapsed);
+	}
+
+	if (--test->remaining == 0) {
+		wlf_backend_quit(test->backend);
+	}
+}
+
+int main(int argc, char *argv[]) {
+	uint32_t threads = 0;
+	int size = 0;
+	bool cancel = false;
+	bool show_help = false;
+
+	struct wlf_cmd_option options[] = {
+		{ WLF_OPTION_UNSIGNED_INTEGER, "threads", 't', &threads },
+		{ WLF_OPTION_INTEGER, "size", 's', &size },
+		{ WLF_OPTION_BOOLEAN, "cancel", 'c', &cancel },
+		{ WLF_OPTION_BOOLEAN, "help", 'h', &show_help },
+	};
+
+	if (wlf_cmd_parse_options(options, 4, &argc, argv) < 0) {
+		fprintf(stderr, "Error parsing command line options\n");
+		return EXIT_FAILURE;
+	}
+
+	if (show_help || argc < 2) {
+		print_usage(argv[0]);
+		return show_help ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	wlf_log_init(WLF_INFO, NULL);
+
+	struct loader_test test = { 0 };
+	test.backend = wlf_backend_autocreate();
+	if (test.backend == NULL) {
+		wlf_log(WLF_ERROR, "Failed to auto-create backend");
+		return EXIT_FAILURE;
+	}
+
+	test.loader = wlf_image_loader_create(test.backend, threads);
+	if (test.loader == NULL) {
+		wlf_log(WLF_ERROR, "Failed to create image loader");
+		wlf_backend_destroy(test.backend);
+		return EXIT_FAILURE;
+	}
+
+	uint32_t target = size > 0 ? (uint32_t)size : 0;
+	test.start_ms = get_current_time_msec();
+	for (int i = 1; i < argc; i++) {
+		struct wlf_image_load_request *request = wlf_image_loader_load(
+			test.loader, argv[i], target, target, i, handle_load_done, &test);
+		if (request == NULL) {
+			wlf_log(WLF_ERROR, "Failed to queue %s", argv[i]);
+			continue;
+		}
+
+		if (cancel && i % 2 == 0) {
+			wlf_image_load_request_cancel(request);
+			wlf_log(WLF_INFO, "cancelled %s", argv[i]);
+			continue;
+		}
+
+		wlf_log(WLF_INFO, "queued %s (priority %d)", argv[i], i);
+		test.remaining++;
+	}
+
+	if (test.remaining > 0) {
+		wlf_backend_exe(test.backend);
+	}
+
+	wlf_image_loader_destroy(test.loader);
+	wlf_backend_destroy(test.backend);
+
+	return EXIT_SUCCESS;
+}
@@ -79,12 +79,14 @@ static void print_usage(const char *program_name) {
 	printf("  -i, --input <path>     Input JPEG file path to load and test\n");
 	printf("  -o, --output <path>    Output path for saved images (default: current directory)\n");
 	printf("  -q, --quality <value>  JPEG quality for output (1-100, default: 85)\n");
+	printf("  -t, --thumbnail <px>   Also decode the input at a reduced size for a px-sized thumbnail\n");
 	printf("  -v, --verbose          Enable verbose logging\n");
 	printf("  -h, --help             Show this help message\n\n");
 	printf("Examples:\n");
 	printf("  %s                           # Create test images in current directory\n", program_name);
 	printf("  %s -i photo.jpg              # Load and test photo.jpg\n", program_name);
 	printf("  %s -i photo.jpg -o output/   # Load photo.jpg and save to output directory\n", program_name);
+	printf("  %s -i photo.jpg -t 128       # Also decode photo.jpg for a 128px thumbnail\n", program_name);
 	printf("  %s -v -q 95                  # Create test images with high quality and verbose output\n", program_name);
 }
 
@@ -93,6 +95,7 @@ int main(int argc, char *argv[]) {
 	char *input_path = NULL;
 	char *output_path = NULL;
 	int quality = 85;
+	int thumbnail = 0;
 	bool verbose = false;
 	bool show_help = false;
 
@@ -101,12 +104,13 @@ int main(int argc, char *argv[]) {
 		{WLF_OPTION_STRING, "input", 'i', &input_path},
 		{WLF_OPTION_STRING, "output", 'o', &output_path},
 		{WLF_OPTION_INTEGER, "quality", 'q', &quality},
+		{WLF_OPTION_INTEGER, "thumbnail", 't', &thumbnail},
 		{WLF_OPTION_BOOLEAN, "verbose", 'v', &verbose},
 		{WLF_OPTION_BOOLEAN, "help", 'h', &show_help}
 	};
 
 	// Parse command line arguments
-	int remaining_args = wlf_cmd_parse_options(options, 5, &argc, argv);
+	int remaining_args = wlf_cmd_parse_options(options, 6, &argc, argv);
 	if (remaining_args < 0) {
 		fprintf(stderr, "Error parsing command line options\n");
 		return EXIT_FAILURE;
@@ -124,6 +128,11 @@ int main(int argc, char *argv[]) {
 		return EXIT_FAILURE;
 	}
 
+	if (thumbnail < 0) {
+		fprintf(stderr, "Error: Thumbnail size must not be negative\n");
+		return EXIT_FAILURE;
+	}
+
 	// Initialize logging
 	int32_t log_level = verbose ? WLF_DEBUG : WLF_INFO;
 	wlf_log_init(log_level, NULL);
@@ -152,6 +161,20 @@ int main(int argc, char *argv[]) {
 
 		print_image_info(img, input_path);
 
+		if (thumbnail > 0) {
+			// Decode again at the smallest DCT scale covering the thumbnail
+			struct wlf_image *thumb = wlf_image_load_at_size(input_path,
+				(uint32_t)thumbnail, (uint32_t)thumbnail);
+			if (thumb != NULL) {
+				printf("\nReduced decode for a %dpx thumbnail:\n", thumbnail);
+				print_image_info(thumb, input_path);
+				wlf_image_finish(thumb);
+				free(thumb);
+			} else {
+				wlf_log(WLF_ERROR, "Failed to decode thumbnail: %s", input_path);
+			}
+		}
+
 		// Prepare output filename
 		char output_filename[PATH_MAX];
 		if (output_path) {
@@ -0,0 +1,250 @@
+/**
+ * @file        event_loop_bench.c
+ * @brief       Example: measure backend event loop wakeup cost.
+ * @details     Registers a number of eventfd sources, then repeatedly signals
+ *              one of them and runs one iteration of each loop until it has
+ *              been dispatched. The poll loop rebuilds a pollfd array with
+ *              every source on each iteration, as the Wayland backend used
+ *              to; the epoll loop polls a display fd and the loop's epoll fd
+ *              the way the backend does now. Reports the time per wakeup.
+ */
+
+#include "wlf/platform/linux/event_loop.h"
+#include "wlf/utils/wlf_cmd_parser.h"
+#include "wlf/utils/wlf_log.h"
+#include "wlf/utils/wlf_time.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+static const uint32_t default_source_counts[] = { 1, 16, 128, 512 };
+
+struct bench_sources {
+	int display_fd; /* Stands in for the Wayland display, never readable */
+	int *fds;
+	uint32_t count;
+	uint64_t dispatched;
+};
+
+static void print_usage(const char *program_name) {
+	printf("Usage: %s [OPTIONS]\n", program_name);
+	printf("wlframe Event Loop Wakeup Benchmark\n\n");
+	printf("Signals one of N eventfd sources per iteration and reports the\n");
+	printf("time per wakeup of the poll and epoll backend loops.\n\n");
+	printf("Options:\n");
+	printf("  -n, --iterations <n>   Wakeups per run (default: 100000)\n");
+	printf("  -s, --sources <n>      Number of sources (default: 1, 16, 128, 512)\n");
+	printf("  -h, --help             Show this help message\n");
+}
+
+static void consume(struct bench_sources *sources, int fd) {
+	uint64_t value;
+	if (read(fd, &value, sizeof(value)) == sizeof(value)) {
+		sources->dispatched++;
+	}
+}
+
+static bool signal_source(const struct bench_sources *sources) {
+	uint64_t one = 1;
+	if (write(sources->fds[sources->count - 1], &one, sizeof(one)) < 0) {
+		wlf_log_errno(WLF_ERROR, "Failed to signal eventfd");
+		return false;
+	}
+	return true;
+}
+
+static void sources_finish(struct bench_sources *sources) {
+	for (uint32_t i = 0; i < sources->count; i++) {
+		close(sources->fds[i]);
+	}
+	free(sources->fds);
+	if (sources->display_fd >= 0) {
+		close(sources->display_fd);
+	}
+}
+
+static bool sources_init(struct bench_sources *sources, uint32_t count) {
+	*sources = (struct bench_sources){ .display_fd = -1 };
+	sources->fds = calloc(count, sizeof(*sources->fds));
+	if (sources->fds == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate source fds");
+		return false;
+	}
+
+	sources->display_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (sources->display_fd < 0) {
+		wlf_log_errno(WLF_ERROR, "Failed to create eventfd");
+		sources_finish(sources);
+		return false;
+	}
+	for (; sources->count < count; sources->count++) {
+		int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		if (fd < 0) {
+			wlf_log_errno(WLF_ERROR, "Failed to create eventfd");
+			sources_finish(sources);
+			return false;
+		}
+		sources->fds[sources->count] = fd;
+	}
+	return true;
+}
+
+/* One iteration of the previous Wayland backend loop. */
+static bool poll_loop_iterate(struct bench_sources *sources) {
+	size_t nfds = 1 + sources->count;
+	struct pollfd *fds = calloc(nfds, sizeof(struct pollfd));
+	if (fds == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate pollfd array");
+		return false;
+	}
+
+	fds[0].fd = sources->display_fd;
+	fds[0].events = POLLIN;
+	for (uint32_t i = 0; i < sources->count; i++) {
+		fds[i + 1].fd = sources->fds[i];
+		fds[i + 1].events = POLLIN;
+	}
+
+	if (poll(fds, nfds, -1) < 0 && errno != EINTR) {
+		wlf_log_errno(WLF_ERROR, "poll() failed");
+		free(fds);
+		return false;
+	}
+
+	for (uint32_t i = 0; i < sources->count; i++) {
+		if (fds[i + 1].revents != 0) {
+			consume(sources, fds[i + 1].fd);
+		}
+	}
+
+	free(fds);
+	return true;
+}
+
+static void handle_source(int fd, uint32_t mask, void *data) {
+	(void)mask;
+	consume(data, fd);
+}
+
+static bool bench_poll_loop(struct bench_sources *sources,
+		uint32_t iterations, double *ns_per_wakeup) {
+	struct timespec start, end, elapsed;
+	wlf_get_monotonic_time(&start);
+	for (uint32_t i = 0; i < iterations; i++) {
+		if (!signal_source(sources) || !poll_loop_iterate(sources)) {
+			return false;
+		}
+	}
+	wlf_get_monotonic_time(&end);
+	timespec_sub(&elapsed, &end, &start);
+
+	*ns_per_wakeup = (double)timespec_to_nsec(&elapsed) / iterations;
+	return true;
+}
+
+static bool bench_epoll_loop(struct bench_sources *sources,
+		uint32_t iterations, double *ns_per_wakeup) {
+	struct wlf_event_loop *loop = wlf_event_loop_create();
+	if (loop == NULL) {
+		return false;
+	}
+
+	bool ok = true;
+	for (uint32_t i = 0; ok && i < sources->count; i++) {
+		ok = wlf_event_loop_add_fd(loop, sources->fds[i], POLLIN,
+			handle_source, sources) != NULL;
+	}
+
+	struct pollfd fds[2] = {
+		{ .fd = sources->display_fd, .events = POLLIN },
+		{ .fd = wlf_event_loop_get_fd(loop), .events = POLLIN },
+	};
+
+	struct timespec start, end, elapsed;
+	wlf_get_monotonic_time(&start);
+	for (uint32_t i = 0; ok && i < iterations; i++) {
+		ok = signal_source(sources);
+		if (ok && poll(fds, 2, -1) < 0 && errno != EINTR) {
+			wlf_log_errno(WLF_ERROR, "poll() failed");
+			ok = false;
+		}
+		if (ok && (fds[1].revents & POLLIN) != 0) {
+			ok = wlf_event_loop_dispatch(loop, 0);
+		}
+	}
+	wlf_get_monotonic_time(&end);
+	timespec_sub(&elapsed, &end, &start);
+
+	*ns_per_wakeup = (double)timespec_to_nsec(&elapsed) / iterations;
+	wlf_event_loop_destroy(loop);
+	return ok;
+}
+
+static bool bench_sources(uint32_t count, uint32_t iterations) {
+	struct bench_sources sources;
+	if (!sources_init(&sources, count)) {
+		return false;
+	}
+
+	double poll_ns = 0.0, epoll_ns = 0.0;
+	bool ok = bench_poll_loop(&sources, iterations, &poll_ns) &&
+		bench_epoll_loop(&sources, iterations, &epoll_ns);
+	if (ok && sources.dispatched != (uint64_t)iterations * 2) {
+		wlf_log(WLF_ERROR, "%u sources: dispatched %llu of %llu wakeups",
+			count, (unsigned long long)sources.dispatched,
+			(unsigned long long)iterations * 2);
+		ok = false;
+	}
+	if (ok) {
+		wlf_log(WLF_INFO, "%u sources: poll %.0f ns/wakeup, epoll %.0f ns/wakeup (%.2fx)",
+			count, poll_ns, epoll_ns, poll_ns / epoll_ns);
+	}
+
+	sources_finish(&sources);
+	return ok;
+}
+
+int main(int argc, char *argv[]) {
+	uint32_t iterations = 100000;
+	uint32_t source_count = 0;
+	bool show_help = false;
+
+	struct wlf_cmd_option options[] = {
+		{ WLF_OPTION_UNSIGNED_INTEGER, "iterations", 'n', &iterations },
+		{ WLF_OPTION_UNSIGNED_INTEGER, "sources", 's', &source_count },
+		{ WLF_OPTION_BOOLEAN, "help", 'h', &show_help },
+	};
+
+	if (wlf_cmd_parse_options(options, 3, &argc, argv) < 0) {
+		fprintf(stderr, "Error parsing command line options\n");
+		return EXIT_FAILURE;
+	}
+
+	if (show_help) {
+		print_usage(argv[0]);
+		return EXIT_SUCCESS;
+	}
+	if (iterations == 0) {
+		iterations = 1;
+	}
+
+	wlf_log_init(WLF_INFO, NULL);
+
+	bool ok = true;
+	if (source_count > 0) {
+		ok = bench_sources(source_count, iterations);
+	} else {
+		for (size_t i = 0; i < sizeof(default_source_counts) / sizeof(default_source_counts[0]); i++) {
+			ok &= bench_sources(default_source_counts[i], iterations);
+		}
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
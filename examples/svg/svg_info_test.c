@@ -32,6 +32,40 @@ static const char *svg_paint_desc(const struct wlf_gradient *grad,
 	return "solid";
 }
 
+struct shape_walk {
+	int shape_idx;
+	int text_count;
+};
+
+/* Visits every drawn shape, including the symbol shapes placed by <use>,
+ * which are not in the image's shape list. */
+static bool log_shape(struct wlf_svg_shape *s, float x, float y, void *data) {
+	struct shape_walk *walk = data;
+	if (s->geometry && wlf_shape_is_text(s->geometry)) {
+		struct wlf_text_shape *text = wlf_text_shape_from_shape(s->geometry);
+		walk->text_count++;
+		wlf_log(WLF_DEBUG, "    text=\"%s\" font=\"%s\" size=%.2f",
+			text->text, text->font_family, text->font_size);
+	}
+	wlf_log(WLF_DEBUG, "  Shape[%d] id=\"%s\" opacity=%.2f visible=%s offset=(%.2f, %.2f)",
+		walk->shape_idx, s->id[0] ? s->id : "(none)", s->opacity,
+		(s->flags & WLF_SVG_FLAGS_VISIBLE) ? "yes" : "no", x, y);
+	wlf_log(WLF_DEBUG, "    fill=%s  stroke=%s  stroke_width=%.2f",
+		svg_paint_desc(s->fill, s->fill_gradient),
+		svg_paint_desc(s->stroke, s->stroke_gradient),
+		s->stroke_width);
+	walk->shape_idx++;
+	return true;
+}
+
+static bool count_text(struct wlf_svg_shape *s, float x, float y, void *data) {
+	int *text_count = data;
+	if (s->geometry && wlf_shape_is_text(s->geometry)) {
+		(*text_count)++;
+	}
+	return true;
+}
+
 static void print_usage(const char *program_name) {
 	printf("Usage: %s [OPTIONS]\n", program_name);
 	printf("wlframe SVG Info Test Program\n\n");
@@ -88,30 +122,19 @@ int main(int argc, char *argv[]) {
 	wlf_log(WLF_INFO, "SVG canvas   : %.1f x %.1f px", info.width, info.height);
 	wlf_log(WLF_INFO, "Shape count  : %d", info.n_shapes);
 	wlf_log(WLF_INFO, "Path count   : %d", info.n_paths);
+	int use_count = 0;
+	for (struct wlf_svg_use_data *use = image->uses; use != NULL; use = use->next) {
+		use_count++;
+	}
+	wlf_log(WLF_INFO, "Use instances: %d", use_count);
 	if (info.n_paths > 0) {
 		wlf_log(WLF_INFO, "Geometry bbox: [%.2f, %.2f, %.2f, %.2f]",
 			info.bounds[0], info.bounds[1], info.bounds[2], info.bounds[3]);
 	}
 
-	int shape_idx = 0;
-	int text_count = 0;
-	for (struct wlf_shape *base = image->shapes; base != NULL;
-		base = (struct wlf_shape *)wlf_svg_shape_from_shape(base)->next, shape_idx++) {
-		struct wlf_svg_shape *s = wlf_svg_shape_from_shape(base);
-		if (s->geometry && wlf_shape_is_text(s->geometry)) {
-			struct wlf_text_shape *text = wlf_text_shape_from_shape(s->geometry);
-			text_count++;
-			wlf_log(WLF_DEBUG, "    text=\"%s\" font=\"%s\" size=%.2f",
-				text->text, text->font_family, text->font_size);
-		}
-		wlf_log(WLF_DEBUG, "  Shape[%d] id=\"%s\" opacity=%.2f visible=%s",
-			shape_idx, s->id[0] ? s->id : "(none)", s->opacity,
-			(s->flags & WLF_SVG_FLAGS_VISIBLE) ? "yes" : "no");
-		wlf_log(WLF_DEBUG, "    fill=%s  stroke=%s  stroke_width=%.2f",
-			svg_paint_desc(s->fill, s->fill_gradient),
-			svg_paint_desc(s->stroke, s->stroke_gradient),
-			s->stroke_width);
-	}
+	struct shape_walk walk = {0};
+	wlf_svg_for_each_shape(image, log_shape, &walk);
+	int text_count = walk.text_count;
 	wlf_log(WLF_INFO, "Text count   : %d", text_count);
 
 	if (output_path) {
@@ -129,13 +152,7 @@ int main(int argc, char *argv[]) {
 			}
 
 			int saved_text_count = 0;
-			for (struct wlf_shape *base = saved->shapes; base != NULL;
-				base = (struct wlf_shape *)wlf_svg_shape_from_shape(base)->next) {
-				struct wlf_svg_shape *s = wlf_svg_shape_from_shape(base);
-				if (s->geometry && wlf_shape_is_text(s->geometry)) {
-					saved_text_count++;
-				}
-			}
+			wlf_svg_for_each_shape(saved, count_text, &saved_text_count);
 
 			wlf_log(WLF_INFO, "Saved text count: %d", saved_text_count);
 			if (text_count > 0 && saved_text_count == 0) {
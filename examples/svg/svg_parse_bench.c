@@ -0,0 +1,143 @@
+/**
+ * @file        svg_parse_bench.c
+ * @brief       Example: measure SVG parse throughput.
+ * @details     Reads each SVG file into memory once, then parses it
+ *              repeatedly with wlf_svg_parse_buffer() and reports the time
+ *              per parse and the throughput in MiB/s. Without arguments the
+ *              files in examples/svg/resources are used.
+ */
+
+#include "wlf/svg/wlf_svg.h"
+#include "wlf/utils/wlf_cmd_parser.h"
+#include "wlf/utils/wlf_log.h"
+#include "wlf/utils/wlf_time.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static const char *default_files[] = {
+	"examples/svg/resources/test.svg",
+	"examples/svg/resources/svg_node_test.svg",
+};
+
+static void print_usage(const char *program_name) {
+	printf("Usage: %s [OPTIONS] [SVG...]\n", program_name);
+	printf("wlframe SVG Parse Benchmark\n\n");
+	printf("Parses every SVG (default: examples/svg/resources) repeatedly and\n");
+	printf("reports time per parse and throughput.\n\n");
+	printf("Options:\n");
+	printf("  -n, --iterations <n>   Parses per file (default: 1000)\n");
+	printf("  -h, --help             Show this help message\n");
+}
+
+static char *read_file(const char *filename, size_t *size) {
+	FILE *fp = fopen(filename, "rb");
+	if (fp == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to open %s", filename);
+		return NULL;
+	}
+
+	char *data = NULL;
+	long length;
+	if (fseek(fp, 0, SEEK_END) != 0 || (length = ftell(fp)) < 0 ||
+			fseek(fp, 0, SEEK_SET) != 0) {
+		wlf_log_errno(WLF_ERROR, "Failed to size %s", filename);
+		goto out;
+	}
+
+	data = malloc((size_t)length + 1);
+	if (data == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate %ld bytes", length);
+		goto out;
+	}
+	if (fread(data, 1, (size_t)length, fp) != (size_t)length) {
+		wlf_log(WLF_ERROR, "Failed to read %s", filename);
+		free(data);
+		data = NULL;
+		goto out;
+	}
+	data[length] = '\0';
+	*size = (size_t)length;
+
+out:
+	fclose(fp);
+	return data;
+}
+
+static bool bench_file(const char *filename, uint32_t iterations) {
+	size_t size = 0;
+	char *data = read_file(filename, &size);
+	if (data == NULL) {
+		return false;
+	}
+
+	/* One untimed parse to validate the file and warm the caches. */
+	struct wlf_svg_image *image = wlf_svg_parse_buffer(data, size, "px", 96.0f);
+	if (image == NULL) {
+		wlf_log(WLF_ERROR, "Failed to parse %s", filename);
+		free(data);
+		return false;
+	}
+	struct wlf_svg_info info;
+	wlf_svg_get_info(image, &info);
+	wlf_svg_destroy(image);
+
+	struct timespec start, end, elapsed;
+	wlf_get_monotonic_time(&start);
+	for (uint32_t i = 0; i < iterations; i++) {
+		wlf_svg_destroy(wlf_svg_parse_buffer(data, size, "px", 96.0f));
+	}
+	wlf_get_monotonic_time(&end);
+	timespec_sub(&elapsed, &end, &start);
+
+	double total_ns = (double)timespec_to_nsec(&elapsed);
+	double per_parse_us = total_ns / iterations / 1000.0;
+	double mib_per_s = (double)size * iterations / (1024.0 * 1024.0) /
+		(total_ns / 1e9);
+	wlf_log(WLF_INFO, "%s: %zu bytes, %d shapes, %d paths: %.1f us/parse, %.1f MiB/s",
+		filename, size, info.n_shapes, info.n_paths, per_parse_us, mib_per_s);
+
+	free(data);
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	uint32_t iterations = 1000;
+	bool show_help = false;
+
+	struct wlf_cmd_option options[] = {
+		{ WLF_OPTION_UNSIGNED_INTEGER, "iterations", 'n', &iterations },
+		{ WLF_OPTION_BOOLEAN, "help", 'h', &show_help },
+	};
+
+	if (wlf_cmd_parse_options(options, 2, &argc, argv) < 0) {
+		fprintf(stderr, "Error parsing command line options\n");
+		return EXIT_FAILURE;
+	}
+
+	if (show_help) {
+		print_usage(argv[0]);
+		return EXIT_SUCCESS;
+	}
+	if (iterations == 0) {
+		iterations = 1;
+	}
+
+	wlf_log_init(WLF_INFO, NULL);
+
+	bool ok = true;
+	if (argc > 1) {
+		for (int i = 1; i < argc; i++) {
+			ok &= bench_file(argv[i], iterations);
+		}
+	} else {
+		for (size_t i = 0; i < sizeof(default_files) / sizeof(default_files[0]); i++) {
+			ok &= bench_file(default_files[i], iterations);
+		}
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
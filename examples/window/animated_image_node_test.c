@@ -0,0 +1,145 @@
+#include "wlf/image/wlf_gif_image.h"
+#include "wlf/image/wlf_image.h"
+#include "wlf/platform/wlf_backend.h"
+#include "wlf/renderer/wlf_renderer.h"
+#include "wlf/scene/wlf_animated_image_node.h"
+#include "wlf/scene/wlf_scene.h"
+#include "wlf/scene/wlf_scene_tree.h"
+#include "wlf/utils/wlf_cmd_parser.h"
+#include "wlf/utils/wlf_log.h"
+#include "wlf/window/wayland/xdg_toplevel_window.h"
+#include "wlf/window/wlf_window.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <string.h>
+
+struct test_state {
+	struct wlf_backend *backend;
+	struct wlf_listener close;
+};
+
+static void handle_close(struct wlf_listener *listener, void *data) {
+	(void)data;
+	struct test_state *state = wlf_container_of(listener, state, close);
+	wlf_backend_quit(state->backend);
+}
+
+static void print_usage(const char *program_name) {
+	printf("Usage: %s [OPTIONS]\n", program_name);
+	printf("  -i, --input <path>  GIF or WebP file to play\n");
+	printf("  -s, --stream        Decode GIF frames on demand\n");
+	printf("  -h, --help          Show this help message\n");
+}
+
+static struct wlf_image *load_image(const char *path, bool stream) {
+	const char *ext = strrchr(path, '.');
+	if (!stream || ext == NULL || strcasecmp(ext, ".gif") != 0) {
+		return wlf_image_load(path);
+	}
+
+	struct wlf_gif_image *gif = wlf_gif_image_create();
+	if (gif == NULL) {
+		return NULL;
+	}
+	if (!wlf_gif_image_load_streaming(gif, path, NULL)) {
+		wlf_image_finish(&gif->base);
+		free(gif);
+		return NULL;
+	}
+	return &gif->base;
+}
+
+int main(int argc, char *argv[]) {
+	char *input_path = NULL;
+	bool stream = false;
+	bool show_help = false;
+	const struct wlf_cmd_option options[] = {
+		{WLF_OPTION_STRING, "input", 'i', &input_path},
+		{WLF_OPTION_BOOLEAN, "stream", 's', &stream},
+		{WLF_OPTION_BOOLEAN, "help", 'h', &show_help},
+	};
+	wlf_cmd_parse_options(options, 3, &argc, argv);
+	if (show_help) {
+		print_usage(argv[0]);
+		free(input_path);
+		return EXIT_SUCCESS;
+	}
+	if (argc != 1) {
+		print_usage(argv[0]);
+		free(input_path);
+		return EXIT_FAILURE;
+	}
+	const char *image_path = input_path != NULL ? input_path :
+		WLF_ANIMATED_IMAGE_NODE_TEST_IMAGE;
+
+	wlf_log_init(WLF_DEBUG, NULL);
+	wlf_log(WLF_INFO, "Loading animation: %s", image_path);
+	struct wlf_image *image = load_image(image_path, stream);
+	if (image == NULL) {
+		wlf_log(WLF_ERROR, "Failed to load animation: %s", image_path);
+		free(input_path);
+		return EXIT_FAILURE;
+	}
+	free(input_path);
+
+	struct wlf_backend *backend = wlf_backend_autocreate();
+	if (backend == NULL) {
+		wlf_image_finish(image);
+		free(image);
+		return EXIT_FAILURE;
+	}
+	struct wlf_renderer *renderer = wlf_renderer_autocreate(backend);
+	struct wlf_window *window = wlf_xdg_toplevel_window_create_from_backend(
+		backend, 720, 480);
+	if (renderer == NULL || window == NULL) {
+		wlf_image_finish(image);
+		free(image);
+		wlf_renderer_destroy(renderer);
+		wlf_backend_destroy(backend);
+		return EXIT_FAILURE;
+	}
+
+	wlf_window_init_renderer(window, renderer);
+	struct wlf_scene *scene = wlf_scene_create(window);
+	if (scene == NULL) {
+		wlf_image_finish(image);
+		free(image);
+		wlf_window_destroy(window);
+		wlf_renderer_destroy(renderer);
+		wlf_backend_destroy(backend);
+		return EXIT_FAILURE;
+	}
+	wlf_window_set_title(window, "wlframe animated image node test");
+	wlf_window_set_background_color(window, &WLF_COLOR_DARK_GRAY);
+
+	/* The node owns the image from here on. */
+	struct wlf_animated_image_node *node = wlf_animated_image_node_create(
+		&scene->tree->base, image, 60, 60, 0, 0);
+	if (node == NULL) {
+		wlf_log(WLF_ERROR, "Failed to create animated image node");
+		wlf_image_finish(image);
+		free(image);
+		wlf_window_destroy(window);
+		wlf_renderer_destroy(renderer);
+		wlf_backend_destroy(backend);
+		return EXIT_FAILURE;
+	}
+	wlf_log(WLF_INFO, "Playing %u frames", node->frame_count);
+
+	struct test_state state = {
+		.backend = backend,
+		.close.notify = handle_close,
+	};
+	wlf_signal_add(&window->events.close, &state.close);
+	wlf_window_show(window);
+	wlf_backend_exe(backend);
+
+	wlf_linked_list_remove(&state.close.link);
+	wlf_window_destroy(window);
+	wlf_renderer_destroy(renderer);
+	wlf_backend_destroy(backend);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+#include "wlf/platform/wlf_backend.h"
+#include "wlf/renderer/wlf_renderer.h"
+#include "wlf/scene/wlf_scene.h"
+#include "wlf/scene/wlf_scene_tree.h"
+#include "wlf/scene/wlf_text_node.h"
+#include "wlf/utils/wlf_log.h"
+#include "wlf/window/wayland/xdg_toplevel_window.h"
+#include "wlf/window/wlf_window.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+enum test_step {
+	TEST_STEP_CHANGE_SCALE,
+	TEST_STEP_SCROLL_INTO_VIEW,
+	TEST_STEP_CHECK_RASTERIZED,
+};
+
+struct test_state {
+	struct wlf_backend *backend;
+	struct wlf_window *window;
+	struct wlf_text_node *text;
+	enum test_step step;
+	double scale;
+	bool passed;
+	struct wlf_listener frame_done;
+	struct wlf_listener close;
+};
+
+static bool text_is_stale(const struct wlf_text_node *text) {
+	return !wlf_linked_list_empty(&text->stale_link);
+}
+
+static void finish(struct test_state *state, bool passed) {
+	state->passed = passed;
+	wlf_backend_quit(state->backend);
+}
+
+/* The text starts below the window. A scale change leaves it stale while it
+ * is off screen; moving it into view must get it rasterized at the new scale
+ * by the next commit even though no further scale change happens. */
+static void handle_frame_done(struct wlf_listener *listener, void *data) {
+	(void)data;
+	struct test_state *state =
+		wlf_container_of(listener, state, frame_done);
+	switch (state->step) {
+	case TEST_STEP_CHANGE_SCALE:
+		state->scale = state->window->state.scale * 2.0;
+		wlf_window_set_scale(state->window, state->scale);
+		state->step = TEST_STEP_SCROLL_INTO_VIEW;
+		break;
+	case TEST_STEP_SCROLL_INTO_VIEW:
+		if (!text_is_stale(state->text)) {
+			wlf_log(WLF_ERROR, "off-screen text was rasterized at scale %.2f",
+				state->text->raster_scale);
+			finish(state, false);
+			return;
+		}
+		wlf_scene_node_set_position(&state->text->base, 20, 20);
+		state->step = TEST_STEP_CHECK_RASTERIZED;
+		break;
+	case TEST_STEP_CHECK_RASTERIZED:
+		if (text_is_stale(state->text) ||
+				state->text->raster_scale != state->scale) {
+			wlf_log(WLF_ERROR, "text scrolled into view kept scale %.2f, expected %.2f",
+				state->text->raster_scale, state->scale);
+			finish(state, false);
+			return;
+		}
+		wlf_log(WLF_INFO, "stale text rasterized at scale %.2f once visible",
+			state->scale);
+		finish(state, true);
+		return;
+	}
+	wlf_window_schedule_frame(state->window);
+}
+
+static void handle_close(struct wlf_listener *listener, void *data) {
+	(void)data;
+	struct test_state *state = wlf_container_of(listener, state, close);
+	wlf_backend_quit(state->backend);
+}
+
+int main(void) {
+	wlf_log_init(WLF_DEBUG, NULL);
+	struct wlf_backend *backend = wlf_backend_autocreate();
+	if (backend == NULL) {
+		return EXIT_FAILURE;
+	}
+
+	struct wlf_renderer *renderer = wlf_renderer_autocreate(backend);
+	struct wlf_window *window = wlf_xdg_toplevel_window_create_from_backend(
+		backend, 640, 360);
+	if (renderer == NULL || window == NULL) {
+		wlf_renderer_destroy(renderer);
+		wlf_backend_destroy(backend);
+		return EXIT_FAILURE;
+	}
+
+	wlf_window_init_renderer(window, renderer);
+	struct wlf_scene *scene = wlf_scene_create(window);
+	if (scene == NULL) {
+		wlf_window_destroy(window);
+		wlf_renderer_destroy(renderer);
+		wlf_backend_destroy(backend);
+		return EXIT_FAILURE;
+	}
+
+	wlf_window_set_title(window, "wlframe stale text test");
+	wlf_window_set_background_color(window, &WLF_COLOR_DARK_GRAY);
+	struct wlf_text_node *text = wlf_text_node_create(&scene->tree->base,
+		20, 1000, "Rasterized once scrolled into view", NULL, 24.0, NULL);
+	if (text == NULL) {
+		wlf_window_destroy(window);
+		wlf_renderer_destroy(renderer);
+		wlf_backend_destroy(backend);
+		return EXIT_FAILURE;
+	}
+
+	struct test_state state = {
+		.backend = backend,
+		.window = window,
+		.text = text,
+		.step = TEST_STEP_CHANGE_SCALE,
+		.frame_done.notify = handle_frame_done,
+		.close.notify = handle_close,
+	};
+	wlf_signal_add(&scene->events.frame_done, &state.frame_done);
+	wlf_signal_add(&window->events.close, &state.close);
+
+	wlf_window_show(window);
+	wlf_backend_exe(backend);
+
+	wlf_linked_list_remove(&state.frame_done.link);
+	wlf_linked_list_remove(&state.close.link);
+	wlf_window_destroy(window);
+	wlf_renderer_destroy(renderer);
+	wlf_backend_destroy(backend);
+	return state.passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
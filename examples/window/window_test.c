@@ -13,6 +13,7 @@
 #include "wlf/scene/wlf_poly_node.h"
 #include "wlf/scene/wlf_path_node.h"
 #include "wlf/image/wlf_image.h"
+#include "wlf/image/wlf_image_cache.h"
 #include "wlf/utils/wlf_log.h"
 #include "wlf/window/wayland/xdg_toplevel_window.h"
 #include "wlf/window/wlf_window.h"
@@ -219,33 +220,29 @@ int main(int argc, char *argv[]) {
 		WLF_TEXT_FONT_WEIGHT_BOLD);
 	wlf_text_node_set_max_width(render.text, 260);
 
-	struct wlf_image *image = wlf_image_load(image_path);
-	if (image == NULL) {
+	/* Icons and images shared by several nodes are decoded and uploaded
+	 * once through the image cache. */
+	struct wlf_image_cache_entry *entry = wlf_image_cache_load(
+		wlf_image_cache_get_default(), image_path, 0, 0, 1.0f);
+	if (entry == NULL) {
 		wlf_log(WLF_ERROR, "Failed to load image: %s", image_path);
 		wlf_window_destroy(window);
 		wlf_renderer_destroy(renderer);
 		wlf_backend_destroy(backend);
 		return EXIT_FAILURE;
 	}
-	struct wlf_texture *texture = wlf_texture_from_image(renderer, image);
+	const struct wlf_image *image = wlf_image_cache_entry_get_image(entry);
 	double scale = fmin(270.0 / image->width, 190.0 / image->height);
 	double image_width = image->width * scale;
 	double image_height = image->height * scale;
-	wlf_image_finish(image);
-	free(image);
-	if (texture == NULL) {
-		wlf_log(WLF_ERROR, "Failed to create texture for: %s", image_path);
-		wlf_window_destroy(window);
-		wlf_renderer_destroy(renderer);
-		wlf_backend_destroy(backend);
-		return EXIT_FAILURE;
-	}
-	render.image = wlf_texture_node_create(&tree->base, texture,
+	render.image = wlf_texture_node_create_from_cache(&tree->base, entry,
+		renderer,
 		40.0 + (270.0 - image_width) / 2.0,
 		270.0 + (190.0 - image_height) / 2.0,
 		image_width, image_height);
+	wlf_image_cache_entry_unref(entry);
 	if (render.image == NULL) {
-		wlf_texture_destroy(texture);
+		wlf_log(WLF_ERROR, "Failed to create texture for: %s", image_path);
 		wlf_window_destroy(window);
 		wlf_renderer_destroy(renderer);
 		wlf_backend_destroy(backend);
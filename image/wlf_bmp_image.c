@@ -1,4 +1,5 @@
 #include "wlf/image/wlf_bmp_image.h"
+#include "wlf/utils/wlf_file_source.h"
 #include "wlf/utils/wlf_log.h"
 #include "wlf/utils/wlf_linked_list.h"
 
@@ -62,25 +63,18 @@ static void write_uint32_le(FILE *fp, uint32_t value) {
 }
 
 /**
- * @brief Read a 16-bit value in little-endian format.
+ * @brief Read a 16-bit little-endian value from memory.
  */
-static uint16_t read_uint16_le(FILE *fp) {
-	uint16_t value = 0;
-	value |= fgetc(fp);
-	value |= (fgetc(fp) << 8);
-	return value;
+static uint16_t read_uint16_le(const uint8_t *p) {
+	return (uint16_t)(p[0] | (p[1] << 8));
 }
 
 /**
- * @brief Read a 32-bit value in little-endian format.
+ * @brief Read a 32-bit little-endian value from memory.
  */
-static uint32_t read_uint32_le(FILE *fp) {
-	uint32_t value = 0;
-	value |= fgetc(fp);
-	value |= (fgetc(fp) << 8);
-	value |= (fgetc(fp) << 16);
-	value |= (fgetc(fp) << 24);
-	return value;
+static uint32_t read_uint32_le(const uint8_t *p) {
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+		((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
 }
 
 static bool bmp_image_save(struct wlf_image *image, const char *filename) {
@@ -147,49 +141,37 @@ static bool bmp_image_save(struct wlf_image *image, const char *filename) {
 	return true;
 }
 
-static bool bmp_image_load(struct wlf_image *image, const char *filename, bool enable_16_bit) {
-	FILE *fp = fopen(filename, "rb");
-	if (fp == NULL) {
-		wlf_log_errno(WLF_ERROR, "File %s cannot be opened!", filename);
-		return false;
-	}
-
-	// Read and verify BMP file header
-	uint16_t signature = read_uint16_le(fp);
-	if (signature != 0x4D42) { // "BM"
-		wlf_log(WLF_ERROR, "File %s is not a valid BMP image!", filename);
-		fclose(fp);
+static bool bmp_image_load_source(struct wlf_image *image,
+		struct wlf_file_source *source, bool enable_16_bit) {
+	// File header (14 bytes) followed by BITMAPINFOHEADER (40 bytes)
+	const uint8_t *header = wlf_file_source_take(source, 14 + 40);
+	if (header == NULL || read_uint16_le(header) != 0x4D42) { // "BM"
+		wlf_log(WLF_ERROR, "File %s is not a valid BMP image!", source->name);
 		return false;
 	}
 
-	read_uint32_le(fp); // file_size (not used)
-	read_uint16_le(fp); // reserved1 (not used)
-	read_uint16_le(fp); // reserved2 (not used)
-	uint32_t data_offset = read_uint32_le(fp);
+	// file_size and reserved fields (not used)
+	uint32_t data_offset = read_uint32_le(header + 10);
 
-	// Read BMP info header
-	uint32_t header_size = read_uint32_le(fp);
+	const uint8_t *info = header + 14;
+	uint32_t header_size = read_uint32_le(info);
 	if (header_size != 40) {
 		wlf_log(WLF_ERROR, "Unsupported BMP header size: %u", header_size);
-		fclose(fp);
 		return false;
 	}
 
-	int32_t width = (int32_t)read_uint32_le(fp);
-	int32_t height = (int32_t)read_uint32_le(fp);
-	uint16_t planes = read_uint16_le(fp);
-	uint16_t bits_per_pixel = read_uint16_le(fp);
-	uint32_t compression = read_uint32_le(fp);
-	read_uint32_le(fp); // image_size (not used)
-	read_uint32_le(fp); // x_ppm (not used)
-	read_uint32_le(fp); // y_ppm (not used)
-	uint32_t colors_used = read_uint32_le(fp);
-	uint32_t important_colors = read_uint32_le(fp);
+	int32_t width = (int32_t)read_uint32_le(info + 4);
+	int32_t height = (int32_t)read_uint32_le(info + 8);
+	uint16_t planes = read_uint16_le(info + 12);
+	uint16_t bits_per_pixel = read_uint16_le(info + 14);
+	uint32_t compression = read_uint32_le(info + 16);
+	// image_size, x_ppm and y_ppm (not used)
+	uint32_t colors_used = read_uint32_le(info + 32);
+	uint32_t important_colors = read_uint32_le(info + 36);
 
 	// Validate header values
-	if (width <= 0 || abs(height) <= 0 || planes != 1) {
+	if (width <= 0 || height == 0 || height == INT32_MIN || planes != 1) {
 		wlf_log(WLF_ERROR, "Invalid BMP dimensions or plane count!");
-		fclose(fp);
 		return false;
 	}
 
@@ -197,20 +179,25 @@ static bool bmp_image_load(struct wlf_image *image, const char *filename, bool e
 	if (bits_per_pixel != 24 || compression != WLF_BMP_COMPRESSION_RGB) {
 		wlf_log(WLF_ERROR, "Unsupported BMP format: %u bits, compression %u",
 			bits_per_pixel, compression);
-		fclose(fp);
 		return false;
 	}
 
 	bool top_down = (height < 0);
 	uint32_t abs_height = abs(height);
-	uint32_t row_size = calculate_row_size(width, bits_per_pixel);
 	size_t width_u = (size_t)width;
 	size_t abs_height_u = (size_t)abs_height;
 	size_t stride = width_u * 3;
+	size_t row_size = (stride + 3) & ~(size_t)3;
 
 	if (stride > UINT32_MAX || width_u > UINT32_MAX || abs_height_u > UINT32_MAX) {
 		wlf_log(WLF_ERROR, "BMP dimensions are too large");
-		fclose(fp);
+		return false;
+	}
+
+	// The whole pixel array must be present before anything is allocated
+	if (!wlf_file_source_seek(source, data_offset) ||
+			wlf_file_source_remaining(source) / row_size < abs_height_u) {
+		wlf_log(WLF_ERROR, "Error reading pixel data!");
 		return false;
 	}
 
@@ -219,47 +206,24 @@ static bool bmp_image_load(struct wlf_image *image, const char *filename, bool e
 	image->data = malloc(data_size);
 	if (image->data == NULL) {
 		wlf_log_errno(WLF_ERROR, "Failed to allocate image data");
-		fclose(fp);
-		return false;
-	}
-
-	// Seek to pixel data
-	fseek(fp, data_offset, SEEK_SET);
-
-	// Read pixel data
-	uint8_t *row_buffer = malloc(row_size);
-	if (row_buffer == NULL) {
-		wlf_log_errno(WLF_ERROR, "Failed to allocate row buffer");
-		free(image->data);
-		fclose(fp);
 		return false;
 	}
 
 	for (uint32_t y = 0; y < abs_height; y++) {
-		if (fread(row_buffer, 1, row_size, fp) != row_size) {
-			wlf_log(WLF_ERROR, "Error reading pixel data!");
-			free(row_buffer);
-			free(image->data);
-			fclose(fp);
-			return false;
-		}
+		const uint8_t *row = wlf_file_source_take(source, row_size);
 
 		// Determine the target row (BMP is bottom-up by default)
 		uint32_t target_y = top_down ? y : (abs_height - 1 - y);
+		unsigned char *dst = image->data + (size_t)target_y * stride;
 
 		// Convert BGR to RGB
-		for (uint32_t x = 0; x < (uint32_t)width; x++) {
-			uint32_t src_offset = x * 3;
-			uint32_t dst_offset = (target_y * width + x) * 3;
-
-			image->data[dst_offset] = row_buffer[src_offset + 2];     // R
-			image->data[dst_offset + 1] = row_buffer[src_offset + 1]; // G
-			image->data[dst_offset + 2] = row_buffer[src_offset];     // B
+		for (size_t x = 0; x < width_u; x++) {
+			dst[x * 3] = row[x * 3 + 2];     // R
+			dst[x * 3 + 1] = row[x * 3 + 1]; // G
+			dst[x * 3 + 2] = row[x * 3];     // B
 		}
 	}
 
-	free(row_buffer);
-
 	// Set image properties
 	image->width = (uint32_t)width;
 	image->height = abs_height;
@@ -278,7 +242,6 @@ static bool bmp_image_load(struct wlf_image *image, const char *filename, bool e
 	bmp_image->important_colors = important_colors;
 	bmp_image->top_down = top_down;
 
-	fclose(fp);
 	return true;
 }
 
@@ -289,7 +252,8 @@ static void bmp_image_destroy(struct wlf_image *wlf_image) {
 
 static const struct wlf_image_impl bmp_image_impl = {
 	.save = bmp_image_save,
-	.load = bmp_image_load,
+	.load = wlf_image_load_source_file,
+	.load_source = bmp_image_load_source,
 	.destroy = bmp_image_destroy,
 };
 
@@ -321,6 +285,36 @@ struct wlf_bmp_image *wlf_bmp_image_from_image(struct wlf_image *wlf_image) {
 	return image;
 }
 
+bool wlf_bmp_image_probe(struct wlf_file_source *source,
+		struct wlf_image_info *info) {
+	const uint8_t *header = wlf_file_source_take(source, 14 + 40);
+	if (header == NULL || read_uint16_le(header) != 0x4D42) { // "BM"
+		return false;
+	}
+
+	// Accept exactly what bmp_image_load_source() can decode
+	const uint8_t *bmp_info = header + 14;
+	int32_t width = (int32_t)read_uint32_le(bmp_info + 4);
+	int32_t height = (int32_t)read_uint32_le(bmp_info + 8);
+	if (read_uint32_le(bmp_info) != 40 ||
+			width <= 0 || height == 0 || height == INT32_MIN ||
+			read_uint16_le(bmp_info + 12) != 1 ||
+			read_uint16_le(bmp_info + 14) != 24 ||
+			read_uint32_le(bmp_info + 16) != WLF_BMP_COMPRESSION_RGB) {
+		return false;
+	}
+
+	info->type = WLF_IMAGE_TYPE_BMP;
+	info->width = (uint32_t)width;
+	info->height = (uint32_t)abs(height);
+	info->format = WLF_COLOR_TYPE_RGB;
+	info->bit_depth = WLF_IMAGE_BIT_DEPTH_8;
+	info->has_alpha_channel = false;
+	info->is_animated = false;
+
+	return true;
+}
+
 void wlf_bmp_image_set_compression(struct wlf_bmp_image *image, enum wlf_bmp_compression compression) {
 	if (image) {
 		image->compression = compression;
@@ -1,8 +1,10 @@
 #include "wlf/image/wlf_gif_image.h"
+#include "wlf/utils/wlf_file_source.h"
 #include "wlf/utils/wlf_linked_list.h"
 #include "wlf/utils/wlf_log.h"
 
 #include <assert.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
@@ -14,12 +16,12 @@
 #endif
 
 #if GIFLIB_MAJOR >= 5
-#define WLF_DGIF_OPEN(path, err) DGifOpenFileName((path), (err))
+#define WLF_DGIF_OPEN_USER(data, func, err) DGifOpen((data), (func), (err))
 #define WLF_EGIF_OPEN(path, err) EGifOpenFileName((path), false, (err))
 #define WLF_DGIF_CLOSE(gif, err) DGifCloseFile((gif), (err))
 #define WLF_EGIF_CLOSE(gif, err) EGifCloseFile((gif), (err))
 #else
-#define WLF_DGIF_OPEN(path, err) DGifOpenFileName((path))
+#define WLF_DGIF_OPEN_USER(data, func, err) DGifOpen((data), (func))
 #define WLF_EGIF_OPEN(path, err) EGifOpenFileName((path), false)
 #define WLF_DGIF_CLOSE(gif, err) DGifCloseFile((gif))
 #define WLF_EGIF_CLOSE(gif, err) EGifCloseFile((gif))
@@ -297,6 +299,7 @@ static bool image_save(struct wlf_image *image, const char *filename) {
 	struct wlf_gif_image *gif_image = wlf_gif_image_from_image(image);
 	bool has_frames = (gif_image->frames != NULL && gif_image->frame_count > 0);
 	uint32_t frame_count = has_frames ? gif_image->frame_count : 1;
+	uint32_t saved_frame = gif_image->current_frame;
 
 	int gif_error = 0;
 	GifFileType *gif_file = WLF_EGIF_OPEN(filename, &gif_error);
@@ -348,12 +351,21 @@ static bool image_save(struct wlf_image *image, const char *filename) {
 
 		if (has_frames) {
 			const struct wlf_gif_frame *f = &gif_image->frames[i];
-			if (f->pixels == NULL || f->width != image->width || f->height != image->height) {
+			const unsigned char *pixels = f->pixels;
+			if (pixels == NULL && gif_image->stream != NULL) {
+				/* Streaming images composite each frame on demand. */
+				if (!wlf_gif_image_seek_frame(gif_image, i, NULL)) {
+					ok = false;
+					break;
+				}
+				pixels = image->data;
+			}
+			if (pixels == NULL || f->width != image->width || f->height != image->height) {
 				wlf_log(WLF_ERROR, "Invalid GIF frame %u dimensions or data", i);
 				ok = false;
 				break;
 			}
-			if (!wlf_rgba_to_indices(f->pixels, f->width, f->height, f->stride,
+			if (!wlf_rgba_to_indices(pixels, f->width, f->height, f->stride,
 					indices, &has_transparency, &transparent_index)) {
 				ok = false;
 				break;
@@ -409,6 +421,11 @@ static bool image_save(struct wlf_image *image, const char *filename) {
 	free(indices);
 	GifFreeMapObject(color_map);
 
+	if (gif_image->stream != NULL && gif_image->current_frame != saved_frame &&
+			!wlf_gif_image_seek_frame(gif_image, saved_frame, NULL)) {
+		ok = false;
+	}
+
 	if (gif_close_write(gif_file) == GIF_ERROR) {
 		wlf_log(WLF_ERROR, "EGifCloseFile failed");
 		ok = false;
@@ -540,63 +557,106 @@ static void wlf_blend_saved_image_to_canvas(unsigned char *canvas, GifFileType *
 	}
 }
 
-static bool image_load(struct wlf_image *image, const char *filename, bool enable_16_bit) {
-	(void)enable_16_bit;
-	if (image == NULL || filename == NULL) {
-		return false;
+static int gif_read_source(GifFileType *gif_file, GifByteType *buf, int len) {
+	struct wlf_file_source *source = gif_file->UserData;
+	if (len <= 0) {
+		return 0;
 	}
+	return (int)wlf_file_source_read(source, buf, (size_t)len);
+}
 
+/* Decodes all records of a GIF into palette indices, for the loader that
+ * composites every frame up front. */
+static GifFileType *gif_slurp_source(struct wlf_file_source *source) {
+	const char *filename = source->name;
 	int gif_error = 0;
-	GifFileType *gif_file = WLF_DGIF_OPEN(filename, &gif_error);
+	GifFileType *gif_file = WLF_DGIF_OPEN_USER(source, gif_read_source, &gif_error);
 	if (gif_file == NULL) {
 		wlf_log(WLF_ERROR, "Cannot open %s for GIF reading (err=%d)", filename, gif_error);
-		return false;
+		return NULL;
 	}
 
-	if (DGifSlurp(gif_file) == GIF_ERROR) {
+	int ret = DGifSlurp(gif_file);
+	gif_file->UserData = NULL;
+	if (ret == GIF_ERROR) {
 		wlf_log(WLF_ERROR, "DGifSlurp failed for %s", filename);
 		gif_close_read(gif_file);
-		return false;
+		return NULL;
 	}
 
 	if (gif_file->ImageCount <= 0 || gif_file->SavedImages == NULL ||
 		gif_file->SWidth <= 0 || gif_file->SHeight <= 0) {
 		wlf_log(WLF_ERROR, "Invalid GIF content: %s", filename);
 		gif_close_read(gif_file);
-		return false;
+		return NULL;
 	}
 
-	struct wlf_gif_image *gif_image = wlf_gif_image_from_image(image);
-	if (gif_file->ImageCount > INT_MAX || gif_file->ImageCount < 0 ||
-		gif_file->SWidth > INT_MAX || gif_file->SHeight > INT_MAX) {
-		wlf_log(WLF_ERROR, "GIF metadata is too large");
+	if ((size_t)gif_file->SWidth * 4 > UINT32_MAX) {
+		wlf_log(WLF_ERROR, "GIF row stride is too large");
 		gif_close_read(gif_file);
-		return false;
+		return NULL;
 	}
 
-	gif_image->frame_count = (uint32_t)gif_file->ImageCount;
-	gif_image->frames = calloc(gif_image->frame_count, sizeof(*gif_image->frames));
-	if (gif_image->frames == NULL) {
-		wlf_log(WLF_ERROR, "Failed to allocate GIF frame array");
-		gif_close_read(gif_file);
-		return false;
+	return gif_file;
+}
+
+static void gif_free_frames(struct wlf_gif_image *gif_image) {
+	if (gif_image->frames != NULL) {
+		for (uint32_t i = 0; i < gif_image->frame_count; i++) {
+			free(gif_image->frames[i].pixels);
+		}
 	}
+	free(gif_image->frames);
+	gif_image->frames = NULL;
+	gif_image->frame_count = 0;
+}
 
-	size_t canvas_size = (size_t)gif_file->SWidth * gif_file->SHeight * 4;
-	unsigned char *canvas = malloc(canvas_size);
-	unsigned char *previous_canvas = malloc(canvas_size);
-	if (canvas == NULL || previous_canvas == NULL) {
-		wlf_log(WLF_ERROR, "Failed to allocate GIF composition buffers");
-		free(canvas);
-		free(previous_canvas);
-		free(gif_image->frames);
-		gif_image->frames = NULL;
+static bool gif_alloc_frames(struct wlf_gif_image *gif_image, uint32_t count) {
+	gif_image->frame_count = count;
+	gif_image->frames = calloc(count, sizeof(*gif_image->frames));
+	if (gif_image->frames == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate GIF frame array");
 		gif_image->frame_count = 0;
-		gif_close_read(gif_file);
 		return false;
 	}
 
-	wlf_build_initial_canvas(gif_file, canvas);
+	return true;
+}
+
+/* Fills one frame table entry; frames must be set in order because each
+ * timestamp follows from the previous frame. */
+static void gif_set_frame(struct wlf_gif_image *gif_image, const GifFileType *gif_file,
+		uint32_t index, const GraphicsControlBlock *gcb) {
+	struct wlf_gif_frame *out = &gif_image->frames[index];
+	out->width = (uint32_t)gif_file->SWidth;
+	out->height = (uint32_t)gif_file->SHeight;
+	out->stride = (uint32_t)((size_t)gif_file->SWidth * 4);
+	out->delay_ms = (uint32_t)gcb->DelayTime * 10;
+	out->timestamp_ms = index == 0 ? 0 :
+		out[-1].timestamp_ms + out[-1].delay_ms;
+	out->disposal_method = (uint8_t)gcb->DisposalMode;
+}
+
+static void gif_set_base(struct wlf_gif_image *gif_image, const GifFileType *gif_file,
+		bool has_alpha) {
+	struct wlf_image *image = &gif_image->base;
+	image->width = (uint32_t)gif_file->SWidth;
+	image->height = (uint32_t)gif_file->SHeight;
+	image->format = WLF_COLOR_TYPE_RGBA;
+	image->bit_depth = WLF_IMAGE_BIT_DEPTH_8;
+	image->stride = (uint32_t)((size_t)gif_file->SWidth * 4);
+	image->has_alpha_channel = has_alpha;
+	image->is_opaque = !has_alpha;
+	gif_image->delay_ms = gif_image->frames[0].delay_ms;
+	gif_image->current_frame = 0;
+}
+
+/* Fills the frame table, loop count and base image fields, without
+ * compositing any pixels. */
+static bool gif_load_metadata(struct wlf_gif_image *gif_image, GifFileType *gif_file) {
+	if (!gif_alloc_frames(gif_image, (uint32_t)gif_file->ImageCount)) {
+		return false;
+	}
 
 	bool found_loop = false;
 	gif_image->loop_count = 0;
@@ -614,6 +674,51 @@ static bool image_load(struct wlf_image *image, const char *filename, bool enabl
 	}
 
 	bool has_alpha = false;
+	for (int i = 0; i < gif_file->ImageCount; i++) {
+		GraphicsControlBlock gcb;
+		wlf_get_frame_gcb(gif_file, i, &gcb);
+		gif_set_frame(gif_image, gif_file, (uint32_t)i, &gcb);
+		if (gcb.TransparentColor != NO_TRANSPARENT_COLOR) {
+			has_alpha = true;
+		}
+	}
+
+	gif_set_base(gif_image, gif_file, has_alpha);
+	return true;
+}
+
+static bool image_load_source(struct wlf_image *image,
+		struct wlf_file_source *source, bool enable_16_bit) {
+	(void)enable_16_bit;
+	if (image == NULL || source == NULL) {
+		return false;
+	}
+
+	GifFileType *gif_file = gif_slurp_source(source);
+	if (gif_file == NULL) {
+		return false;
+	}
+
+	struct wlf_gif_image *gif_image = wlf_gif_image_from_image(image);
+	if (!gif_load_metadata(gif_image, gif_file)) {
+		gif_close_read(gif_file);
+		return false;
+	}
+
+	size_t canvas_size = (size_t)gif_file->SWidth * gif_file->SHeight * 4;
+	unsigned char *canvas = malloc(canvas_size);
+	unsigned char *previous_canvas = malloc(canvas_size);
+	if (canvas == NULL || previous_canvas == NULL) {
+		wlf_log(WLF_ERROR, "Failed to allocate GIF composition buffers");
+		free(canvas);
+		free(previous_canvas);
+		gif_free_frames(gif_image);
+		gif_close_read(gif_file);
+		return false;
+	}
+
+	wlf_build_initial_canvas(gif_file, canvas);
+
 	for (int i = 0; i < gif_file->ImageCount; i++) {
 		SavedImage *frame = &gif_file->SavedImages[i];
 		GraphicsControlBlock gcb;
@@ -626,34 +731,10 @@ static bool image_load(struct wlf_image *image, const char *filename, bool enabl
 		wlf_blend_saved_image_to_canvas(canvas, gif_file, frame, &gcb);
 
 		struct wlf_gif_frame *out = &gif_image->frames[i];
-		if ((size_t)gif_file->SWidth * 4 > UINT32_MAX) {
-			wlf_log(WLF_ERROR, "GIF row stride is too large");
-			for (int j = 0; j < i; j++) {
-				free(gif_image->frames[j].pixels);
-			}
-			free(gif_image->frames);
-			gif_image->frames = NULL;
-			gif_image->frame_count = 0;
-			free(canvas);
-			free(previous_canvas);
-			gif_close_read(gif_file);
-			return false;
-		}
-
-		out->width = (uint32_t)gif_file->SWidth;
-		out->height = (uint32_t)gif_file->SHeight;
-		out->stride = (uint32_t)((size_t)gif_file->SWidth * 4);
-		out->delay_ms = (uint32_t)gcb.DelayTime * 10;
-		out->disposal_method = (uint8_t)gcb.DisposalMode;
 		out->pixels = malloc(canvas_size);
 		if (out->pixels == NULL) {
 			wlf_log(WLF_ERROR, "Failed to allocate frame pixels for frame %d", i);
-			for (int j = 0; j < i; j++) {
-				free(gif_image->frames[j].pixels);
-			}
-			free(gif_image->frames);
-			gif_image->frames = NULL;
-			gif_image->frame_count = 0;
+			gif_free_frames(gif_image);
 			free(canvas);
 			free(previous_canvas);
 			gif_close_read(gif_file);
@@ -661,10 +742,6 @@ static bool image_load(struct wlf_image *image, const char *filename, bool enabl
 		}
 		memcpy(out->pixels, canvas, canvas_size);
 
-		if (gcb.TransparentColor != NO_TRANSPARENT_COLOR) {
-			has_alpha = true;
-		}
-
 		if (gcb.DisposalMode == DISPOSE_BACKGROUND) {
 			wlf_clear_rect_to_background(canvas, gif_file, &frame->ImageDesc);
 		} else if (gcb.DisposalMode == DISPOSE_PREVIOUS) {
@@ -675,15 +752,7 @@ static bool image_load(struct wlf_image *image, const char *filename, bool enabl
 	free(canvas);
 	free(previous_canvas);
 
-	image->width = (uint32_t)gif_file->SWidth;
-	image->height = (uint32_t)gif_file->SHeight;
-	image->format = WLF_COLOR_TYPE_RGBA;
-	image->bit_depth = WLF_IMAGE_BIT_DEPTH_8;
-	image->stride = (uint32_t)((size_t)gif_file->SWidth * 4);
-	image->has_alpha_channel = has_alpha;
-	image->is_opaque = !has_alpha;
 	image->data = gif_image->frames[0].pixels;
-	gif_image->delay_ms = gif_image->frames[0].delay_ms;
 
 	if (gif_close_read(gif_file) == GIF_ERROR) {
 		wlf_log(WLF_ERROR, "DGifCloseFile failed");
@@ -693,26 +762,633 @@ static bool image_load(struct wlf_image *image, const char *filename, bool enabl
 	return true;
 }
 
+#define GIF_DEFAULT_KEYFRAME_INTERVAL 16
+#define GIF_DEFAULT_MAX_KEYFRAMES 4
+#define GIF_NO_FRAME UINT32_MAX
+
+/**
+ * A snapshot of the canvas right before a frame is composited, i.e. after
+ * the disposal of the frame preceding it.
+ */
+struct gif_keyframe {
+	uint32_t index;
+	uint64_t last_used;
+	unsigned char *pixels;
+};
+
+/**
+ * Where a frame starts in the encoded data, and what is needed to dispose
+ * of it without decompressing it again.
+ */
+struct gif_stream_frame {
+	size_t offset;                /* Source offset just past the image separator */
+	GifImageDesc desc;            /* Frame placement; ColorMap is always NULL */
+	GraphicsControlBlock gcb;
+};
+
+struct wlf_gif_stream {
+	struct wlf_file_source source; /* Encoded bytes, read again for each frame */
+	GifFileType *gif_file;        /* Decoder reading source at its cursor */
+	struct gif_stream_frame *frames;
+	uint32_t frame_count;
+	GifByteType *indices;         /* Palette indices of the frame being decoded */
+	unsigned char *canvas;        /* Composited RGBA canvas, aliased by base.data */
+	unsigned char *previous;      /* Canvas area saved for DISPOSE_PREVIOUS, may be NULL */
+	size_t canvas_size;
+	uint32_t current;             /* Frame shown in canvas, or GIF_NO_FRAME */
+	uint32_t next;                /* Frame canvas is prepared for when current is GIF_NO_FRAME */
+
+	uint32_t keyframe_interval;
+	uint32_t max_keyframes;
+	uint32_t keyframe_count;
+	uint64_t use_clock;
+	struct gif_keyframe *keyframes;
+};
+
+static const GraphicsControlBlock gif_default_gcb = {
+	.DisposalMode = DISPOSAL_UNSPECIFIED,
+	.UserInputFlag = false,
+	.DelayTime = 0,
+	.TransparentColor = NO_TRANSPARENT_COLOR,
+};
+
+static struct wlf_rect gif_canvas_rect(const GifFileType *gif_file) {
+	return wlf_rect_make(0, 0, gif_file->SWidth, gif_file->SHeight);
+}
+
+static struct wlf_rect gif_frame_rect(const GifFileType *gif_file, const GifImageDesc *desc) {
+	int x1 = desc->Left > 0 ? desc->Left : 0;
+	int y1 = desc->Top > 0 ? desc->Top : 0;
+	int x2 = desc->Left + desc->Width;
+	int y2 = desc->Top + desc->Height;
+	if (x2 > gif_file->SWidth) {
+		x2 = gif_file->SWidth;
+	}
+	if (y2 > gif_file->SHeight) {
+		y2 = gif_file->SHeight;
+	}
+	if (x2 <= x1 || y2 <= y1) {
+		return wlf_rect_make(0, 0, 0, 0);
+	}
+
+	return wlf_rect_make(x1, y1, x2 - x1, y2 - y1);
+}
+
+static void rect_add(struct wlf_rect *dst, const struct wlf_rect *rect) {
+	if (wlf_rect_is_empty(rect)) {
+		return;
+	}
+	if (wlf_rect_is_empty(dst)) {
+		*dst = *rect;
+		return;
+	}
+
+	int x1 = dst->x < rect->x ? dst->x : rect->x;
+	int y1 = dst->y < rect->y ? dst->y : rect->y;
+	int x2 = dst->x + dst->width > rect->x + rect->width ?
+		dst->x + dst->width : rect->x + rect->width;
+	int y2 = dst->y + dst->height > rect->y + rect->height ?
+		dst->y + dst->height : rect->y + rect->height;
+	*dst = wlf_rect_make(x1, y1, x2 - x1, y2 - y1);
+}
+
+static void copy_canvas_rect(unsigned char *dst, const unsigned char *src,
+		int canvas_width, const struct wlf_rect *rect) {
+	size_t row_size = (size_t)rect->width * 4;
+	for (int y = rect->y; y < rect->y + rect->height; y++) {
+		size_t offset = ((size_t)y * canvas_width + rect->x) * 4;
+		memcpy(dst + offset, src + offset, row_size);
+	}
+}
+
+/* DGifGetImageDesc() appends every descriptor it reads to SavedImages. The
+ * stream reads descriptors again on each frame, so drop them right away. */
+static void gif_drop_saved_images(GifFileType *gif_file) {
+	GifFreeSavedImages(gif_file);
+	gif_file->ImageCount = 0;
+}
+
+static void gif_stream_destroy(struct wlf_gif_stream *stream) {
+	if (stream == NULL) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < stream->keyframe_count; i++) {
+		free(stream->keyframes[i].pixels);
+	}
+	free(stream->keyframes);
+	free(stream->previous);
+	free(stream->canvas);
+	free(stream->indices);
+	free(stream->frames);
+	if (stream->gif_file != NULL) {
+		gif_close_read(stream->gif_file);
+	}
+	wlf_file_source_finish(&stream->source);
+	free(stream);
+}
+
+static bool gif_stream_scan_extension(GifFileType *gif_file, GraphicsControlBlock *gcb,
+		uint32_t *loop_count, bool *found_loop) {
+	int function = 0;
+	GifByteType *ext = NULL;
+	if (DGifGetExtension(gif_file, &function, &ext) == GIF_ERROR) {
+		return false;
+	}
+
+	bool loop_block = false;
+	if (ext != NULL && function == GRAPHICS_EXT_FUNC_CODE) {
+		DGifExtensionToGCB(ext[0], ext + 1, gcb);
+	} else if (ext != NULL && function == APPLICATION_EXT_FUNC_CODE && ext[0] >= 11) {
+		loop_block = !*found_loop &&
+			(memcmp(ext + 1, "NETSCAPE2.0", 11) == 0 ||
+			memcmp(ext + 1, "ANIMEXTS1.0", 11) == 0);
+	}
+
+	while (ext != NULL) {
+		if (DGifGetExtensionNext(gif_file, &ext) == GIF_ERROR) {
+			return false;
+		}
+		if (loop_block && ext != NULL && ext[0] >= 3 && ext[1] == 1) {
+			*loop_count = (uint32_t)(ext[2] | (ext[3] << 8));
+			*found_loop = true;
+			loop_block = false;
+		}
+	}
+
+	return true;
+}
+
+static bool gif_stream_add_frame(struct wlf_gif_stream *stream, uint32_t *capacity,
+		size_t offset, const GraphicsControlBlock *gcb) {
+	if (stream->frame_count == *capacity) {
+		if (*capacity > UINT32_MAX / 2) {
+			return false;
+		}
+		uint32_t new_capacity = *capacity == 0 ? 16 : *capacity * 2;
+		struct gif_stream_frame *frames = realloc(stream->frames,
+			(size_t)new_capacity * sizeof(*frames));
+		if (frames == NULL) {
+			wlf_log_errno(WLF_ERROR, "Failed to allocate GIF frame offsets");
+			return false;
+		}
+		stream->frames = frames;
+		*capacity = new_capacity;
+	}
+
+	struct gif_stream_frame *frame = &stream->frames[stream->frame_count++];
+	frame->offset = offset;
+	frame->desc = stream->gif_file->Image;
+	frame->desc.ColorMap = NULL;
+	frame->gcb = *gcb;
+	return true;
+}
+
+/* Walks the records once, skipping the LZW data, to record where each frame
+ * starts together with its placement and graphics control block. */
+static bool gif_stream_scan(struct wlf_gif_stream *stream, uint32_t *loop_count,
+		size_t *max_frame_area) {
+	GifFileType *gif_file = stream->gif_file;
+	GraphicsControlBlock gcb = gif_default_gcb;
+	bool found_loop = false;
+	uint32_t capacity = 0;
+	*loop_count = 0;
+	*max_frame_area = 0;
+
+	for (;;) {
+		GifRecordType type;
+		if (DGifGetRecordType(gif_file, &type) == GIF_ERROR) {
+			return false;
+		}
+		if (type == TERMINATE_RECORD_TYPE) {
+			return stream->frame_count > 0;
+		}
+		if (type == EXTENSION_RECORD_TYPE) {
+			if (!gif_stream_scan_extension(gif_file, &gcb, loop_count, &found_loop)) {
+				return false;
+			}
+			continue;
+		}
+		if (type != IMAGE_DESC_RECORD_TYPE) {
+			continue;
+		}
+
+		size_t offset = stream->source.offset;
+		if (DGifGetImageDesc(gif_file) == GIF_ERROR) {
+			return false;
+		}
+		gif_drop_saved_images(gif_file);
+		if (!gif_stream_add_frame(stream, &capacity, offset, &gcb)) {
+			return false;
+		}
+		gcb = gif_default_gcb;
+
+		size_t area = (size_t)gif_file->Image.Width * gif_file->Image.Height;
+		if (area > *max_frame_area) {
+			*max_frame_area = area;
+		}
+
+		int code_size = 0;
+		GifByteType *block = NULL;
+		if (DGifGetCode(gif_file, &code_size, &block) == GIF_ERROR) {
+			return false;
+		}
+		while (block != NULL) {
+			if (DGifGetCodeNext(gif_file, &block) == GIF_ERROR) {
+				return false;
+			}
+		}
+	}
+}
+
+/* Decompresses one frame into stream->indices, rows in file order. On
+ * success gif_file->Image describes the frame and its local color map. */
+static bool gif_stream_decode(struct wlf_gif_stream *stream, uint32_t index) {
+	GifFileType *gif_file = stream->gif_file;
+	if (!wlf_file_source_seek(&stream->source, stream->frames[index].offset) ||
+			DGifGetImageDesc(gif_file) == GIF_ERROR) {
+		return false;
+	}
+	gif_drop_saved_images(gif_file);
+
+	const GifImageDesc *desc = &gif_file->Image;
+	for (int y = 0; y < desc->Height; y++) {
+		GifByteType *row = stream->indices + (size_t)y * desc->Width;
+		if (DGifGetLine(gif_file, row, desc->Width) == GIF_ERROR) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void gif_stream_reset(struct wlf_gif_stream *stream) {
+	wlf_build_initial_canvas(stream->gif_file, stream->canvas);
+	stream->current = GIF_NO_FRAME;
+	stream->next = 0;
+}
+
+static struct gif_keyframe *gif_stream_find_keyframe(struct wlf_gif_stream *stream,
+		uint32_t index) {
+	struct gif_keyframe *best = NULL;
+	for (uint32_t i = 0; i < stream->keyframe_count; i++) {
+		struct gif_keyframe *keyframe = &stream->keyframes[i];
+		if (keyframe->index <= index &&
+				(best == NULL || keyframe->index > best->index)) {
+			best = keyframe;
+		}
+	}
+
+	return best;
+}
+
+static void gif_stream_store_keyframe(struct wlf_gif_stream *stream) {
+	uint32_t index = stream->next;
+	if (index == 0 || index % stream->keyframe_interval != 0) {
+		return;
+	}
+
+	struct gif_keyframe *slot = NULL;
+	for (uint32_t i = 0; i < stream->keyframe_count; i++) {
+		struct gif_keyframe *keyframe = &stream->keyframes[i];
+		if (keyframe->index == index) {
+			keyframe->last_used = ++stream->use_clock;
+			return;
+		}
+		if (slot == NULL || keyframe->last_used < slot->last_used) {
+			slot = keyframe;
+		}
+	}
+
+	if (stream->keyframe_count < stream->max_keyframes) {
+		unsigned char *pixels = malloc(stream->canvas_size);
+		if (pixels == NULL) {
+			/* The cache only speeds up seeking, playback works without it. */
+			wlf_log(WLF_DEBUG, "Failed to allocate GIF keyframe for frame %u", index);
+			return;
+		}
+		slot = &stream->keyframes[stream->keyframe_count++];
+		slot->pixels = pixels;
+	}
+
+	slot->index = index;
+	slot->last_used = ++stream->use_clock;
+	memcpy(slot->pixels, stream->canvas, stream->canvas_size);
+}
+
+static void gif_stream_dispose(struct wlf_gif_stream *stream, struct wlf_rect *damage) {
+	if (stream->current == GIF_NO_FRAME) {
+		return;
+	}
+
+	GifFileType *gif_file = stream->gif_file;
+	const struct gif_stream_frame *frame = &stream->frames[stream->current];
+	struct wlf_rect rect = gif_frame_rect(gif_file, &frame->desc);
+	if (frame->gcb.DisposalMode == DISPOSE_BACKGROUND) {
+		wlf_clear_rect_to_background(stream->canvas, gif_file, &frame->desc);
+		rect_add(damage, &rect);
+	} else if (frame->gcb.DisposalMode == DISPOSE_PREVIOUS && stream->previous != NULL) {
+		copy_canvas_rect(stream->canvas, stream->previous, gif_file->SWidth, &rect);
+		rect_add(damage, &rect);
+	}
+
+	stream->next = stream->current + 1;
+	stream->current = GIF_NO_FRAME;
+}
+
+static bool gif_stream_composite(struct wlf_gif_stream *stream, struct wlf_rect *damage) {
+	GifFileType *gif_file = stream->gif_file;
+	uint32_t index = stream->next;
+	const struct gif_stream_frame *frame = &stream->frames[index];
+
+	struct wlf_rect rect = gif_frame_rect(gif_file, &frame->desc);
+	if (frame->gcb.DisposalMode == DISPOSE_PREVIOUS) {
+		/* Only the area covered by this frame can change, so only that
+		 * part of the canvas needs to be restored afterwards. */
+		if (stream->previous == NULL) {
+			stream->previous = malloc(stream->canvas_size);
+			if (stream->previous == NULL) {
+				wlf_log_errno(WLF_ERROR, "Failed to allocate GIF disposal buffer");
+				return false;
+			}
+		}
+		copy_canvas_rect(stream->previous, stream->canvas, gif_file->SWidth, &rect);
+	}
+
+	if (!gif_stream_decode(stream, index)) {
+		wlf_log(WLF_ERROR, "Failed to decode GIF frame %u", index);
+		return false;
+	}
+	SavedImage decoded = {
+		.ImageDesc = gif_file->Image,
+		.RasterBits = stream->indices,
+	};
+	wlf_blend_saved_image_to_canvas(stream->canvas, gif_file, &decoded, &frame->gcb);
+	rect_add(damage, &rect);
+	stream->current = index;
+
+	return true;
+}
+
+static bool gif_stream_seek(struct wlf_gif_stream *stream, uint32_t index,
+		struct wlf_rect *damage) {
+	if (stream->current == index) {
+		return true;
+	}
+
+	bool resume = stream->current != GIF_NO_FRAME && stream->current < index;
+	struct gif_keyframe *keyframe = gif_stream_find_keyframe(stream, index);
+	if (keyframe != NULL && (!resume || keyframe->index > stream->current + 1)) {
+		memcpy(stream->canvas, keyframe->pixels, stream->canvas_size);
+		keyframe->last_used = ++stream->use_clock;
+		stream->current = GIF_NO_FRAME;
+		stream->next = keyframe->index;
+		*damage = gif_canvas_rect(stream->gif_file);
+	} else if (!resume) {
+		gif_stream_reset(stream);
+		*damage = gif_canvas_rect(stream->gif_file);
+	}
+
+	for (;;) {
+		gif_stream_dispose(stream, damage);
+		gif_stream_store_keyframe(stream);
+		if (!gif_stream_composite(stream, damage)) {
+			gif_stream_reset(stream);
+			return false;
+		}
+		if (stream->current == index) {
+			return true;
+		}
+	}
+}
+
+static bool gif_stream_load_metadata(struct wlf_gif_image *gif_image,
+		const struct wlf_gif_stream *stream, uint32_t loop_count) {
+	if (!gif_alloc_frames(gif_image, stream->frame_count)) {
+		return false;
+	}
+
+	bool has_alpha = false;
+	for (uint32_t i = 0; i < stream->frame_count; i++) {
+		const GraphicsControlBlock *gcb = &stream->frames[i].gcb;
+		gif_set_frame(gif_image, stream->gif_file, i, gcb);
+		if (gcb->TransparentColor != NO_TRANSPARENT_COLOR) {
+			has_alpha = true;
+		}
+	}
+
+	gif_image->loop_count = loop_count;
+	gif_set_base(gif_image, stream->gif_file, has_alpha);
+	return true;
+}
+
+/* Takes ownership of source, which is finished on failure as well. */
+static bool gif_load_streaming(struct wlf_gif_image *image,
+		struct wlf_file_source *source, const struct wlf_gif_stream_options *options) {
+	struct wlf_gif_stream *stream = calloc(1, sizeof(*stream));
+	if (stream == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate GIF stream");
+		wlf_file_source_finish(source);
+		return false;
+	}
+
+	/* The file name is only borrowed while loading. */
+	const char *name = source->name;
+	stream->source = *source;
+	stream->source.name = NULL;
+	int gif_error = 0;
+	stream->gif_file = WLF_DGIF_OPEN_USER(&stream->source, gif_read_source, &gif_error);
+	if (stream->gif_file == NULL) {
+		wlf_log(WLF_ERROR, "Cannot open %s for GIF reading (err=%d)", name, gif_error);
+		gif_stream_destroy(stream);
+		return false;
+	}
+
+	GifFileType *gif_file = stream->gif_file;
+	uint32_t loop_count = 0;
+	size_t max_frame_area = 0;
+	if (!gif_stream_scan(stream, &loop_count, &max_frame_area) ||
+			gif_file->SWidth <= 0 || gif_file->SHeight <= 0) {
+		wlf_log(WLF_ERROR, "Invalid GIF content: %s", name);
+		gif_stream_destroy(stream);
+		return false;
+	}
+	if ((size_t)gif_file->SWidth * 4 > UINT32_MAX) {
+		wlf_log(WLF_ERROR, "GIF row stride is too large");
+		gif_stream_destroy(stream);
+		return false;
+	}
+
+	if (!gif_stream_load_metadata(image, stream, loop_count)) {
+		gif_stream_destroy(stream);
+		return false;
+	}
+
+	stream->canvas_size = (size_t)gif_file->SWidth * gif_file->SHeight * 4;
+	stream->keyframe_interval = GIF_DEFAULT_KEYFRAME_INTERVAL;
+	stream->max_keyframes = GIF_DEFAULT_MAX_KEYFRAMES;
+	if (options != NULL && options->keyframe_interval > 0) {
+		stream->keyframe_interval = options->keyframe_interval;
+	}
+	if (options != NULL && options->max_keyframes > 0) {
+		stream->max_keyframes = options->max_keyframes;
+	}
+
+	stream->canvas = malloc(stream->canvas_size);
+	stream->indices = malloc(max_frame_area > 0 ? max_frame_area : 1);
+	stream->keyframes = calloc(stream->max_keyframes, sizeof(*stream->keyframes));
+	if (stream->canvas == NULL || stream->indices == NULL || stream->keyframes == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate GIF stream buffers");
+		gif_stream_destroy(stream);
+		gif_free_frames(image);
+		return false;
+	}
+
+	gif_stream_reset(stream);
+	struct wlf_rect damage = { 0 };
+	if (!gif_stream_composite(stream, &damage)) {
+		gif_stream_destroy(stream);
+		gif_free_frames(image);
+		return false;
+	}
+
+	image->stream = stream;
+	image->base.image_type = WLF_IMAGE_TYPE_GIF;
+	image->base.data = stream->canvas;
+
+	return true;
+}
+
+bool wlf_gif_image_load_streaming(struct wlf_gif_image *image,
+		const char *filename, const struct wlf_gif_stream_options *options) {
+	if (image == NULL || filename == NULL) {
+		return false;
+	}
+
+	struct wlf_file_source source;
+	if (!wlf_file_source_init_from_file(&source, filename)) {
+		return false;
+	}
+
+	return gif_load_streaming(image, &source, options);
+}
+
+bool wlf_gif_image_load_streaming_from_memory(struct wlf_gif_image *image,
+		const void *data, size_t size, const struct wlf_gif_stream_options *options) {
+	if (image == NULL || data == NULL || size == 0) {
+		return false;
+	}
+
+	struct wlf_file_source source;
+	wlf_file_source_init_from_memory(&source, data, size);
+	return gif_load_streaming(image, &source, options);
+}
+
+bool wlf_gif_image_is_streaming(const struct wlf_gif_image *image) {
+	return image->stream != NULL;
+}
+
+bool wlf_gif_image_seek_frame(struct wlf_gif_image *image, uint32_t index,
+		struct wlf_rect *damage) {
+	struct wlf_rect unused;
+	if (damage == NULL) {
+		damage = &unused;
+	}
+	*damage = wlf_rect_make(0, 0, 0, 0);
+
+	if (image->frames == NULL || index >= image->frame_count) {
+		return false;
+	}
+	if (index == image->current_frame) {
+		return true;
+	}
+
+	if (image->stream == NULL) {
+		image->base.data = image->frames[index].pixels;
+		image->current_frame = index;
+		*damage = wlf_rect_make(0, 0, (int)image->base.width, (int)image->base.height);
+		return true;
+	}
+
+	if (!gif_stream_seek(image->stream, index, damage)) {
+		wlf_log(WLF_ERROR, "Failed to composite GIF frame %u", index);
+		/* The canvas was reset to the background color. */
+		image->current_frame = GIF_NO_FRAME;
+		*damage = wlf_rect_make(0, 0, (int)image->base.width, (int)image->base.height);
+		return false;
+	}
+	image->current_frame = index;
+
+	return true;
+}
+
+bool wlf_gif_image_next_frame(struct wlf_gif_image *image,
+		struct wlf_rect *damage) {
+	if (image->frame_count == 0) {
+		return false;
+	}
+
+	uint32_t next = image->current_frame + 1;
+	if (next >= image->frame_count) {
+		next = 0;
+	}
+
+	return wlf_gif_image_seek_frame(image, next, damage);
+}
+
+uint32_t wlf_gif_image_frame_at_time(const struct wlf_gif_image *image,
+		uint64_t time_ms) {
+	if (image->frames == NULL || image->frame_count == 0) {
+		return 0;
+	}
+
+	uint32_t low = 0;
+	uint32_t high = image->frame_count - 1;
+	while (low < high) {
+		uint32_t mid = low + (high - low + 1) / 2;
+		if (image->frames[mid].timestamp_ms <= time_ms) {
+			low = mid;
+		} else {
+			high = mid - 1;
+		}
+	}
+
+	return low;
+}
+
+uint64_t wlf_gif_image_get_duration(const struct wlf_gif_image *image) {
+	if (image->frames == NULL || image->frame_count == 0) {
+		return 0;
+	}
+
+	const struct wlf_gif_frame *last = &image->frames[image->frame_count - 1];
+	return (uint64_t)last->timestamp_ms + last->delay_ms;
+}
+
 static void image_destroy(struct wlf_image *wlf_image) {
 	struct wlf_gif_image *image = wlf_gif_image_from_image(wlf_image);
+	if (image->stream != NULL) {
+		/* base.data aliases the stream canvas. */
+		gif_stream_destroy(image->stream);
+		image->stream = NULL;
+		gif_free_frames(image);
+		image->base.data = NULL;
+		return;
+	}
 	if (image->frames != NULL) {
-		for (uint32_t i = 0; i < image->frame_count; i++) {
-			free(image->frames[i].pixels);
-			image->frames[i].pixels = NULL;
-		}
-		free(image->frames);
-		image->frames = NULL;
-		image->frame_count = 0;
+		/* base.data aliases one of the frame buffers. */
+		gif_free_frames(image);
 		image->base.data = NULL;
 		return;
 	}
 	free(image->base.data);
-	free(image);
+	image->base.data = NULL;
 }
 
 static const struct wlf_image_impl gif_image_impl = {
 	.save = image_save,
-	.load = image_load,
+	.load = wlf_image_load_source_file,
+	.load_source = image_load_source,
 	.destroy = image_destroy,
 };
 
@@ -727,7 +1403,9 @@ struct wlf_gif_image *wlf_gif_image_create(void) {
 	image->loop_count = 0;
 	image->delay_ms = 0;
 	image->frame_count = 0;
+	image->current_frame = 0;
 	image->frames = NULL;
+	image->stream = NULL;
 
 	return image;
 }
@@ -743,3 +1421,99 @@ struct wlf_gif_image *wlf_gif_image_from_image(struct wlf_image *wlf_image) {
 
 	return image;
 }
+
+/* Skips a chain of data sub-blocks up to and including the terminator. */
+static bool gif_skip_sub_blocks(struct wlf_file_source *source) {
+	for (;;) {
+		int len = wlf_file_source_getc(source);
+		if (len < 0) {
+			return false;
+		}
+		if (len == 0) {
+			return true;
+		}
+		if (wlf_file_source_take(source, (size_t)len) == NULL) {
+			return false;
+		}
+	}
+}
+
+bool wlf_gif_image_probe(struct wlf_file_source *source,
+		struct wlf_image_info *info) {
+	// Signature, version and logical screen descriptor
+	const uint8_t *header = wlf_file_source_take(source, 13);
+	if (header == NULL || (memcmp(header, "GIF87a", 6) != 0 &&
+			memcmp(header, "GIF89a", 6) != 0)) {
+		return false;
+	}
+
+	uint32_t width = (uint32_t)header[6] | ((uint32_t)header[7] << 8);
+	uint32_t height = (uint32_t)header[8] | ((uint32_t)header[9] << 8);
+	uint8_t flags = header[10];
+	if (width == 0 || height == 0) {
+		return false;
+	}
+	if ((flags & 0x80) &&
+			wlf_file_source_take(source, 3u << ((flags & 0x07) + 1)) == NULL) {
+		return false;
+	}
+
+	/* Walk the block structure without decompressing any LZW data to count
+	 * frames and find transparent colors, like gif_load_metadata() does. */
+	uint32_t frame_count = 0;
+	bool has_alpha = false;
+	bool done = false;
+	while (!done) {
+		int block = wlf_file_source_getc(source);
+		switch (block) {
+			case 0x2C: { // Image descriptor
+				const uint8_t *desc = wlf_file_source_take(source, 9);
+				if (desc == NULL) {
+					return false;
+				}
+				if ((desc[8] & 0x80) &&
+						wlf_file_source_take(source, 3u << ((desc[8] & 0x07) + 1)) == NULL) {
+					return false;
+				}
+				// LZW minimum code size, then the image data
+				if (wlf_file_source_getc(source) < 0 || !gif_skip_sub_blocks(source)) {
+					return false;
+				}
+				frame_count++;
+				break;
+			}
+			case 0x21: { // Extension
+				int label = wlf_file_source_getc(source);
+				if (label == 0xF9 && wlf_file_source_peek(source) == 4 &&
+						wlf_file_source_remaining(source) > 2) {
+					// Graphics control block; bit 0 of the packed byte
+					has_alpha |= (source->data[source->offset + 1] & 0x01) != 0;
+				}
+				if (label < 0 || !gif_skip_sub_blocks(source)) {
+					return false;
+				}
+				break;
+			}
+			case 0x3B: // Trailer
+				done = true;
+				break;
+			default:
+				// Truncated data or an unknown record, which giflib rejects too
+				return false;
+		}
+	}
+
+	if (frame_count == 0) {
+		return false;
+	}
+
+	info->type = WLF_IMAGE_TYPE_GIF;
+	info->width = width;
+	info->height = height;
+	info->format = WLF_COLOR_TYPE_RGBA;
+	info->bit_depth = WLF_IMAGE_BIT_DEPTH_8;
+	info->has_alpha_channel = has_alpha;
+	info->is_animated = frame_count > 1;
+
+	return true;
+}
@@ -6,6 +6,7 @@
 #include "wlf/image/wlf_webp_image.h"
 #include "wlf/image/wlf_xpm_image.h"
 #include "wlf/image/wlf_gif_image.h"
+#include "wlf/utils/wlf_file_source.h"
 #include "wlf/utils/wlf_compat.h"
 
 #include <assert.h>
@@ -33,6 +34,23 @@ void wlf_image_finish(struct wlf_image *image) {
 	}
 }
 
+bool wlf_image_load_source_file(struct wlf_image *image, const char *filename,
+		bool enable_16_bit) {
+	if (image == NULL || image->impl->load_source == NULL) {
+		return false;
+	}
+
+	struct wlf_file_source source;
+	if (!wlf_file_source_init_from_file(&source, filename)) {
+		return false;
+	}
+
+	bool ok = image->impl->load_source(image, &source, enable_16_bit);
+	wlf_file_source_finish(&source);
+
+	return ok;
+}
+
 enum wlf_image_type wlf_image_type_from_string(const char *str) {
 	for (long unsigned int i = 0; i < sizeof(image_type) / sizeof(image_type[0]); i++) {
 		if (strcmp(image_type[i].name, str) == 0) {
@@ -139,110 +157,308 @@ bool wlf_image_save(struct wlf_image *image, const char *filename) {
 	return false;
 }
 
-struct wlf_image *wlf_image_load(const char *filename) {
-	if (filename == NULL) {
-		return NULL;
+static struct wlf_image *png_create(void) {
+	struct wlf_png_image *png_image = wlf_png_image_create();
+	return png_image ? &png_image->base : NULL;
+}
+
+static struct wlf_image *jpeg_create(void) {
+	struct wlf_jpeg_image *jpeg_image = wlf_jpeg_image_create();
+	return jpeg_image ? &jpeg_image->base : NULL;
+}
+
+static struct wlf_image *bmp_create(void) {
+	struct wlf_bmp_image *bmp_image = wlf_bmp_image_create();
+	return bmp_image ? &bmp_image->base : NULL;
+}
+
+static struct wlf_image *ppm_create(void) {
+	struct wlf_ppm_image *ppm_image = wlf_ppm_image_create();
+	return ppm_image ? &ppm_image->base : NULL;
+}
+
+static struct wlf_image *webp_create(void) {
+	struct wlf_webp_image *webp_image = wlf_webp_image_create();
+	return webp_image ? &webp_image->base : NULL;
+}
+
+static struct wlf_image *xpm_create(void) {
+	struct wlf_xpm_image *xpm_image = wlf_xpm_image_create();
+	return xpm_image ? &xpm_image->base : NULL;
+}
+
+static struct wlf_image *gif_create(void) {
+	struct wlf_gif_image *gif_image = wlf_gif_image_create();
+	return gif_image ? &gif_image->base : NULL;
+}
+
+static bool png_sniff(const uint8_t *data, size_t size) {
+	static const uint8_t signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	return size >= sizeof(signature) &&
+		memcmp(data, signature, sizeof(signature)) == 0;
+}
+
+static bool jpeg_sniff(const uint8_t *data, size_t size) {
+	// SOI marker followed by the first marker of the stream
+	return size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+}
+
+static bool bmp_sniff(const uint8_t *data, size_t size) {
+	if (size < 18 || data[0] != 'B' || data[1] != 'M') {
+		return false;
+	}
+
+	// "BM" alone is too weak; also require the BITMAPINFOHEADER size, the
+	// only DIB header the BMP loader decodes
+	uint32_t dib_size = (uint32_t)data[14] | ((uint32_t)data[15] << 8) |
+		((uint32_t)data[16] << 16) | ((uint32_t)data[17] << 24);
+	return dib_size == 40;
+}
+
+static bool ppm_sniff(const uint8_t *data, size_t size) {
+	return size >= 3 && data[0] == 'P' && (data[1] == '3' || data[1] == '6') &&
+		(data[2] == ' ' || data[2] == '\t' || data[2] == '\n' ||
+		 data[2] == '\r' || data[2] == '#');
+}
+
+static bool webp_sniff(const uint8_t *data, size_t size) {
+	return size >= 12 && memcmp(data, "RIFF", 4) == 0 &&
+		memcmp(data + 8, "WEBP", 4) == 0;
+}
+
+static bool xpm_sniff(const uint8_t *data, size_t size) {
+	static const char magic[] = "/* XPM */";
+	// Leading whitespace is skipped only as far as the magic still ends
+	// within the 32 bytes wlf_image_type_sniff() documents as enough
+	size_t max_skip = 32 - (sizeof(magic) - 1);
+	size_t i = 0;
+	while (i < size && i < max_skip && (data[i] == ' ' || data[i] == '\t' ||
+			data[i] == '\n' || data[i] == '\r')) {
+		i++;
+	}
+
+	return size - i >= sizeof(magic) - 1 &&
+		memcmp(data + i, magic, sizeof(magic) - 1) == 0;
+}
+
+static bool gif_sniff(const uint8_t *data, size_t size) {
+	return size >= 6 && (memcmp(data, "GIF87a", 6) == 0 ||
+		memcmp(data, "GIF89a", 6) == 0);
+}
+
+/**
+ * @brief Entry of the decoder registry.
+ * @details Detection tries each entry's sniff() on the leading bytes of the
+ *          content; the file extension is only consulted when no signature
+ *          matches. Adding a format means adding one row here.
+ */
+struct image_decoder {
+	enum wlf_image_type type;
+	const char *extensions[3];
+	bool (*sniff)(const uint8_t *data, size_t size);
+	struct wlf_image *(*create)(void);
+	bool (*probe)(struct wlf_file_source *source, struct wlf_image_info *info);
+};
+
+static const struct image_decoder image_decoders[] = {
+	{ WLF_IMAGE_TYPE_PNG,  { ".png" },          png_sniff,  png_create,  wlf_png_image_probe  },
+	{ WLF_IMAGE_TYPE_JPEG, { ".jpg", ".jpeg" }, jpeg_sniff, jpeg_create, wlf_jpeg_image_probe },
+	{ WLF_IMAGE_TYPE_GIF,  { ".gif" },          gif_sniff,  gif_create,  wlf_gif_image_probe  },
+	{ WLF_IMAGE_TYPE_WEBP, { ".webp" },         webp_sniff, webp_create, wlf_webp_image_probe },
+	{ WLF_IMAGE_TYPE_BMP,  { ".bmp" },          bmp_sniff,  bmp_create,  wlf_bmp_image_probe  },
+	{ WLF_IMAGE_TYPE_PPM,  { ".ppm" },          ppm_sniff,  ppm_create,  wlf_ppm_image_probe  },
+	{ WLF_IMAGE_TYPE_XPM,  { ".xpm" },          xpm_sniff,  xpm_create,  wlf_xpm_image_probe  },
+};
+
+static const struct image_decoder *image_decoder_for_type(enum wlf_image_type type) {
+	for (size_t i = 0; i < sizeof(image_decoders) / sizeof(image_decoders[0]); i++) {
+		if (image_decoders[i].type == type) {
+			return &image_decoders[i];
+		}
 	}
 
+	return NULL;
+}
+
+static enum wlf_image_type image_type_from_extension(const char *filename) {
 	const char *ext = strrchr(filename, '.');
 	if (ext == NULL) {
 		// No file extension found
-		return NULL;
+		return WLF_IMAGE_TYPE_UNKNOWN;
 	}
 
-	// Check for PNG format
-	if (strcasecmp(ext, ".png") == 0) {
-		struct wlf_png_image *png_image = wlf_png_image_create();
-		if (png_image) {
-			png_image->base.image_type = WLF_IMAGE_TYPE_PNG;
-			if (png_image->base.impl->load(&png_image->base, filename, false)) {
-				return &png_image->base;
-			} else {
-				png_image->base.impl->destroy(&png_image->base);
-				return NULL;
+	for (size_t i = 0; i < sizeof(image_decoders) / sizeof(image_decoders[0]); i++) {
+		const struct image_decoder *decoder = &image_decoders[i];
+		for (size_t j = 0; j < sizeof(decoder->extensions) / sizeof(decoder->extensions[0]); j++) {
+			if (decoder->extensions[j] != NULL &&
+					strcasecmp(ext, decoder->extensions[j]) == 0) {
+				return decoder->type;
 			}
-		} else {
-			return NULL;
 		}
-	} else if (strcasecmp(ext, ".jpg") == 0 || strcasecmp(ext, ".jpeg") == 0) {
-		struct wlf_jpeg_image *jpeg_image = wlf_jpeg_image_create();
-		if (jpeg_image) {
-			jpeg_image->base.image_type = WLF_IMAGE_TYPE_JPEG;
-			if (jpeg_image->base.impl->load(&jpeg_image->base, filename, false)) {
-				return &jpeg_image->base;
-			} else {
-				jpeg_image->base.impl->destroy(&jpeg_image->base);
-				return NULL;
-			}
-		} else {
-			return NULL;
-		}
-	} else if (strcasecmp(ext, ".bmp") == 0) {
-		struct wlf_bmp_image *bmp_image = wlf_bmp_image_create();
-		if (bmp_image) {
-			bmp_image->base.image_type = WLF_IMAGE_TYPE_BMP;
-			if (bmp_image->base.impl->load(&bmp_image->base, filename, false)) {
-				return &bmp_image->base;
-			} else {
-				bmp_image->base.impl->destroy(&bmp_image->base);
-				return NULL;
-			}
-		} else {
-			return NULL;
-		}
-	} else if (strcasecmp(ext, ".ppm") == 0) {
-		struct wlf_ppm_image *ppm_image = wlf_ppm_image_create();
-		if (ppm_image) {
-			ppm_image->base.image_type = WLF_IMAGE_TYPE_PPM;
-			if (ppm_image->base.impl->load(&ppm_image->base, filename, false)) {
-				return &ppm_image->base;
-			} else {
-				ppm_image->base.impl->destroy(&ppm_image->base);
-				return NULL;
-			}
-		} else {
-			return NULL;
-		}
-	} else if (strcasecmp(ext, ".webp") == 0) {
-		struct wlf_webp_image *webp_image = wlf_webp_image_create();
-		if (webp_image) {
-			webp_image->base.image_type = WLF_IMAGE_TYPE_WEBP;
-			if (webp_image->base.impl->load(&webp_image->base, filename, false)) {
-				return &webp_image->base;
-			} else {
-				webp_image->base.impl->destroy(&webp_image->base);
-				return NULL;
-			}
-		} else {
-			return NULL;
-		}
-	} else if (strcasecmp(ext, ".xpm") == 0) {
-		struct wlf_xpm_image *xpm_image = wlf_xpm_image_create();
-		if (xpm_image) {
-			xpm_image->base.image_type = WLF_IMAGE_TYPE_XPM;
-			if (xpm_image->base.impl->load(&xpm_image->base, filename, false)) {
-				return &xpm_image->base;
-			} else {
-				xpm_image->base.impl->destroy(&xpm_image->base);
-				return NULL;
-			}
-		} else {
-			return NULL;
-		}
-	} else if (strcasecmp(ext, ".gif") == 0) {
-		struct wlf_gif_image *gif_image = wlf_gif_image_create();
-		if (gif_image) {
-			gif_image->base.image_type = WLF_IMAGE_TYPE_GIF;
-			if (gif_image->base.impl->load(&gif_image->base, filename, false)) {
-				return &gif_image->base;
-			} else {
-				gif_image->base.impl->destroy(&gif_image->base);
-				return NULL;
-			}
-		} else {
-			return NULL;
+	}
+
+	return WLF_IMAGE_TYPE_UNKNOWN;
+}
+
+enum wlf_image_type wlf_image_type_sniff(const void *data, size_t size) {
+	if (data == NULL) {
+		return WLF_IMAGE_TYPE_UNKNOWN;
+	}
+
+	for (size_t i = 0; i < sizeof(image_decoders) / sizeof(image_decoders[0]); i++) {
+		if (image_decoders[i].sniff(data, size)) {
+			return image_decoders[i].type;
 		}
 	}
 
-	return NULL;
+	return WLF_IMAGE_TYPE_UNKNOWN;
+}
+
+/* Content wins over the name, so misnamed files still load. */
+static enum wlf_image_type image_detect_type(const struct wlf_file_source *source,
+		const char *filename) {
+	enum wlf_image_type type = wlf_image_type_sniff(source->data, source->size);
+	if (type == WLF_IMAGE_TYPE_UNKNOWN && filename != NULL) {
+		type = image_type_from_extension(filename);
+	}
+
+	return type;
+}
+
+static struct wlf_image *image_load_source(enum wlf_image_type type,
+		struct wlf_file_source *source,
+		uint32_t target_width, uint32_t target_height) {
+	const struct image_decoder *decoder = image_decoder_for_type(type);
+	if (decoder == NULL) {
+		return NULL;
+	}
+
+	struct wlf_image *image = decoder->create();
+	if (image == NULL) {
+		return NULL;
+	}
+	image->image_type = type;
+	source->offset = 0;
+
+	bool ok;
+	if ((target_width != 0 || target_height != 0) &&
+			image->impl->load_at_size != NULL) {
+		ok = image->impl->load_at_size(image, source,
+			target_width, target_height);
+	} else {
+		ok = image->impl->load_source(image, source, false);
+	}
+
+	if (!ok) {
+		wlf_image_finish(image);
+		free(image);
+		return NULL;
+	}
+
+	return image;
+}
+
+static struct wlf_image *image_load(const char *filename,
+		uint32_t target_width, uint32_t target_height) {
+	if (filename == NULL) {
+		return NULL;
+	}
+
+	struct wlf_file_source source;
+	if (!wlf_file_source_init_from_file(&source, filename)) {
+		return NULL;
+	}
+
+	struct wlf_image *image = image_load_source(
+		image_detect_type(&source, filename), &source,
+		target_width, target_height);
+	wlf_file_source_finish(&source);
+
+	return image;
+}
+
+struct wlf_image *wlf_image_load(const char *filename) {
+	return image_load(filename, 0, 0);
+}
+
+struct wlf_image *wlf_image_load_at_size(const char *filename,
+		uint32_t target_width, uint32_t target_height) {
+	return image_load(filename, target_width, target_height);
+}
+
+struct wlf_image *wlf_image_load_from_memory_at_size(const void *data,
+		size_t size, enum wlf_image_type type,
+		uint32_t target_width, uint32_t target_height) {
+	if (data == NULL || size == 0) {
+		return NULL;
+	}
+
+	struct wlf_file_source source;
+	wlf_file_source_init_from_memory(&source, data, size);
+	if (type == WLF_IMAGE_TYPE_UNKNOWN) {
+		type = image_detect_type(&source, NULL);
+	}
+
+	struct wlf_image *image = image_load_source(type, &source,
+		target_width, target_height);
+	wlf_file_source_finish(&source);
+
+	return image;
+}
+
+struct wlf_image *wlf_image_load_from_memory(const void *data, size_t size,
+		enum wlf_image_type type) {
+	return wlf_image_load_from_memory_at_size(data, size, type, 0, 0);
+}
+
+static bool image_probe_source(struct wlf_file_source *source,
+		const char *filename, struct wlf_image_info *info) {
+	const struct image_decoder *decoder =
+		image_decoder_for_type(image_detect_type(source, filename));
+	if (decoder == NULL) {
+		return false;
+	}
+
+	struct wlf_image_info probed = { 0 };
+	source->offset = 0;
+	if (!decoder->probe(source, &probed)) {
+		return false;
+	}
+
+	probed.type = decoder->type;
+	*info = probed;
+
+	return true;
+}
+
+bool wlf_image_probe(const char *filename, struct wlf_image_info *info) {
+	if (filename == NULL || info == NULL) {
+		return false;
+	}
+
+	/* Mapping only faults in the pages the header parser touches. */
+	struct wlf_file_source source;
+	if (!wlf_file_source_init_from_file(&source, filename)) {
+		return false;
+	}
+
+	bool ok = image_probe_source(&source, filename, info);
+	wlf_file_source_finish(&source);
+
+	return ok;
+}
+
+bool wlf_image_probe_from_memory(const void *data, size_t size,
+		struct wlf_image_info *info) {
+	if (data == NULL || size == 0 || info == NULL) {
+		return false;
+	}
+
+	struct wlf_file_source source;
+	wlf_file_source_init_from_memory(&source, data, size);
+
+	bool ok = image_probe_source(&source, NULL, info);
+	wlf_file_source_finish(&source);
+
+	return ok;
 }
@@ -0,0 +1,337 @@
+#include "wlf/image/wlf_image_cache.h"
+#include "wlf/image/wlf_image.h"
+#include "wlf/renderer/wlf_renderer.h"
+#include "wlf/texture/wlf_texture.h"
+#include "wlf/utils/wlf_hash.h"
+#include "wlf/utils/wlf_linked_list.h"
+#include "wlf/utils/wlf_log.h"
+#include "wlf/utils/wlf_lru_table.h"
+#include "wlf/utils/wlf_signal.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define IMAGE_CACHE_MIN_BUCKETS 64
+
+struct image_cache_texture {
+	struct wlf_image_cache_entry *entry;
+	struct wlf_texture *texture;
+	struct wlf_linked_list link;         /* wlf_image_cache_entry.textures */
+	struct wlf_listener renderer_destroy;
+};
+
+struct wlf_image_cache_entry {
+	struct wlf_lru_entry base;
+
+	/* Key */
+	char *filename;                      /* NULL for in-memory content */
+	uint64_t content_hash;
+	size_t content_size;
+	uint32_t target_width;
+	uint32_t target_height;
+	float scale;
+
+	struct wlf_image *image;
+	struct wlf_linked_list textures;     /* image_cache_texture.link */
+	size_t bytes;
+};
+
+/* Entries cost their pixel bytes; the budget covers referenced ones too. */
+struct wlf_image_cache {
+	struct wlf_lru_table table;
+};
+
+static struct wlf_image_cache *default_cache;
+
+static uint64_t key_hash(const char *filename, uint64_t content_hash,
+		size_t content_size, uint32_t target_width, uint32_t target_height,
+		float scale) {
+	uint64_t hash = WLF_HASH_INIT;
+	if (filename != NULL) {
+		hash = wlf_hash_string(hash, filename);
+	} else {
+		hash = wlf_hash_bytes(hash, &content_hash, sizeof(content_hash));
+		hash = wlf_hash_bytes(hash, &content_size, sizeof(content_size));
+	}
+	hash = wlf_hash_bytes(hash, &target_width, sizeof(target_width));
+	hash = wlf_hash_bytes(hash, &target_height, sizeof(target_height));
+	hash = wlf_hash_bytes(hash, &scale, sizeof(scale));
+	return hash;
+}
+
+struct image_cache_key {
+	const char *filename;
+	uint64_t content_hash;
+	size_t content_size;
+	uint32_t target_width;
+	uint32_t target_height;
+	float scale;
+};
+
+static bool entry_matches(const struct wlf_lru_entry *base, const void *data) {
+	const struct wlf_image_cache_entry *entry =
+		wlf_container_of(base, entry, base);
+	const struct image_cache_key *key = data;
+	if (entry->target_width != key->target_width ||
+			entry->target_height != key->target_height ||
+			entry->scale != key->scale) {
+		return false;
+	}
+	if (key->filename != NULL) {
+		return entry->filename != NULL && strcmp(entry->filename, key->filename) == 0;
+	}
+	return entry->filename == NULL && entry->content_hash == key->content_hash &&
+		entry->content_size == key->content_size;
+}
+
+static size_t image_bytes(const struct wlf_image *image) {
+	return (size_t)image->stride * image->height;
+}
+
+static size_t texture_bytes(const struct wlf_texture *texture) {
+	return (size_t)texture->width * texture->height * 4;
+}
+
+static void cache_texture_destroy(struct image_cache_texture *cache_texture) {
+	struct wlf_image_cache_entry *entry = cache_texture->entry;
+	entry->bytes -= texture_bytes(cache_texture->texture);
+	wlf_lru_entry_set_cost(&entry->base, entry->bytes);
+
+	wlf_linked_list_remove(&cache_texture->renderer_destroy.link);
+	wlf_linked_list_remove(&cache_texture->link);
+	wlf_texture_destroy(cache_texture->texture);
+	free(cache_texture);
+}
+
+static void handle_renderer_destroy(struct wlf_listener *listener, void *data) {
+	(void)data;
+	struct image_cache_texture *cache_texture =
+		wlf_container_of(listener, cache_texture, renderer_destroy);
+	cache_texture_destroy(cache_texture);
+}
+
+static void entry_destroy(struct wlf_lru_entry *base) {
+	struct wlf_image_cache_entry *entry = wlf_container_of(base, entry, base);
+	struct image_cache_texture *cache_texture, *tmp;
+	wlf_linked_list_for_each_safe(cache_texture, tmp, &entry->textures, link) {
+		cache_texture_destroy(cache_texture);
+	}
+
+	wlf_image_finish(entry->image);
+	free(entry->image);
+	free(entry->filename);
+	free(entry);
+}
+
+static const struct wlf_lru_table_impl image_cache_impl = {
+	.destroy = entry_destroy,
+};
+
+struct wlf_image_cache *wlf_image_cache_create(size_t byte_budget) {
+	struct wlf_image_cache *cache = calloc(1, sizeof(*cache));
+	if (cache == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate wlf_image_cache");
+		return NULL;
+	}
+
+	if (!wlf_lru_table_init(&cache->table, &image_cache_impl,
+			IMAGE_CACHE_MIN_BUCKETS, byte_budget, false)) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate image cache buckets");
+		free(cache);
+		return NULL;
+	}
+
+	return cache;
+}
+
+void wlf_image_cache_destroy(struct wlf_image_cache *cache) {
+	if (cache == NULL) {
+		return;
+	}
+
+	if (cache == default_cache) {
+		default_cache = NULL;
+	}
+	wlf_lru_table_finish(&cache->table);
+	free(cache);
+}
+
+struct wlf_image_cache *wlf_image_cache_get_default(void) {
+	if (default_cache == NULL) {
+		default_cache = wlf_image_cache_create(WLF_IMAGE_CACHE_DEFAULT_BUDGET);
+	}
+
+	return default_cache;
+}
+
+void wlf_image_cache_set_budget(struct wlf_image_cache *cache, size_t byte_budget) {
+	wlf_lru_table_set_budget(&cache->table, byte_budget);
+}
+
+static uint32_t scaled_size(uint32_t size, float scale) {
+	if (size == 0) {
+		return 0;
+	}
+
+	double scaled = ceil((double)size * scale);
+	return scaled >= (double)UINT32_MAX ? UINT32_MAX : (uint32_t)scaled;
+}
+
+static struct wlf_image_cache_entry *cache_lookup(struct wlf_image_cache *cache,
+		const char *filename, const void *data, size_t size,
+		uint32_t target_width, uint32_t target_height, float scale) {
+	/* Full-size decodes do not depend on the scale, so share one entry. */
+	if (!(scale > 0.0f) || (target_width == 0 && target_height == 0)) {
+		scale = 1.0f;
+	}
+
+	struct image_cache_key key = {
+		.filename = filename,
+		.content_size = filename != NULL ? 0 : size,
+		.target_width = target_width,
+		.target_height = target_height,
+		.scale = scale,
+	};
+	if (filename == NULL) {
+		key.content_hash = wlf_hash_bytes(WLF_HASH_INIT, data, size);
+	}
+	uint64_t hash = key_hash(filename, key.content_hash, key.content_size,
+		target_width, target_height, scale);
+
+	struct wlf_lru_entry *found =
+		wlf_lru_table_find(&cache->table, hash, entry_matches, &key);
+	if (found != NULL) {
+		struct wlf_image_cache_entry *entry = wlf_container_of(found, entry, base);
+		return entry;
+	}
+
+	uint32_t decode_width = scaled_size(target_width, scale);
+	uint32_t decode_height = scaled_size(target_height, scale);
+	struct wlf_image *image;
+	if (filename != NULL) {
+		image = wlf_image_load_at_size(filename, decode_width, decode_height);
+	} else {
+		image = wlf_image_load_from_memory_at_size(data, size,
+			WLF_IMAGE_TYPE_UNKNOWN, decode_width, decode_height);
+	}
+	if (image == NULL) {
+		return NULL;
+	}
+
+	struct wlf_image_cache_entry *entry = calloc(1, sizeof(*entry));
+	if (entry == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate wlf_image_cache_entry");
+		wlf_image_finish(image);
+		free(image);
+		return NULL;
+	}
+	if (filename != NULL) {
+		entry->filename = strdup(filename);
+		if (entry->filename == NULL) {
+			wlf_log_errno(WLF_ERROR, "Failed to copy image file name");
+			wlf_image_finish(image);
+			free(image);
+			free(entry);
+			return NULL;
+		}
+	}
+
+	entry->content_hash = key.content_hash;
+	entry->content_size = key.content_size;
+	entry->target_width = target_width;
+	entry->target_height = target_height;
+	entry->scale = scale;
+	entry->image = image;
+	entry->bytes = image_bytes(image);
+	wlf_linked_list_init(&entry->textures);
+	wlf_lru_table_insert(&cache->table, &entry->base, hash, entry->bytes);
+
+	return entry;
+}
+
+struct wlf_image_cache_entry *wlf_image_cache_load(struct wlf_image_cache *cache,
+		const char *filename, uint32_t target_width, uint32_t target_height,
+		float scale) {
+	if (cache == NULL || filename == NULL) {
+		return NULL;
+	}
+
+	return cache_lookup(cache, filename, NULL, 0,
+		target_width, target_height, scale);
+}
+
+struct wlf_image_cache_entry *wlf_image_cache_load_from_memory(
+		struct wlf_image_cache *cache, const void *data, size_t size,
+		uint32_t target_width, uint32_t target_height, float scale) {
+	if (cache == NULL || data == NULL || size == 0) {
+		return NULL;
+	}
+
+	return cache_lookup(cache, NULL, data, size,
+		target_width, target_height, scale);
+}
+
+void wlf_image_cache_get_stats(const struct wlf_image_cache *cache,
+		struct wlf_image_cache_stats *stats) {
+	const struct wlf_lru_table *table = &cache->table;
+	uint64_t lookups = table->hits + table->misses;
+	*stats = (struct wlf_image_cache_stats) {
+		.hits = table->hits,
+		.misses = table->misses,
+		.evictions = table->evictions,
+		.hit_rate = lookups > 0 ? (double)table->hits / (double)lookups : 0.0,
+		.bytes_resident = table->resident_cost,
+		.byte_budget = table->budget,
+		.entry_count = table->entry_count,
+	};
+}
+
+struct wlf_image_cache_entry *wlf_image_cache_entry_ref(
+		struct wlf_image_cache_entry *entry) {
+	wlf_lru_entry_ref(&entry->base);
+	return entry;
+}
+
+void wlf_image_cache_entry_unref(struct wlf_image_cache_entry *entry) {
+	if (entry != NULL) {
+		wlf_lru_entry_unref(&entry->base);
+	}
+}
+
+const struct wlf_image *wlf_image_cache_entry_get_image(
+		const struct wlf_image_cache_entry *entry) {
+	return entry->image;
+}
+
+struct wlf_texture *wlf_image_cache_entry_get_texture(
+		struct wlf_image_cache_entry *entry, struct wlf_renderer *renderer) {
+	struct image_cache_texture *cache_texture;
+	wlf_linked_list_for_each(cache_texture, &entry->textures, link) {
+		if (cache_texture->texture->renderer == renderer) {
+			return cache_texture->texture;
+		}
+	}
+
+	cache_texture = calloc(1, sizeof(*cache_texture));
+	if (cache_texture == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate image_cache_texture");
+		return NULL;
+	}
+
+	cache_texture->texture = wlf_texture_from_image(renderer, entry->image);
+	if (cache_texture->texture == NULL) {
+		free(cache_texture);
+		return NULL;
+	}
+
+	cache_texture->entry = entry;
+	cache_texture->renderer_destroy.notify = handle_renderer_destroy;
+	wlf_signal_add(&renderer->events.destroy, &cache_texture->renderer_destroy);
+	wlf_linked_list_insert(&entry->textures, &cache_texture->link);
+
+	entry->bytes += texture_bytes(cache_texture->texture);
+	wlf_lru_entry_set_cost(&entry->base, entry->bytes);
+
+	return cache_texture->texture;
+}
@@ -0,0 +1,435 @@
+#include "wlf/image/wlf_image_loader.h"
+#include "wlf/image/wlf_image.h"
+#include "wlf/platform/wlf_backend.h"
+#include "wlf/utils/wlf_log.h"
+#include "wlf/utils/wlf_signal.h"
+#include "wlf/utils/wlf_linked_list.h"
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define IMAGE_LOADER_MAX_DEFAULT_THREADS 4
+
+enum image_load_state {
+	IMAGE_LOAD_PENDING,  /* Queued, waiting for a worker */
+	IMAGE_LOAD_RUNNING,  /* Being decoded by a worker */
+	IMAGE_LOAD_DONE,     /* Decoded, waiting for the event loop */
+};
+
+struct wlf_image_load_request {
+	struct wlf_image_loader *loader;
+	char *filename;
+	uint32_t target_width;
+	uint32_t target_height;
+	int32_t priority;
+	uint64_t sequence;       /* Submission order, breaks priority ties */
+	size_t queue_index;      /* Position in the pending heap */
+	enum image_load_state state;
+	bool cancelled;
+
+	struct wlf_image *image; /* Result, set by the worker */
+	wlf_image_load_done_t done;
+	void *data;
+
+	struct wlf_image_load_request *next; /* Link in the completed list */
+};
+
+struct wlf_image_loader {
+	pthread_t *threads;
+	uint32_t thread_count;
+
+	/* Everything below is guarded by lock. */
+	pthread_mutex_t lock;
+	struct wlf_backend *backend; /* NULL once the backend is destroyed */
+	pthread_cond_t cond;
+	struct wlf_image_load_request **queue; /* Max-heap of pending requests */
+	size_t queue_len;
+	size_t queue_cap;
+	uint64_t next_sequence;
+	struct wlf_image_load_request *completed_head;
+	struct wlf_image_load_request *completed_tail;
+	bool dispatch_posted;        /* A dispatch task is queued on the backend */
+	bool quit;
+
+	/* Event loop thread only. */
+	bool dispatching;
+	bool destroy_pending;
+
+	struct wlf_listener backend_destroy;
+};
+
+static void image_destroy(struct wlf_image *image) {
+	if (image != NULL) {
+		wlf_image_finish(image);
+		free(image);
+	}
+}
+
+static void request_free(struct wlf_image_load_request *request) {
+	image_destroy(request->image);
+	free(request->filename);
+	free(request);
+}
+
+/* Whether a should be decoded before b. */
+static bool request_before(const struct wlf_image_load_request *a,
+		const struct wlf_image_load_request *b) {
+	if (a->priority != b->priority) {
+		return a->priority > b->priority;
+	}
+	return a->sequence < b->sequence;
+}
+
+static void queue_set(struct wlf_image_loader *loader, size_t index,
+		struct wlf_image_load_request *request) {
+	loader->queue[index] = request;
+	request->queue_index = index;
+}
+
+static void queue_sift_up(struct wlf_image_loader *loader, size_t index) {
+	struct wlf_image_load_request *request = loader->queue[index];
+	while (index > 0) {
+		size_t parent = (index - 1) / 2;
+		if (!request_before(request, loader->queue[parent])) {
+			break;
+		}
+		queue_set(loader, index, loader->queue[parent]);
+		index = parent;
+	}
+	queue_set(loader, index, request);
+}
+
+static void queue_sift_down(struct wlf_image_loader *loader, size_t index) {
+	struct wlf_image_load_request *request = loader->queue[index];
+	for (;;) {
+		size_t child = index * 2 + 1;
+		if (child >= loader->queue_len) {
+			break;
+		}
+		if (child + 1 < loader->queue_len &&
+				request_before(loader->queue[child + 1], loader->queue[child])) {
+			child++;
+		}
+		if (!request_before(loader->queue[child], request)) {
+			break;
+		}
+		queue_set(loader, index, loader->queue[child]);
+		index = child;
+	}
+	queue_set(loader, index, request);
+}
+
+static bool queue_push(struct wlf_image_loader *loader,
+		struct wlf_image_load_request *request) {
+	if (loader->queue_len == loader->queue_cap) {
+		size_t new_cap = loader->queue_cap == 0 ? 16 : loader->queue_cap * 2;
+		struct wlf_image_load_request **queue =
+			realloc(loader->queue, new_cap * sizeof(*queue));
+		if (queue == NULL) {
+			wlf_log_errno(WLF_ERROR, "Failed to grow image load queue");
+			return false;
+		}
+		loader->queue = queue;
+		loader->queue_cap = new_cap;
+	}
+
+	queue_set(loader, loader->queue_len++, request);
+	queue_sift_up(loader, request->queue_index);
+
+	return true;
+}
+
+static void queue_remove(struct wlf_image_loader *loader, size_t index) {
+	loader->queue_len--;
+	if (index == loader->queue_len) {
+		return;
+	}
+
+	queue_set(loader, index, loader->queue[loader->queue_len]);
+	queue_sift_up(loader, index);
+	queue_sift_down(loader, loader->queue[index]->queue_index);
+}
+
+static void image_loader_dispatch(void *data);
+
+static void *image_loader_worker(void *data) {
+	struct wlf_image_loader *loader = data;
+
+	pthread_mutex_lock(&loader->lock);
+	for (;;) {
+		while (!loader->quit && loader->queue_len == 0) {
+			pthread_cond_wait(&loader->cond, &loader->lock);
+		}
+		if (loader->quit) {
+			break;
+		}
+
+		struct wlf_image_load_request *request = loader->queue[0];
+		queue_remove(loader, 0);
+		request->state = IMAGE_LOAD_RUNNING;
+		pthread_mutex_unlock(&loader->lock);
+
+		/* A running request is never freed by the event loop thread, so its
+		 * immutable fields can be read without the lock. */
+		struct wlf_image *image = wlf_image_load_at_size(request->filename,
+			request->target_width, request->target_height);
+
+		pthread_mutex_lock(&loader->lock);
+		request->image = image;
+		request->state = IMAGE_LOAD_DONE;
+		request->next = NULL;
+		if (loader->completed_tail != NULL) {
+			loader->completed_tail->next = request;
+		} else {
+			loader->completed_head = request;
+		}
+		loader->completed_tail = request;
+
+		/* One queued dispatch delivers every completion that arrives
+		 * before it runs. */
+		if (!loader->dispatch_posted && loader->backend != NULL) {
+			loader->dispatch_posted = wlf_backend_post(loader->backend,
+				image_loader_dispatch, loader);
+		}
+	}
+	pthread_mutex_unlock(&loader->lock);
+
+	return NULL;
+}
+
+static void image_loader_stop(struct wlf_image_loader *loader) {
+	pthread_mutex_lock(&loader->lock);
+	loader->quit = true;
+	pthread_cond_broadcast(&loader->cond);
+	pthread_mutex_unlock(&loader->lock);
+
+	for (uint32_t i = 0; i < loader->thread_count; i++) {
+		pthread_join(loader->threads[i], NULL);
+	}
+	loader->thread_count = 0;
+}
+
+static void image_loader_free(struct wlf_image_loader *loader) {
+	for (size_t i = 0; i < loader->queue_len; i++) {
+		request_free(loader->queue[i]);
+	}
+	struct wlf_image_load_request *request = loader->completed_head;
+	while (request != NULL) {
+		struct wlf_image_load_request *next = request->next;
+		request_free(request);
+		request = next;
+	}
+
+	if (loader->backend != NULL) {
+		wlf_linked_list_remove(&loader->backend_destroy.link);
+	}
+
+	pthread_cond_destroy(&loader->cond);
+	pthread_mutex_destroy(&loader->lock);
+	free(loader->queue);
+	free(loader->threads);
+	free(loader);
+}
+
+/* Stops the workers and frees the loader, or leaves that to the dispatch
+ * task still queued on the backend, which cannot be withdrawn. */
+static void image_loader_release(struct wlf_image_loader *loader) {
+	image_loader_stop(loader);
+	if (loader->dispatch_posted && loader->backend != NULL) {
+		loader->destroy_pending = true;
+		return;
+	}
+
+	image_loader_free(loader);
+}
+
+static void image_loader_dispatch(void *data) {
+	struct wlf_image_loader *loader = data;
+
+	pthread_mutex_lock(&loader->lock);
+	struct wlf_image_load_request *request = loader->completed_head;
+	loader->completed_head = NULL;
+	loader->completed_tail = NULL;
+	loader->dispatch_posted = false;
+	pthread_mutex_unlock(&loader->lock);
+
+	/* Callbacks may cancel later requests of this batch, queue new ones or
+	 * destroy the loader, so every entry is re-checked before use. */
+	loader->dispatching = true;
+	while (request != NULL) {
+		struct wlf_image_load_request *next = request->next;
+		if (!request->cancelled && !loader->destroy_pending) {
+			struct wlf_image *image = request->image;
+			request->image = NULL;
+			request->done(request, image, request->data);
+		}
+		request_free(request);
+		request = next;
+	}
+	loader->dispatching = false;
+
+	if (loader->destroy_pending) {
+		image_loader_release(loader);
+	}
+}
+
+static void handle_backend_destroy(struct wlf_listener *listener, void *data) {
+	struct wlf_image_loader *loader =
+		wlf_container_of(listener, loader, backend_destroy);
+
+	/* The backend drops its queued tasks; completions are no longer
+	 * delivered, but the loader stays valid until it is destroyed. */
+	wlf_linked_list_remove(&loader->backend_destroy.link);
+	pthread_mutex_lock(&loader->lock);
+	loader->backend = NULL;
+	pthread_mutex_unlock(&loader->lock);
+
+	/* A destroy waiting for the dropped dispatch task finishes here. */
+	if (loader->destroy_pending && !loader->dispatching) {
+		image_loader_free(loader);
+	}
+}
+
+struct wlf_image_loader *wlf_image_loader_create(struct wlf_backend *backend,
+		uint32_t thread_count) {
+	assert(backend != NULL);
+
+	if (wlf_backend_get_event_loop(backend) == NULL) {
+		wlf_log(WLF_ERROR, "%s backend cannot deliver image loads",
+			backend->impl->name);
+		return NULL;
+	}
+
+	if (thread_count == 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		thread_count = cpus > 0 ? (uint32_t)cpus : 1;
+		if (thread_count > IMAGE_LOADER_MAX_DEFAULT_THREADS) {
+			thread_count = IMAGE_LOADER_MAX_DEFAULT_THREADS;
+		}
+	}
+
+	struct wlf_image_loader *loader = calloc(1, sizeof(*loader));
+	if (loader == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate wlf_image_loader");
+		return NULL;
+	}
+
+	loader->threads = calloc(thread_count, sizeof(*loader->threads));
+	if (loader->threads == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate image loader threads");
+		free(loader);
+		return NULL;
+	}
+
+	pthread_mutex_init(&loader->lock, NULL);
+	pthread_cond_init(&loader->cond, NULL);
+
+	loader->backend = backend;
+	loader->backend_destroy.notify = handle_backend_destroy;
+	wlf_signal_add(&backend->events.destroy, &loader->backend_destroy);
+
+	for (uint32_t i = 0; i < thread_count; i++) {
+		int ret = pthread_create(&loader->threads[i], NULL,
+			image_loader_worker, loader);
+		if (ret != 0) {
+			wlf_log(WLF_ERROR, "Failed to start image loader thread: %s",
+				strerror(ret));
+			image_loader_stop(loader);
+			image_loader_free(loader);
+			return NULL;
+		}
+		loader->thread_count++;
+	}
+
+	return loader;
+}
+
+void wlf_image_loader_destroy(struct wlf_image_loader *loader) {
+	if (loader == NULL) {
+		return;
+	}
+
+	if (loader->dispatching) {
+		loader->destroy_pending = true;
+		return;
+	}
+
+	image_loader_release(loader);
+}
+
+struct wlf_image_load_request *wlf_image_loader_load(
+		struct wlf_image_loader *loader, const char *filename,
+		uint32_t target_width, uint32_t target_height, int32_t priority,
+		wlf_image_load_done_t done, void *data) {
+	assert(loader != NULL);
+	assert(done != NULL);
+
+	if (filename == NULL || loader->destroy_pending) {
+		return NULL;
+	}
+
+	struct wlf_image_load_request *request = calloc(1, sizeof(*request));
+	if (request == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate wlf_image_load_request");
+		return NULL;
+	}
+
+	request->filename = strdup(filename);
+	if (request->filename == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to copy image file name");
+		free(request);
+		return NULL;
+	}
+
+	request->loader = loader;
+	request->target_width = target_width;
+	request->target_height = target_height;
+	request->priority = priority;
+	request->state = IMAGE_LOAD_PENDING;
+	request->done = done;
+	request->data = data;
+
+	pthread_mutex_lock(&loader->lock);
+	request->sequence = loader->next_sequence++;
+	if (!queue_push(loader, request)) {
+		pthread_mutex_unlock(&loader->lock);
+		request_free(request);
+		return NULL;
+	}
+	pthread_cond_signal(&loader->cond);
+	pthread_mutex_unlock(&loader->lock);
+
+	return request;
+}
+
+void wlf_image_load_request_set_priority(struct wlf_image_load_request *request,
+		int32_t priority) {
+	struct wlf_image_loader *loader = request->loader;
+
+	pthread_mutex_lock(&loader->lock);
+	if (request->state == IMAGE_LOAD_PENDING && request->priority != priority) {
+		request->priority = priority;
+		queue_sift_up(loader, request->queue_index);
+		queue_sift_down(loader, request->queue_index);
+	}
+	pthread_mutex_unlock(&loader->lock);
+}
+
+void wlf_image_load_request_cancel(struct wlf_image_load_request *request) {
+	struct wlf_image_loader *loader = request->loader;
+
+	pthread_mutex_lock(&loader->lock);
+	if (request->state == IMAGE_LOAD_PENDING) {
+		queue_remove(loader, request->queue_index);
+		pthread_mutex_unlock(&loader->lock);
+		request_free(request);
+		return;
+	}
+
+	/* Running or finished: the event loop drops it when it arrives. */
+	request->cancelled = true;
+	pthread_mutex_unlock(&loader->lock);
+}
@@ -1,4 +1,5 @@
 #include "wlf/image/wlf_jpeg_image.h"
+#include "wlf/utils/wlf_file_source.h"
 #include "wlf/utils/wlf_log.h"
 #include "wlf/utils/wlf_linked_list.h"
 #include "wlf/utils/wlf_compat.h"
@@ -13,6 +14,9 @@
 #include <jpeglib.h>
 #include <jerror.h>
 
+/* Upper bound on rows libjpeg returns from a single jpeg_read_scanlines(). */
+#define JPEG_MAX_ROWS_PER_READ 16
+
 /**
  * @brief Error handling structure for JPEG operations.
  */
@@ -205,20 +209,49 @@ static bool jpeg_image_save(struct wlf_image *image, const char *filename) {
 }
 
 /**
- * @brief Load a JPEG file into a wlf_image structure.
+ * @brief Pick the largest libjpeg DCT reduction that still covers a target size.
+ * @param width Full image width in pixels.
+ * @param height Full image height in pixels.
+ * @param target_width Minimum output width, or 0 for any.
+ * @param target_height Minimum output height, or 0 for any.
+ * @return Scale denominator: 1, 2, 4 or 8.
+ */
+static unsigned int jpeg_choose_scale_denom(JDIMENSION width, JDIMENSION height,
+		uint32_t target_width, uint32_t target_height) {
+	if (target_width == 0 && target_height == 0) {
+		return 1;
+	}
+
+	for (unsigned int denom = 8; denom > 1; denom /= 2) {
+		/* libjpeg rounds scaled dimensions up. */
+		JDIMENSION scaled_width = (width + denom - 1) / denom;
+		JDIMENSION scaled_height = (height + denom - 1) / denom;
+		if ((target_width == 0 || scaled_width >= target_width) &&
+				(target_height == 0 || scaled_height >= target_height)) {
+			return denom;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Decode JPEG data into a wlf_image structure.
  * @param image Pointer to the wlf_image structure to populate.
- * @param filename Path to the JPEG file to load.
- * @param enable_16_bit Whether to enable 16-bit mode (not supported by JPEG).
+ * @param source Encoded JPEG bytes.
+ * @param target_width Minimum output width for reduced decoding, or 0.
+ * @param target_height Minimum output height for reduced decoding, or 0.
  * @return true on success, false on failure.
- * @note This function reads a JPEG file and populates the image structure
- *       with the decoded pixel data. It automatically handles different
- *       JPEG colorspaces and converts them to standard wlframe formats.
- *       The enable_16_bit parameter is ignored as JPEG only supports 8-bit.
+ * @note With a non-zero target size, libjpeg's scaled IDCT decodes directly
+ *       at 1/2, 1/4 or 1/8 of the full size, so neither the full-size pixels
+ *       nor the skipped DCT work are ever produced. Scanlines are decoded
+ *       straight into the image buffer, several rows per call.
  */
-static bool jpeg_image_load(struct wlf_image *image, const char *filename, bool enable_16_bit) {
-	FILE *fp = fopen(filename, "rb");
-	if (fp == NULL) {
-		wlf_log_errno(WLF_ERROR, "Cannot open %s for reading!", filename);
+static bool jpeg_image_decode(struct wlf_image *image,
+		struct wlf_file_source *source,
+		uint32_t target_width, uint32_t target_height) {
+	if (source->size > ULONG_MAX) {
+		wlf_log(WLF_ERROR, "JPEG data in %s is too large", source->name);
 		return false;
 	}
 
@@ -227,21 +260,24 @@ static bool jpeg_image_load(struct wlf_image *image, const char *filename, bool
 	cinfo.err = jpeg_std_error(&jerr.pub);
 	jerr.pub.error_exit = wlf_jpeg_error_exit;
 
+	/* Written after setjmp(), so it must be volatile to survive longjmp(). */
+	unsigned char *volatile data = NULL;
 	if (setjmp(jerr.setjmp_buffer)) {
+		free(data);
+		image->data = NULL;
 		jpeg_destroy_decompress(&cinfo);
-		fclose(fp);
 		return false;
 	}
 
 	jpeg_create_decompress(&cinfo);
-	jpeg_stdio_src(&cinfo, fp);
+	/* Decode straight from the mapped bytes; older libjpeg takes a
+	 * non-const pointer but never writes through it. */
+	jpeg_mem_src(&cinfo, (unsigned char *)source->data,
+		(unsigned long)source->size);
 	jpeg_read_header(&cinfo, TRUE);
 
 	struct wlf_jpeg_image *jpeg_image = wlf_jpeg_image_from_image(image);
 	assert(jpeg_image != NULL);
-	if (enable_16_bit) {
-		wlf_log(WLF_INFO, "16-bit mode not supported by JPEG, using 8-bit");
-	}
 
 	switch (cinfo.jpeg_color_space) {
 		case JCS_GRAYSCALE:
@@ -274,16 +310,19 @@ static bool jpeg_image_load(struct wlf_image *image, const char *filename, bool
 		default:
 			wlf_log(WLF_ERROR, "Unsupported JPEG colorspace: %d", cinfo.jpeg_color_space);
 			jpeg_destroy_decompress(&cinfo);
-			fclose(fp);
-			return false;
+				return false;
 	}
 
+	cinfo.scale_num = 1;
+	cinfo.scale_denom = jpeg_choose_scale_denom(cinfo.image_width,
+		cinfo.image_height, target_width, target_height);
+	jpeg_image->scale_denom = cinfo.scale_denom;
+
 	jpeg_image->is_progressive = (cinfo.progressive_mode != 0);
 	jpeg_start_decompress(&cinfo);
 	if (cinfo.output_width > UINT32_MAX || cinfo.output_height > UINT32_MAX) {
 		wlf_log(WLF_ERROR, "JPEG dimensions are too large");
 		jpeg_destroy_decompress(&cinfo);
-		fclose(fp);
 		return false;
 	}
 
@@ -297,39 +336,81 @@ static bool jpeg_image_load(struct wlf_image *image, const char *filename, bool
 	if (row_stride > UINT32_MAX) {
 		wlf_log(WLF_ERROR, "JPEG row stride is too large");
 		jpeg_destroy_decompress(&cinfo);
-		fclose(fp);
 		return false;
 	}
 
 	image->stride = (uint32_t)row_stride;
-	image->data = malloc((size_t)image->height * row_stride);
-	if (image->data == NULL) {
+	data = malloc((size_t)image->height * row_stride);
+	if (data == NULL) {
 		wlf_log_errno(WLF_ERROR, "Failed to allocate image data");
 		jpeg_destroy_decompress(&cinfo);
-		fclose(fp);
 		return false;
 	}
 
-	JSAMPARRAY buffer = (*cinfo.mem->alloc_sarray)(
-		(j_common_ptr)&cinfo, JPOOL_IMAGE, (JDIMENSION)row_stride, 1);
-
+	/* libjpeg emits at most rec_outbuf_height rows per call; hand it that
+	 * many row pointers into the destination so no copy is needed. */
+	JSAMPROW rows[JPEG_MAX_ROWS_PER_READ];
+	JDIMENSION max_rows = (JDIMENSION)cinfo.rec_outbuf_height;
+	if (max_rows < 1 || max_rows > JPEG_MAX_ROWS_PER_READ) {
+		max_rows = JPEG_MAX_ROWS_PER_READ;
+	}
 	while (cinfo.output_scanline < cinfo.output_height) {
-		jpeg_read_scanlines(&cinfo, buffer, 1);
-		memcpy(image->data + (size_t)(cinfo.output_scanline - 1) * row_stride,
-		       buffer[0], row_stride);
+		JDIMENSION count = cinfo.output_height - cinfo.output_scanline;
+		if (count > max_rows) {
+			count = max_rows;
+		}
+		for (JDIMENSION i = 0; i < count; i++) {
+			rows[i] = data + (size_t)(cinfo.output_scanline + i) * row_stride;
+		}
+		jpeg_read_scanlines(&cinfo, rows, count);
 	}
 
 	jpeg_finish_decompress(&cinfo);
 	jpeg_destroy_decompress(&cinfo);
-	fclose(fp);
+	image->data = data;
 
-	wlf_log(WLF_DEBUG, "JPEG Info: %ux%u, Format: %d, Bit Depth: %d, Stride: %u, Progressive: %s",
-		image->width, image->height, image->format, image->bit_depth, image->stride,
+	wlf_log(WLF_DEBUG, "JPEG Info: %ux%u (1/%u), Format: %d, Bit Depth: %d, Stride: %u, Progressive: %s",
+		image->width, image->height, jpeg_image->scale_denom, image->format,
+		image->bit_depth, image->stride,
 		jpeg_image->is_progressive ? "Yes" : "No");
 
 	return true;
 }
 
+/**
+ * @brief Load JPEG data into a wlf_image structure.
+ * @param image Pointer to the wlf_image structure to populate.
+ * @param source Encoded JPEG bytes.
+ * @param enable_16_bit Whether to enable 16-bit mode (not supported by JPEG).
+ * @return true on success, false on failure.
+ * @note This function decodes JPEG data and populates the image structure
+ *       with the decoded pixel data. It automatically handles different
+ *       JPEG colorspaces and converts them to standard wlframe formats.
+ *       The enable_16_bit parameter is ignored as JPEG only supports 8-bit.
+ */
+static bool jpeg_image_load_source(struct wlf_image *image,
+		struct wlf_file_source *source, bool enable_16_bit) {
+	if (enable_16_bit) {
+		wlf_log(WLF_INFO, "16-bit mode not supported by JPEG, using 8-bit");
+	}
+
+	return jpeg_image_decode(image, source, 0, 0);
+}
+
+/**
+ * @brief Load JPEG data at a reduced size.
+ * @param image Pointer to the wlf_image structure to populate.
+ * @param source Encoded JPEG bytes.
+ * @param target_width Minimum output width, or 0 for any.
+ * @param target_height Minimum output height, or 0 for any.
+ * @return true on success, false on failure.
+ */
+static bool jpeg_image_load_at_size(struct wlf_image *image,
+		struct wlf_file_source *source,
+		uint32_t target_width, uint32_t target_height) {
+	return jpeg_image_decode(image, source, target_width, target_height);
+}
+
 static void jpeg_image_destroy(struct wlf_image *wlf_image) {
 	struct wlf_jpeg_image *image = wlf_jpeg_image_from_image(wlf_image);
 	free(image->base.data);
@@ -337,7 +418,9 @@ static void jpeg_image_destroy(struct wlf_image *wlf_image) {
 
 static const struct wlf_image_impl jpeg_image_impl = {
 	.save = jpeg_image_save,
-	.load = jpeg_image_load,
+	.load = wlf_image_load_source_file,
+	.load_source = jpeg_image_load_source,
+	.load_at_size = jpeg_image_load_at_size,
 	.destroy = jpeg_image_destroy,
 };
 
@@ -352,6 +435,7 @@ struct wlf_jpeg_image *wlf_jpeg_image_create(void) {
 	image->options = wlf_jpeg_get_default_options();
 	image->colorspace = WLF_JPEG_COLORSPACE_UNKNOWN;
 	image->is_progressive = false;
+	image->scale_denom = 1;
 
 	return image;
 }
@@ -374,6 +458,61 @@ bool wlf_image_is_jpeg(const struct wlf_image *image) {
 	return image->impl == &jpeg_image_impl;
 }
 
+bool wlf_jpeg_image_probe(struct wlf_file_source *source,
+		struct wlf_image_info *info) {
+	if (source->size > ULONG_MAX) {
+		return false;
+	}
+
+	struct jpeg_decompress_struct cinfo;
+	struct wlf_jpeg_error_mgr jerr;
+	cinfo.err = jpeg_std_error(&jerr.pub);
+	jerr.pub.error_exit = wlf_jpeg_error_exit;
+
+	if (setjmp(jerr.setjmp_buffer)) {
+		jpeg_destroy_decompress(&cinfo);
+		return false;
+	}
+
+	/* jpeg_read_header() stops at the first SOS marker, so no entropy-coded
+	 * data is touched. */
+	jpeg_create_decompress(&cinfo);
+	jpeg_mem_src(&cinfo, (unsigned char *)source->data,
+		(unsigned long)source->size);
+	jpeg_read_header(&cinfo, TRUE);
+
+	bool ok = true;
+	switch (cinfo.jpeg_color_space) {
+		case JCS_GRAYSCALE:
+			info->format = WLF_COLOR_TYPE_GRAY;
+			break;
+		case JCS_RGB:
+		case JCS_YCbCr:
+		case JCS_CMYK:
+		case JCS_YCCK:
+			info->format = WLF_COLOR_TYPE_RGB;
+			break;
+		default:
+			ok = false;
+			break;
+	}
+
+	if (cinfo.image_width > UINT32_MAX || cinfo.image_height > UINT32_MAX) {
+		ok = false;
+	}
+
+	info->type = WLF_IMAGE_TYPE_JPEG;
+	info->width = (uint32_t)cinfo.image_width;
+	info->height = (uint32_t)cinfo.image_height;
+	info->bit_depth = WLF_IMAGE_BIT_DEPTH_8;
+	info->has_alpha_channel = false;
+	info->is_animated = false;
+
+	jpeg_destroy_decompress(&cinfo);
+
+	return ok;
+}
+
 enum wlf_jpeg_colorspace wlf_color_type_to_jpeg_colorspace(const struct wlf_image *image) {
 	if (image == NULL) {
 		return WLF_JPEG_COLORSPACE_UNKNOWN;
@@ -1,4 +1,5 @@
 #include "wlf/image/wlf_png_image.h"
+#include "wlf/utils/wlf_file_source.h"
 #include "wlf/utils/wlf_log.h"
 #include "wlf/utils/wlf_linked_list.h"
 #include "wlf/utils/wlf_compat.h"
@@ -72,13 +73,15 @@ static bool png_image_save(struct wlf_image *image, const char *filename) {
 	return true;
 };
 
-static bool png_image_load(struct wlf_image *image, const char *filename, bool enable_16_bit) {
-	FILE *fp = fopen(filename, "rb");
-	if (fp == NULL) {
-		wlf_log_errno(WLF_ERROR, "File %s is not a valid PNG image!", filename);
-		return false;
+static void png_read_source(png_structp png_ptr, png_bytep data, png_size_t length) {
+	struct wlf_file_source *source = png_get_io_ptr(png_ptr);
+	if (wlf_file_source_read(source, data, length) != length) {
+		png_error(png_ptr, "Unexpected end of PNG data");
 	}
+}
 
+static bool png_image_load_source(struct wlf_image *image,
+		struct wlf_file_source *source, bool enable_16_bit) {
 	png_structp png_ptr;
 	png_infop info_ptr;
 	png_uint_32 width, height;
@@ -87,24 +90,25 @@ static bool png_image_load(struct wlf_image *image, const char *filename, bool e
 
 	png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
 	if (png_ptr == NULL) {
-		fclose(fp);
 		return false;
 	}
 
 	info_ptr = png_create_info_struct(png_ptr);
 	if (info_ptr == NULL) {
-		fclose(fp);
 		png_destroy_read_struct(&png_ptr, NULL, NULL);
 		return false;
 	}
 
+	/* Written after setjmp(), so it must be volatile to survive longjmp()
+	 * from a truncated image. */
+	png_bytep *volatile row_pointers = NULL;
 	if (setjmp(png_jmpbuf(png_ptr))) {
+		free(row_pointers);
 		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-		fclose(fp);
 		return false;
 	}
 
-	png_init_io(png_ptr, fp);
+	png_set_read_fn(png_ptr, source, png_read_source);
 	png_set_sig_bytes(png_ptr, sig_read);
 	png_read_info(png_ptr, info_ptr);
 	png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth, &color_type,
@@ -128,7 +132,6 @@ static bool png_image_load(struct wlf_image *image, const char *filename, bool e
 	} else if (color_type != PNG_COLOR_TYPE_RGB &&
 			color_type != PNG_COLOR_TYPE_RGBA) {
 		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-		fclose(fp);
 		return false;
 	}
 
@@ -160,33 +163,31 @@ static bool png_image_load(struct wlf_image *image, const char *filename, bool e
 		break;
 	default:
 		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-		fclose(fp);
 		wlf_log(WLF_ERROR, "Unsupported PNG channel count");
 		return false;
 	}
 
 	png_size_t rowbytes = png_get_rowbytes(png_ptr, info_ptr);
 	image->data = (unsigned char *)malloc(rowbytes * height);
-	png_bytep *row_pointers = malloc(sizeof(png_bytep) * height);
+	row_pointers = malloc(sizeof(png_bytep) * height);
 	for (png_uint_32 y = 0; y < height; y++) {
 		row_pointers[y] = image->data + y * rowbytes;
 	}
 
 	png_read_image(png_ptr, row_pointers);
 	free(row_pointers);
+	row_pointers = NULL;
 	image->width = width;
 	image->height = height;
 	image->bit_depth = png_get_bit_depth(png_ptr, info_ptr);
 	if (rowbytes > UINT32_MAX) {
 		png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-		fclose(fp);
 		wlf_log(WLF_ERROR, "PNG row stride exceeds uint32_t range");
 		return false;
 	}
 	image->stride = (uint32_t)rowbytes;
 
 	png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-	fclose(fp);
 	wlf_log(WLF_DEBUG, "PNG Info: %dx%d, Format: %d, Bit Depth: %d\n, Stride: %d",
 		image->width, image->height, image->format, image->bit_depth, image->stride);
 
@@ -200,7 +201,8 @@ static void png_image_destroy(struct wlf_image *wlf_image) {
 
 static const struct wlf_image_impl png_image_impl = {
 	.save = png_image_save,
-	.load = png_image_load,
+	.load = wlf_image_load_source_file,
+	.load_source = png_image_load_source,
 	.destroy = png_image_destroy,
 };
 
@@ -226,6 +228,75 @@ struct wlf_png_image *wlf_png_image_from_image(struct wlf_image *wlf_image) {
 	return image;
 }
 
+static uint32_t png_read_u32(const uint8_t *p) {
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+		((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+bool wlf_png_image_probe(struct wlf_file_source *source,
+		struct wlf_image_info *info) {
+	static const uint8_t signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	const uint8_t *data = source->data;
+	size_t size = source->size;
+
+	// Signature, then the IHDR chunk: length, type and 13 data bytes
+	if (size < 8 + 8 + 13 || memcmp(data, signature, sizeof(signature)) != 0 ||
+			memcmp(data + 12, "IHDR", 4) != 0) {
+		return false;
+	}
+
+	uint32_t width = png_read_u32(data + 16);
+	uint32_t height = png_read_u32(data + 20);
+	int color_type = data[25];
+	if (width == 0 || height == 0) {
+		return false;
+	}
+
+	/* The loader expands tRNS to an alpha channel; it must precede IDAT. */
+	bool has_trns = false;
+	size_t offset = sizeof(signature);
+	while (size - offset >= 12) {
+		uint32_t length = png_read_u32(data + offset);
+		const uint8_t *type = data + offset + 4;
+		if (memcmp(type, "tRNS", 4) == 0) {
+			has_trns = true;
+			break;
+		}
+		if (memcmp(type, "IDAT", 4) == 0 || memcmp(type, "IEND", 4) == 0 ||
+				length > size - offset - 12) {
+			break;
+		}
+		offset += 12 + (size_t)length;
+	}
+
+	switch (color_type) {
+	case PNG_COLOR_TYPE_GRAY:
+		info->format = has_trns ? WLF_COLOR_TYPE_GRAY_ALPHA : WLF_COLOR_TYPE_GRAY;
+		break;
+	case PNG_COLOR_TYPE_PALETTE:
+	case PNG_COLOR_TYPE_RGB:
+		info->format = has_trns ? WLF_COLOR_TYPE_RGBA : WLF_COLOR_TYPE_RGB;
+		break;
+	case PNG_COLOR_TYPE_GRAY_ALPHA:
+	case PNG_COLOR_TYPE_RGBA:
+		info->format = WLF_COLOR_TYPE_RGBA;
+		break;
+	default:
+		return false;
+	}
+
+	info->type = WLF_IMAGE_TYPE_PNG;
+	info->width = width;
+	info->height = height;
+	/* wlf_image_load() strips 16-bit samples and expands low bit depths. */
+	info->bit_depth = WLF_IMAGE_BIT_DEPTH_8;
+	info->has_alpha_channel = info->format == WLF_COLOR_TYPE_RGBA ||
+		info->format == WLF_COLOR_TYPE_GRAY_ALPHA;
+	info->is_animated = false;
+
+	return true;
+}
+
 void wlf_png_image_print_data(const struct wlf_image *image) {
 	if (image == NULL || !image->data) {
 		wlf_log(WLF_ERROR, "PNG image data is NULL");
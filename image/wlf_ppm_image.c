@@ -1,4 +1,5 @@
 #include "wlf/image/wlf_ppm_image.h"
+#include "wlf/utils/wlf_file_source.h"
 #include "wlf/utils/wlf_log.h"
 #include "wlf/utils/wlf_linked_list.h"
 
@@ -10,42 +11,45 @@
 #include <limits.h>
 
 /**
- * @brief Skip whitespace and comments in PPM file.
- * @param fp File pointer.
+ * @brief Skip whitespace and comments in PPM data.
+ * @param source Image source positioned inside the header or P3 samples.
  */
-static void skip_whitespace_and_comments(FILE *fp) {
+static void skip_whitespace_and_comments(struct wlf_file_source *source) {
 	int c;
-	while ((c = fgetc(fp)) != EOF) {
+	while ((c = wlf_file_source_peek(source)) != -1) {
 		if (c == '#') {
 			// Skip comment line
-			while ((c = fgetc(fp)) != EOF && c != '\n');
-		} else if (!isspace(c)) {
-			ungetc(c, fp);
+			while ((c = wlf_file_source_getc(source)) != -1 && c != '\n');
+		} else if (isspace(c)) {
+			source->offset++;
+		} else {
 			break;
 		}
 	}
 }
 
 /**
- * @brief Read a number from PPM file, skipping whitespace and comments.
- * @param fp File pointer.
+ * @brief Read a number from PPM data, skipping whitespace and comments.
+ * @param source Image source positioned inside the header or P3 samples.
  * @return The number read, or -1 on error.
  */
-static int read_ppm_number(FILE *fp) {
+static int read_ppm_number(struct wlf_file_source *source) {
 	int num = 0;
+	int digits = 0;
 	int c;
 
-	skip_whitespace_and_comments(fp);
+	skip_whitespace_and_comments(source);
 
-	while ((c = fgetc(fp)) != EOF && isdigit(c)) {
+	while ((c = wlf_file_source_peek(source)) != -1 && isdigit(c)) {
+		if (num > (INT_MAX - 9) / 10) {
+			return -1;
+		}
 		num = num * 10 + (c - '0');
+		digits++;
+		source->offset++;
 	}
 
-	if (c != EOF) {
-		ungetc(c, fp);
-	}
-
-	return num;
+	return digits > 0 ? num : -1;
 }
 
 static bool ppm_image_save(struct wlf_image *image, const char *filename) {
@@ -119,39 +123,30 @@ static bool ppm_image_save(struct wlf_image *image, const char *filename) {
 	return true;
 }
 
-static bool ppm_image_load(struct wlf_image *image, const char *filename, bool enable_16_bit) {
-	FILE *fp = fopen(filename, "rb");
-	if (fp == NULL) {
-		wlf_log_errno(WLF_ERROR, "File %s cannot be opened!", filename);
-		return false;
-	}
-
-	char magic[3];
-	if (fread(magic, 1, 2, fp) != 2) {
+static bool ppm_image_load_source(struct wlf_image *image,
+		struct wlf_file_source *source, bool enable_16_bit) {
+	const uint8_t *magic = wlf_file_source_take(source, 2);
+	if (magic == NULL) {
 		wlf_log(WLF_ERROR, "Cannot read PPM magic number!");
-		fclose(fp);
 		return false;
 	}
-	magic[2] = '\0';
 
 	enum wlf_ppm_format format;
-	if (strcmp(magic, "P3") == 0) {
+	if (magic[0] == 'P' && magic[1] == '3') {
 		format = WLF_PPM_FORMAT_P3;
-	} else if (strcmp(magic, "P6") == 0) {
+	} else if (magic[0] == 'P' && magic[1] == '6') {
 		format = WLF_PPM_FORMAT_P6;
 	} else {
-		wlf_log(WLF_ERROR, "File %s is not a valid PPM image!", filename);
-		fclose(fp);
+		wlf_log(WLF_ERROR, "File %s is not a valid PPM image!", source->name);
 		return false;
 	}
 
-	int width = read_ppm_number(fp);
-	int height = read_ppm_number(fp);
-	int max_val = read_ppm_number(fp);
+	int width = read_ppm_number(source);
+	int height = read_ppm_number(source);
+	int max_val = read_ppm_number(source);
 
-	if (width <= 0 || height <= 0 || max_val <= 0) {
+	if (width <= 0 || height <= 0 || max_val <= 0 || max_val > 65535) {
 		wlf_log(WLF_ERROR, "Invalid PPM dimensions or max value!");
-		fclose(fp);
 		return false;
 	}
 
@@ -160,76 +155,60 @@ static bool ppm_image_load(struct wlf_image *image, const char *filename, bool e
 	size_t stride = width_u * 3;
 	if (width_u > UINT32_MAX || height_u > UINT32_MAX || stride > UINT32_MAX) {
 		wlf_log(WLF_ERROR, "PPM dimensions are too large");
-		fclose(fp);
 		return false;
 	}
 
-	fgetc(fp);
+	// Single whitespace byte between the header and the samples
+	wlf_file_source_getc(source);
 	size_t data_size = width_u * height_u * 3; // RGB format
+
+	const uint8_t *samples = NULL;
+	if (format == WLF_PPM_FORMAT_P6) {
+		size_t sample_size = max_val <= 255 ? 1 : 2;
+		if (wlf_file_source_remaining(source) / sample_size < data_size) {
+			wlf_log(WLF_ERROR, "Error reading binary pixel data!");
+			return false;
+		}
+		samples = wlf_file_source_take(source, data_size * sample_size);
+	}
+
 	image->data = malloc(data_size);
 	if (image->data == NULL) {
 		wlf_log_errno(WLF_ERROR, "Failed to allocate image data");
-		fclose(fp);
 		return false;
 	}
 
 	if (format == WLF_PPM_FORMAT_P3) {
-		for (int y = 0; y < height; y++) {
-			for (int x = 0; x < width; x++) {
-				int r = read_ppm_number(fp);
-				int g = read_ppm_number(fp);
-				int b = read_ppm_number(fp);
-
-				if (r < 0 || g < 0 || b < 0) {
-					wlf_log(WLF_ERROR, "Error reading pixel data!");
-					free(image->data);
-					fclose(fp);
-					return false;
-				}
-
-				// Scale values to 0-255 range if max_val is not 255
-				if (max_val != 255) {
-					r = (r * 255) / max_val;
-					g = (g * 255) / max_val;
-					b = (b * 255) / max_val;
-				}
-
-				uint32_t offset = (y * width + x) * 3;
-				image->data[offset] = (unsigned char)r;
-				image->data[offset + 1] = (unsigned char)g;
-				image->data[offset + 2] = (unsigned char)b;
-			}
-		}
-	} else {
-		if (max_val <= 255) {
-			if (fread(image->data, 1, data_size, fp) != data_size) {
-				wlf_log(WLF_ERROR, "Error reading binary pixel data!");
+		for (size_t i = 0; i < data_size; i++) {
+			int v = read_ppm_number(source);
+			if (v < 0) {
+				wlf_log(WLF_ERROR, "Error reading pixel data!");
 				free(image->data);
-				fclose(fp);
+				image->data = NULL;
 				return false;
 			}
+
+			// Scale values to 0-255 range if max_val is not 255
 			if (max_val != 255) {
-				for (size_t i = 0; i < data_size; i++) {
-					image->data[i] = (image->data[i] * 255) / max_val;
-				}
-			}
-		} else {
-			/* PPM stores 16-bit samples most-significant byte first. Keep the
-			 * public image data normalized to the same 8-bit RGB layout used by
-			 * the other decoders. */
-			for (size_t i = 0; i < data_size; i++) {
-				int high = fgetc(fp);
-				int low = fgetc(fp);
-				if (high == EOF || low == EOF) {
-					wlf_log(WLF_ERROR, "Error reading 16-bit pixel data!");
-					free(image->data);
-					fclose(fp);
-					return false;
-				}
-				unsigned int sample = ((unsigned int)high << 8) | (unsigned int)low;
-				image->data[i] = (unsigned char)((sample * 255U + max_val / 2U) /
-					(unsigned int)max_val);
+				v = (int)(((long long)v * 255) / max_val);
 			}
+			image->data[i] = (unsigned char)v;
+		}
+	} else if (max_val == 255) {
+		memcpy(image->data, samples, data_size);
+	} else if (max_val < 255) {
+		for (size_t i = 0; i < data_size; i++) {
+			image->data[i] = (samples[i] * 255) / max_val;
+		}
+	} else {
+		/* PPM stores 16-bit samples most-significant byte first. Keep the
+		 * public image data normalized to the same 8-bit RGB layout used by
+		 * the other decoders. */
+		for (size_t i = 0; i < data_size; i++) {
+			unsigned int sample = ((unsigned int)samples[i * 2] << 8) |
+				(unsigned int)samples[i * 2 + 1];
+			image->data[i] = (unsigned char)((sample * 255U + max_val / 2U) /
+				(unsigned int)max_val);
 		}
 	}
 
@@ -246,7 +225,6 @@ static bool ppm_image_load(struct wlf_image *image, const char *filename, bool e
 	ppm_image->format = format;
 	ppm_image->max_val = max_val; // Preserve original max_val
 
-	fclose(fp);
 	return true;
 }
 
@@ -257,7 +235,8 @@ static void ppm_image_destroy(struct wlf_image *wlf_image) {
 
 static const struct wlf_image_impl ppm_image_impl = {
 	.save = ppm_image_save,
-	.load = ppm_image_load,
+	.load = wlf_image_load_source_file,
+	.load_source = ppm_image_load_source,
 	.destroy = ppm_image_destroy,
 };
 
@@ -286,6 +265,31 @@ struct wlf_ppm_image *wlf_ppm_image_from_image(struct wlf_image *wlf_image) {
 	return image;
 }
 
+bool wlf_ppm_image_probe(struct wlf_file_source *source,
+		struct wlf_image_info *info) {
+	const uint8_t *magic = wlf_file_source_take(source, 2);
+	if (magic == NULL || magic[0] != 'P' || (magic[1] != '3' && magic[1] != '6')) {
+		return false;
+	}
+
+	int width = read_ppm_number(source);
+	int height = read_ppm_number(source);
+	int max_val = read_ppm_number(source);
+	if (width <= 0 || height <= 0 || max_val <= 0 || max_val > 65535) {
+		return false;
+	}
+
+	info->type = WLF_IMAGE_TYPE_PPM;
+	info->width = (uint32_t)width;
+	info->height = (uint32_t)height;
+	info->format = WLF_COLOR_TYPE_RGB;
+	info->bit_depth = WLF_IMAGE_BIT_DEPTH_8;
+	info->has_alpha_channel = false;
+	info->is_animated = false;
+
+	return true;
+}
+
 void wlf_ppm_image_set_format(struct wlf_ppm_image *image, enum wlf_ppm_format format) {
 	if (image) {
 		image->format = format;
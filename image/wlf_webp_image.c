@@ -1,4 +1,5 @@
 #include "wlf/image/wlf_webp_image.h"
+#include "wlf/utils/wlf_file_source.h"
 #include "wlf/utils/wlf_log.h"
 #include "wlf/utils/wlf_linked_list.h"
 
@@ -13,39 +14,6 @@
 #include <webp/encode.h>
 #include <webp/mux.h>
 
-static uint8_t *read_file(const char *path, size_t *out_size) {
-	FILE *fp = fopen(path, "rb");
-	if (fp == NULL) {
-		wlf_log_errno(WLF_ERROR, "Open %s failed!", path);
-		return NULL;
-	}
-
-	fseek(fp, 0, SEEK_END);
-	long size = ftell(fp);
-	rewind(fp);
-
-	if (size <= 0) {
-		fclose(fp);
-		return NULL;
-	}
-
-	uint8_t *data = malloc((size_t)size);
-	if (!data) {
-		fclose(fp);
-		return NULL;
-	}
-
-	size_t read_size = fread(data, 1, (size_t)size, fp);
-	fclose(fp);
-	if (read_size != (size_t)size) {
-		free(data);
-		return NULL;
-	}
-
-	*out_size = (size_t)size;
-	return data;
-}
-
 static int write_file(const char *path, const uint8_t *data, size_t size) {
 	FILE *fp = fopen(path, "wb");
 	if (fp == NULL) {
@@ -246,18 +214,19 @@ anim_out:
 	return true;
 }
 
-static bool image_load(struct wlf_image *image, const char *filename, bool enable_16_bit) {
+static bool image_load_source(struct wlf_image *image,
+		struct wlf_file_source *source, bool enable_16_bit) {
 	(void)enable_16_bit;
-	size_t file_size = 0;
-	uint8_t *file_data = read_file(filename, &file_size);
+	/* libwebp decodes straight from the mapped or caller-supplied bytes. */
+	const uint8_t *file_data = source->data;
+	size_t file_size = source->size;
 	if (file_data == NULL) {
 		return false;
 	}
 
 	WebPBitstreamFeatures features;
 	if (WebPGetFeatures(file_data, (size_t)file_size, &features) != VP8_STATUS_OK) {
-		wlf_log(WLF_ERROR, "Invalid WebP bitstream: %s", filename);
-		free(file_data);
+		wlf_log(WLF_ERROR, "Invalid WebP bitstream: %s", source->name);
 		return false;
 	}
 
@@ -282,12 +251,12 @@ static bool image_load(struct wlf_image *image, const char *filename, bool enabl
 
 		dec = WebPAnimDecoderNew(&webp_data, &dec_opts);
 		if (dec == NULL) {
-			wlf_log(WLF_ERROR, "WebPAnimDecoderNew failed: %s", filename);
+			wlf_log(WLF_ERROR, "WebPAnimDecoderNew failed: %s", source->name);
 			goto anim_out;
 		}
 
 		if (!WebPAnimDecoderGetInfo(dec, &info)) {
-			wlf_log(WLF_ERROR, "WebPAnimDecoderGetInfo failed: %s", filename);
+			wlf_log(WLF_ERROR, "WebPAnimDecoderGetInfo failed: %s", source->name);
 			goto anim_out;
 		}
 
@@ -378,7 +347,6 @@ static bool image_load(struct wlf_image *image, const char *filename, bool enabl
 
 anim_out:
 		WebPAnimDecoderDelete(dec);
-		free(file_data);
 		if (!ret) {
 			if (anim) {
 				free(anim->frames);
@@ -396,14 +364,12 @@ anim_out:
 	size_t buf_size = stride * (size_t)height;
 	if ((size_t)width > UINT32_MAX || (size_t)height > UINT32_MAX || stride > UINT32_MAX) {
 		wlf_log(WLF_ERROR, "WebP dimensions are too large");
-		free(file_data);
 		return false;
 	}
 
 	image->data = malloc(buf_size);
 	if (image->data == NULL) {
 		wlf_log(WLF_ERROR, "Failed to allocate pixel data");
-		free(file_data);
 		return false;
 	}
 
@@ -422,8 +388,6 @@ anim_out:
 		image->is_opaque = true;
 	}
 
-	free(file_data);
-
 	if (decoded == NULL) {
 		free(image->data);
 		image->data = NULL;
@@ -454,7 +418,8 @@ static void image_destroy(struct wlf_image *image) {
 
 static const struct wlf_image_impl image_impl = {
 	.save = image_save,
-	.load = image_load,
+	.load = wlf_image_load_source_file,
+	.load_source = image_load_source,
 	.destroy = image_destroy,
 };
 
@@ -483,14 +448,36 @@ struct wlf_webp_image *wlf_webp_image_from_image(struct wlf_image *wlf_image) {
 	return image;
 }
 
+bool wlf_webp_image_probe(struct wlf_file_source *source,
+		struct wlf_image_info *info) {
+	WebPBitstreamFeatures features;
+	if (source->data == NULL ||
+			WebPGetFeatures(source->data, source->size, &features) != VP8_STATUS_OK ||
+			features.width <= 0 || features.height <= 0) {
+		return false;
+	}
+
+	// For animations the features carry the canvas size
+	info->type = WLF_IMAGE_TYPE_WEBP;
+	info->width = (uint32_t)features.width;
+	info->height = (uint32_t)features.height;
+	info->format = (features.has_animation || features.has_alpha) ?
+		WLF_COLOR_TYPE_RGBA : WLF_COLOR_TYPE_RGB;
+	info->bit_depth = WLF_IMAGE_BIT_DEPTH_8;
+	info->has_alpha_channel = info->format == WLF_COLOR_TYPE_RGBA;
+	info->is_animated = features.has_animation != 0;
+
+	return true;
+}
+
 bool wlf_file_is_webp(const char *file_name) {
-	size_t data_size;
-	uint8_t *data = read_file(file_name, &data_size);
-	if (data == NULL) {
+	struct wlf_file_source source;
+	if (!wlf_file_source_init_from_file(&source, file_name) || source.size == 0) {
+		wlf_file_source_finish(&source);
 		return false;
 	}
 	int width, height;
-	int ok = WebPGetInfo(data, data_size, &width, &height);
-	free(data);
+	int ok = WebPGetInfo(source.data, source.size, &width, &height);
+	wlf_file_source_finish(&source);
 	return ok != 0;
 }
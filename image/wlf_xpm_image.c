@@ -1,4 +1,6 @@
 #include "wlf/image/wlf_xpm_image.h"
+#include "wlf/utils/wlf_file_source.h"
+#include "wlf/utils/wlf_hash.h"
 #include "wlf/utils/wlf_linked_list.h"
 #include "wlf/utils/wlf_log.h"
 #include "wlf/utils/wlf_compat.h"
@@ -11,6 +13,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if WLF_HAS_LINUX_PLATFORM
+#include <pthread.h>
+#endif
+
 struct wlf_xpm_color {
 	char *key;
 	uint8_t r;
@@ -21,6 +27,7 @@ struct wlf_xpm_color {
 
 struct wlf_x11_named_color {
 	char *name;
+	size_t order;
 	uint8_t r;
 	uint8_t g;
 	uint8_t b;
@@ -28,7 +35,11 @@ struct wlf_x11_named_color {
 
 static struct wlf_x11_named_color *x11_named_colors;
 static size_t x11_named_color_count;
+#if WLF_HAS_LINUX_PLATFORM
+static pthread_once_t x11_named_colors_once = PTHREAD_ONCE_INIT;
+#else
 static bool x11_named_colors_loaded;
+#endif
 
 static void trim_ascii(char *s) {
 	if (s == NULL) {
@@ -81,44 +92,72 @@ static int compare_named_color(const void *a, const void *b) {
 	return strcmp(ca->name, cb->name);
 }
 
-static void add_named_color(uint8_t r, uint8_t g, uint8_t b, const char *name) {
+static int compare_named_color_entry(const void *a, const void *b) {
+	const struct wlf_x11_named_color *ca = a;
+	const struct wlf_x11_named_color *cb = b;
+	int ret = strcmp(ca->name, cb->name);
+	if (ret != 0) {
+		return ret;
+	}
+
+	/* Keep file order among duplicates so the first definition wins. */
+	return (ca->order > cb->order) - (ca->order < cb->order);
+}
+
+static void add_named_color(uint8_t r, uint8_t g, uint8_t b, const char *name,
+		size_t *capacity) {
 	char normalized[128];
 	if (!normalize_color_name(name, normalized, sizeof(normalized))) {
 		return;
 	}
 
-	for (size_t i = 0; i < x11_named_color_count; i++) {
-		if (strcmp(x11_named_colors[i].name, normalized) == 0) {
+	if (x11_named_color_count == *capacity) {
+		size_t new_capacity = *capacity > 0 ? *capacity * 2 : 1024;
+		struct wlf_x11_named_color *tmp = realloc(x11_named_colors,
+			new_capacity * sizeof(*x11_named_colors));
+		if (tmp == NULL) {
 			return;
 		}
+		x11_named_colors = tmp;
+		*capacity = new_capacity;
 	}
 
-	struct wlf_x11_named_color *tmp = realloc(
-		x11_named_colors,
-		(x11_named_color_count + 1) * sizeof(*x11_named_colors)
-	);
-	if (tmp == NULL) {
-		return;
-	}
-
-	x11_named_colors = tmp;
-	x11_named_colors[x11_named_color_count].name = strdup(normalized);
-	if (x11_named_colors[x11_named_color_count].name == NULL) {
+	char *copy = strdup(normalized);
+	if (copy == NULL) {
 		return;
 	}
 
-	x11_named_colors[x11_named_color_count].r = r;
-	x11_named_colors[x11_named_color_count].g = g;
-	x11_named_colors[x11_named_color_count].b = b;
+	x11_named_colors[x11_named_color_count] = (struct wlf_x11_named_color){
+		.name = copy,
+		.order = x11_named_color_count,
+		.r = r,
+		.g = g,
+		.b = b,
+	};
 	x11_named_color_count++;
 }
 
-static void load_x11_named_colors(void) {
-	if (x11_named_colors_loaded) {
+/* Sorts the table for bsearch() and drops later duplicates of a name. */
+static void finish_x11_named_colors(void) {
+	if (x11_named_color_count < 2) {
 		return;
 	}
-	x11_named_colors_loaded = true;
 
+	qsort(x11_named_colors, x11_named_color_count, sizeof(*x11_named_colors),
+		compare_named_color_entry);
+
+	size_t out = 1;
+	for (size_t i = 1; i < x11_named_color_count; i++) {
+		if (strcmp(x11_named_colors[i].name, x11_named_colors[out - 1].name) == 0) {
+			free(x11_named_colors[i].name);
+			continue;
+		}
+		x11_named_colors[out++] = x11_named_colors[i];
+	}
+	x11_named_color_count = out;
+}
+
+static void read_x11_named_colors(void) {
 	static const char *paths[] = {
 		"/usr/share/X11/rgb.txt",
 		"/usr/X11R6/lib/X11/rgb.txt",
@@ -136,6 +175,7 @@ static void load_x11_named_colors(void) {
 		return;
 	}
 
+	size_t capacity = 0;
 	char line[512];
 	while (fgets(line, sizeof(line), fp) != NULL) {
 		trim_ascii(line);
@@ -156,14 +196,29 @@ static void load_x11_named_colors(void) {
 			continue;
 		}
 
-		add_named_color((uint8_t)r, (uint8_t)g, (uint8_t)b, name);
+		add_named_color((uint8_t)r, (uint8_t)g, (uint8_t)b, name, &capacity);
 	}
 
 	fclose(fp);
 
-	if (x11_named_color_count > 1) {
-		qsort(x11_named_colors, x11_named_color_count, sizeof(*x11_named_colors), compare_named_color);
+	finish_x11_named_colors();
+}
+
+/*
+ * The parsed rgb.txt table is process-wide: it is read once on the first
+ * named color lookup and reused by every later XPM load. Asynchronous
+ * loads may decode several XPMs at once, hence the once-guard.
+ */
+static void load_x11_named_colors(void) {
+#if WLF_HAS_LINUX_PLATFORM
+	pthread_once(&x11_named_colors_once, read_x11_named_colors);
+#else
+	if (x11_named_colors_loaded) {
+		return;
 	}
+	x11_named_colors_loaded = true;
+	read_x11_named_colors();
+#endif
 }
 
 static bool lookup_x11_named_color(const char *spec, uint8_t *r, uint8_t *g, uint8_t *b) {
@@ -317,42 +372,10 @@ static bool parse_named_color(const char *spec, uint8_t *r, uint8_t *g, uint8_t
 	return false;
 }
 
-static char *read_file_all(const char *filename, size_t *size_out) {
-	FILE *fp = fopen(filename, "rb");
-	if (fp == NULL) {
-		wlf_log_errno(WLF_ERROR, "Open %s failed", filename);
-		return NULL;
-	}
-	if (fseek(fp, 0, SEEK_END) != 0) {
-		fclose(fp);
-		return NULL;
-	}
-	long fsize = ftell(fp);
-	if (fsize < 0) {
-		fclose(fp);
-		return NULL;
-	}
-	rewind(fp);
-	char *buf = malloc((size_t)fsize + 1);
-	if (buf == NULL) {
-		wlf_log_errno(WLF_ERROR, "Failed to allocate file buf");
-		fclose(fp);
-		return NULL;
-	}
-	size_t n = fread(buf, 1, (size_t)fsize, fp);
-	fclose(fp);
-	if (n != (size_t)fsize) {
-		free(buf);
-		return NULL;
-	}
-	buf[n] = '\0';
-	if (size_out) {
-		*size_out = n;
-	}
-	return buf;
-}
-
-static char **extract_quoted_strings(const char *buf, size_t *count_out) {
+/* Collects at most max_count C string literals from buf, unescaping them. */
+static char **extract_quoted_strings(const char *buf, size_t size,
+		size_t max_count, size_t *count_out) {
+	const char *end = buf + size;
 	size_t cap = 64;
 	size_t count = 0;
 	char **arr = malloc(cap * sizeof(char *));
@@ -361,21 +384,21 @@ static char **extract_quoted_strings(const char *buf, size_t *count_out) {
 		return NULL;
 	}
 
-	for (const char *p = buf; *p != '\0'; p++) {
+	for (const char *p = buf; p < end && count < max_count; p++) {
 		if (*p != '"') {
 			continue;
 		}
 		p++;
 		const char *start = p;
 		size_t len = 0;
-		while (*p != '\0') {
+		while (p < end) {
 			if (*p == '"' && (p == start || p[-1] != '\\')) {
 				break;
 			}
 			p++;
 			len++;
 		}
-		if (*p != '"') {
+		if (p == end) {
 			break;
 		}
 
@@ -493,19 +516,115 @@ static bool parse_color_line(const char *line, int cpp, struct wlf_xpm_color *ou
 	return false;
 }
 
-static bool xpm_image_load(struct wlf_image *image, const char *filename, bool enable_16_bit) {
+/*
+ * Maps a cpp-character pixel key to its index in the color table. Keys of
+ * one or two characters index a flat array directly; longer keys go through
+ * an open-addressing hash table sized to a power of two at least twice the
+ * color count. Slots hold index + 1 so that zero marks an empty slot.
+ */
+struct xpm_color_table {
+	const struct wlf_xpm_color *colors;
+	int cpp;
+	uint32_t *slots;
+	size_t mask;
+};
+
+static size_t xpm_key_direct_index(const char *key, int cpp) {
+	size_t index = (unsigned char)key[0];
+	if (cpp == 2) {
+		index = (index << 8) | (unsigned char)key[1];
+	}
+	return index;
+}
+
+static size_t xpm_key_hash(const char *key, int cpp) {
+	return (size_t)wlf_hash_bytes(WLF_HASH_INIT, key, (size_t)cpp);
+}
+
+static bool xpm_color_table_init(struct xpm_color_table *table,
+		const struct wlf_xpm_color *colors, int color_count, int cpp) {
+	size_t slot_count;
+	if (cpp <= 2) {
+		slot_count = (size_t)1 << (8 * cpp);
+	} else {
+		slot_count = 16;
+		while (slot_count < (size_t)color_count * 2) {
+			slot_count *= 2;
+		}
+	}
+
+	*table = (struct xpm_color_table){
+		.colors = colors,
+		.cpp = cpp,
+		.slots = calloc(slot_count, sizeof(*table->slots)),
+		.mask = slot_count - 1,
+	};
+	if (table->slots == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate XPM color table");
+		return false;
+	}
+
+	/* Insert in order and never overwrite, so the first definition of a
+	 * duplicated key wins as it does in other XPM readers. */
+	for (int i = 0; i < color_count; i++) {
+		const char *key = colors[i].key;
+		if (cpp <= 2) {
+			uint32_t *slot = &table->slots[xpm_key_direct_index(key, cpp)];
+			if (*slot == 0) {
+				*slot = (uint32_t)i + 1;
+			}
+			continue;
+		}
+
+		size_t pos = xpm_key_hash(key, cpp) & table->mask;
+		while (table->slots[pos] != 0 &&
+				memcmp(colors[table->slots[pos] - 1].key, key, (size_t)cpp) != 0) {
+			pos = (pos + 1) & table->mask;
+		}
+		if (table->slots[pos] == 0) {
+			table->slots[pos] = (uint32_t)i + 1;
+		}
+	}
+
+	return true;
+}
+
+static void xpm_color_table_finish(struct xpm_color_table *table) {
+	free(table->slots);
+	table->slots = NULL;
+}
+
+static const struct wlf_xpm_color *xpm_color_table_find(
+		const struct xpm_color_table *table, const char *key) {
+	if (table->cpp <= 2) {
+		uint32_t slot = table->slots[xpm_key_direct_index(key, table->cpp)];
+		return slot != 0 ? &table->colors[slot - 1] : NULL;
+	}
+
+	size_t pos = xpm_key_hash(key, table->cpp) & table->mask;
+	while (table->slots[pos] != 0) {
+		const struct wlf_xpm_color *color = &table->colors[table->slots[pos] - 1];
+		if (memcmp(color->key, key, (size_t)table->cpp) == 0) {
+			return color;
+		}
+		pos = (pos + 1) & table->mask;
+	}
+
+	return NULL;
+}
+
+static bool xpm_image_load_source(struct wlf_image *image,
+		struct wlf_file_source *source, bool enable_16_bit) {
 	(void)enable_16_bit;
 
-	size_t file_size = 0;
-	char *buf = read_file_all(filename, &file_size);
-	if (buf == NULL || file_size == 0) {
-		free(buf);
+	if (source->size == 0) {
 		return false;
 	}
 
+	const char *filename = source->name;
 	size_t line_count = 0;
-	char **lines = extract_quoted_strings(buf, &line_count);
-	free(buf);
+	char **lines = extract_quoted_strings((const char *)source->data, source->size,
+		SIZE_MAX, &line_count);
 	if (lines == NULL || line_count == 0) {
 		free_string_list(lines, line_count);
 		wlf_log(WLF_ERROR, "Invalid XPM content: %s", filename);
@@ -555,11 +674,22 @@ static bool xpm_image_load(struct wlf_image *image, const char *filename, bool e
 		}
 	}
 
+	struct xpm_color_table table;
+	if (!xpm_color_table_init(&table, colors, color_count, cpp)) {
+		for (int i = 0; i < color_count; i++) {
+			free(colors[i].key);
+		}
+		free(colors);
+		free_string_list(lines, line_count);
+		return false;
+	}
+
 	int channels = has_alpha ? 4 : 3;
 	size_t data_size = (size_t)width * height * channels;
 	unsigned char *data = malloc(data_size);
 	if (data == NULL) {
 		wlf_log_errno(WLF_ERROR, "Failed to allocate unsigned char");
+		xpm_color_table_finish(&table);
 		for (int i = 0; i < color_count; i++) {
 			free(colors[i].key);
 		}
@@ -572,6 +702,7 @@ static bool xpm_image_load(struct wlf_image *image, const char *filename, bool e
 		const char *px = lines[1 + color_count + y];
 		if (strlen(px) < (size_t)width * (size_t)cpp) {
 			free(data);
+			xpm_color_table_finish(&table);
 			for (int i = 0; i < color_count; i++) {
 				free(colors[i].key);
 			}
@@ -582,16 +713,11 @@ static bool xpm_image_load(struct wlf_image *image, const char *filename, bool e
 		}
 
 		for (int x = 0; x < width; x++) {
-			const char *key = px + x * cpp;
-			int found = -1;
-			for (int c = 0; c < color_count; c++) {
-				if (strncmp(colors[c].key, key, (size_t)cpp) == 0) {
-					found = c;
-					break;
-				}
-			}
-			if (found < 0) {
+			const struct wlf_xpm_color *color =
+				xpm_color_table_find(&table, px + (size_t)x * cpp);
+			if (color == NULL) {
 				free(data);
+				xpm_color_table_finish(&table);
 				for (int i = 0; i < color_count; i++) {
 					free(colors[i].key);
 				}
@@ -602,15 +728,16 @@ static bool xpm_image_load(struct wlf_image *image, const char *filename, bool e
 			}
 
 			size_t off = ((size_t)y * (size_t)width + (size_t)x) * (size_t)channels;
-			data[off + 0] = colors[found].r;
-			data[off + 1] = colors[found].g;
-			data[off + 2] = colors[found].b;
+			data[off + 0] = color->r;
+			data[off + 1] = color->g;
+			data[off + 2] = color->b;
 			if (channels == 4) {
-				data[off + 3] = colors[found].a;
+				data[off + 3] = color->a;
 			}
 		}
 	}
 
+	xpm_color_table_finish(&table);
 	for (int i = 0; i < color_count; i++) {
 		free(colors[i].key);
 	}
@@ -858,7 +985,8 @@ static void xpm_image_destroy(struct wlf_image *wlf_image) {
 
 static const struct wlf_image_impl xpm_image_impl = {
 	.save = xpm_image_save,
-	.load = xpm_image_load,
+	.load = wlf_image_load_source_file,
+	.load_source = xpm_image_load_source,
 	.destroy = xpm_image_destroy,
 };
 
@@ -884,3 +1012,58 @@ struct wlf_xpm_image *wlf_xpm_image_from_image(struct wlf_image *wlf_image) {
 
 	return image;
 }
+
+bool wlf_xpm_image_probe(struct wlf_file_source *source,
+		struct wlf_image_info *info) {
+	if (source->size == 0) {
+		return false;
+	}
+
+	/* Only the values line and the color table are needed; the pixel rows
+	 * are never extracted. */
+	int width = 0;
+	int height = 0;
+	int color_count = 0;
+	int cpp = 0;
+	size_t line_count = 0;
+	char **lines = extract_quoted_strings((const char *)source->data, source->size,
+		1, &line_count);
+	bool ok = lines != NULL && line_count == 1 &&
+		sscanf(lines[0], "%d %d %d %d", &width, &height, &color_count, &cpp) == 4 &&
+		width > 0 && height > 0 && color_count > 0 && cpp > 0;
+	free_string_list(lines, line_count);
+	if (!ok) {
+		return false;
+	}
+
+	lines = extract_quoted_strings((const char *)source->data, source->size,
+		1 + (size_t)color_count, &line_count);
+	if (lines == NULL || line_count != 1 + (size_t)color_count) {
+		free_string_list(lines, line_count);
+		return false;
+	}
+
+	bool has_alpha = false;
+	for (int i = 0; i < color_count; i++) {
+		struct wlf_xpm_color color;
+		if (!parse_color_line(lines[1 + i], cpp, &color)) {
+			free_string_list(lines, line_count);
+			return false;
+		}
+		free(color.key);
+		if (color.a < 255) {
+			has_alpha = true;
+		}
+	}
+	free_string_list(lines, line_count);
+
+	info->type = WLF_IMAGE_TYPE_XPM;
+	info->width = (uint32_t)width;
+	info->height = (uint32_t)height;
+	info->format = has_alpha ? WLF_COLOR_TYPE_RGBA : WLF_COLOR_TYPE_RGB;
+	info->bit_depth = WLF_IMAGE_BIT_DEPTH_8;
+	info->has_alpha_channel = has_alpha;
+	info->is_animated = false;
+
+	return true;
+}
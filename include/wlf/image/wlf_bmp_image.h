@@ -69,6 +69,15 @@ bool wlf_image_is_bmp(const struct wlf_image *image);
  */
 struct wlf_bmp_image *wlf_bmp_image_from_image(struct wlf_image *wlf_image);
 
+/**
+ * @brief Read the properties of BMP data from its header.
+ * @param source Encoded image bytes; the cursor may be moved.
+ * @param info Receives the image properties.
+ * @return true if the header is a valid BMP header, false otherwise.
+ */
+bool wlf_bmp_image_probe(struct wlf_file_source *source,
+	struct wlf_image_info *info);
+
 /**
  * @brief Set the BMP compression type for the image.
  * @param image Pointer to the wlf_bmp_image structure.
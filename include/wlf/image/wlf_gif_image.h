@@ -11,25 +11,38 @@
  * @par Copyright(c):
  * @par History:
  *      version: v1.0, YaoBing Xiao, 2026-08-09, initial version\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, decode streamed frames from the encoded data\n
  */
 
 #ifndef IMAGE_WLF_GIF_IMAGE_H
 #define IMAGE_WLF_GIF_IMAGE_H
 
 #include "wlf/image/wlf_image.h"
+#include "wlf/math/wlf_rect.h"
+
+struct wlf_gif_stream;
 
 /**
  * @brief One decoded GIF frame as a full-canvas RGBA image.
  */
 struct wlf_gif_frame {
-	unsigned char *pixels;  /**< RGBA pixels, size = width * height * 4 */
+	unsigned char *pixels;  /**< RGBA pixels, size = width * height * 4; NULL while streaming */
 	uint32_t width;         /**< Frame canvas width in pixels */
 	uint32_t height;        /**< Frame canvas height in pixels */
 	uint32_t stride;        /**< Bytes per row (usually width * 4) */
 	uint32_t delay_ms;      /**< Frame delay in milliseconds */
+	uint32_t timestamp_ms;  /**< Frame start time relative to the first frame */
 	uint8_t disposal_method;/**< GIF disposal method (0..3) */
 };
 
+/**
+ * @brief Options for streaming GIF decoding.
+ */
+struct wlf_gif_stream_options {
+	uint32_t keyframe_interval; /**< Frames between cached seek points, 0 for the default */
+	uint32_t max_keyframes;     /**< Maximum number of cached canvases, 0 for the default */
+};
+
 /**
  * @brief GIF image structure, extending wlf_image with animation metadata.
  */
@@ -38,7 +51,9 @@ struct wlf_gif_image {
 	uint32_t loop_count;            /**< Animation loop count (0 means infinite) */
 	uint32_t delay_ms;              /**< First frame delay time in milliseconds */
 	uint32_t frame_count;           /**< Number of frames */
+	uint32_t current_frame;         /**< Index of the frame currently in base.data */
 	struct wlf_gif_frame *frames;   /**< Optional frame array for animation */
+	struct wlf_gif_stream *stream;  /**< Streaming decoder state, may be NULL */
 };
 
 /**
@@ -61,4 +76,97 @@ bool wlf_image_is_gif(const struct wlf_image *image);
  */
 struct wlf_gif_image *wlf_gif_image_from_image(struct wlf_image *wlf_image);
 
+/**
+ * @brief Read the properties of GIF data from its header.
+ * @param source Encoded image bytes; the cursor may be moved.
+ * @param info Receives the image properties.
+ * @return true if the header is a valid GIF header, false otherwise.
+ */
+bool wlf_gif_image_probe(struct wlf_file_source *source,
+	struct wlf_image_info *info);
+
+/**
+ * @brief Load a GIF in streaming mode.
+ * @details Instead of compositing every frame up front, the encoded data is
+ *          kept together with the position of each frame, and a frame is
+ *          decompressed when it is composited onto a single RGBA canvas as
+ *          playback advances. Memory use is the encoded size plus a few
+ *          canvases, independent of the frame count. A small cache of
+ *          canvas snapshots bounds the cost of seeking backwards.
+ *
+ *          After loading, base.data points at the canvas of frame 0 and
+ *          frames[i].pixels is NULL for every frame. base.data is only valid
+ *          until the next call to wlf_gif_image_next_frame() or
+ *          wlf_gif_image_seek_frame().
+ * @param image GIF image created by wlf_gif_image_create().
+ * @param filename Path to the GIF file.
+ * @param options Streaming options, or NULL for the defaults.
+ * @return true on success, false on failure.
+ */
+bool wlf_gif_image_load_streaming(struct wlf_gif_image *image,
+	const char *filename, const struct wlf_gif_stream_options *options);
+
+/**
+ * @brief Load a GIF from encoded bytes in memory in streaming mode.
+ * @details Behaves like wlf_gif_image_load_streaming(). Frames are decoded
+ *          from @p data whenever they are shown, so the buffer is borrowed,
+ *          not copied.
+ * @param image GIF image created by wlf_gif_image_create().
+ * @param data Encoded GIF bytes. They must stay valid and unchanged until
+ *        @p image is destroyed.
+ * @param size Number of bytes at @p data.
+ * @param options Streaming options, or NULL for the defaults.
+ * @return true on success, false on failure.
+ */
+bool wlf_gif_image_load_streaming_from_memory(struct wlf_gif_image *image,
+	const void *data, size_t size, const struct wlf_gif_stream_options *options);
+
+/**
+ * @brief Check if a GIF image decodes its frames on demand.
+ * @param image GIF image to check.
+ * @return true if the image was loaded by wlf_gif_image_load_streaming() or
+ *         wlf_gif_image_load_streaming_from_memory().
+ */
+bool wlf_gif_image_is_streaming(const struct wlf_gif_image *image);
+
+/**
+ * @brief Advance to the next frame, wrapping to frame 0 after the last one.
+ * @details Works for both fully decoded and streaming images; base.data is
+ *          updated to point at the new frame.
+ * @param image GIF image to advance.
+ * @param damage Receives the canvas rectangle that changed, may be NULL.
+ * @return true on success, false on failure.
+ */
+bool wlf_gif_image_next_frame(struct wlf_gif_image *image,
+	struct wlf_rect *damage);
+
+/**
+ * @brief Make a specific frame current.
+ * @details Streaming images resume from the closest cached canvas at or
+ *          before @p index, so seeking backwards does not always restart
+ *          from frame 0.
+ * @param image GIF image to seek.
+ * @param index Frame index, must be lower than frame_count.
+ * @param damage Receives the canvas rectangle that changed, may be NULL.
+ * @return true on success, false on failure.
+ */
+bool wlf_gif_image_seek_frame(struct wlf_gif_image *image, uint32_t index,
+	struct wlf_rect *damage);
+
+/**
+ * @brief Find the frame shown at a given playback time.
+ * @param image GIF image to query.
+ * @param time_ms Time since the start of the current loop, in milliseconds.
+ * @return Frame index, or frame_count - 1 past the end of the animation.
+ */
+uint32_t wlf_gif_image_frame_at_time(const struct wlf_gif_image *image,
+	uint64_t time_ms);
+
+/**
+ * @brief Get the total duration of one animation loop.
+ * @param image GIF image to query.
+ * @return Sum of all frame delays in milliseconds.
+ */
+uint64_t wlf_gif_image_get_duration(const struct wlf_gif_image *image);
+
 #endif // IMAGE_WLF_GIF_IMAGE_H
@@ -17,6 +17,7 @@
  * @par Copyright:
  * @par History:
  *      version: v1.0, YaoBing Xiao, 2025-06-08, initial version\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, decode from a shared wlf_file_source\n
  */
 
 #ifndef IMAGE_WLF_IMAGE_H
@@ -24,8 +25,10 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 struct wlf_image;
+struct wlf_file_source;
 
 /**
  * @brief Supported image types.
@@ -55,6 +58,19 @@ struct wlf_image_type_map {
 struct wlf_image_impl {
 	bool (*save)(struct wlf_image *image, const char *filename);
 	bool (*load)(struct wlf_image *image, const char *filename, bool enable_16_bit);
+	/**
+	 * Decodes from encoded bytes in memory. The source cursor starts at
+	 * offset 0 and the bytes are only valid during the call.
+	 */
+	bool (*load_source)(struct wlf_image *image, struct wlf_file_source *source,
+		bool enable_16_bit);
+	/**
+	 * Optional reduced-size decode. Implementations return the smallest
+	 * image the codec can produce natively that still covers the target
+	 * size; a zero target dimension is unconstrained.
+	 */
+	bool (*load_at_size)(struct wlf_image *image, struct wlf_file_source *source,
+		uint32_t target_width, uint32_t target_height);
 	void (*destroy)(struct wlf_image *image);
 };
 
@@ -112,6 +128,21 @@ struct wlf_image {
 	bool is_opaque;         /**< True if image is fully opaque */
 };
 
+/**
+ * @brief Image properties read from the file header, without decoding pixels.
+ * @details The fields describe the image wlf_image_load() would return, e.g.
+ *          a palette PNG with transparency reports RGBA.
+ */
+struct wlf_image_info {
+	enum wlf_image_type type;           /**< Detected file type */
+	uint32_t width;                     /**< Width in pixels */
+	uint32_t height;                    /**< Height in pixels */
+	enum wlf_image_format format;       /**< Decoded pixel format */
+	enum wlf_image_bit_depth bit_depth; /**< Decoded bit depth per channel */
+	bool has_alpha_channel;             /**< True if decoded pixels carry alpha */
+	bool is_animated;                   /**< True for multi-frame GIF and WebP */
+};
+
 /**
  * @brief Initialize a wlf_image structure.
  * @param image Pointer to the image structure.
@@ -129,6 +160,18 @@ void wlf_image_init(struct wlf_image *image,
  */
 void wlf_image_finish(struct wlf_image *image);
 
+/**
+ * @brief Load a file through an image's @ref wlf_image_impl.load_source hook.
+ * @details Decoders that decode from a wlf_file_source use this as their
+ *          filename-based @ref wlf_image_impl.load implementation.
+ * @param image Image to populate.
+ * @param filename Path of the file to load.
+ * @param enable_16_bit Whether 16-bit samples should be preserved.
+ * @return true on success, false on failure.
+ */
+bool wlf_image_load_source_file(struct wlf_image *image, const char *filename,
+	bool enable_16_bit);
+
 /**
  * @brief Get image type from string.
  * @param str String representation of image type.
@@ -165,4 +208,74 @@ bool wlf_image_save(struct wlf_image *image, const char *filename);
  */
 struct wlf_image *wlf_image_load(const char *filename);
 
+/**
+ * @brief Load an image from a file for display at a reduced size.
+ * @param filename Path to the image file to load.
+ * @param target_width Width the image will be displayed at, or 0 for any.
+ * @param target_height Height the image will be displayed at, or 0 for any.
+ * @return Pointer to a newly allocated wlf_image structure, or NULL on failure.
+ * @note Formats whose codec can decode at a fraction of the full size (JPEG
+ *       at 1/2, 1/4 or 1/8) return the smallest such image that is still at
+ *       least the target size, saving decode time and memory. The result is
+ *       not resampled to the exact target size, and formats without native
+ *       reduction are loaded at full size.
+ */
+struct wlf_image *wlf_image_load_at_size(const char *filename,
+	uint32_t target_width, uint32_t target_height);
+
+/**
+ * @brief Load an image from encoded bytes in memory.
+ * @param data Encoded image bytes, e.g. an embedded resource.
+ * @param size Number of bytes at @p data.
+ * @param type Format of the encoded bytes, or WLF_IMAGE_TYPE_UNKNOWN to
+ *        detect it from the content.
+ * @return Pointer to a newly allocated wlf_image structure, or NULL on failure.
+ * @note @p data is only read during the call and may be released afterwards.
+ */
+struct wlf_image *wlf_image_load_from_memory(const void *data, size_t size,
+	enum wlf_image_type type);
+
+/**
+ * @brief Load an in-memory image for display at a given size.
+ * @param data Encoded image bytes.
+ * @param size Number of bytes at @p data.
+ * @param type Format of the encoded bytes, or WLF_IMAGE_TYPE_UNKNOWN.
+ * @param target_width Display width in pixels, or 0.
+ * @param target_height Display height in pixels, or 0.
+ * @return Pointer to a newly allocated wlf_image structure, or NULL on failure.
+ * @see wlf_image_load_at_size()
+ */
+struct wlf_image *wlf_image_load_from_memory_at_size(const void *data,
+	size_t size, enum wlf_image_type type,
+	uint32_t target_width, uint32_t target_height);
+
+/**
+ * @brief Detect an image type from the leading bytes of its content.
+ * @param data Start of the encoded image.
+ * @param size Number of bytes available at @p data; 32 are enough for
+ *        every supported format.
+ * @return Detected type, or WLF_IMAGE_TYPE_UNKNOWN.
+ */
+enum wlf_image_type wlf_image_type_sniff(const void *data, size_t size);
+
+/**
+ * @brief Read the size and format of an image file without decoding it.
+ * @param filename Path to the image file.
+ * @param info Receives the image properties.
+ * @return true on success, false if the file is unreadable or unsupported.
+ * @note Only the header is parsed, which makes this suitable for laying out
+ *       many images before any of them is decoded.
+ */
+bool wlf_image_probe(const char *filename, struct wlf_image_info *info);
+
+/**
+ * @brief Read the size and format of an in-memory image without decoding it.
+ * @param data Encoded image bytes.
+ * @param size Number of bytes at @p data.
+ * @param info Receives the image properties.
+ * @return true on success, false if the content is unsupported.
+ */
+bool wlf_image_probe_from_memory(const void *data, size_t size,
+	struct wlf_image_info *info);
+
 #endif // IMAGE_WLF_IMAGE_H
@@ -0,0 +1,165 @@
+/**
+ * @file        wlf_image_cache.h
+ * @brief       Shared cache of decoded images and their textures.
+ * @details     A wlf_image_cache keeps decoded images keyed by file path (or
+ *              by a hash of in-memory content) together with the requested
+ *              target size and output scale, so that icons and other images
+ *              used by many nodes are decoded once. Each entry also keeps one
+ *              texture per renderer, uploaded on first use.
+ *
+ *              Entries are reference counted. Entries nobody references stay
+ *              resident on an LRU list and are evicted, least recently used
+ *              first, once the bytes held by the cache exceed its budget.
+ *              Referenced entries are never evicted, even over budget.
+ *
+ *              Typical usage:
+ *                  - Look up an image with wlf_image_cache_load().
+ *                  - Draw it with wlf_image_cache_entry_get_texture(), or pass
+ *                    the entry to wlf_texture_node_create_from_cache().
+ *                  - Drop the reference with wlf_image_cache_entry_unref().
+ *
+ * @note        A cache is not thread-safe; use it from the event loop thread.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ */
+
+#ifndef IMAGE_WLF_IMAGE_CACHE_H
+#define IMAGE_WLF_IMAGE_CACHE_H
+
+#include "wlf/image/wlf_image.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Byte budget of the process-wide cache returned by wlf_image_cache_get_default(). */
+#define WLF_IMAGE_CACHE_DEFAULT_BUDGET (64u * 1024u * 1024u)
+
+struct wlf_renderer;
+struct wlf_texture;
+struct wlf_image_cache;
+struct wlf_image_cache_entry;
+
+/**
+ * @brief Cache counters, see wlf_image_cache_get_stats().
+ */
+struct wlf_image_cache_stats {
+	uint64_t hits;            /**< Lookups served from the cache */
+	uint64_t misses;          /**< Lookups that had to decode */
+	uint64_t evictions;       /**< Entries dropped to stay within budget */
+	double hit_rate;          /**< hits / (hits + misses), 0 before any lookup */
+	size_t bytes_resident;    /**< Pixel bytes of all images and textures held */
+	size_t byte_budget;       /**< Current budget */
+	uint32_t entry_count;     /**< Entries resident, referenced or not */
+};
+
+/**
+ * @brief Creates an image cache.
+ * @param byte_budget Maximum bytes kept for unreferenced entries. Image data
+ *        counts stride × height, textures width × height × 4.
+ * @return New cache, or NULL on allocation failure.
+ */
+struct wlf_image_cache *wlf_image_cache_create(size_t byte_budget);
+
+/**
+ * @brief Destroys a cache.
+ * @details Unreferenced entries are released immediately. Entries still
+ *          referenced stay valid and are released by their last unref.
+ * @param cache Cache to destroy, may be NULL.
+ */
+void wlf_image_cache_destroy(struct wlf_image_cache *cache);
+
+/**
+ * @brief Returns the process-wide cache, creating it on first use.
+ * @details Its budget starts at @ref WLF_IMAGE_CACHE_DEFAULT_BUDGET.
+ * @return The shared cache, or NULL on allocation failure.
+ */
+struct wlf_image_cache *wlf_image_cache_get_default(void);
+
+/**
+ * @brief Changes the byte budget, evicting entries if needed.
+ * @param cache Cache to update.
+ * @param byte_budget New budget; 0 keeps only referenced entries.
+ */
+void wlf_image_cache_set_budget(struct wlf_image_cache *cache, size_t byte_budget);
+
+/**
+ * @brief Looks up or decodes an image file.
+ * @param cache Cache to use.
+ * @param filename Path of the image file. Files are assumed not to change
+ *        while cached.
+ * @param target_width Logical display width, or 0 for the full image.
+ * @param target_height Logical display height, or 0 for the full image.
+ * @param scale Output scale; the image is decoded for target × scale pixels.
+ * @return Referenced entry, or NULL if the file cannot be loaded.
+ * @see wlf_image_load_at_size() for the meaning of the target size.
+ */
+struct wlf_image_cache_entry *wlf_image_cache_load(struct wlf_image_cache *cache,
+	const char *filename, uint32_t target_width, uint32_t target_height,
+	float scale);
+
+/**
+ * @brief Looks up or decodes an in-memory image.
+ * @details The entry is keyed by a hash of the content and its size, so
+ *          identical embedded resources share one decode.
+ * @param cache Cache to use.
+ * @param data Encoded image bytes; only read during the call.
+ * @param size Number of bytes at @p data.
+ * @param target_width Logical display width, or 0 for the full image.
+ * @param target_height Logical display height, or 0 for the full image.
+ * @param scale Output scale; the image is decoded for target × scale pixels.
+ * @return Referenced entry, or NULL if the content cannot be decoded.
+ */
+struct wlf_image_cache_entry *wlf_image_cache_load_from_memory(
+	struct wlf_image_cache *cache, const void *data, size_t size,
+	uint32_t target_width, uint32_t target_height, float scale);
+
+/**
+ * @brief Reads the cache counters.
+ * @param cache Cache to query.
+ * @param stats Receives the counters.
+ */
+void wlf_image_cache_get_stats(const struct wlf_image_cache *cache,
+	struct wlf_image_cache_stats *stats);
+
+/**
+ * @brief Takes an additional reference to an entry.
+ * @param entry Entry to reference.
+ * @return @p entry.
+ */
+struct wlf_image_cache_entry *wlf_image_cache_entry_ref(
+	struct wlf_image_cache_entry *entry);
+
+/**
+ * @brief Drops a reference to an entry.
+ * @details The entry stays cached and becomes eligible for eviction once the
+ *          last reference is gone.
+ * @param entry Entry to release, may be NULL.
+ */
+void wlf_image_cache_entry_unref(struct wlf_image_cache_entry *entry);
+
+/**
+ * @brief Returns the decoded image of an entry.
+ * @param entry Referenced entry.
+ * @return Image owned by the entry; it must not be modified or freed.
+ */
+const struct wlf_image *wlf_image_cache_entry_get_image(
+	const struct wlf_image_cache_entry *entry);
+
+/**
+ * @brief Returns the entry's texture for a renderer, uploading it on first use.
+ * @details The texture is shared by every user of the entry on @p renderer.
+ *          It is owned by the entry and released when the entry is evicted or
+ *          the renderer is destroyed.
+ * @param entry Referenced entry.
+ * @param renderer Renderer to get the texture for.
+ * @return Texture owned by the entry, or NULL if the upload failed.
+ */
+struct wlf_texture *wlf_image_cache_entry_get_texture(
+	struct wlf_image_cache_entry *entry, struct wlf_renderer *renderer);
+
+#endif // IMAGE_WLF_IMAGE_CACHE_H
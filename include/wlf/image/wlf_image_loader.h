@@ -0,0 +1,109 @@
+/**
+ * @file        wlf_image_loader.h
+ * @brief       Asynchronous image loading for wlframe.
+ * @details     A wlf_image_loader decodes images on a small pool of worker
+ *              threads so that opening many files does not block the UI.
+ *              Finished images are handed back with wlf_backend_post(), so
+ *              completion callbacks run on the thread running
+ *              wlf_backend_exe(), where textures can be created from them.
+ *
+ *              Pending requests are decoded highest priority first and can
+ *              be re-prioritized or cancelled, e.g. when items scroll into
+ *              or out of view.
+ *
+ *              Typical usage:
+ *                  - Create a loader with wlf_image_loader_create().
+ *                  - Queue files with wlf_image_loader_load().
+ *                  - Upload the image to a texture in the completion callback.
+ *                  - Destroy the loader with wlf_image_loader_destroy().
+ *
+ * @note        Only available on Linux.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, deliver completions through backend tasks\n
+ */
+
+#ifndef IMAGE_WLF_IMAGE_LOADER_H
+#define IMAGE_WLF_IMAGE_LOADER_H
+
+#include "wlf/image/wlf_image.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct wlf_backend;
+struct wlf_image_loader;
+struct wlf_image_load_request;
+
+/**
+ * @brief Completion callback of an asynchronous load.
+ * @param request Finished request. It is freed when the callback returns.
+ * @param image Decoded image, or NULL when decoding failed. Ownership passes
+ *        to the callback, which releases it with wlf_image_finish() and free().
+ * @param data User data given to wlf_image_loader_load().
+ */
+typedef void (*wlf_image_load_done_t)(struct wlf_image_load_request *request,
+	struct wlf_image *image, void *data);
+
+/**
+ * @brief Creates an asynchronous image loader.
+ * @param backend Backend whose event loop delivers completions.
+ * @param thread_count Number of decoding threads, or 0 to use the number of
+ *        online CPUs capped at 4.
+ * @return New loader, or NULL on failure.
+ */
+struct wlf_image_loader *wlf_image_loader_create(struct wlf_backend *backend,
+	uint32_t thread_count);
+
+/**
+ * @brief Destroys a loader.
+ * @details Pending requests are dropped without invoking their callbacks.
+ *          Decodes already running are waited for and their results
+ *          discarded. May be called from a completion callback.
+ * @param loader Loader to destroy, may be NULL.
+ */
+void wlf_image_loader_destroy(struct wlf_image_loader *loader);
+
+/**
+ * @brief Queues a file for decoding.
+ * @param loader Loader to use.
+ * @param filename Path of the image file; it is copied.
+ * @param target_width Display width for reduced-size decoding, or 0.
+ * @param target_height Display height for reduced-size decoding, or 0.
+ * @param priority Scheduling priority; higher values decode first, equal
+ *        priorities in submission order.
+ * @param done Completion callback, invoked once on the event loop thread
+ *        unless the request is cancelled.
+ * @param data User data passed to @p done.
+ * @return Request handle, valid until @p done returns or the request is
+ *         cancelled, or NULL on failure.
+ * @see wlf_image_load_at_size() for the meaning of the target size.
+ */
+struct wlf_image_load_request *wlf_image_loader_load(
+	struct wlf_image_loader *loader, const char *filename,
+	uint32_t target_width, uint32_t target_height, int32_t priority,
+	wlf_image_load_done_t done, void *data);
+
+/**
+ * @brief Changes the priority of a request.
+ * @details Only affects requests still waiting for a worker.
+ * @param request Request to update.
+ * @param priority New scheduling priority.
+ */
+void wlf_image_load_request_set_priority(struct wlf_image_load_request *request,
+	int32_t priority);
+
+/**
+ * @brief Cancels a request.
+ * @details The completion callback is not invoked and @p request becomes
+ *          invalid. A request that is already being decoded finishes in the
+ *          background and its image is discarded.
+ * @param request Request to cancel.
+ */
+void wlf_image_load_request_cancel(struct wlf_image_load_request *request);
+
+#endif // IMAGE_WLF_IMAGE_LOADER_H
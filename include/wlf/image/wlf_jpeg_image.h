@@ -77,6 +77,7 @@ struct wlf_jpeg_image {
 	enum wlf_jpeg_colorspace colorspace;    /**< JPEG colorspace */
 	struct wlf_jpeg_options options;        /**< JPEG compression options */
 	bool is_progressive;                    /**< True if image uses progressive encoding */
+	uint32_t scale_denom;                   /**< DCT reduction applied when decoding (1, 2, 4 or 8) */
 };
 
 /**
@@ -99,6 +100,15 @@ struct wlf_jpeg_image *wlf_jpeg_image_create_with_options(const struct wlf_jpeg_
  */
 struct wlf_jpeg_image *wlf_jpeg_image_from_image(struct wlf_image *wlf_image);
 
+/**
+ * @brief Read the properties of JPEG data from its header.
+ * @param source Encoded image bytes; the cursor may be moved.
+ * @param info Receives the image properties.
+ * @return true if the header is a valid JPEG header, false otherwise.
+ */
+bool wlf_jpeg_image_probe(struct wlf_file_source *source,
+	struct wlf_image_info *info);
+
 /**
  * @brief Check if a wlf_image is a JPEG image.
  * @param image Pointer to the wlf_image structure to check.
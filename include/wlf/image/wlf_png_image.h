@@ -63,6 +63,15 @@ bool wlf_image_is_png(const struct wlf_image *image);
  */
 struct wlf_png_image *wlf_png_image_from_image(struct wlf_image *wlf_image);
 
+/**
+ * @brief Read the properties of PNG data from its header.
+ * @param source Encoded image bytes; the cursor may be moved.
+ * @param info Receives the image properties.
+ * @return true if the header is a valid PNG header, false otherwise.
+ */
+bool wlf_png_image_probe(struct wlf_file_source *source,
+	struct wlf_image_info *info);
+
 /**
  * @brief Print the raw pixel data of a PNG image for debugging.
  * @param png_image Pointer to the wlf_image structure (should be PNG).
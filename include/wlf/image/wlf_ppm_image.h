@@ -64,6 +64,15 @@ bool wlf_image_is_ppm(const struct wlf_image *image);
  */
 struct wlf_ppm_image *wlf_ppm_image_from_image(struct wlf_image *wlf_image);
 
+/**
+ * @brief Read the properties of PPM data from its header.
+ * @param source Encoded image bytes; the cursor may be moved.
+ * @param info Receives the image properties.
+ * @return true if the header is a valid PPM header, false otherwise.
+ */
+bool wlf_ppm_image_probe(struct wlf_file_source *source,
+	struct wlf_image_info *info);
+
 /**
  * @brief Set the PPM format for the image.
  * @param image Pointer to the wlf_ppm_image structure.
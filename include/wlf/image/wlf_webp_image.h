@@ -78,6 +78,15 @@ bool wlf_image_is_webp(const struct wlf_image *image);
  */
 struct wlf_webp_image *wlf_webp_image_from_image(struct wlf_image *wlf_image);
 
+/**
+ * @brief Read the properties of WebP data from its header.
+ * @param source Encoded image bytes; the cursor may be moved.
+ * @param info Receives the image properties.
+ * @return true if the header is a valid WebP header, false otherwise.
+ */
+bool wlf_webp_image_probe(struct wlf_file_source *source,
+	struct wlf_image_info *info);
+
 /**
  * @brief Check whether a file is a WebP image by its content/signature.
  * @param file_name Path to the file.
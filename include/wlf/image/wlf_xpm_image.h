@@ -51,4 +51,13 @@ bool wlf_image_is_xpm(const struct wlf_image *image);
  */
 struct wlf_xpm_image *wlf_xpm_image_from_image(struct wlf_image *wlf_image);
 
+/**
+ * @brief Read the properties of XPM data from its header.
+ * @param source Encoded image bytes; the cursor may be moved.
+ * @param info Receives the image properties.
+ * @return true if the header is a valid XPM header, false otherwise.
+ */
+bool wlf_xpm_image_probe(struct wlf_file_source *source,
+	struct wlf_image_info *info);
+
 #endif // IMAGE_WLF_XPM_IMAGE_H
@@ -0,0 +1,27 @@
+/**
+ * @file        text_pass.h
+ * @brief       Pixman glyph-atlas text rendering pass.
+ * @details     Declares the Pixman implementation of the generic text pass.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ */
+
+#ifndef PASS_PIXMAN_TEXT_PASS_H
+#define PASS_PIXMAN_TEXT_PASS_H
+
+#include "wlf/pass/wlf_text_pass.h"
+
+/**
+ * @brief Creates a Pixman-backed text pass.
+ *
+ * The glyph atlas is attached by wlf_text_pass_auto_create().
+ *
+ * @return Text pass, or NULL when the pass cannot be created.
+ */
+struct wlf_text_pass *wlf_pixman_text_pass_create(void);
+
+#endif // PASS_PIXMAN_TEXT_PASS_H
@@ -0,0 +1,128 @@
+/**
+ * @file        wlf_glyph_atlas.h
+ * @brief       Shared 8-bit coverage atlas of rasterized glyphs.
+ * @details     A glyph atlas packs glyph coverage masks into one A8 image so
+ *              that every glyph is rasterized once and text is drawn as
+ *              textured quads sampling the atlas. Glyphs are keyed by font,
+ *              glyph index and horizontal subpixel offset; the font identifier
+ *              already encodes the face, size and raster scale.
+ *
+ *              Masks are packed on shelves. When the atlas is full it is
+ *              cleared and its generation changes, so users holding atlas
+ *              rectangles know they have to look their glyphs up again.
+ *
+ * @note        An atlas is not thread-safe; use it from the event loop thread.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ */
+
+#ifndef PASS_WLF_GLYPH_ATLAS_H
+#define PASS_WLF_GLYPH_ATLAS_H
+
+#include "wlf/math/wlf_rect.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Number of horizontal subpixel positions a glyph is rasterized at. */
+#define WLF_GLYPH_ATLAS_SUBPIXEL_STEPS 4
+
+struct wlf_glyph_atlas;
+
+/**
+ * @brief Lookup key of a glyph mask.
+ */
+struct wlf_glyph_key {
+	uint32_t font; /**< Text implementation font identifier. */
+	uint32_t index; /**< Glyph index within the font. */
+	uint32_t subpixel; /**< Subpixel step, below @ref WLF_GLYPH_ATLAS_SUBPIXEL_STEPS. */
+};
+
+/**
+ * @brief Glyph mask stored in an atlas.
+ */
+struct wlf_glyph_atlas_entry {
+	struct wlf_glyph_key key; /**< Lookup key. */
+	struct wlf_rect box; /**< Mask location in the atlas, empty for glyphs without ink. */
+	int32_t left; /**< Mask offset from the pen position. */
+	int32_t top; /**< Mask offset from the baseline. */
+};
+
+/**
+ * @brief Creates an empty atlas.
+ * @param width Atlas width in pixels, a multiple of 4.
+ * @param height Atlas height in pixels.
+ * @return New atlas, or NULL on allocation failure.
+ */
+struct wlf_glyph_atlas *wlf_glyph_atlas_create(uint32_t width, uint32_t height);
+
+/**
+ * @brief Destroys an atlas.
+ * @param atlas Atlas to destroy, may be NULL.
+ */
+void wlf_glyph_atlas_destroy(struct wlf_glyph_atlas *atlas);
+
+/**
+ * @brief Looks a glyph up.
+ * @param atlas Atlas to search.
+ * @param key Glyph key.
+ * @return Entry valid until the next wlf_glyph_atlas_add(), or NULL on a miss.
+ */
+const struct wlf_glyph_atlas_entry *wlf_glyph_atlas_get(
+	const struct wlf_glyph_atlas *atlas, const struct wlf_glyph_key *key);
+
+/**
+ * @brief Stores a glyph mask.
+ * @details If the mask does not fit, the atlas is cleared first and its
+ *          generation changes.
+ * @param atlas Atlas to update.
+ * @param key Glyph key, not already present.
+ * @param left Mask offset from the pen position.
+ * @param top Mask offset from the baseline.
+ * @param width Mask width in pixels, 0 for glyphs without ink.
+ * @param height Mask height in pixels, 0 for glyphs without ink.
+ * @param stride Mask row stride in bytes.
+ * @param data 8-bit coverage of the mask.
+ * @return Entry valid until the next wlf_glyph_atlas_add(), or NULL when the
+ *         mask is larger than the atlas or on allocation failure.
+ */
+const struct wlf_glyph_atlas_entry *wlf_glyph_atlas_add(
+	struct wlf_glyph_atlas *atlas, const struct wlf_glyph_key *key,
+	int32_t left, int32_t top, uint32_t width, uint32_t height,
+	uint32_t stride, const uint8_t *data);
+
+/**
+ * @brief Returns the atlas generation.
+ * @details Generations change whenever the atlas is cleared and are unique
+ *          across all atlases of the process.
+ * @param atlas Atlas to query.
+ * @return Current generation.
+ */
+uint32_t wlf_glyph_atlas_get_generation(const struct wlf_glyph_atlas *atlas);
+
+/**
+ * @brief Returns the atlas pixels.
+ * @details Rows are tightly packed, so the stride equals the width.
+ * @param atlas Atlas to query.
+ * @param width Receives the width in pixels.
+ * @param height Receives the height in pixels.
+ * @return 8-bit coverage owned by the atlas.
+ */
+const uint8_t *wlf_glyph_atlas_get_data(const struct wlf_glyph_atlas *atlas,
+	uint32_t *width, uint32_t *height);
+
+/**
+ * @brief Returns and resets the rows written since the previous call.
+ * @param atlas Atlas to query.
+ * @param y Receives the first written row.
+ * @param height Receives the number of written rows.
+ * @return true when rows were written, false when nothing changed.
+ */
+bool wlf_glyph_atlas_take_damage(struct wlf_glyph_atlas *atlas,
+	uint32_t *y, uint32_t *height);
+
+#endif // PASS_WLF_GLYPH_ATLAS_H
@@ -0,0 +1,138 @@
+/**
+ * @file        wlf_text_pass.h
+ * @brief       Renderer-independent glyph-atlas text pass interface.
+ * @details     A text pass owns a glyph atlas and draws text as lists of
+ *              quads sampling it, tinted with a solid color. Text nodes look
+ *              their glyphs up in the atlas of the scene's text pass, so each
+ *              glyph is rasterized once per window and text changes only cost
+ *              quad generation.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, draw quads at their destination size\n
+ */
+
+#ifndef PASS_WLF_TEXT_PASS_H
+#define PASS_WLF_TEXT_PASS_H
+
+#include "wlf/math/wlf_frect.h"
+#include "wlf/math/wlf_rect.h"
+#include "wlf/pass/wlf_glyph_atlas.h"
+#include "wlf/pass/wlf_pass.h"
+#include "wlf/pass/wlf_render_target_info.h"
+#include "wlf/types/wlf_color.h"
+#include "wlf/utils/wlf_signal.h"
+
+#include <pixman.h>
+#include <stddef.h>
+
+/** Width and height of the glyph atlas owned by a text pass. */
+#define WLF_TEXT_PASS_ATLAS_SIZE 1024
+
+/**
+ * @brief One glyph quad.
+ *
+ * The destination box usually maps one atlas pixel to one target pixel.
+ * Quads of a text node still waiting to be rasterized at a new window scale
+ * keep their old glyphs in a box of the new size, so passes must stretch the
+ * mask over the destination box when the sizes differ.
+ */
+struct wlf_text_quad {
+	struct wlf_frect dst_box; /**< Destination rectangle in logical coordinates. */
+	struct wlf_rect src_box; /**< Mask rectangle in the atlas. */
+};
+
+/**
+ * @brief Options for drawing a list of glyph quads.
+ */
+struct wlf_render_text_options {
+	const struct wlf_text_quad *quads; /**< Quads to draw. */
+	size_t quad_count; /**< Number of quads. */
+	double offset_x; /**< Horizontal offset added to every quad. */
+	double offset_y; /**< Vertical offset added to every quad. */
+	struct wlf_color color; /**< Text color before coverage and opacity. */
+	float opacity; /**< Opacity in the inclusive range 0..1. */
+	const pixman_region32_t *clip; /**< Optional logical clip region. */
+};
+
+/**
+ * @brief Renderer-independent text pass object.
+ *
+ * Backend-specific passes embed this base structure.
+ */
+struct wlf_text_pass;
+
+/**
+ * @brief Virtual methods implemented by a text pass backend.
+ */
+struct wlf_text_pass_impl {
+	/**
+	 * @brief Releases backend resources owned by @p pass.
+	 * @param pass Text pass to destroy.
+	 */
+	void (*destroy)(struct wlf_text_pass *pass);
+	/**
+	 * @brief Renders glyph quads to @p render_target_info.
+	 *
+	 * The implementation uploads atlas rows reported by
+	 * wlf_glyph_atlas_take_damage() before drawing.
+	 *
+	 * @param pass Text pass performing the draw.
+	 * @param render_target_info Destination render target.
+	 * @param options Quads and compositing options.
+	 */
+	void (*render)(struct wlf_text_pass *pass,
+		struct wlf_render_target_info *render_target_info,
+		const struct wlf_render_text_options *options);
+};
+
+/**
+ * @brief Base object shared by all text pass implementations.
+ */
+struct wlf_text_pass {
+	const struct wlf_text_pass_impl *impl; /**< Backend virtual methods. */
+	struct wlf_glyph_atlas *atlas; /**< Glyph atlas sampled by the pass. */
+	struct {
+		struct wlf_signal destroy; /**< Emitted before the pass is destroyed. */
+	} events;
+};
+
+/**
+ * @brief Automatically creates a text pass and its glyph atlas.
+ *
+ * Selects the pass implementation that matches the renderer backend.
+ *
+ * @param renderer Renderer used to select the pass backend.
+ * @return A newly created text pass, or NULL if the backend is unsupported
+ *         or pass creation fails.
+ */
+struct wlf_text_pass *wlf_text_pass_auto_create(struct wlf_renderer *renderer);
+
+/**
+ * @brief Initializes a text pass with backend virtual methods.
+ * @param pass Text pass to initialize.
+ * @param impl Backend virtual-method table.
+ */
+void wlf_text_pass_init(struct wlf_text_pass *pass,
+	const struct wlf_text_pass_impl *impl);
+
+/**
+ * @brief Destroys a text pass and its atlas, emitting its destroy signal.
+ * @param pass Text pass to destroy, may be NULL.
+ */
+void wlf_text_pass_destroy(struct wlf_text_pass *pass);
+
+/**
+ * @brief Submits glyph quads to the pass.
+ * @param pass Text pass receiving the draw operation.
+ * @param render_target_info Destination render target.
+ * @param options Quads and compositing options.
+ */
+void wlf_render_pass_add_glyphs(struct wlf_text_pass *pass,
+	struct wlf_render_target_info *render_target_info,
+	const struct wlf_render_text_options *options);
+
+#endif // PASS_WLF_TEXT_PASS_H
@@ -9,6 +9,7 @@
  * @par Copyright(c):
  * @par History:
  *      version: v1.0, YaoBing Xiao, 2026-08-05, initial version\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, add tinted coverage masks\n
  */
 
 #ifndef PASS_WLF_TEXTURE_PASS_H
@@ -18,6 +19,7 @@
 #include "wlf/pass/wlf_pass.h"
 #include "wlf/pass/wlf_render_target_info.h"
 #include "wlf/texture/wlf_texture.h"
+#include "wlf/types/wlf_color.h"
 #include "wlf/utils/wlf_signal.h"
 
 #include <pixman.h>
@@ -26,7 +28,9 @@
  * @brief Rendering options for one textured rectangle.
  *
  * The source rectangle is sampled from the texture and mapped to the
- * destination rectangle on the render target.
+ * destination rectangle on the render target. With a tint, the texture is a
+ * single-channel coverage mask (e.g. WLF_FORMAT_R8) and the tint color is
+ * drawn through it, so one mask serves any text or icon color.
  */
 struct wlf_render_texture_options {
 	struct wlf_texture *texture; /**< Texture to sample. */
@@ -36,6 +40,7 @@ struct wlf_render_texture_options {
 	const pixman_region32_t *clip; /**< Optional logical clip region. */
 	enum wlf_scale_filter_mode filter_mode; /**< Texture filtering mode. */
 	enum wlf_render_blend_mode blend_mode; /**< Compositing mode. */
+	const struct wlf_color *tint; /**< Optional color drawn through a coverage mask. */
 };
 
 /**
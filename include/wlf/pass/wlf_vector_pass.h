@@ -9,6 +9,7 @@
  * @par Copyright(c):
  * @par History:
  *      version: v1.0, YaoBing Xiao, 2026-08-05, initial version\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, share the pixman rasterizer\n
  */
 
 #ifndef PASS_WLF_VECTOR_PASS_H
@@ -122,4 +123,20 @@ void wlf_render_pass_add_triangles(struct wlf_vector_pass *pass,
 	struct wlf_render_target_info *render_target_info,
 	const struct wlf_vector_options *options);
 
+/**
+ * @brief Composites a triangle list into a pixman image on the CPU.
+ *
+ * This is the rasterizer of the pixman vector pass. Offscreen rasterizers
+ * that tessellate with the regular shape passes use it too, on every
+ * platform. Only fully covered triangles are drawn.
+ *
+ * @param image Destination image.
+ * @param render_target_info Render target whose scale maps logical
+ *        coordinates to @p image pixels.
+ * @param options Triangle and compositing options.
+ */
+void wlf_vector_pass_composite_pixman(pixman_image_t *image,
+	const struct wlf_render_target_info *render_target_info,
+	const struct wlf_vector_options *options);
+
 #endif // PASS_WLF_VECTOR_PASS_H
@@ -0,0 +1,171 @@
+/**
+ * @file        event_loop.h
+ * @brief       epoll event loop shared by the Linux backends.
+ * @details     Multiplexes file descriptor, timer and idle sources behind a
+ *              single epoll file descriptor. Adding or removing a source is a
+ *              single epoll_ctl() call, timers share one timerfd armed for the
+ *              earliest deadline of a min-heap, and idle callbacks run before
+ *              the loop blocks. Other threads can post tasks to the loop
+ *              through a lock-free queue. A backend can poll the loop's fd
+ *              next to its own connection instead of rebuilding a pollfd
+ *              array each time.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, post tasks from other threads\n
+ */
+
+#ifndef PLATFORM_LINUX_EVENT_LOOP_H
+#define PLATFORM_LINUX_EVENT_LOOP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct wlf_event_loop;
+struct wlf_event_source;
+
+/**
+ * @brief Callback for a file descriptor source.
+ * @param fd Watched file descriptor.
+ * @param mask Ready events, as an epoll(7) mask.
+ * @param data User data given when the source was added.
+ */
+typedef void (*wlf_event_loop_fd_func_t)(int fd, uint32_t mask, void *data);
+
+/**
+ * @brief Callback for a timer or idle source, or a posted task.
+ * @param data User data given when the source was added.
+ */
+typedef void (*wlf_event_loop_func_t)(void *data);
+
+/**
+ * @brief Creates an event loop.
+ * @return New event loop, or NULL on failure.
+ */
+struct wlf_event_loop *wlf_event_loop_create(void);
+
+/**
+ * @brief Destroys an event loop and every source still registered on it.
+ * @param loop Event loop to destroy, may be NULL.
+ */
+void wlf_event_loop_destroy(struct wlf_event_loop *loop);
+
+/**
+ * @brief Returns the epoll file descriptor of the loop.
+ * @details The fd becomes readable when any source of the loop is ready, so
+ *          the loop can be nested in another poll() or epoll set.
+ * @param loop Event loop to query.
+ * @return The epoll file descriptor, owned by the loop.
+ */
+int wlf_event_loop_get_fd(const struct wlf_event_loop *loop);
+
+/**
+ * @brief Watches a file descriptor.
+ * @details A file descriptor can only be watched once per loop.
+ * @param loop Event loop to add the source to.
+ * @param fd File descriptor to watch. It must stay open until the source is
+ *        removed.
+ * @param mask epoll(7) event mask; EPOLLIN, EPOLLOUT, EPOLLERR and EPOLLHUP
+ *        share their values with the poll(2) flags.
+ * @param func Callback invoked when the fd is ready.
+ * @param data User data passed to @p func.
+ * @return New source, or NULL on failure.
+ */
+struct wlf_event_source *wlf_event_loop_add_fd(struct wlf_event_loop *loop,
+	int fd, uint32_t mask, wlf_event_loop_fd_func_t func, void *data);
+
+/**
+ * @brief Changes the events a file descriptor source waits for.
+ * @param source File descriptor source.
+ * @param mask New epoll(7) event mask.
+ * @return true on success, false on failure.
+ */
+bool wlf_event_source_fd_update(struct wlf_event_source *source,
+	uint32_t mask);
+
+/**
+ * @brief Adds a timer source.
+ * @details The timer starts disarmed; arm it with
+ *          wlf_event_source_timer_update().
+ * @param loop Event loop to add the source to.
+ * @param func Callback invoked when the timer expires.
+ * @param data User data passed to @p func.
+ * @return New source, or NULL on failure.
+ */
+struct wlf_event_source *wlf_event_loop_add_timer(struct wlf_event_loop *loop,
+	wlf_event_loop_func_t func, void *data);
+
+/**
+ * @brief Arms or disarms a timer source.
+ * @details A timer fires once per arming; its callback may arm it again.
+ * @param source Timer source.
+ * @param ms_delay Delay from now in milliseconds, zero to disarm.
+ * @return true on success, false on failure.
+ */
+bool wlf_event_source_timer_update(struct wlf_event_source *source,
+	int ms_delay);
+
+/**
+ * @brief Queues a callback to run before the loop next blocks.
+ * @details Idle sources run once, in the order they were added. A source is
+ *          removed just before its callback runs, so the callback may queue
+ *          a new idle source for itself, which runs in the same
+ *          wlf_event_loop_dispatch_idle() call.
+ * @param loop Event loop to add the source to.
+ * @param func Callback to run.
+ * @param data User data passed to @p func.
+ * @return New source, valid until its callback is called, or NULL on failure.
+ */
+struct wlf_event_source *wlf_event_loop_add_idle(struct wlf_event_loop *loop,
+	wlf_event_loop_func_t func, void *data);
+
+/**
+ * @brief Queues a task to run on the thread dispatching the loop.
+ * @details Safe to call from any thread while the loop exists. Tasks run
+ *          from wlf_event_loop_dispatch() in the order they were posted, and
+ *          all tasks posted before the loop wakes up run in that one wakeup.
+ *          Tasks still queued when the loop is destroyed are dropped without
+ *          running.
+ * @param loop Event loop to post to.
+ * @param func Task to run.
+ * @param data User data passed to @p func.
+ * @return true if the task was queued, false on allocation failure.
+ */
+bool wlf_event_loop_post(struct wlf_event_loop *loop,
+	wlf_event_loop_func_t func, void *data);
+
+/**
+ * @brief Removes a source.
+ * @details Safe to call from any callback of the loop, including the
+ *          source's own. A removed source is never dispatched again.
+ * @param source Source to remove, may be NULL.
+ */
+void wlf_event_source_remove(struct wlf_event_source *source);
+
+/**
+ * @brief Waits for ready sources and dispatches them.
+ * @details Idle sources are not run; see wlf_event_loop_dispatch_idle().
+ *          The wait does not block while idle sources are pending.
+ * @param loop Event loop to dispatch.
+ * @param timeout Timeout in milliseconds, -1 to wait indefinitely.
+ * @return true on success or interruption by a signal, false on failure.
+ */
+bool wlf_event_loop_dispatch(struct wlf_event_loop *loop, int timeout);
+
+/**
+ * @brief Runs pending idle sources, including the ones they queue.
+ * @param loop Event loop to dispatch.
+ */
+void wlf_event_loop_dispatch_idle(struct wlf_event_loop *loop);
+
+/**
+ * @brief Checks whether idle sources are pending.
+ * @param loop Event loop to query.
+ * @return true if wlf_event_loop_dispatch_idle() has callbacks to run.
+ */
+bool wlf_event_loop_has_idle(const struct wlf_event_loop *loop);
+
+#endif // PLATFORM_LINUX_EVENT_LOOP_H
@@ -2,13 +2,20 @@
  * @file        text.h
  * @brief       Linux text implementation for wlframe.
  * @details     Declares the Linux Cairo/Pango/HarfBuzz text implementation used by
- *              the platform-independent text interface.
+ *              the platform-independent text interface. One object keeps a
+ *              persistent Pango font map, context and layout so that Pango's
+ *              font and shaping caches survive between rasterizations.
  * @author      YaoBing Xiao
  * @date        2026-08-12
  * @version     v1.0
  * @par Copyright(c):
  * @par History:
  *      version: v1.0, YaoBing Xiao, 2026-08-12, initial version\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, keep Pango state alive\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, cache shaped layouts\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, wrap lines\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, warm up fonts on a thread\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, adopt the warmed font map\n
  */
 
 #ifndef LINUX_TEXT_H
@@ -16,11 +23,92 @@
 
 #include "wlf/platform/wlf_text.h"
 
+#include <glib.h>
+#include <pango/pango.h>
+#include <stdint.h>
+
+/** Number of font descriptions remembered by a Linux text object. */
+#define WLF_LINUX_TEXT_FONT_CACHE_SIZE 16
+
+/** Number of shaped layouts remembered by a Linux text object. */
+#define WLF_LINUX_TEXT_LAYOUT_CACHE_SIZE 64
+
+/** Number of shaped fonts a Linux text object hands out identifiers for. */
+#define WLF_LINUX_TEXT_GLYPH_FONT_COUNT 64
+
+/**
+ * @brief Font referenced by the glyph runs of a Linux text object.
+ */
+struct wlf_linux_text_glyph_font {
+	PangoFont *font; /**< Referenced font, NULL for an unused slot. */
+	uint32_t id; /**< Identifier stored in struct wlf_text_glyph. */
+	uint64_t last_used; /**< Value of the use counter at the last lookup. */
+};
+
+/**
+ * @brief Font description cached by a Linux text object.
+ */
+struct wlf_linux_text_font {
+	char *family; /**< Requested family, NULL for an unused slot. */
+	int size; /**< Absolute size in Pango units. */
+	enum wlf_text_font_slant slant; /**< Requested slant. */
+	enum wlf_text_font_weight weight; /**< Requested weight. */
+	PangoFontDescription *description; /**< Description built for the key. */
+	uint32_t id; /**< Identifier never reused for another description. */
+	uint64_t last_used; /**< Value of the use counter at the last lookup. */
+};
+
+/**
+ * @brief Shaped layout cached by a Linux text object.
+ *
+ * The raster scale is part of the font size, and the maximum width only
+ * clips rasters, so text and font identify the shaping result.
+ */
+struct wlf_linux_text_layout {
+	char *text; /**< Shaped text, NULL for an unused slot. */
+	uint64_t hash; /**< Hash of @ref text, compared before the string. */
+	uint32_t font; /**< Identifier of the font description. */
+	PangoLayout *layout; /**< Layout, kept for reuse when the slot is empty. */
+	struct wlf_text_metrics metrics; /**< Metrics measured after shaping. */
+	uint64_t last_used; /**< Value of the use counter at the last lookup. */
+};
+
+/**
+ * @brief Font warmed up by a Linux text object.
+ *
+ * The warm-up thread only writes @ref fontset; the event loop thread reads
+ * it after joining the thread.
+ */
+struct wlf_linux_text_warm_font {
+	char *family; /**< Requested family. */
+	int size; /**< Absolute size at the requested scale in Pango units. */
+	enum wlf_text_font_slant slant; /**< Requested slant. */
+	enum wlf_text_font_weight weight; /**< Requested weight. */
+	PangoFontset *fontset; /**< Fontset loaded by the warm-up thread. */
+};
+
 /**
  * @brief Linux text object.
+ *
+ * The object is shared by every text node of a backend and must only be used
+ * from the event loop thread.
  */
 struct wlf_linux_text {
 	struct wlf_text base; /**< Platform-independent text object. */
+	PangoFontMap *font_map; /**< Font map owning Pango's font cache. */
+	PangoContext *context; /**< Context owning Pango's shaping state. */
+	struct wlf_linux_text_font fonts[WLF_LINUX_TEXT_FONT_CACHE_SIZE]; /**< Recently used font descriptions. */
+	struct wlf_linux_text_layout layouts[WLF_LINUX_TEXT_LAYOUT_CACHE_SIZE]; /**< Recently shaped layouts. */
+	PangoLayout *wrap_layout; /**< Layout reused for line wrapping, created on first use. */
+	uint32_t next_font_id; /**< Next identifier handed out for a description. */
+	struct wlf_linux_text_glyph_font glyph_fonts[WLF_LINUX_TEXT_GLYPH_FONT_COUNT]; /**< Fonts of recent glyph runs. */
+	uint32_t next_glyph_font_id; /**< Next identifier handed out for a font. */
+	uint64_t font_use_counter; /**< Monotonic counter used to pick LRU slots. */
+	struct wlf_linux_text_warm_font *warm_fonts; /**< Fonts passed to the last warm-up. */
+	size_t warm_font_count; /**< Number of entries in @ref warm_fonts. */
+	GThread *warm_up_thread; /**< Thread resolving @ref warm_fonts, NULL once joined. */
+	PangoFontMap *warm_font_map; /**< Font map the thread loads @ref warm_fonts into, adopted once joined. */
+	PangoContext *warm_context; /**< Context of @ref warm_font_map. */
 };
 
 /**
@@ -16,6 +16,10 @@
  * @par Copyright:
  * @par History:
  *      version: v1.0, YaoBing Xiao, 2025-06-25, initial version\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, warm up text fonts\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, dispatch sources from an event loop\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, post tasks from other threads\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, warm up text at the window scale\n
  */
 
 #ifndef PLATFORM_WLF_BACKEND_H
@@ -29,11 +33,30 @@
 #include <stddef.h>
 
 struct wlf_backend;
+struct wlf_event_loop;
+struct wlf_event_source;
+struct wlf_text;
+struct wlf_text_font;
 struct wlf_theme;
 
 typedef void (*wlf_backend_event_source_dispatch_t)(
 	struct wlf_backend *backend, int fd, uint32_t revents, void *data);
 
+typedef void (*wlf_backend_task_func_t)(void *data);
+
+/**
+ * @brief External file descriptor registered on a backend
+ */
+struct wlf_backend_event_source {
+	struct wlf_linked_list link;  /**< Link in wlf_backend::event_sources */
+	struct wlf_backend *backend;  /**< Backend the fd is registered on */
+	int fd;  /**< File descriptor to monitor */
+	short events;  /**< poll(2) event mask */
+	wlf_backend_event_source_dispatch_t dispatch;  /**< Event callback */
+	void *data;  /**< User data passed to callback */
+	struct wlf_event_source *source;  /**< Event loop source, NULL without an event loop */
+};
+
 /**
  * @brief Backend implementation interface
  * This structure defines the function pointers that each backend must implement
@@ -76,20 +99,20 @@ struct wlf_backend_impl {
 struct wlf_backend {
 	const struct wlf_backend_impl *impl;  /**< Backend implementation */
 	struct wlf_theme *theme; /**< Host appearance and semantic color palette. */
+	struct wlf_text *text; /**< Text implementation shared by all text nodes, created on first use. */
+	double text_warm_up_scale; /**< Scale the default UI fonts were warmed up at, 0 when the application chose its fonts. */
 	bool running;  /**< True while backend event loop is running */
 	struct {
 		/** Whether the platform can provide server-side window decorations. */
 		bool server_side_decorations;
 	} features;
 
-	struct {
-		int fd;  /**< File descriptor to monitor */
-		short events;  /**< poll(2) event mask */
-		wlf_backend_event_source_dispatch_t dispatch;  /**< Event callback */
-		void *data;  /**< User data passed to callback */
-	} *event_sources;  /**< Dynamic event source array */
-	size_t event_source_count;  /**< Number of active event sources */
-	size_t event_source_capacity;  /**< Allocated event source capacity */
+	/**
+	 * Event loop dispatching the registered sources, set by backends that
+	 * run one; NULL otherwise.
+	 */
+	struct wlf_event_loop *event_loop;
+	struct wlf_linked_list event_sources;  /**< wlf_backend_event_source list */
 
 	struct {
 		struct wlf_signal destroy;        /**< Emitted when backend is destroyed */
@@ -121,6 +144,45 @@ void wlf_backend_init(struct wlf_backend *backend,
  */
 bool wlf_backend_init_theme(struct wlf_backend *backend);
 
+/**
+ * @brief Returns the text implementation shared by everything on a backend.
+ *
+ * The object is created on first use and destroyed with the backend, so
+ * font and shaping caches are shared by every window and text node.
+ * @param backend Backend to query.
+ * @return The shared text object, or NULL when no implementation is available.
+ */
+struct wlf_text *wlf_backend_get_text(struct wlf_backend *backend);
+
+/**
+ * @brief Starts resolving fonts for the shared text object in the background.
+ *
+ * wlf_backend_autocreate() calls this for the default UI fonts, so the first
+ * frame does not wait for the system font configuration to load.
+ * Applications using other fonts may call it again with their own list.
+ * The default UI fonts are resolved at scale 1 until a window reports its
+ * scale through wlf_backend_warm_up_text_scale().
+ * @param backend Backend whose text object is warmed up.
+ * @param fonts Fonts to resolve, or NULL for the default UI fonts.
+ * @param count Number of entries in @p fonts, ignored when it is NULL.
+ * @return true if the work was started, false when the text implementation
+ *         cannot warm up fonts or on failure.
+ */
+bool wlf_backend_warm_up_text(struct wlf_backend *backend,
+	const struct wlf_text_font *fonts, size_t count);
+
+/**
+ * @brief Resolves the default UI fonts again at a window's scale.
+ *
+ * wlf_window_set_scale() calls this, so the warmed fonts match the raster
+ * scale the window draws at. Does nothing when the application warmed up
+ * its own fonts or the fonts are already warmed up at @p scale.
+ * @param backend Backend whose text object is warmed up.
+ * @param scale Raster scale of the window.
+ */
+void wlf_backend_warm_up_text_scale(struct wlf_backend *backend,
+	double scale);
+
 /**
  * @brief Auto-create the best available backend for the current environment
  * @return Pointer to created backend, or NULL on failure
@@ -163,6 +225,36 @@ bool wlf_backend_add_event_source(struct wlf_backend *backend,
 bool wlf_backend_remove_event_source(struct wlf_backend *backend,
 	int fd, void *data);
 
+/**
+ * @brief Get the event loop the backend dispatches
+ *
+ * Timer and idle sources added to the loop run on the backend thread while
+ * wlf_backend_exe() is running.
+ *
+ * @param backend Pointer to backend
+ * @return Event loop owned by the backend, or NULL if it has none
+ */
+struct wlf_event_loop *wlf_backend_get_event_loop(struct wlf_backend *backend);
+
+/**
+ * @brief Run a function on the backend thread
+ *
+ * Lets worker threads hand results back to the thread running
+ * wlf_backend_exe() without an event source of their own. Safe to call from
+ * any thread while the backend exists. Tasks run in the order they were
+ * posted, and all tasks posted before the backend wakes up run in that one
+ * wakeup. Tasks still queued when the backend is destroyed are dropped
+ * without running.
+ *
+ * @param backend Pointer to backend
+ * @param func Function to run on the backend thread
+ * @param data User data passed to @p func
+ * @return true if queued, false if the backend has no event loop or on
+ *         allocation failure
+ */
+bool wlf_backend_post(struct wlf_backend *backend,
+	wlf_backend_task_func_t func, void *data);
+
 /**
  * @brief Request backend event loop termination
  * @param backend Pointer to backend
@@ -4,20 +4,31 @@
  * @details     The scene layer uses this interface without depending on a
  *              particular text stack. Platform implementations provide shaped text
  *              metrics and premultiplied ARGB8888 pixels for texture upload.
+ *              Implementations may also expose shaped glyph runs and per-glyph
+ *              coverage masks, which the scene caches in a glyph atlas.
  * @author      YaoBing Xiao
  * @date        2026-08-12
  * @version     v1.0
  * @par Copyright(c):
  * @par History:
  *      version: v1.0, YaoBing Xiao, 2026-08-12, initial version\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, add glyph runs and glyph masks\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, rasterize coverage masks\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, add measure-only layout\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, add line wrapping\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, add asynchronous font warm-up\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, add line height helper\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, warm up fonts at a raster scale\n
  */
 
 #ifndef PLATFORM_WLF_TEXT_H
 #define PLATFORM_WLF_TEXT_H
 
 #include "wlf/types/wlf_color.h"
+#include "wlf/utils/wlf_array.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -48,7 +59,7 @@ struct wlf_text_options {
 	const char *font_family; /**< Requested family, or NULL for sans-serif. */
 	double font_size; /**< Font size in logical units. */
 	double raster_scale; /**< Device scale used for rasterization. */
-	struct wlf_color color; /**< Text color. */
+	struct wlf_color color; /**< Text color; rasters are coverage and ignore it. */
 	int max_width; /**< Maximum logical width, or a non-positive value for none. */
 	enum wlf_text_font_slant slant; /**< Requested font slant. */
 	enum wlf_text_font_weight weight; /**< Requested font weight. */
@@ -71,8 +82,10 @@ struct wlf_text_metrics {
 /**
  * @brief Rasterized text returned by a text implementation.
  *
- * @p data remains owned by the text implementation and is valid until
- * wlf_text_raster_destroy() is called. Empty text may return zero dimensions
+ * The raster is a one-byte-per-pixel coverage mask, independent of the text
+ * color, so it can be tinted when drawn. Rows are padded to a multiple of
+ * four bytes. @p data remains owned by the text implementation and is valid
+ * until wlf_text_raster_destroy() is called. Empty text may return zero dimensions
  * and a NULL data pointer while still providing valid metrics.
  */
 struct wlf_text_raster {
@@ -80,23 +93,105 @@ struct wlf_text_raster {
 	uint32_t width; /**< Raster width in pixels after clipping. */
 	uint32_t height; /**< Raster height in pixels. */
 	uint32_t stride; /**< Raster row stride in bytes. */
-	const void *data; /**< Premultiplied ARGB8888 pixel data. */
+	const void *data; /**< 8-bit coverage, one byte per pixel. */
 	void *private_data; /**< Opaque storage owned by the text implementation. */
 };
 
+/**
+ * @brief One positioned glyph of a shaped run.
+ *
+ * Positions are pen positions on the baseline, in raster pixels relative to
+ * the top-left corner of the run's bounds.
+ */
+struct wlf_text_glyph {
+	uint32_t font; /**< Implementation font identifier, never reused. */
+	uint32_t index; /**< Glyph index within the font. */
+	float x; /**< Horizontal pen position. */
+	float y; /**< Baseline position. */
+};
+
+/**
+ * @brief Shaped text returned by wlf_text_shape().
+ *
+ * Glyphs without ink, such as spaces, are omitted. @p glyphs is owned by the
+ * run and released by wlf_text_glyph_run_finish().
+ */
+struct wlf_text_glyph_run {
+	struct wlf_text_metrics metrics; /**< Natural shaped text metrics. */
+	struct wlf_text_glyph *glyphs; /**< Glyphs in drawing order. */
+	size_t glyph_count; /**< Number of glyphs. */
+};
+
+/**
+ * @brief Coverage mask of one glyph returned by wlf_text_rasterize_glyph().
+ *
+ * The mask is placed at pen position + (@p left, @p top). Glyphs without ink
+ * return zero dimensions and a NULL data pointer.
+ */
+struct wlf_text_glyph_image {
+	int32_t left; /**< Mask offset from the pen position. */
+	int32_t top; /**< Mask offset from the baseline. */
+	uint32_t width; /**< Mask width in pixels. */
+	uint32_t height; /**< Mask height in pixels. */
+	uint32_t stride; /**< Mask row stride in bytes. */
+	const uint8_t *data; /**< 8-bit coverage. */
+	void *private_data; /**< Opaque storage owned by the text implementation. */
+};
+
+/**
+ * @brief Byte range of one line returned by wlf_text_wrap().
+ */
+struct wlf_text_line {
+	size_t start; /**< Byte offset of the line in the wrapped text. */
+	size_t length; /**< Length in bytes, without the line break. */
+};
+
+/**
+ * @brief Font resolved ahead of its first use by wlf_text_warm_up().
+ */
+struct wlf_text_font {
+	const char *family; /**< Requested family, or NULL for sans-serif. */
+	double size; /**< Font size in logical units. */
+	double scale; /**< Raster scale to resolve the font at, or 0 for 1. */
+	enum wlf_text_font_slant slant; /**< Requested font slant. */
+	enum wlf_text_font_weight weight; /**< Requested font weight. */
+};
+
 struct wlf_text;
 
 /**
  * @brief Virtual methods implemented by a platform text implementation.
+ *
+ * The measure, wrap, warm-up and glyph methods are optional. Without a
+ * measure method, measuring rasterizes the text and drops the raster;
+ * without a wrap method, text only breaks at line breaks; without a warm-up
+ * method, fonts are resolved on first use; without the glyph methods, only
+ * whole-string rasterization is supported.
  */
 
 struct wlf_text_impl {
 	const char *name; /**< Human-readable implementation name. */
+	bool (*measure)(struct wlf_text *text,
+		const struct wlf_text_options *options,
+		struct wlf_text_metrics *metrics); /**< Shape text and return its metrics. */
+	bool (*wrap)(struct wlf_text *text,
+		const struct wlf_text_options *options,
+		struct wlf_array *lines); /**< Break text into lines of a maximum width. */
+	bool (*warm_up)(struct wlf_text *text, const struct wlf_text_font *fonts,
+		size_t count); /**< Start resolving fonts in the background. */
 	bool (*rasterize)(struct wlf_text *text,
 		const struct wlf_text_options *options,
 		struct wlf_text_raster *raster); /**< Shape and rasterize text. */
 	void (*destroy_raster)(struct wlf_text *text,
 		struct wlf_text_raster *raster); /**< Release raster-owned resources. */
+	bool (*shape)(struct wlf_text *text,
+		const struct wlf_text_options *options,
+		struct wlf_text_glyph_run *run); /**< Shape text into positioned glyphs. */
+	bool (*rasterize_glyph)(struct wlf_text *text, uint32_t font,
+		uint32_t index, float subpixel_x,
+		struct wlf_text_glyph_image *image); /**< Rasterize one glyph mask. */
+	void (*destroy_glyph_image)(struct wlf_text *text,
+		struct wlf_text_glyph_image *image); /**< Release glyph-mask resources. */
 	void (*destroy)(struct wlf_text *text); /**< Destroy the text implementation. */
 };
 
@@ -131,6 +226,75 @@ struct wlf_text *wlf_text_autocreate(void);
  */
 void wlf_text_destroy(struct wlf_text *text);
 
+/**
+ * @brief Start resolving fonts in the background before they are used.
+ *
+ * Font discovery can take long the first time a process looks up a font,
+ * for example while the system font configuration and caches are loaded.
+ * Implementations that support it do this on a background thread and keep
+ * the resolved fonts for the text object, so the first text drawn does not
+ * wait for it. The text object stays usable meanwhile; a call that needs
+ * the fonts before they are resolved waits for the background work.
+ * Calling this again replaces the previously warmed fonts.
+ *
+ * @param text Text object to warm up.
+ * @param fonts Fonts to resolve; the array is copied.
+ * @param count Number of entries in @p fonts.
+ * @return true if the work was started, false on invalid input, missing
+ *         support or failure.
+ */
+bool wlf_text_warm_up(struct wlf_text *text, const struct wlf_text_font *fonts,
+	size_t count);
+
+/**
+ * @brief Shape text and return its metrics without rasterizing it.
+ *
+ * Implementations cache recently shaped text, so measuring a string and then
+ * rasterizing or shaping it with the same options shapes it only once. The
+ * color and maximum width options are ignored; the metrics are those of the
+ * unclipped text.
+ *
+ * @param text Text object to use.
+ * @param options Text shaping options.
+ * @param metrics Output metrics in raster pixels.
+ * @return true on success, false on invalid input or implementation failure.
+ */
+bool wlf_text_measure(struct wlf_text *text,
+	const struct wlf_text_options *options,
+	struct wlf_text_metrics *metrics);
+
+/**
+ * @brief Return the distance between stacked lines of text.
+ *
+ * This is the logical height of an empty line, measured at scale 1 so a
+ * layout built on it does not move when the window scale changes. When the
+ * text cannot be measured it falls back to 1.2 times the font size.
+ *
+ * @param text Text object to use.
+ * @param font_family Font family, or NULL for sans-serif.
+ * @param font_size Font size in logical pixels.
+ * @return Line height in logical pixels.
+ */
+uint32_t wlf_text_line_height(struct wlf_text *text,
+	const char *font_family, double font_size);
+
+/**
+ * @brief Break text into lines no wider than the maximum width.
+ *
+ * Lines break at '\n' and, when the maximum width is positive and the
+ * implementation can wrap, between words or, for words wider than a line,
+ * between characters. Every '\n' ends a line, so text ending with one ends
+ * with an empty line. The color option is ignored.
+ *
+ * @param text Text object to use.
+ * @param options Text shaping options; @p max_width is the line width.
+ * @param lines Array to which one struct wlf_text_line is appended per line.
+ * @return true on success, false on invalid input, allocation failure or
+ *         implementation failure. Lines may have been appended on failure.
+ */
+bool wlf_text_wrap(struct wlf_text *text,
+	const struct wlf_text_options *options, struct wlf_array *lines);
+
 /**
  * @brief Shape and rasterize text through a text implementation.
  * @param text Text object to use.
@@ -150,6 +314,53 @@ bool wlf_text_rasterize(struct wlf_text *text,
 void wlf_text_raster_destroy(struct wlf_text *text,
 	struct wlf_text_raster *raster);
 
+/**
+ * @brief Check whether a text implementation can shape glyph runs.
+ * @param text Text object to query. NULL is allowed.
+ * @return true when wlf_text_shape() and wlf_text_rasterize_glyph() are available.
+ */
+bool wlf_text_supports_glyphs(const struct wlf_text *text);
+
+/**
+ * @brief Shape text into positioned glyphs without rasterizing it.
+ *
+ * The color and maximum width options are ignored.
+ *
+ * @param text Text object to use.
+ * @param options Text shaping options.
+ * @param run Output glyph run.
+ * @return true on success, false on invalid input, missing support or failure.
+ */
+bool wlf_text_shape(struct wlf_text *text,
+	const struct wlf_text_options *options,
+	struct wlf_text_glyph_run *run);
+
+/**
+ * @brief Release the glyphs of a run returned by wlf_text_shape().
+ * @param run Run to release. NULL is allowed.
+ */
+void wlf_text_glyph_run_finish(struct wlf_text_glyph_run *run);
+
+/**
+ * @brief Rasterize the coverage mask of one glyph.
+ * @param text Text object that shaped the glyph.
+ * @param font Font identifier from a struct wlf_text_glyph.
+ * @param index Glyph index from a struct wlf_text_glyph.
+ * @param subpixel_x Horizontal pen offset in the range [0, 1).
+ * @param image Output glyph mask.
+ * @return true on success, false on invalid input or failure.
+ */
+bool wlf_text_rasterize_glyph(struct wlf_text *text, uint32_t font,
+	uint32_t index, float subpixel_x, struct wlf_text_glyph_image *image);
+
+/**
+ * @brief Release a glyph mask returned by wlf_text_rasterize_glyph().
+ * @param text Text object that produced the mask.
+ * @param image Mask to release. NULL is allowed.
+ */
+void wlf_text_glyph_image_destroy(struct wlf_text *text,
+	struct wlf_text_glyph_image *image);
+
 /**
  * @brief Check whether a string is valid UTF-8.
  * @param text NUL-terminated string to check.
@@ -52,6 +52,7 @@ struct wlf_gles_renderer {
 		bool OES_texture_half_float_linear; /**< GL_OES_texture_half_float_linear: linear filtering for fp16 textures. */
 		bool EXT_texture_norm16;            /**< GL_EXT_texture_norm16: 16-bit normalised texture formats. */
 		bool EXT_disjoint_timer_query;      /**< GL_EXT_disjoint_timer_query: GPU timestamp queries. */
+		bool EXT_unpack_subimage;           /**< GL_EXT_unpack_subimage: strided sub-rectangle uploads. */
 	} exts;
 
 	struct {
@@ -0,0 +1,129 @@
+/**
+ * @file        wlf_animated_image_node.h
+ * @brief       Animated image scene-node interface.
+ * @details     Provides a scene node that plays GIF and animated WebP images.
+ *              Frames advance from the scene's frame-done timing, only the
+ *              pixels that changed are uploaded and damaged, and playback
+ *              pauses while the node has no visible region.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ */
+
+#ifndef SCENE_WLF_ANIMATED_IMAGE_NODE_H
+#define SCENE_WLF_ANIMATED_IMAGE_NODE_H
+
+#include "wlf/image/wlf_image.h"
+#include "wlf/pass/wlf_texture_pass.h"
+#include "wlf/scene/wlf_scene_node.h"
+#include "wlf/texture/wlf_texture.h"
+
+#include <stdint.h>
+
+/**
+ * @brief A scene node playing an animated image.
+ *
+ * The node owns the image and a renderer texture holding the displayed frame.
+ * When a new frame becomes due, the texture is updated in place from the
+ * changed rectangle only, and only that rectangle is damaged in the scene.
+ */
+struct wlf_animated_image_node {
+	struct wlf_scene_node base;
+	struct wlf_image *image;        /**< Owned GIF or WebP image */
+	struct wlf_renderer *renderer;  /**< Renderer owning @ref texture */
+	struct wlf_texture *texture;    /**< Texture holding the displayed frame */
+	uint8_t *pixels;                /**< Premultiplied ABGR8888 copy of the displayed frame */
+	uint32_t stride;                /**< Bytes per row of @ref pixels */
+
+	uint32_t frame_count;           /**< Number of frames in the animation */
+	uint32_t current_frame;         /**< Index of the displayed frame */
+	uint32_t loop_count;            /**< Loops to play, 0 for infinite */
+	uint32_t loops_played;          /**< Completed loops since playback started */
+	int64_t frame_elapsed_ms;       /**< Time spent on the displayed frame */
+	int64_t last_frame_ms;          /**< Timestamp of the last frame-done event */
+	bool has_last_frame;            /**< Whether @ref last_frame_ms is valid */
+	bool playing;                   /**< Whether playback is running */
+
+	struct wlf_listener renderer_destroy;
+	struct wlf_listener frame_done;
+};
+
+/**
+ * @brief Creates an animated image node.
+ * @details The node takes ownership of @p image, which must be an 8-bit RGBA
+ *          GIF or WebP image. Streaming GIFs are supported. Playback starts
+ *          immediately. A zero destination width or height uses the image's
+ *          natural size.
+ * @param parent Parent scene node attached to a scene.
+ * @param image Image to own and play.
+ * @param x Initial x position relative to @p parent.
+ * @param y Initial y position relative to @p parent.
+ * @param width Destination width, or zero for the natural width.
+ * @param height Destination height, or zero for the natural height.
+ * @return New animated image node, or NULL on failure. @p image is only
+ *         owned by the node on success.
+ */
+struct wlf_animated_image_node *wlf_animated_image_node_create(
+	struct wlf_scene_node *parent, struct wlf_image *image,
+	int x, int y, uint32_t width, uint32_t height);
+
+/**
+ * @brief Starts or pauses playback.
+ * @details Restarting a finished animation resets its loop counter.
+ * @param node Animated image node to update.
+ * @param playing Whether playback should run.
+ */
+void wlf_animated_image_node_set_playing(struct wlf_animated_image_node *node,
+	bool playing);
+
+/**
+ * @brief Shows a specific frame.
+ * @param node Animated image node to update.
+ * @param index Frame index to show.
+ * @return true when the frame is displayed, false on an invalid index or a
+ *         decoding failure.
+ */
+bool wlf_animated_image_node_seek(struct wlf_animated_image_node *node,
+	uint32_t index);
+
+/**
+ * @brief Changes the destination size.
+ * @param node Animated image node to update.
+ * @param width Destination width; zero uses the natural width.
+ * @param height Destination height; zero uses the natural height.
+ */
+void wlf_animated_image_node_set_dest_size(struct wlf_animated_image_node *node,
+	uint32_t width, uint32_t height);
+
+/**
+ * @brief Checks whether a scene node is an animated image node.
+ * @param node Scene node to inspect.
+ * @return true when @p node is an animated image node, false otherwise.
+ */
+bool wlf_scene_node_is_animated_image(const struct wlf_scene_node *node);
+
+/**
+ * @brief Casts a scene node to an animated image node.
+ * @param node Scene node known to be an animated image node.
+ * @return The enclosing animated image node.
+ * @note The function asserts when @p node has another type.
+ */
+struct wlf_animated_image_node *wlf_animated_image_node_from_node(
+	struct wlf_scene_node *node);
+
+/**
+ * @brief Renders an animated image node through the supplied texture pass.
+ * @param node Animated image node to render.
+ * @param pass Texture pass used for rendering.
+ * @param render_target_info Destination render target.
+ * @param clip Optional clip region.
+ */
+void wlf_animated_image_node_render(struct wlf_animated_image_node *node,
+	struct wlf_texture_pass *pass,
+	struct wlf_render_target_info *render_target_info,
+	const pixman_region32_t *clip);
+
+#endif // SCENE_WLF_ANIMATED_IMAGE_NODE_H
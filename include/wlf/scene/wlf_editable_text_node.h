@@ -0,0 +1,124 @@
+/**
+ * @file        wlf_editable_text_node.h
+ * @brief       Editable multi-line text scene-node interface.
+ * @details     Provides a scene node holding editable UTF-8 text. Every line
+ *              is a text node of its own, so an edit only reshapes the lines
+ *              it touches and only damages their rectangles.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ */
+
+#ifndef SCENE_WLF_EDITABLE_TEXT_NODE_H
+#define SCENE_WLF_EDITABLE_TEXT_NODE_H
+
+#include "wlf/scene/wlf_scene_node.h"
+#include "wlf/scene/wlf_text_node.h"
+#include "wlf/types/wlf_color.h"
+#include "wlf/utils/wlf_linked_list.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief One line of an editable text node.
+ */
+struct wlf_editable_text_line {
+	struct wlf_text_node *node; /**< Child text node drawing the line. */
+	size_t start; /**< Byte offset of the line in the node text. */
+	size_t length; /**< Length in bytes, without the line break. */
+};
+
+/**
+ * @brief A scene node containing editable UTF-8 text.
+ *
+ * Lines are separated by '\n' and stacked at a fixed line height. Lines an
+ * edit does not touch keep their shaped text and are not repainted, except
+ * for lines below an edit that adds or removes line breaks, which move.
+ */
+struct wlf_editable_text_node {
+	struct wlf_scene_node base;
+	struct wlf_linked_list children;
+	char *text; /**< Whole text, NUL-terminated. */
+	size_t length; /**< Length of @ref text in bytes. */
+	size_t capacity; /**< Allocated size of @ref text. */
+	struct wlf_editable_text_line *lines;
+	size_t line_count;
+	size_t line_capacity;
+	char *font_family;
+	double font_size;
+	struct wlf_color color;
+	uint32_t line_height; /**< Distance between line tops in logical units. */
+};
+
+/**
+ * @brief Creates an editable text node.
+ * @param parent Parent scene node.
+ * @param x Initial x position relative to @p parent.
+ * @param y Initial y position relative to @p parent.
+ * @param text Initial UTF-8 text, or NULL for an empty string.
+ * @param font_family Font family, or NULL for the default sans-serif family.
+ * @param font_size Font size in logical units.
+ * @param color Text color, or NULL for opaque white.
+ * @return New node, or NULL on invalid input or allocation failure.
+ */
+struct wlf_editable_text_node *wlf_editable_text_node_create(
+	struct wlf_scene_node *parent, int x, int y, const char *text,
+	const char *font_family, double font_size, const struct wlf_color *color);
+
+/**
+ * @brief Inserts UTF-8 text at a byte offset.
+ * @param node Node to edit.
+ * @param offset Byte offset on a character boundary, at most the text length.
+ * @param text UTF-8 text to insert.
+ * @return true on success, false on invalid input or allocation failure.
+ */
+bool wlf_editable_text_node_insert(struct wlf_editable_text_node *node,
+	size_t offset, const char *text);
+
+/**
+ * @brief Deletes a byte range of the text.
+ * @param node Node to edit.
+ * @param offset Byte offset of the range, on a character boundary.
+ * @param length Length of the range in bytes, ending on a character boundary.
+ * @return true on success, false on invalid input or allocation failure.
+ */
+bool wlf_editable_text_node_delete(struct wlf_editable_text_node *node,
+	size_t offset, size_t length);
+
+/**
+ * @brief Returns the current text.
+ * @param node Node to query.
+ * @return NUL-terminated text owned by the node, valid until the next edit.
+ */
+const char *wlf_editable_text_node_get_text(
+	const struct wlf_editable_text_node *node);
+
+/**
+ * @brief Changes the text color without reshaping any line.
+ * @param node Node to update.
+ * @param color New text color.
+ */
+void wlf_editable_text_node_set_color(struct wlf_editable_text_node *node,
+	const struct wlf_color *color);
+
+/**
+ * @brief Checks whether a scene node is an editable text node.
+ * @param node Node to test.
+ * @return true if @p node was created by wlf_editable_text_node_create().
+ */
+bool wlf_scene_node_is_editable_text(const struct wlf_scene_node *node);
+
+/**
+ * @brief Converts a scene node to its editable text node.
+ * @param node Scene node for which wlf_scene_node_is_editable_text() is true.
+ * @return Containing editable text node.
+ */
+struct wlf_editable_text_node *wlf_editable_text_node_from_node(
+	struct wlf_scene_node *node);
+
+#endif // SCENE_WLF_EDITABLE_TEXT_NODE_H
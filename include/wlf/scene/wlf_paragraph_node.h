@@ -0,0 +1,143 @@
+/**
+ * @file        wlf_paragraph_node.h
+ * @brief       Multi-line paragraph scene-node interface.
+ * @details     Provides a scrollable text view that wraps UTF-8 text into
+ *              lines and only keeps the lines inside its view shaped, so
+ *              scrolling costs the same however long the text is.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ */
+
+#ifndef SCENE_WLF_PARAGRAPH_NODE_H
+#define SCENE_WLF_PARAGRAPH_NODE_H
+
+#include "wlf/platform/wlf_text.h"
+#include "wlf/scene/wlf_scene_node.h"
+#include "wlf/scene/wlf_text_node.h"
+#include "wlf/types/wlf_color.h"
+#include "wlf/utils/wlf_array.h"
+#include "wlf/utils/wlf_linked_list.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief One visible row of a paragraph node.
+ */
+struct wlf_paragraph_row {
+	struct wlf_text_node *node; /**< Child text node, NULL until first used. */
+	size_t line; /**< Index of the line shown, SIZE_MAX for none. */
+};
+
+/**
+ * @brief A scrollable scene node containing wrapped UTF-8 text.
+ *
+ * The text is wrapped once, when it or the view width changes, into an array
+ * of byte ranges. The view shows whole lines from @ref first_line on, each
+ * drawn by a child text node. Rows are assigned to lines modulo the row
+ * count, so scrolling by a few lines reshapes only the rows that come into
+ * view and moves the others.
+ */
+struct wlf_paragraph_node {
+	struct wlf_scene_node base;
+	struct wlf_linked_list children;
+	char *text; /**< Whole text, NUL-terminated. */
+	struct wlf_array lines; /**< Wrapped lines as struct wlf_text_line. */
+	struct wlf_paragraph_row *rows;
+	size_t row_count; /**< Number of whole lines fitting in the view. */
+	size_t first_line; /**< Index of the line at the top of the view. */
+	char *font_family;
+	double font_size;
+	struct wlf_color color;
+	int view_width; /**< Wrap width in logical units, zero for none. */
+	uint32_t view_height; /**< View height in logical units. */
+	uint32_t line_height; /**< Distance between line tops in logical units. */
+	struct wlf_text *text_context;
+};
+
+/**
+ * @brief Creates a paragraph node.
+ * @param parent Parent scene node.
+ * @param x Initial x position relative to @p parent.
+ * @param y Initial y position relative to @p parent.
+ * @param width View width in logical units; lines wrap at it and are
+ *        clipped to it. Zero disables wrapping and clipping.
+ * @param height View height in logical units.
+ * @param text Initial UTF-8 text, or NULL for an empty string.
+ * @param font_family Font family, or NULL for the default sans-serif family.
+ * @param font_size Font size in logical units.
+ * @param color Text color, or NULL for opaque white.
+ * @return New node, or NULL on invalid input or allocation failure.
+ */
+struct wlf_paragraph_node *wlf_paragraph_node_create(
+	struct wlf_scene_node *parent, int x, int y, int width, uint32_t height,
+	const char *text, const char *font_family, double font_size,
+	const struct wlf_color *color);
+
+/**
+ * @brief Replaces the text and wraps it again.
+ * @details The view keeps its first line, clamped to the new line count.
+ * @param node Node to update.
+ * @param text New UTF-8 text, or NULL for an empty string.
+ * @return true on success, false on invalid input or allocation failure.
+ */
+bool wlf_paragraph_node_set_text(struct wlf_paragraph_node *node,
+	const char *text);
+
+/**
+ * @brief Resizes the view, wrapping the text again when the width changes.
+ * @param node Node to update.
+ * @param width New view width in logical units, zero for no wrapping.
+ * @param height New view height in logical units.
+ * @return true on success, false on invalid input or allocation failure.
+ */
+bool wlf_paragraph_node_set_size(struct wlf_paragraph_node *node,
+	int width, uint32_t height);
+
+/**
+ * @brief Scrolls the view so that a line is at its top.
+ * @details The line is clamped so that the view stays filled when the text
+ *          has enough lines. Only rows showing another line are reshaped.
+ * @param node Node to scroll.
+ * @param line Index of the wrapped line to show at the top.
+ */
+void wlf_paragraph_node_scroll_to_line(struct wlf_paragraph_node *node,
+	size_t line);
+
+/**
+ * @brief Returns the number of wrapped lines.
+ * @param node Node to query.
+ * @return Number of lines, at least one for a valid node.
+ */
+size_t wlf_paragraph_node_get_line_count(
+	const struct wlf_paragraph_node *node);
+
+/**
+ * @brief Changes the text color without reshaping any line.
+ * @param node Node to update.
+ * @param color New text color.
+ */
+void wlf_paragraph_node_set_color(struct wlf_paragraph_node *node,
+	const struct wlf_color *color);
+
+/**
+ * @brief Checks whether a scene node is a paragraph node.
+ * @param node Node to test.
+ * @return true if @p node was created by wlf_paragraph_node_create().
+ */
+bool wlf_scene_node_is_paragraph(const struct wlf_scene_node *node);
+
+/**
+ * @brief Converts a scene node to its paragraph node.
+ * @param node Scene node for which wlf_scene_node_is_paragraph() is true.
+ * @return Containing paragraph node.
+ */
+struct wlf_paragraph_node *wlf_paragraph_node_from_node(
+	struct wlf_scene_node *node);
+
+#endif // SCENE_WLF_PARAGRAPH_NODE_H
@@ -10,6 +10,8 @@
  * @par Copyright(c):
  * @par History:
  *      version: v1.0, YaoBing Xiao, 2026-08-05, initial version\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, rasterize text lazily after scale changes\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, rasterize stale text once it scrolls into view\n
  */
 
 #ifndef SCENE_WLF_SCENE_H
@@ -27,6 +29,7 @@ struct wlf_window;
 struct wlf_scene_tree;
 struct wlf_rect_pass;
 struct wlf_texture_pass;
+struct wlf_text_pass;
 struct wlf_rect_shape_pass;
 struct wlf_circle_pass;
 struct wlf_ellipse_pass;
@@ -35,6 +38,9 @@ struct wlf_poly_pass;
 struct wlf_path_pass;
 struct wlf_titlebar;
 
+/** Number of stale text nodes rasterized again per frame after a scale change. */
+#define WLF_SCENE_STALE_TEXT_BUDGET 64
+
 /**
  * @brief Scene damage visualization mode, compatible with wlroots semantics.
  *
@@ -66,9 +72,12 @@ struct wlf_scene {
 	struct wlf_linked_list damage_highlight_regions; /**< Temporary highlight regions. */
 	struct wlf_array render_list; /**< Reused array of struct wlf_render_list_entry. */
 	bool frame_scheduled; /**< True after requesting a frame and before the next expose callback. */
+	struct wlf_linked_list stale_text; /**< Text nodes rasterized at an old window scale. */
+	bool stale_text_visible; /**< Whether stale_text holds on-screen nodes that need a frame. */
 
 	struct wlf_rect_pass *rect_pass; /**< Solid rectangle pass. */
 	struct wlf_texture_pass *texture_pass; /**< Texture pass. */
+	struct wlf_text_pass *text_pass; /**< Glyph-atlas text pass, NULL when unavailable. */
 	struct wlf_rect_shape_pass *rect_shape_pass; /**< Rectangle-shape pass. */
 	struct wlf_circle_pass *circle_pass; /**< Circle pass. */
 	struct wlf_ellipse_pass *ellipse_pass; /**< Ellipse pass. */
@@ -147,7 +156,8 @@ void wlf_scene_set_debug_damage(struct wlf_scene *scene,
 /**
  * @brief Returns whether a scene commit has work to do.
  *
- * A scene needs a frame when it has pending damage or a scheduled frame.
+ * A scene needs a frame when it has pending damage or a scheduled frame,
+ * or when on-screen text still has to be rasterized at a new scale.
  *
  * @param scene Scene to inspect.
  * @return true when a frame is pending, false otherwise.
@@ -158,6 +168,10 @@ bool wlf_scene_needs_frame(const struct wlf_scene *scene);
  * @brief Renders accumulated damage and presents the window swapchain.
  *
  * On success, the committed damage is removed from the scene's pending region.
+ * Text nodes left stale by a scale change are rasterized first, on-screen
+ * ones only and at most WLF_SCENE_STALE_TEXT_BUDGET per frame; the others
+ * keep drawing their old raster scaled to the new scale meanwhile. Off-screen
+ * stale nodes are checked again on every commit and rasterized once visible.
  *
  * @param scene Scene to commit.
  * @return true when the frame was rendered and submitted, false on failure.
@@ -176,6 +190,17 @@ bool wlf_scene_commit(struct wlf_scene *scene);
 bool wlf_scene_set_client_side_decorated(struct wlf_scene *scene,
 	bool enabled);
 
+/**
+ * @brief Requests a frame callback without adding damage.
+ *
+ * Animations use this to keep receiving frame-done events while they wait for
+ * their next frame to become due. Duplicate requests before the next expose
+ * are coalesced.
+ *
+ * @param scene Scene requesting a frame.
+ */
+void wlf_scene_schedule_frame(struct wlf_scene *scene);
+
 /**
  * @brief Notifies scene consumers that the frame timestamp has been reached.
  *
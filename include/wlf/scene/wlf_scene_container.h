@@ -0,0 +1,85 @@
+/**
+ * @file        wlf_scene_container.h
+ * @brief       Shared callbacks for composite scene nodes.
+ * @details     Composite nodes, such as SVG, editable text and paragraph
+ *              nodes, draw nothing themselves and keep their content in
+ *              child nodes. Their wlf_scene_node_impl can use these
+ *              callbacks for everything that only walks the children
+ *              returned by get_children.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ */
+
+#ifndef SCENE_WLF_SCENE_CONTAINER_H
+#define SCENE_WLF_SCENE_CONTAINER_H
+
+#include "wlf/scene/wlf_scene_node.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Destroys every child of a composite node.
+ * @param node Composite node.
+ */
+void wlf_scene_container_destroy_children(struct wlf_scene_node *node);
+
+/**
+ * @brief Damages a band of a composite node after moving children in place.
+ * @details Children repositioned by writing their state directly skip the
+ *          per-node visibility pass of wlf_scene_node_set_position(). This
+ *          recalculates visibility once and damages the band instead.
+ * @param node Composite node.
+ * @param y Top of the band, relative to the node.
+ * @param width Width of the band.
+ * @param height Height of the band.
+ */
+void wlf_scene_container_damage_band(struct wlf_scene_node *node, int y,
+	uint32_t width, uint32_t height);
+
+/**
+ * @brief set_opacity callback applying the opacity to every child.
+ */
+void wlf_scene_container_set_opacity(struct wlf_scene_node *node, float opacity);
+
+/**
+ * @brief get_size callback returning the size stored in the node state.
+ */
+void wlf_scene_container_get_size(struct wlf_scene_node *node,
+	uint32_t *width, uint32_t *height);
+
+/**
+ * @brief invisible callback; a composite node has nothing of its own to draw.
+ */
+bool wlf_scene_container_invisible(struct wlf_scene_node *node);
+
+/**
+ * @brief visibility callback visiting every enabled child.
+ */
+void wlf_scene_container_visibility(struct wlf_scene_node *node,
+	pixman_region32_t *visible);
+
+/**
+ * @brief at callback returning the topmost child under a point.
+ */
+struct wlf_scene_node *wlf_scene_container_at(struct wlf_scene_node *node,
+	double lx, double ly, double *nx, double *ny);
+
+/**
+ * @brief bounds callback accumulating the bounds of every child.
+ */
+void wlf_scene_container_bounds(struct wlf_scene_node *node,
+	int x, int y, pixman_region32_t *visible);
+
+/**
+ * @brief in_box callback visiting the children from the top down.
+ */
+bool wlf_scene_container_in_box(struct wlf_scene_node *node,
+	struct wlf_frect *box, scene_node_box_iterator_func_t iterator,
+	void *user_data);
+
+#endif // SCENE_WLF_SCENE_CONTAINER_H
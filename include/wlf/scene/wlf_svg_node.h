@@ -18,19 +18,33 @@
 
 #include "wlf/scene/wlf_scene_node.h"
 #include "wlf/svg/wlf_svg.h"
+#include "wlf/utils/wlf_signal.h"
+
+struct wlf_svg_document;
+struct wlf_texture_node;
 
 /**
  * A composite scene node backed by a parsed SVG image.
  *
- * The node owns @ref image and exposes its generated scene children through
- * @ref children. SVG geometry is represented by regular wlframe shape and text
- * nodes, so rendering, damage tracking and hit testing use the normal scene
- * pipeline on every renderer backend.
+ * The node owns @ref image, or shares it read-only through @ref document, and
+ * exposes its generated scene children through @ref children. SVG geometry is
+ * represented by regular wlframe shape and text nodes, so rendering, damage
+ * tracking and hit testing use the normal scene pipeline on every renderer
+ * backend. A rasterized node instead has a single texture child, see
+ * wlf_svg_node_set_rasterized().
+ *
+ * The opacity of the node applies to all of its children.
  */
 struct wlf_svg_node {
 	struct wlf_scene_node base;
 	struct wlf_linked_list children;
 	struct wlf_svg_image *image;
+	/** Cached document sharing @ref image, or NULL when the node owns it. */
+	struct wlf_svg_document *document;
+	/** Texture child while rasterized, otherwise NULL. */
+	struct wlf_texture_node *raster;
+	double raster_scale;
+	struct wlf_listener window_scale;
 };
 
 /**
@@ -49,6 +63,36 @@ struct wlf_svg_node {
 struct wlf_svg_node *wlf_svg_node_create(struct wlf_scene_node *parent,
 	int x, int y, struct wlf_svg_image *image);
 
+/**
+ * Creates an SVG node sharing a cached document.
+ *
+ * The node takes its own reference to @p document and never modifies its
+ * image, so one parsed document can back any number of nodes.
+ *
+ * @param parent Parent container node.
+ * @param x Horizontal position relative to the parent.
+ * @param y Vertical position relative to the parent.
+ * @param document Document returned by wlf_svg_cache_parse().
+ * @return A new SVG node, or NULL on failure.
+ */
+struct wlf_svg_node *wlf_svg_node_create_from_document(
+	struct wlf_scene_node *parent, int x, int y,
+	struct wlf_svg_document *document);
+
+/**
+ * Switches between shape-node children and a single rasterized texture.
+ *
+ * A rasterized node draws its geometry once on the CPU at the window scale
+ * and shows it through one texture node, which is cheaper for small icons
+ * than a subtree of shape nodes. The texture is redrawn when the window scale
+ * changes. Images containing text cannot be rasterized.
+ *
+ * @param node SVG node to update.
+ * @param rasterized true to rasterize, false to rebuild the shape children.
+ * @return true on success. On failure the node keeps its previous mode.
+ */
+bool wlf_svg_node_set_rasterized(struct wlf_svg_node *node, bool rasterized);
+
 /**
  * Parses a file and creates an SVG node.
  *
@@ -9,11 +9,14 @@
  * @par Copyright(c):
  * @par History:
  *      version: v1.0, YaoBing Xiao, 2026-08-05, initial version\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, draw from a glyph atlas or a tinted mask\n
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, rasterize lazily after scale changes\n
  */
 
 #ifndef SCENE_WLF_TEXT_NODE_H
 #define SCENE_WLF_TEXT_NODE_H
 
+#include "wlf/pass/wlf_text_pass.h"
 #include "wlf/pass/wlf_texture_pass.h"
 #include "wlf/platform/wlf_text.h"
 #include "wlf/scene/wlf_scene_node.h"
@@ -23,8 +26,18 @@
 /**
  * @brief A scene node containing rasterized UTF-8 text.
  *
- * Text is shaped and rasterized through the platform text implementation into a
- * renderer texture owned by the node.
+ * When the scene has a text pass and the platform text implementation can
+ * shape glyph runs, the node keeps its shaped glyphs and draws them as quads
+ * from the scene's shared glyph atlas; changing the text then only reshapes
+ * it, and changing the color only repaints it. Otherwise text is rasterized
+ * through the platform text implementation into a single-channel coverage
+ * texture owned by the node, which is tinted with the node color when drawn,
+ * so color changes do not rasterize either.
+ *
+ * A window scale change does not rasterize the node right away. The node
+ * joins its scene's stale_text list and keeps drawing its old raster,
+ * scaled, until the scene rasterizes it when it is on screen, or until a
+ * property change rasterizes it anyway.
  */
 struct wlf_text_node {
 	struct wlf_scene_node base;
@@ -41,8 +54,17 @@ struct wlf_text_node {
 	struct wlf_text *text_context;
 	struct wlf_renderer *renderer;
 	struct wlf_texture *texture;
+	struct wlf_frect texture_box;
+	bool use_glyph_atlas;
+	struct wlf_text_glyph_run glyph_run;
+	struct wlf_text_quad *quads;
+	size_t quad_count;
+	size_t quad_capacity;
+	uint32_t quad_generation;
+	bool quads_valid;
 	struct wlf_listener renderer_destroy;
 	struct wlf_listener window_scale;
+	struct wlf_linked_list stale_link; /**< Link in the scene's stale_text list. */
 };
 
 /**
@@ -109,6 +131,13 @@ void wlf_text_node_set_font_style(struct wlf_text_node *node,
  */
 void wlf_text_node_set_max_width(struct wlf_text_node *node, int max_width);
 
+/**
+ * @brief Rasterizes a text node at its window scale if it is stale.
+ * @details The scene calls this for stale nodes before rendering a frame.
+ * @param node Text node to update.
+ */
+void wlf_text_node_update_scale(struct wlf_text_node *node);
+
 /**
  * @brief Checks whether a scene node is a text node.
  * @param node Scene node to inspect.
@@ -126,6 +155,8 @@ struct wlf_text_node *wlf_text_node_from_node(struct wlf_scene_node *node);
 
 /**
  * @brief Renders a text node through the supplied texture pass.
+ * @details Nodes drawn from the glyph atlas use the text pass of their scene
+ *          instead of @p pass.
  * @param node Text node to render.
  * @param pass Texture pass used for rendering.
  * @param render_target_info Destination render target.
@@ -18,6 +18,8 @@
 #include "wlf/scene/wlf_scene_node.h"
 #include "wlf/texture/wlf_texture.h"
 
+struct wlf_image_cache_entry;
+
 /**
  * @brief A scene-graph node displaying a renderer texture.
  *
@@ -27,6 +29,8 @@
 struct wlf_texture_node {
 	struct wlf_scene_node base;
 	struct wlf_texture *texture;
+	/** Cache entry owning @ref texture, or NULL when the node owns it. */
+	struct wlf_image_cache_entry *cache_entry;
 	enum wlf_scale_filter_mode filter_mode;
 	enum wlf_render_blend_mode blend_mode;
 	struct wlf_listener renderer_destroy;
@@ -48,6 +52,25 @@ struct wlf_texture_node *wlf_texture_node_create(
 	struct wlf_scene_node *parent, struct wlf_texture *texture,
 	int x, int y, uint32_t width, uint32_t height);
 
+/**
+ * @brief Creates a texture node showing a cached image.
+ * @details The node shares the entry's texture for @p renderer instead of
+ *          uploading its own copy, and holds a reference to @p entry until
+ *          it is destroyed or its texture is replaced.
+ * @param parent Parent scene node.
+ * @param entry Cache entry to display; the node takes its own reference.
+ * @param renderer Renderer the scene is drawn with.
+ * @param x Initial x position relative to @p parent.
+ * @param y Initial y position relative to @p parent.
+ * @param width Destination width, or zero for the natural width.
+ * @param height Destination height, or zero for the natural height.
+ * @return New texture node, or NULL on failure.
+ */
+struct wlf_texture_node *wlf_texture_node_create_from_cache(
+	struct wlf_scene_node *parent, struct wlf_image_cache_entry *entry,
+	struct wlf_renderer *renderer, int x, int y,
+	uint32_t width, uint32_t height);
+
 /**
  * @brief Replaces the owned texture.
  * @details Passing NULL makes the node invisible.
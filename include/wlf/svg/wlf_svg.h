@@ -7,7 +7,11 @@
  *              paints (solid colour and linear/radial gradients), and viewBox scaling.
  *
  *              Typical usage:
- *                  - Load an SVG with wlf_svg_parse_from_file() or wlf_svg_parse().
+ *                  - Load an SVG with wlf_svg_parse_from_file(),
+ *                    wlf_svg_parse_buffer() or, for data arriving in pieces,
+ *                    a wlf_svg_stream.
+ *                  - Load icons precompiled by wlf-svg-compile with
+ *                    wlf_svg_load_binary_from_file().
  *                  - Walk image->shapes / shape->paths to inspect geometry.
  *                  - Query summary metadata with wlf_svg_get_info().
  *                  - Free the image with wlf_svg_destroy() when done.
@@ -27,6 +31,9 @@
 #include "wlf/shapes/wlf_path_shape.h"
 #include "wlf/types/wlf_gradient.h"
 
+#include <stdbool.h>
+#include <stddef.h>
+
 enum wlf_svg_paint_type {
 	WLF_SVG_PAINT_UNDEF = -1,
 	WLF_SVG_PAINT_NONE = 0,
@@ -59,8 +66,7 @@ enum wlf_svg_fill_rule {
 };
 
 enum wlf_svg_flags {
-	WLF_SVG_FLAGS_VISIBLE = 0x01,
-	WLF_SVG_FLAGS_FROM_USE = 0x02
+	WLF_SVG_FLAGS_VISIBLE = 0x01
 };
 
 enum wlf_svg_paint_order {
@@ -211,13 +217,25 @@ struct wlf_svg_shape {
 	struct wlf_svg_shape *next;    /**< Next shape in the linked list, or NULL. */
 };
 
+struct wlf_svg_symbol_data;
+
+/**
+ * An instance of a \<symbol\> placed by \<use\>. The symbol shapes are
+ * shared by all instances and drawn translated by (x, y); use
+ * wlf_svg_for_each_shape() to visit them in paint order.
+ */
 struct wlf_svg_use_data {
 	char href[64];
-	float x;
+	float x;                             /**< Instance offset, scaled to pixel units. */
 	float y;
+	struct wlf_svg_symbol_data *symbol;  /**< Referenced symbol, NULL if it was not defined. */
+	struct wlf_shape *after;             /**< Shape of image->shapes painted just before the
+	                                          instance, NULL when the instance comes first. */
 	struct wlf_svg_use_data *next;
 };
 
+struct wlf_svg_arena;
+
 struct wlf_svg_image {
 	float width;                   /**< SVG canvas width in pixel units. */
 	float height;                  /**< SVG canvas height in pixel units. */
@@ -229,9 +247,16 @@ struct wlf_svg_image {
 	char height_attr[64];          /**< Raw height attribute text from root element. */
 	char view_box[128];            /**< Raw viewBox attribute text from root element. */
 	char preserve_aspect_ratio[64];/**< Raw preserveAspectRatio text from root element. */
-	struct wlf_shape *shapes;      /**< Linked list of shapes parsed from the SVG. */
+	/**
+	 * Linked list of the shapes drawn directly by the SVG. The shapes of
+	 * \<symbol\> content placed by \<use\> are not in it; walk the image
+	 * with wlf_svg_for_each_shape() to visit those too.
+	 */
+	struct wlf_shape *shapes;
 	struct wlf_svg_symbol_data *symbols; /**< Parsed <symbol> definitions. */
 	struct wlf_svg_use_data *uses; /**< Parsed <use> elements. */
+	struct wlf_svg_arena *arena;   /**< Block storage of the image, its shapes, paths, symbols
+	                                    and uses; NULL for images not built by the parser. */
 };
 
 /**
@@ -352,7 +377,21 @@ struct wlf_svg_symbol_data {
 	struct wlf_svg_symbol_data *next;       /**< Next symbol definition. */
 };
 
-/** Full parser state. Allocated and freed by wlf_svg_parse_from_file() / wlf_svg_parse(). */
+/** Slot of a wlf_svg_id_map; @c id points into the indexed definition. */
+struct wlf_svg_id_map_entry {
+	const char   *id;
+	unsigned int  hash;
+	void         *value;
+};
+
+/** Open-addressed index of gradient or symbol definitions by id. */
+struct wlf_svg_id_map {
+	struct wlf_svg_id_map_entry *entries;
+	unsigned int                 capacity; /**< Power of two, 0 before first insert. */
+	unsigned int                 count;
+};
+
+/** Full parser state. Allocated and freed by the wlf_svg_parse*() functions and wlf_svg_stream. */
 struct wlf_svg_parser {
 	struct wlf_svg_attrib              attr[WLF_SVG_MAX_ATTR];
 	int                         attrHead;
@@ -367,6 +406,9 @@ struct wlf_svg_parser {
 	struct wlf_svg_symbol_data *symbols;        /**< All parsed \<symbol\> definitions. */
 	struct wlf_svg_symbol_data *current_symbol; /**< Non-NULL while inside \<symbol\>. */
 	struct wlf_svg_use_data    *uses;           /**< All parsed \<use\> elements. */
+	struct wlf_svg_use_data    *uses_tail;      /**< Tail pointer for O(1) append. */
+	struct wlf_svg_id_map       gradient_ids;   /**< Gradients by id, newest wins. */
+	struct wlf_svg_id_map       symbol_ids;     /**< Symbols by id, newest wins. */
 	float viewMinx, viewMiny, viewWidth, viewHeight;
 	int   alignX, alignY, alignType;
 	float dpi;
@@ -393,13 +435,64 @@ struct wlf_svg_image *wlf_svg_parse_from_file(const char *filename,
 
 /**
  * @brief Parse an SVG buffer into wlframe SVG image data.
- * @param input Null-terminated SVG text buffer. This function modifies the buffer.
+ * @param input Null-terminated SVG text buffer. It is not modified.
  * @param units Target units (`px`, `pt`, `pc`, `mm`, `cm`, `in`).
  * @param dpi Dots per inch used for unit conversion.
  * @return Parsed image, or NULL on failure.
  */
 struct wlf_svg_image *wlf_svg_parse(char *input, const char *units, float dpi);
 
+/**
+ * @brief Parse SVG text of known length into wlframe SVG image data.
+ * @details The buffer is only read, so it may be read-only memory such as a
+ *          file mapping or a static icon string, and need not be terminated.
+ * @param data SVG text.
+ * @param size Number of bytes at @p data.
+ * @param units Target units (`px`, `pt`, `pc`, `mm`, `cm`, `in`), or NULL for `px`.
+ * @param dpi Dots per inch used for unit conversion.
+ * @return Parsed image, or NULL on failure.
+ */
+struct wlf_svg_image *wlf_svg_parse_buffer(const char *data, size_t size,
+	const char *units, float dpi);
+
+/** Incremental SVG parser, see wlf_svg_stream_create(). */
+struct wlf_svg_stream;
+
+/**
+ * @brief Start parsing an SVG document delivered in chunks.
+ * @details Feed the text with wlf_svg_stream_feed(), in pieces split at any
+ *          byte, then collect the image with wlf_svg_stream_finish(). Elements
+ *          are parsed as soon as their closing `>` arrives; only the tag in
+ *          progress is buffered.
+ * @param units Target units (`px`, `pt`, `pc`, `mm`, `cm`, `in`), or NULL for `px`.
+ * @param dpi Dots per inch used for unit conversion.
+ * @return New stream, or NULL on allocation failure.
+ */
+struct wlf_svg_stream *wlf_svg_stream_create(const char *units, float dpi);
+
+/**
+ * @brief Parse the next chunk of SVG text.
+ * @param stream Stream to feed.
+ * @param data Next bytes of the document; only read during the call.
+ * @param size Number of bytes at @p data.
+ * @return false if the stream failed; it must then be destroyed.
+ */
+bool wlf_svg_stream_feed(struct wlf_svg_stream *stream,
+	const char *data, size_t size);
+
+/**
+ * @brief Finish parsing and destroy the stream.
+ * @param stream Stream to finish.
+ * @return Parsed image, or NULL on failure.
+ */
+struct wlf_svg_image *wlf_svg_stream_finish(struct wlf_svg_stream *stream);
+
+/**
+ * @brief Abandon a stream without producing an image.
+ * @param stream Stream to destroy, may be NULL.
+ */
+void wlf_svg_stream_destroy(struct wlf_svg_stream *stream);
+
 /**
  * @brief Save a parsed SVG image back to an SVG file.
  * @param image Parsed SVG image.
@@ -408,6 +501,37 @@ struct wlf_svg_image *wlf_svg_parse(char *input, const char *units, float dpi);
  */
 bool wlf_svg_save(const struct wlf_svg_image *image, const char *filename);
 
+/**
+ * @brief Save a parsed SVG image in wlframe's binary SVG format.
+ * @details The binary form keeps the image as parsed, already scaled to its
+ *          viewBox with paths flattened and gradients resolved, so loading it
+ *          skips all text parsing. Bounds are recomputed on load, and the raw
+ *          root attributes and gradient ids are not kept, so wlf_svg_save()
+ *          writes a loaded image with default root attributes. Use it to
+ *          precompile icons at build time, e.g. with the wlf-svg-compile tool.
+ * @param image Parsed SVG image.
+ * @param filename Output file path.
+ * @return true on success, false on failure.
+ */
+bool wlf_svg_save_binary(const struct wlf_svg_image *image, const char *filename);
+
+/**
+ * @brief Load an image written by wlf_svg_save_binary().
+ * @details The data is validated and copied, so it may be read-only memory
+ *          and need not stay valid after the call.
+ * @param data Binary SVG data.
+ * @param size Number of bytes at @p data.
+ * @return Loaded image, or NULL if the data is not a valid binary SVG.
+ */
+struct wlf_svg_image *wlf_svg_load_binary(const void *data, size_t size);
+
+/**
+ * @brief Load a binary SVG file written by wlf_svg_save_binary().
+ * @param filename Binary SVG file path; the file is mapped, not read.
+ * @return Loaded image, or NULL on failure.
+ */
+struct wlf_svg_image *wlf_svg_load_binary_from_file(const char *filename);
+
 /**
  * @brief Duplicate a wlframe SVG path.
  * @param path Source path.
@@ -415,8 +539,35 @@ bool wlf_svg_save(const struct wlf_svg_image *image, const char *filename);
  */
 struct wlf_path *wlf_svg_path_duplicate(struct wlf_path *path);
 
+/**
+ * @brief Callback for wlf_svg_for_each_shape().
+ * @param shape Shape to draw. Instance shapes belong to a symbol and are
+ *        shared by all of its instances.
+ * @param x Horizontal offset to draw @p shape at; 0 outside instances.
+ * @param y Vertical offset to draw @p shape at; 0 outside instances.
+ * @param data User data passed to wlf_svg_for_each_shape().
+ * @return false to stop the iteration.
+ */
+typedef bool (*wlf_svg_shape_iterator_func_t)(struct wlf_svg_shape *shape,
+	float x, float y, void *data);
+
+/**
+ * @brief Visit the shapes of an image in paint order, including the shapes
+ *        of every \<use\> instance at their instance offset.
+ * @param image Parsed image.
+ * @param iterator Called for every shape.
+ * @param data User data passed to @p iterator.
+ * @return false if @p iterator stopped the iteration, true otherwise.
+ */
+bool wlf_svg_for_each_shape(const struct wlf_svg_image *image,
+	wlf_svg_shape_iterator_func_t iterator, void *data);
+
 /**
  * @brief Destroy a wlframe SVG image.
+ * @details Shapes, paths, symbols and uses are released together with the
+ *          image in a few frees; they must not be destroyed individually.
+ *          Copy out anything that has to outlive the image, e.g. with
+ *          wlf_shape_clone() or wlf_svg_path_duplicate().
  * @param image Parsed image to destroy.
  */
 void wlf_svg_destroy(struct wlf_svg_image *image);
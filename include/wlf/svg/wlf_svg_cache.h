@@ -0,0 +1,129 @@
+/**
+ * @file        wlf_svg_cache.h
+ * @brief       Shared cache of parsed SVG documents.
+ * @details     A wlf_svg_cache keeps parsed wlf_svg_image documents keyed by
+ *              their source text and a caller-chosen variant tag (for example
+ *              the theme appearance an icon was written for), so that icons
+ *              embedded in the toolkit are parsed once per process instead of
+ *              once per window and theme change.
+ *
+ *              Documents are reference counted and shared read-only. Documents
+ *              nobody references stay resident on an LRU list, and the least
+ *              recently used ones are released once more than the cache
+ *              capacity are idle.
+ *
+ *              Typical usage:
+ *                  - Look up a document with wlf_svg_cache_parse().
+ *                  - Show it with wlf_svg_node_create_from_document(), which
+ *                    takes its own reference.
+ *                  - Drop the reference with wlf_svg_document_unref().
+ *
+ * @note        A cache is not thread-safe; use it from the event loop thread.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ */
+
+#ifndef SVG_WLF_SVG_CACHE_H
+#define SVG_WLF_SVG_CACHE_H
+
+#include "wlf/svg/wlf_svg.h"
+
+#include <stdint.h>
+
+/** Idle documents kept by the cache returned by wlf_svg_cache_get_default(). */
+#define WLF_SVG_CACHE_DEFAULT_CAPACITY 64
+
+struct wlf_svg_cache;
+struct wlf_svg_document;
+
+/**
+ * @brief Cache counters, see wlf_svg_cache_get_stats().
+ */
+struct wlf_svg_cache_stats {
+	uint64_t hits;            /**< Lookups served from the cache */
+	uint64_t misses;          /**< Lookups that had to parse */
+	uint64_t evictions;       /**< Idle documents released to stay within capacity */
+	uint32_t document_count;  /**< Documents resident, referenced or not */
+	uint32_t capacity;        /**< Current capacity */
+};
+
+/**
+ * @brief Creates an SVG document cache.
+ * @param capacity Maximum number of unreferenced documents kept.
+ * @return New cache, or NULL on allocation failure.
+ */
+struct wlf_svg_cache *wlf_svg_cache_create(uint32_t capacity);
+
+/**
+ * @brief Destroys a cache.
+ * @details Unreferenced documents are released immediately. Documents still
+ *          referenced stay valid and are released by their last unref.
+ * @param cache Cache to destroy, may be NULL.
+ */
+void wlf_svg_cache_destroy(struct wlf_svg_cache *cache);
+
+/**
+ * @brief Returns the process-wide cache, creating it on first use.
+ * @details Its capacity starts at @ref WLF_SVG_CACHE_DEFAULT_CAPACITY.
+ * @return The shared cache, or NULL on allocation failure.
+ */
+struct wlf_svg_cache *wlf_svg_cache_get_default(void);
+
+/**
+ * @brief Changes the number of idle documents kept, releasing some if needed.
+ * @param cache Cache to update.
+ * @param capacity New capacity; 0 keeps only referenced documents.
+ */
+void wlf_svg_cache_set_capacity(struct wlf_svg_cache *cache, uint32_t capacity);
+
+/**
+ * @brief Looks up or parses an SVG document.
+ * @param cache Cache to use.
+ * @param source NUL-terminated SVG text; only read during the call.
+ * @param variant Optional tag distinguishing otherwise identical lookups,
+ *        e.g. "light" and "dark", or NULL.
+ * @param units Output units passed to the SVG parser, or NULL for pixels.
+ * @param dpi Resolution passed to the SVG parser.
+ * @return Referenced document, or NULL if the source cannot be parsed.
+ */
+struct wlf_svg_document *wlf_svg_cache_parse(struct wlf_svg_cache *cache,
+	const char *source, const char *variant, const char *units, float dpi);
+
+/**
+ * @brief Reads the cache counters.
+ * @param cache Cache to query.
+ * @param stats Receives the counters.
+ */
+void wlf_svg_cache_get_stats(const struct wlf_svg_cache *cache,
+	struct wlf_svg_cache_stats *stats);
+
+/**
+ * @brief Takes an additional reference to a document.
+ * @param document Document to reference.
+ * @return @p document.
+ */
+struct wlf_svg_document *wlf_svg_document_ref(struct wlf_svg_document *document);
+
+/**
+ * @brief Drops a reference to a document.
+ * @details The document stays cached and becomes eligible for release once
+ *          the last reference is gone.
+ * @param document Document to release, may be NULL.
+ */
+void wlf_svg_document_unref(struct wlf_svg_document *document);
+
+/**
+ * @brief Returns the parsed image of a document.
+ * @details The image is shared by every user of the document. It must not be
+ *          modified or passed to wlf_svg_destroy().
+ * @param document Referenced document.
+ * @return Image owned by the document.
+ */
+struct wlf_svg_image *wlf_svg_document_get_image(
+	const struct wlf_svg_document *document);
+
+#endif // SVG_WLF_SVG_CACHE_H
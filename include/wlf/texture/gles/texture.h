@@ -47,6 +47,7 @@ struct wlf_gles_texture {
 	struct wlf_gles_renderer *renderer; /**< Renderer owning the GL object. */
 	struct wlf_linked_list link; /**< Link in the renderer texture list. */
 	GLuint tex; /**< GLES texture object. */
+	uint32_t drm_format; /**< DRM fourcc format of the uploaded pixels. */
 };
 
 /**
@@ -0,0 +1,126 @@
+/**
+ * @file        wlf_file_source.h
+ * @brief       Encoded image input shared by the image decoders.
+ * @details     A wlf_file_source exposes the complete encoded bytes of an
+ *              image as one contiguous, read-only range. File inputs are
+ *              memory-mapped, so decoders parse the page cache directly
+ *              instead of copying the file through stdio into a heap buffer;
+ *              where mapping is unavailable the file is read once into memory.
+ *              Memory inputs borrow a caller-supplied buffer, which lets
+ *              embedded resources be decoded without a temporary file.
+ *
+ *              The source also carries a read cursor with small helpers for
+ *              decoders that consume headers sequentially.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ */
+
+#ifndef UTILS_WLF_FILE_SOURCE_H
+#define UTILS_WLF_FILE_SOURCE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Contiguous read-only bytes with a read cursor.
+ */
+struct wlf_file_source {
+	const uint8_t *data;  /**< First byte, NULL when @ref size is 0 */
+	size_t size;          /**< Number of bytes at @ref data */
+	size_t offset;        /**< Read cursor used by the helpers below */
+	const char *name;     /**< File name or "memory", used in log messages */
+
+	void *mapping;        /**< File mapping to release, or NULL */
+	size_t mapping_size;  /**< Length of @ref mapping */
+	void *buffer;         /**< Heap copy to release, or NULL */
+};
+
+/**
+ * @brief Opens a file as a source.
+ * @details The file is memory-mapped read-only. When mapping is not possible
+ *          (unsupported platform, pipes, special files) the file is read into
+ *          a heap buffer instead.
+ * @param source Source to initialize.
+ * @param filename Path of the file to open. It must outlive @p source.
+ * @return true on success, false if the file cannot be opened or read.
+ */
+bool wlf_file_source_init_from_file(struct wlf_file_source *source,
+	const char *filename);
+
+/**
+ * @brief Wraps a caller-owned buffer as a source.
+ * @param source Source to initialize.
+ * @param data Bytes to read. The buffer is borrowed, not copied, and
+ *        must stay valid until @p source is finished.
+ * @param size Number of bytes at @p data.
+ */
+void wlf_file_source_init_from_memory(struct wlf_file_source *source,
+	const void *data, size_t size);
+
+/**
+ * @brief Releases a source's mapping or buffer.
+ * @param source Source to finish, may be NULL.
+ */
+void wlf_file_source_finish(struct wlf_file_source *source);
+
+/**
+ * @brief Copies bytes at the cursor and advances it.
+ * @param source Source to read from.
+ * @param dst Destination buffer.
+ * @param len Number of bytes wanted.
+ * @return Number of bytes copied, smaller than @p len at the end of input.
+ */
+size_t wlf_file_source_read(struct wlf_file_source *source, void *dst, size_t len);
+
+/**
+ * @brief Returns the bytes at the cursor without copying and advances it.
+ * @param source Source to read from.
+ * @param len Number of bytes wanted.
+ * @return Pointer to @p len bytes, or NULL if fewer remain. The cursor is
+ *         left unchanged on failure.
+ */
+const uint8_t *wlf_file_source_take(struct wlf_file_source *source, size_t len);
+
+/**
+ * @brief Moves the cursor to an absolute offset.
+ * @param source Source to update.
+ * @param offset New cursor position.
+ * @return true on success, false if @p offset is past the end of input.
+ */
+bool wlf_file_source_seek(struct wlf_file_source *source, size_t offset);
+
+/**
+ * @brief Returns the number of bytes after the cursor.
+ */
+static inline size_t wlf_file_source_remaining(const struct wlf_file_source *source) {
+	return source->size - source->offset;
+}
+
+/**
+ * @brief Returns the byte at the cursor without consuming it.
+ * @return The byte value, or -1 at the end of input.
+ */
+static inline int wlf_file_source_peek(const struct wlf_file_source *source) {
+	if (source->offset >= source->size) {
+		return -1;
+	}
+	return source->data[source->offset];
+}
+
+/**
+ * @brief Consumes and returns the byte at the cursor.
+ * @return The byte value, or -1 at the end of input.
+ */
+static inline int wlf_file_source_getc(struct wlf_file_source *source) {
+	if (source->offset >= source->size) {
+		return -1;
+	}
+	return source->data[source->offset++];
+}
+
+#endif // UTILS_WLF_FILE_SOURCE_H
@@ -0,0 +1,41 @@
+/**
+ * @file        wlf_hash.h
+ * @brief       Non-cryptographic hashing helpers for wlframe.
+ * @details     64-bit FNV-1a, used to key hash tables and caches. Hashes can
+ *              be chained: pass the result of one call as @p hash of the next
+ *              to hash several fields into one key.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ */
+
+#ifndef UTILS_WLF_HASH_H
+#define UTILS_WLF_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Initial hash value (the FNV-1a 64-bit offset basis). */
+#define WLF_HASH_INIT UINT64_C(0xcbf29ce484222325)
+
+/**
+ * @brief Hashes a byte range.
+ * @param hash WLF_HASH_INIT, or the result of a previous hash call.
+ * @param data Bytes to hash.
+ * @param size Number of bytes at @p data.
+ * @return Updated hash.
+ */
+uint64_t wlf_hash_bytes(uint64_t hash, const void *data, size_t size);
+
+/**
+ * @brief Hashes a NUL-terminated string, without its terminator.
+ * @param hash WLF_HASH_INIT, or the result of a previous hash call.
+ * @param str String to hash.
+ * @return Updated hash.
+ */
+uint64_t wlf_hash_string(uint64_t hash, const char *str);
+
+#endif // UTILS_WLF_HASH_H
@@ -0,0 +1,156 @@
+/**
+ * @file        wlf_lru_table.h
+ * @brief       Reference-counted hash table with LRU eviction.
+ * @details     A wlf_lru_table indexes caller-defined entries by a 64-bit
+ *              hash. Entries are reference counted. Unreferenced entries stay
+ *              resident on an LRU list and are evicted, least recently used
+ *              first, while the table is over its budget. Referenced entries
+ *              are never evicted.
+ *
+ *              Each entry has a cost, such as its size in bytes or simply 1,
+ *              and the budget limits either the cost of all resident entries
+ *              or only the cost of the unreferenced ones.
+ *
+ *              Callers embed struct wlf_lru_entry in their entry type, look
+ *              entries up with wlf_lru_table_find() and free them in
+ *              wlf_lru_table_impl.destroy.
+ * @note        A table is not thread-safe.
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ */
+
+#ifndef UTILS_WLF_LRU_TABLE_H
+#define UTILS_WLF_LRU_TABLE_H
+
+#include "wlf/utils/wlf_linked_list.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct wlf_lru_entry;
+
+/**
+ * @brief Callbacks of a table.
+ */
+struct wlf_lru_table_impl {
+	/** Frees an entry once it is evicted or no longer referenced. */
+	void (*destroy)(struct wlf_lru_entry *entry);
+};
+
+/**
+ * @brief Hash table of reference-counted entries.
+ */
+struct wlf_lru_table {
+	const struct wlf_lru_table_impl *impl;
+	struct wlf_lru_entry **buckets;
+	size_t bucket_count;          /**< Power of two */
+	uint32_t entry_count;         /**< Resident entries, referenced or not */
+
+	/** Unreferenced entries, most recently used first. */
+	struct wlf_linked_list lru;
+
+	size_t budget;
+	bool budget_idle_only;        /**< Whether referenced entries are outside the budget */
+	size_t resident_cost;         /**< Cost of all resident entries */
+	size_t idle_cost;             /**< Cost of the unreferenced entries */
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+};
+
+/**
+ * @brief Header embedded in each entry of a table.
+ */
+struct wlf_lru_entry {
+	struct wlf_lru_table *table;  /**< NULL once evicted or the table is finished */
+	const struct wlf_lru_table_impl *impl;
+	struct wlf_lru_entry *hash_next;
+	struct wlf_linked_list lru_link; /**< wlf_lru_table.lru while unreferenced */
+	uint64_t hash;
+	uint32_t refcount;
+	size_t cost;
+};
+
+/**
+ * @brief Initializes a table.
+ * @param table Table to initialize.
+ * @param impl Callbacks, must outlive every entry of the table.
+ * @param bucket_count Initial number of buckets, a power of two.
+ * @param budget Maximum cost kept, see @p budget_idle_only.
+ * @param budget_idle_only true to limit the cost of unreferenced entries
+ *        only, false to count referenced entries as well.
+ * @return true on success, false on allocation failure.
+ */
+bool wlf_lru_table_init(struct wlf_lru_table *table,
+	const struct wlf_lru_table_impl *impl, size_t bucket_count,
+	size_t budget, bool budget_idle_only);
+
+/**
+ * @brief Releases a table.
+ * @details Unreferenced entries are destroyed immediately. Entries still
+ *          referenced stay valid and are destroyed by their last unref.
+ * @param table Table to release.
+ */
+void wlf_lru_table_finish(struct wlf_lru_table *table);
+
+/**
+ * @brief Changes the budget, evicting entries if needed.
+ * @param table Table to update.
+ * @param budget New budget; 0 keeps only referenced entries.
+ */
+void wlf_lru_table_set_budget(struct wlf_lru_table *table, size_t budget);
+
+/**
+ * @brief Looks up an entry and references it.
+ * @details Counts a hit when an entry is found and a miss otherwise.
+ * @param table Table to search.
+ * @param hash Hash of the key.
+ * @param matches Returns whether an entry with the same hash has @p key.
+ * @param key Key passed to @p matches.
+ * @return Referenced entry, or NULL if none matches.
+ */
+struct wlf_lru_entry *wlf_lru_table_find(struct wlf_lru_table *table,
+	uint64_t hash, bool (*matches)(const struct wlf_lru_entry *entry,
+	const void *key), const void *key);
+
+/**
+ * @brief Adds a new entry with one reference.
+ * @details The table may grow; a failed grow only makes lookups slower.
+ *          Unreferenced entries are evicted if the table is now over budget.
+ * @param table Table to add to.
+ * @param entry Entry to add, not in any table yet.
+ * @param hash Hash of the entry's key.
+ * @param cost Initial cost of the entry.
+ */
+void wlf_lru_table_insert(struct wlf_lru_table *table,
+	struct wlf_lru_entry *entry, uint64_t hash, size_t cost);
+
+/**
+ * @brief Changes the cost of an entry, evicting other entries if needed.
+ * @param entry Entry to update.
+ * @param cost New cost.
+ */
+void wlf_lru_entry_set_cost(struct wlf_lru_entry *entry, size_t cost);
+
+/**
+ * @brief Takes an additional reference to an entry.
+ * @param entry Entry to reference.
+ * @return @p entry.
+ */
+struct wlf_lru_entry *wlf_lru_entry_ref(struct wlf_lru_entry *entry);
+
+/**
+ * @brief Drops a reference to an entry.
+ * @details The entry stays resident and becomes eligible for eviction once
+ *          the last reference is gone. Entries whose table was finished are
+ *          destroyed instead.
+ * @param entry Entry to release, may be NULL.
+ */
+void wlf_lru_entry_unref(struct wlf_lru_entry *entry);
+
+#endif // UTILS_WLF_LRU_TABLE_H
@@ -0,0 +1,14 @@
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+
+uniform sampler2D tex;
+uniform float opacity;
+uniform vec4 color;
+varying vec2 v_texcoord;
+
+void main() {
+	gl_FragColor = color * (texture2D(tex, v_texcoord).r * opacity);
+}
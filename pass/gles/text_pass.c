@@ -0,0 +1,277 @@
+#include "wlf/pass/gles/text_pass.h"
+
+#include "wlf/pass/gles/render_target_info.h"
+#include "wlf/renderer/gles/renderer.h"
+#include "wlf/utils/wlf_log.h"
+
+#include "text_frag_src.h"
+#include "text_vert_src.h"
+
+#include <GLES2/gl2.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+struct text_vertex {
+	float x, y;
+	float u, v;
+};
+
+struct wlf_gles_text_pass {
+	struct wlf_text_pass base;
+	GLuint program;
+	GLint attrib_pos;
+	GLint attrib_texcoord;
+	GLint uniform_viewport;
+	GLint uniform_texture;
+	GLint uniform_color;
+
+	GLuint atlas_tex; /* Created on first render */
+	struct text_vertex *vertices; /* Reused between renders */
+	size_t vertex_capacity;
+};
+
+static GLuint compile_shader(GLenum type, const char *source) {
+	GLuint shader = glCreateShader(type);
+	if (shader == 0) {
+		wlf_log(WLF_ERROR, "glCreateShader failed: %s",
+			wlf_gles_error_str(glGetError()));
+		return 0;
+	}
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	GLint ok = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+	if (ok != GL_TRUE) {
+		char log[512] = {0};
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		wlf_log(WLF_ERROR, "failed to compile GLES text shader: %s", log);
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+static bool link_program(struct wlf_gles_text_pass *pass) {
+	GLuint vert = compile_shader(GL_VERTEX_SHADER, text_vert_src);
+	GLuint frag = compile_shader(GL_FRAGMENT_SHADER, text_frag_src);
+	if (vert == 0 || frag == 0) {
+		glDeleteShader(vert);
+		glDeleteShader(frag);
+		return false;
+	}
+
+	pass->program = glCreateProgram();
+	if (pass->program == 0) {
+		glDeleteShader(vert);
+		glDeleteShader(frag);
+		return false;
+	}
+	glAttachShader(pass->program, vert);
+	glAttachShader(pass->program, frag);
+	glBindAttribLocation(pass->program, 0, "pos");
+	glBindAttribLocation(pass->program, 1, "texcoord");
+	glLinkProgram(pass->program);
+	glDeleteShader(vert);
+	glDeleteShader(frag);
+	GLint ok = GL_FALSE;
+	glGetProgramiv(pass->program, GL_LINK_STATUS, &ok);
+	if (ok != GL_TRUE) {
+		char log[512] = {0};
+		glGetProgramInfoLog(pass->program, sizeof(log), NULL, log);
+		wlf_log(WLF_ERROR, "failed to link GLES text program: %s", log);
+		glDeleteProgram(pass->program);
+		pass->program = 0;
+		return false;
+	}
+
+	pass->attrib_pos = glGetAttribLocation(pass->program, "pos");
+	pass->attrib_texcoord = glGetAttribLocation(pass->program, "texcoord");
+	pass->uniform_viewport = glGetUniformLocation(pass->program, "viewport");
+	pass->uniform_texture = glGetUniformLocation(pass->program, "tex");
+	pass->uniform_color = glGetUniformLocation(pass->program, "color");
+	bool locations_ok = pass->attrib_pos >= 0 && pass->attrib_texcoord >= 0 &&
+		pass->uniform_viewport >= 0 && pass->uniform_texture >= 0 &&
+		pass->uniform_color >= 0;
+	if (!locations_ok) {
+		wlf_log(WLF_ERROR, "failed to query GLES text program locations");
+		glDeleteProgram(pass->program);
+		pass->program = 0;
+	}
+	return locations_ok;
+}
+
+static void text_pass_destroy(struct wlf_text_pass *base) {
+	struct wlf_gles_text_pass *pass = wlf_container_of(base, pass, base);
+	if (pass->atlas_tex != 0) {
+		glDeleteTextures(1, &pass->atlas_tex);
+	}
+	if (pass->program != 0) {
+		glDeleteProgram(pass->program);
+	}
+	free(pass->vertices);
+	free(pass);
+}
+
+/* Creates the atlas texture on first use and uploads the rows written since
+ * the previous render. GLES2 cannot upload a sub-rectangle of a wider image,
+ * so whole rows are uploaded; the atlas keeps them tightly packed. */
+static bool upload_atlas(struct wlf_gles_text_pass *pass) {
+	uint32_t width, height;
+	const uint8_t *pixels = wlf_glyph_atlas_get_data(pass->base.atlas,
+		&width, &height);
+	uint32_t y, rows;
+	bool damaged = wlf_glyph_atlas_take_damage(pass->base.atlas, &y, &rows);
+
+	glActiveTexture(GL_TEXTURE0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (pass->atlas_tex == 0) {
+		glGenTextures(1, &pass->atlas_tex);
+		glBindTexture(GL_TEXTURE_2D, pass->atlas_tex);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, width, height, 0,
+			GL_ALPHA, GL_UNSIGNED_BYTE, pixels);
+	} else {
+		glBindTexture(GL_TEXTURE_2D, pass->atlas_tex);
+		if (damaged) {
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, width, rows,
+				GL_ALPHA, GL_UNSIGNED_BYTE, &pixels[(size_t)y * width]);
+		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	GLenum error = glGetError();
+	if (error != GL_NO_ERROR) {
+		wlf_log(WLF_ERROR, "GLES glyph atlas upload failed: %s",
+			wlf_gles_error_str(error));
+		return false;
+	}
+	return true;
+}
+
+static bool build_vertices(struct wlf_gles_text_pass *pass,
+		const struct wlf_render_text_options *options) {
+	size_t vertex_count = options->quad_count * 6;
+	if (vertex_count > pass->vertex_capacity) {
+		struct text_vertex *vertices = realloc(pass->vertices,
+			vertex_count * sizeof(*vertices));
+		if (vertices == NULL) {
+			wlf_log_errno(WLF_ERROR, "failed to allocate text vertices");
+			return false;
+		}
+		pass->vertices = vertices;
+		pass->vertex_capacity = vertex_count;
+	}
+
+	uint32_t width, height;
+	wlf_glyph_atlas_get_data(pass->base.atlas, &width, &height);
+	struct text_vertex *v = pass->vertices;
+	for (size_t i = 0; i < options->quad_count; i++) {
+		const struct wlf_text_quad *quad = &options->quads[i];
+		float x1 = quad->dst_box.x + options->offset_x;
+		float y1 = quad->dst_box.y + options->offset_y;
+		float x2 = x1 + quad->dst_box.width;
+		float y2 = y1 + quad->dst_box.height;
+		float u1 = (float)quad->src_box.x / width;
+		float v1 = (float)quad->src_box.y / height;
+		float u2 = (float)(quad->src_box.x + quad->src_box.width) / width;
+		float v2 = (float)(quad->src_box.y + quad->src_box.height) / height;
+		*v++ = (struct text_vertex){ x1, y1, u1, v1 };
+		*v++ = (struct text_vertex){ x2, y1, u2, v1 };
+		*v++ = (struct text_vertex){ x1, y2, u1, v2 };
+		*v++ = (struct text_vertex){ x2, y1, u2, v1 };
+		*v++ = (struct text_vertex){ x2, y2, u2, v2 };
+		*v++ = (struct text_vertex){ x1, y2, u1, v2 };
+	}
+	return true;
+}
+
+static void text_pass_render(struct wlf_text_pass *base,
+		struct wlf_render_target_info *render_target_info,
+		const struct wlf_render_text_options *options) {
+	struct wlf_gles_text_pass *pass = wlf_container_of(base, pass, base);
+	if (!wlf_render_target_info_is_gles(render_target_info)) {
+		wlf_log(WLF_ERROR, "GLES text pass requires a GLES target");
+		return;
+	}
+	int target_width = render_target_info->buffer_width;
+	int target_height = render_target_info->buffer_height;
+	if (target_width <= 0 || target_height <= 0) {
+		return;
+	}
+	if (options->quad_count > INT_MAX / 6) {
+		wlf_log(WLF_ERROR, "Too many glyphs for GLES text pass");
+		return;
+	}
+	if (!upload_atlas(pass) || !build_vertices(pass, options)) {
+		return;
+	}
+	GLsizei vertex_count = (GLsizei)(options->quad_count * 6);
+
+	struct wlf_color color = wlf_color_clamp(&options->color);
+	float alpha = color.a * options->opacity;
+	float rgba[4] = {
+		color.r * alpha, color.g * alpha, color.b * alpha, alpha,
+	};
+	glViewport(0, 0, target_width, target_height);
+	glUseProgram(pass->program);
+	glUniform2f(pass->uniform_viewport,
+		render_target_info->logical_width,
+		render_target_info->logical_height);
+	glUniform1i(pass->uniform_texture, 0);
+	glUniform4fv(pass->uniform_color, 1, rgba);
+	glVertexAttribPointer(pass->attrib_pos, 2, GL_FLOAT, GL_FALSE,
+		sizeof(struct text_vertex), &pass->vertices[0].x);
+	glVertexAttribPointer(pass->attrib_texcoord, 2, GL_FLOAT, GL_FALSE,
+		sizeof(struct text_vertex), &pass->vertices[0].u);
+	glEnableVertexAttribArray(pass->attrib_pos);
+	glEnableVertexAttribArray(pass->attrib_texcoord);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+	if (options->clip != NULL) {
+		int nrects = 0;
+		pixman_box32_t *rects = pixman_region32_rectangles(
+			(pixman_region32_t *)options->clip, &nrects);
+		glEnable(GL_SCISSOR_TEST);
+		for (int i = 0; i < nrects; i++) {
+			pixman_box32_t *r = &rects[i];
+			int x1 = (int)floor(r->x1 * render_target_info->scale);
+			int y1 = (int)floor(r->y1 * render_target_info->scale);
+			int x2 = (int)ceil(r->x2 * render_target_info->scale);
+			int y2 = (int)ceil(r->y2 * render_target_info->scale);
+			glScissor(x1, target_height - y2, x2 - x1, y2 - y1);
+			glDrawArrays(GL_TRIANGLES, 0, vertex_count);
+		}
+		glDisable(GL_SCISSOR_TEST);
+	} else {
+		glDrawArrays(GL_TRIANGLES, 0, vertex_count);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glDisableVertexAttribArray(pass->attrib_texcoord);
+	glDisableVertexAttribArray(pass->attrib_pos);
+
+	GLenum error = glGetError();
+	if (error != GL_NO_ERROR) {
+		wlf_log(WLF_ERROR, "GLES text render failed: %s",
+			wlf_gles_error_str(error));
+	}
+}
+
+static const struct wlf_text_pass_impl text_pass_impl = {
+	.destroy = text_pass_destroy,
+	.render = text_pass_render,
+};
+
+struct wlf_text_pass *wlf_gles_text_pass_create(void) {
+	struct wlf_gles_text_pass *pass = calloc(1, sizeof(*pass));
+	if (pass == NULL || !link_program(pass)) {
+		free(pass);
+		return NULL;
+	}
+	wlf_text_pass_init(&pass->base, &text_pass_impl);
+	return &pass->base;
+}
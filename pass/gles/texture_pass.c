@@ -6,20 +6,27 @@
 #include "wlf/utils/wlf_log.h"
 
 #include "texture_frag_src.h"
+#include "texture_mask_frag_src.h"
 #include "texture_vert_src.h"
 
 #include <GLES2/gl2.h>
 #include <math.h>
 #include <stdlib.h>
 
-struct wlf_gles_texture_pass {
-	struct wlf_texture_pass base;
+struct texture_program {
 	GLuint program;
 	GLint attrib_pos;
 	GLint attrib_texcoord;
 	GLint uniform_viewport;
 	GLint uniform_texture;
 	GLint uniform_opacity;
+	GLint uniform_color; /* Mask program only */
+};
+
+struct wlf_gles_texture_pass {
+	struct wlf_texture_pass base;
+	struct texture_program texture;
+	struct texture_program mask; /* Draws a tint through a coverage mask */
 };
 
 static GLuint compile_shader(GLenum type, const char *source) {
@@ -43,51 +50,54 @@ static GLuint compile_shader(GLenum type, const char *source) {
 	return shader;
 }
 
-static bool link_program(struct wlf_gles_texture_pass *pass) {
+static bool link_program(struct texture_program *program, const char *frag_src,
+		bool tinted) {
 	GLuint vert = compile_shader(GL_VERTEX_SHADER, texture_vert_src);
-	GLuint frag = compile_shader(GL_FRAGMENT_SHADER, texture_frag_src);
+	GLuint frag = compile_shader(GL_FRAGMENT_SHADER, frag_src);
 	if (vert == 0 || frag == 0) {
 		glDeleteShader(vert);
 		glDeleteShader(frag);
 		return false;
 	}
 
-	pass->program = glCreateProgram();
-	if (pass->program == 0) {
+	program->program = glCreateProgram();
+	if (program->program == 0) {
 		glDeleteShader(vert);
 		glDeleteShader(frag);
 		return false;
 	}
-	glAttachShader(pass->program, vert);
-	glAttachShader(pass->program, frag);
-	glBindAttribLocation(pass->program, 0, "pos");
-	glBindAttribLocation(pass->program, 1, "texcoord");
-	glLinkProgram(pass->program);
+	glAttachShader(program->program, vert);
+	glAttachShader(program->program, frag);
+	glBindAttribLocation(program->program, 0, "pos");
+	glBindAttribLocation(program->program, 1, "texcoord");
+	glLinkProgram(program->program);
 	glDeleteShader(vert);
 	glDeleteShader(frag);
 	GLint ok = GL_FALSE;
-	glGetProgramiv(pass->program, GL_LINK_STATUS, &ok);
+	glGetProgramiv(program->program, GL_LINK_STATUS, &ok);
 	if (ok != GL_TRUE) {
 		char log[512] = {0};
-		glGetProgramInfoLog(pass->program, sizeof(log), NULL, log);
+		glGetProgramInfoLog(program->program, sizeof(log), NULL, log);
 		wlf_log(WLF_ERROR, "failed to link GLES texture program: %s", log);
-		glDeleteProgram(pass->program);
-		pass->program = 0;
+		glDeleteProgram(program->program);
+		program->program = 0;
 		return false;
 	}
 
-	pass->attrib_pos = glGetAttribLocation(pass->program, "pos");
-	pass->attrib_texcoord = glGetAttribLocation(pass->program, "texcoord");
-	pass->uniform_viewport = glGetUniformLocation(pass->program, "viewport");
-	pass->uniform_texture = glGetUniformLocation(pass->program, "tex");
-	pass->uniform_opacity = glGetUniformLocation(pass->program, "opacity");
-	bool locations_ok = pass->attrib_pos >= 0 && pass->attrib_texcoord >= 0 &&
-		pass->uniform_viewport >= 0 && pass->uniform_texture >= 0 &&
-		pass->uniform_opacity >= 0;
+	program->attrib_pos = glGetAttribLocation(program->program, "pos");
+	program->attrib_texcoord = glGetAttribLocation(program->program, "texcoord");
+	program->uniform_viewport = glGetUniformLocation(program->program, "viewport");
+	program->uniform_texture = glGetUniformLocation(program->program, "tex");
+	program->uniform_opacity = glGetUniformLocation(program->program, "opacity");
+	program->uniform_color = tinted ?
+		glGetUniformLocation(program->program, "color") : -1;
+	bool locations_ok = program->attrib_pos >= 0 && program->attrib_texcoord >= 0 &&
+		program->uniform_viewport >= 0 && program->uniform_texture >= 0 &&
+		program->uniform_opacity >= 0 && (!tinted || program->uniform_color >= 0);
 	if (!locations_ok) {
 		wlf_log(WLF_ERROR, "failed to query GLES texture program locations");
-		glDeleteProgram(pass->program);
-		pass->program = 0;
+		glDeleteProgram(program->program);
+		program->program = 0;
 	}
 	return locations_ok;
 }
@@ -95,8 +105,11 @@ static bool link_program(struct wlf_gles_texture_pass *pass) {
 static void texture_pass_destroy(struct wlf_texture_pass *base) {
 	struct wlf_gles_texture_pass *pass =
 		wlf_container_of(base, pass, base);
-	if (pass->program != 0) {
-		glDeleteProgram(pass->program);
+	if (pass->texture.program != 0) {
+		glDeleteProgram(pass->texture.program);
+	}
+	if (pass->mask.program != 0) {
+		glDeleteProgram(pass->mask.program);
 	}
 	free(pass);
 }
@@ -141,17 +154,26 @@ static void texture_pass_render(struct wlf_texture_pass *base,
 			(src.y + src.height) / texture->base.height,
 	};
 
+	const struct texture_program *program =
+		options->tint != NULL ? &pass->mask : &pass->texture;
 	glViewport(0, 0, target_width, target_height);
-	glUseProgram(pass->program);
-	glUniform2f(pass->uniform_viewport,
+	glUseProgram(program->program);
+	glUniform2f(program->uniform_viewport,
 		render_target_info->logical_width,
 		render_target_info->logical_height);
-	glUniform1i(pass->uniform_texture, 0);
-	glUniform1f(pass->uniform_opacity, options->opacity);
-	glVertexAttribPointer(pass->attrib_pos, 2, GL_FLOAT, GL_FALSE, 0, vertices);
-	glVertexAttribPointer(pass->attrib_texcoord, 2, GL_FLOAT, GL_FALSE, 0, texcoords);
-	glEnableVertexAttribArray(pass->attrib_pos);
-	glEnableVertexAttribArray(pass->attrib_texcoord);
+	glUniform1i(program->uniform_texture, 0);
+	glUniform1f(program->uniform_opacity, options->opacity);
+	if (options->tint != NULL) {
+		struct wlf_color tint = wlf_color_clamp(options->tint);
+		glUniform4f(program->uniform_color, tint.r * tint.a,
+			tint.g * tint.a, tint.b * tint.a, tint.a);
+	}
+	glVertexAttribPointer(program->attrib_pos, 2, GL_FLOAT, GL_FALSE, 0,
+		vertices);
+	glVertexAttribPointer(program->attrib_texcoord, 2, GL_FLOAT, GL_FALSE, 0,
+		texcoords);
+	glEnableVertexAttribArray(program->attrib_pos);
+	glEnableVertexAttribArray(program->attrib_texcoord);
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, texture->tex);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
@@ -193,8 +215,8 @@ static void texture_pass_render(struct wlf_texture_pass *base,
 	}
 	glDisable(GL_SCISSOR_TEST);
 	glBindTexture(GL_TEXTURE_2D, 0);
-	glDisableVertexAttribArray(pass->attrib_texcoord);
-	glDisableVertexAttribArray(pass->attrib_pos);
+	glDisableVertexAttribArray(program->attrib_texcoord);
+	glDisableVertexAttribArray(program->attrib_pos);
 	pixman_region32_fini(&clipped);
 	pixman_region32_fini(&dst_region);
 
@@ -212,7 +234,14 @@ static const struct wlf_texture_pass_impl texture_pass_impl = {
 
 struct wlf_texture_pass *wlf_gles_texture_pass_create(void) {
 	struct wlf_gles_texture_pass *pass = calloc(1, sizeof(*pass));
-	if (pass == NULL || !link_program(pass)) {
+	if (pass == NULL) {
+		return NULL;
+	}
+	if (!link_program(&pass->texture, texture_frag_src, false) ||
+			!link_program(&pass->mask, texture_mask_frag_src, true)) {
+		if (pass->texture.program != 0) {
+			glDeleteProgram(pass->texture.program);
+		}
 		free(pass);
 		return NULL;
 	}
@@ -0,0 +1,160 @@
+#include "wlf/pass/pixman/text_pass.h"
+
+#include "wlf/pass/pixman/render_target_info.h"
+#include "wlf/utils/wlf_log.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+struct wlf_pixman_text_pass {
+	struct wlf_text_pass base;
+	pixman_image_t *atlas_image; /* Wraps the atlas pixels, created on first render */
+};
+
+static uint16_t channel(double value) {
+	if (value <= 0) {
+		return 0;
+	}
+	if (value >= 1) {
+		return UINT16_MAX;
+	}
+	return value * UINT16_MAX + 0.5;
+}
+
+static void text_pass_destroy(struct wlf_text_pass *base) {
+	struct wlf_pixman_text_pass *pass = wlf_container_of(base, pass, base);
+	if (pass->atlas_image != NULL) {
+		pixman_image_unref(pass->atlas_image);
+	}
+	free(pass);
+}
+
+static void text_pass_render(struct wlf_text_pass *base,
+		struct wlf_render_target_info *render_target_info,
+		const struct wlf_render_text_options *options) {
+	struct wlf_pixman_text_pass *pass = wlf_container_of(base, pass, base);
+	if (!wlf_render_target_info_is_pixman(render_target_info)) {
+		wlf_log(WLF_ERROR, "pixman text pass requires a pixman target");
+		return;
+	}
+	struct wlf_pixman_render_target_info *target =
+		wlf_pixman_render_target_info_from_info(render_target_info);
+	if (target->buffer == NULL || target->buffer->image == NULL) {
+		return;
+	}
+
+	/* The mask image shares the atlas pixels, so nothing is uploaded. */
+	uint32_t y, rows;
+	(void)wlf_glyph_atlas_take_damage(base->atlas, &y, &rows);
+	if (pass->atlas_image == NULL) {
+		uint32_t width, height;
+		const uint8_t *pixels = wlf_glyph_atlas_get_data(base->atlas,
+			&width, &height);
+		pass->atlas_image = pixman_image_create_bits(PIXMAN_a8,
+			width, height, (uint32_t *)pixels, width);
+		if (pass->atlas_image == NULL) {
+			wlf_log(WLF_ERROR, "failed to wrap glyph atlas in a pixman image");
+			return;
+		}
+	}
+
+	struct wlf_color color = wlf_color_clamp(&options->color);
+	double alpha = color.a * options->opacity;
+	pixman_color_t solid_color = {
+		.red = channel(color.r * alpha),
+		.green = channel(color.g * alpha),
+		.blue = channel(color.b * alpha),
+		.alpha = channel(alpha),
+	};
+	pixman_image_t *solid = pixman_image_create_solid_fill(&solid_color);
+	if (solid == NULL) {
+		return;
+	}
+
+	pixman_region32_t scaled_clip;
+	pixman_region32_init(&scaled_clip);
+	if (options->clip != NULL) {
+		wlf_render_target_info_scale_region(render_target_info,
+			options->clip, &scaled_clip);
+		pixman_image_set_clip_region32(target->buffer->image, &scaled_clip);
+	}
+
+	/* Quads usually map atlas pixels one to one, so each glyph is a single
+	 * unscaled composite at its rounded target position. Glyphs still
+	 * rasterized for an older scale are sampled through a transform that
+	 * stretches them over their destination box. */
+	double scale = render_target_info->scale;
+	bool transformed = false;
+	for (size_t i = 0; i < options->quad_count; i++) {
+		const struct wlf_text_quad *quad = &options->quads[i];
+		int32_t dst_x = (int32_t)lround((quad->dst_box.x + options->offset_x) * scale);
+		int32_t dst_y = (int32_t)lround((quad->dst_box.y + options->offset_y) * scale);
+		double width = quad->dst_box.width * scale;
+		double height = quad->dst_box.height * scale;
+		if (width <= 0 || height <= 0) {
+			continue;
+		}
+
+		if (lround(width) == quad->src_box.width &&
+				lround(height) == quad->src_box.height) {
+			if (transformed) {
+				pixman_image_set_transform(pass->atlas_image, NULL);
+				pixman_image_set_filter(pass->atlas_image,
+					PIXMAN_FILTER_NEAREST, NULL, 0);
+				transformed = false;
+			}
+			pixman_image_composite32(PIXMAN_OP_OVER, solid, pass->atlas_image,
+				target->buffer->image, 0, 0,
+				quad->src_box.x, quad->src_box.y, dst_x, dst_y,
+				quad->src_box.width, quad->src_box.height);
+			continue;
+		}
+
+		double scale_x = quad->src_box.width / width;
+		double scale_y = quad->src_box.height / height;
+		pixman_transform_t transform = {
+			.matrix = {
+				{ pixman_double_to_fixed(scale_x), 0,
+					pixman_double_to_fixed(quad->src_box.x) },
+				{ 0, pixman_double_to_fixed(scale_y),
+					pixman_double_to_fixed(quad->src_box.y) },
+				{ 0, 0, pixman_fixed_1 },
+			},
+		};
+		pixman_image_set_transform(pass->atlas_image, &transform);
+		pixman_image_set_filter(pass->atlas_image,
+			PIXMAN_FILTER_BILINEAR, NULL, 0);
+		transformed = true;
+		pixman_image_composite32(PIXMAN_OP_OVER, solid, pass->atlas_image,
+			target->buffer->image, 0, 0, 0, 0, dst_x, dst_y,
+			(int32_t)ceil(width), (int32_t)ceil(height));
+	}
+	if (transformed) {
+		pixman_image_set_transform(pass->atlas_image, NULL);
+		pixman_image_set_filter(pass->atlas_image,
+			PIXMAN_FILTER_NEAREST, NULL, 0);
+	}
+
+	if (options->clip != NULL) {
+		pixman_image_set_clip_region32(target->buffer->image, NULL);
+	}
+	pixman_region32_fini(&scaled_clip);
+	pixman_image_unref(solid);
+}
+
+static const struct wlf_text_pass_impl text_pass_impl = {
+	.destroy = text_pass_destroy,
+	.render = text_pass_render,
+};
+
+struct wlf_text_pass *wlf_pixman_text_pass_create(void) {
+	struct wlf_pixman_text_pass *pass = calloc(1, sizeof(*pass));
+	if (pass == NULL) {
+		wlf_log_errno(WLF_ERROR, "failed to allocate pixman text pass");
+		return NULL;
+	}
+	wlf_text_pass_init(&pass->base, &text_pass_impl);
+	return &pass->base;
+}
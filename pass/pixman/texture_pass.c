@@ -7,6 +7,25 @@
 #include <math.h>
 #include <stdlib.h>
 
+static uint16_t color_channel(double value) {
+	return (uint16_t)lround(value * 65535.0);
+}
+
+/* Wraps the pixels of a single-channel texture as an a8 image, so they act
+ * as coverage. Pixman reads R8 textures as palette-less grayscale. */
+static pixman_image_t *create_coverage_image(
+		struct wlf_pixman_texture *texture) {
+	if (texture->format_info->bytes_per_block != 1) {
+		wlf_log(WLF_ERROR, "tinted pixman textures must be single-channel");
+		return NULL;
+	}
+	return pixman_image_create_bits(PIXMAN_a8,
+		pixman_image_get_width(texture->image),
+		pixman_image_get_height(texture->image),
+		pixman_image_get_data(texture->image),
+		pixman_image_get_stride(texture->image));
+}
+
 static void pixman_texture_pass_destroy(struct wlf_texture_pass *pass) {
 	free(pass);
 }
@@ -60,6 +79,16 @@ static void pixman_texture_pass_render(struct wlf_texture_pass *pass,
 		pixman_region32_copy(&clipped, &dst_region);
 	}
 
+	pixman_image_t *sampled = texture->image;
+	if (options->tint != NULL) {
+		sampled = create_coverage_image(texture);
+		if (sampled == NULL) {
+			pixman_region32_fini(&clipped);
+			pixman_region32_fini(&dst_region);
+			return;
+		}
+	}
+
 	double scale_x = src.width / dst.width;
 	double scale_y = src.height / dst.height;
 	pixman_transform_t transform = {
@@ -71,14 +100,34 @@ static void pixman_texture_pass_render(struct wlf_texture_pass *pass,
 			{ 0, 0, pixman_fixed_1 },
 		},
 	};
-	pixman_image_set_transform(texture->image, &transform);
-	pixman_image_set_filter(texture->image,
+	pixman_image_set_transform(sampled, &transform);
+	pixman_image_set_filter(sampled,
 		options->filter_mode == WLF_SCALE_FILTER_NEAREST ?
 		PIXMAN_FILTER_NEAREST : PIXMAN_FILTER_BILINEAR, NULL, 0);
-	pixman_image_set_repeat(texture->image, PIXMAN_REPEAT_NONE);
+	pixman_image_set_repeat(sampled, PIXMAN_REPEAT_NONE);
 
+	/* A tinted draw composites the color through the coverage image, with
+	 * opacity folded into the color; otherwise opacity is a solid mask. */
+	pixman_image_t *source = sampled;
 	pixman_image_t *mask = NULL;
-	if (options->opacity < 1.0f) {
+	if (options->tint != NULL) {
+		struct wlf_color tint = wlf_color_clamp(options->tint);
+		double alpha = tint.a * options->opacity;
+		pixman_color_t color = {
+			.red = color_channel(tint.r * alpha),
+			.green = color_channel(tint.g * alpha),
+			.blue = color_channel(tint.b * alpha),
+			.alpha = color_channel(alpha),
+		};
+		source = pixman_image_create_solid_fill(&color);
+		if (source == NULL) {
+			pixman_image_unref(sampled);
+			pixman_region32_fini(&clipped);
+			pixman_region32_fini(&dst_region);
+			return;
+		}
+		mask = sampled;
+	} else if (options->opacity < 1.0f) {
 		pixman_color_t alpha = {
 			.red = 0xffff,
 			.green = 0xffff,
@@ -94,15 +143,22 @@ static void pixman_texture_pass_render(struct wlf_texture_pass *pass,
 		PIXMAN_OP_SRC : PIXMAN_OP_OVER;
 	for (int i = 0; i < nrects; i++) {
 		pixman_box32_t *r = &rects[i];
-		pixman_image_composite32(op, texture->image, mask, target->buffer->image,
-			r->x1, r->y1, 0, 0, r->x1, r->y1,
+		/* Solid images ignore their origin, so the sampled image always
+		 * lines up with the target through the shared coordinates. */
+		pixman_image_composite32(op, source, mask, target->buffer->image,
+			r->x1, r->y1, r->x1, r->y1, r->x1, r->y1,
 			r->x2 - r->x1, r->y2 - r->y1);
 	}
 
-	if (mask != NULL) {
-		pixman_image_unref(mask);
+	if (options->tint != NULL) {
+		pixman_image_unref(source);
+		pixman_image_unref(sampled);
+	} else {
+		if (mask != NULL) {
+			pixman_image_unref(mask);
+		}
+		pixman_image_set_transform(texture->image, NULL);
 	}
-	pixman_image_set_transform(texture->image, NULL);
 	pixman_region32_fini(&clipped);
 	pixman_region32_fini(&dst_region);
 }
@@ -0,0 +1,271 @@
+#include "wlf/pass/wlf_glyph_atlas.h"
+#include "wlf/utils/wlf_log.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GLYPH_ATLAS_BUCKETS 2048
+#define GLYPH_ATLAS_NONE UINT32_MAX
+
+struct glyph_shelf {
+	uint32_t y;
+	uint32_t height;
+	uint32_t x;                          /* Next free column */
+};
+
+struct wlf_glyph_atlas {
+	uint8_t *pixels;
+	uint32_t width, height;
+	uint32_t generation;
+
+	/* Entries live in one array; buckets and next hold entry indices. */
+	struct wlf_glyph_atlas_entry *entries;
+	uint32_t *next;
+	uint32_t entry_count, entry_capacity;
+	uint32_t buckets[GLYPH_ATLAS_BUCKETS];
+
+	struct glyph_shelf *shelves;
+	uint32_t shelf_count, shelf_capacity;
+	uint32_t shelf_bottom;               /* First row below the last shelf */
+
+	uint32_t damage_y1, damage_y2;       /* Written rows, empty when equal */
+};
+
+static uint32_t next_generation;
+
+static uint32_t key_bucket(const struct wlf_glyph_key *key) {
+	uint32_t hash = key->font * UINT32_C(0x9e3779b1);
+	hash ^= key->index * UINT32_C(0x85ebca77) + key->subpixel;
+	hash ^= hash >> 15;
+	return hash & (GLYPH_ATLAS_BUCKETS - 1);
+}
+
+static void atlas_clear(struct wlf_glyph_atlas *atlas) {
+	atlas->entry_count = 0;
+	atlas->shelf_count = 0;
+	atlas->shelf_bottom = 0;
+	for (size_t i = 0; i < GLYPH_ATLAS_BUCKETS; i++) {
+		atlas->buckets[i] = GLYPH_ATLAS_NONE;
+	}
+	atlas->generation = ++next_generation;
+}
+
+struct wlf_glyph_atlas *wlf_glyph_atlas_create(uint32_t width, uint32_t height) {
+	assert(width > 0 && width % 4 == 0 && height > 0);
+
+	struct wlf_glyph_atlas *atlas = calloc(1, sizeof(*atlas));
+	if (atlas == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate wlf_glyph_atlas");
+		return NULL;
+	}
+
+	atlas->pixels = calloc((size_t)width * height, 1);
+	if (atlas->pixels == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate glyph atlas pixels");
+		free(atlas);
+		return NULL;
+	}
+
+	atlas->width = width;
+	atlas->height = height;
+	atlas_clear(atlas);
+
+	return atlas;
+}
+
+void wlf_glyph_atlas_destroy(struct wlf_glyph_atlas *atlas) {
+	if (atlas == NULL) {
+		return;
+	}
+
+	free(atlas->shelves);
+	free(atlas->next);
+	free(atlas->entries);
+	free(atlas->pixels);
+	free(atlas);
+}
+
+const struct wlf_glyph_atlas_entry *wlf_glyph_atlas_get(
+		const struct wlf_glyph_atlas *atlas, const struct wlf_glyph_key *key) {
+	uint32_t index = atlas->buckets[key_bucket(key)];
+	while (index != GLYPH_ATLAS_NONE) {
+		const struct wlf_glyph_atlas_entry *entry = &atlas->entries[index];
+		if (entry->key.font == key->font && entry->key.index == key->index &&
+				entry->key.subpixel == key->subpixel) {
+			return entry;
+		}
+		index = atlas->next[index];
+	}
+
+	return NULL;
+}
+
+/* Finds room for a width × height slot. Shelves are chosen best fit by
+ * height; a new shelf is opened below the last one when none fits. */
+static bool atlas_pack(struct wlf_glyph_atlas *atlas, uint32_t width,
+		uint32_t height, uint32_t *x, uint32_t *y) {
+	struct glyph_shelf *best = NULL;
+	for (uint32_t i = 0; i < atlas->shelf_count; i++) {
+		struct glyph_shelf *shelf = &atlas->shelves[i];
+		if (shelf->height >= height && atlas->width - shelf->x >= width &&
+				(best == NULL || shelf->height < best->height)) {
+			best = shelf;
+		}
+	}
+
+	/* Do not waste a tall shelf on a short glyph while there is space left. */
+	if (best != NULL && best->height > height + height / 2 &&
+			atlas->height - atlas->shelf_bottom >= height) {
+		best = NULL;
+	}
+
+	if (best == NULL) {
+		if (atlas->height - atlas->shelf_bottom < height) {
+			return false;
+		}
+		if (atlas->shelf_count == atlas->shelf_capacity) {
+			uint32_t capacity = atlas->shelf_capacity == 0 ?
+				16 : atlas->shelf_capacity * 2;
+			struct glyph_shelf *shelves = realloc(atlas->shelves,
+				capacity * sizeof(*shelves));
+			if (shelves == NULL) {
+				return false;
+			}
+			atlas->shelves = shelves;
+			atlas->shelf_capacity = capacity;
+		}
+		best = &atlas->shelves[atlas->shelf_count++];
+		*best = (struct glyph_shelf){
+			.y = atlas->shelf_bottom,
+			.height = height,
+		};
+		atlas->shelf_bottom += height;
+	}
+
+	*x = best->x;
+	*y = best->y;
+	best->x += width;
+	return true;
+}
+
+static bool atlas_reserve_entry(struct wlf_glyph_atlas *atlas) {
+	if (atlas->entry_count < atlas->entry_capacity) {
+		return true;
+	}
+
+	uint32_t capacity = atlas->entry_capacity == 0 ?
+		256 : atlas->entry_capacity * 2;
+	struct wlf_glyph_atlas_entry *entries = realloc(atlas->entries,
+		capacity * sizeof(*entries));
+	if (entries == NULL) {
+		return false;
+	}
+	atlas->entries = entries;
+
+	uint32_t *next = realloc(atlas->next, capacity * sizeof(*next));
+	if (next == NULL) {
+		return false;
+	}
+	atlas->next = next;
+	atlas->entry_capacity = capacity;
+
+	return true;
+}
+
+const struct wlf_glyph_atlas_entry *wlf_glyph_atlas_add(
+		struct wlf_glyph_atlas *atlas, const struct wlf_glyph_key *key,
+		int32_t left, int32_t top, uint32_t width, uint32_t height,
+		uint32_t stride, const uint8_t *data) {
+	assert(wlf_glyph_atlas_get(atlas, key) == NULL);
+
+	/* One blank column and row separate neighbouring masks, so linear
+	 * filtering never picks up coverage from another glyph. */
+	uint32_t slot_width = width + 1;
+	uint32_t slot_height = height + 1;
+	if (slot_width > atlas->width || slot_height > atlas->height) {
+		wlf_log(WLF_DEBUG, "Glyph %ux%u does not fit in the atlas",
+			width, height);
+		return NULL;
+	}
+	if (!atlas_reserve_entry(atlas)) {
+		wlf_log_errno(WLF_ERROR, "Failed to grow glyph atlas entries");
+		return NULL;
+	}
+
+	uint32_t x = 0, y = 0;
+	if (width > 0 && height > 0 &&
+			!atlas_pack(atlas, slot_width, slot_height, &x, &y)) {
+		atlas_clear(atlas);
+		if (!atlas_pack(atlas, slot_width, slot_height, &x, &y)) {
+			return NULL;
+		}
+	}
+
+	if (width > 0 && height > 0) {
+		for (uint32_t row = 0; row < slot_height; row++) {
+			uint8_t *dst = &atlas->pixels[(size_t)(y + row) * atlas->width + x];
+			if (row < height) {
+				memcpy(dst, &data[(size_t)row * stride], width);
+				dst[width] = 0;
+			} else {
+				memset(dst, 0, slot_width);
+			}
+		}
+
+		if (atlas->damage_y1 == atlas->damage_y2) {
+			atlas->damage_y1 = y;
+			atlas->damage_y2 = y + slot_height;
+		} else {
+			if (y < atlas->damage_y1) {
+				atlas->damage_y1 = y;
+			}
+			if (y + slot_height > atlas->damage_y2) {
+				atlas->damage_y2 = y + slot_height;
+			}
+		}
+	}
+
+	uint32_t index = atlas->entry_count++;
+	struct wlf_glyph_atlas_entry *entry = &atlas->entries[index];
+	*entry = (struct wlf_glyph_atlas_entry){
+		.key = *key,
+		.box = {
+			.x = (int)x,
+			.y = (int)y,
+			.width = (int)width,
+			.height = (int)height,
+		},
+		.left = left,
+		.top = top,
+	};
+
+	uint32_t bucket = key_bucket(key);
+	atlas->next[index] = atlas->buckets[bucket];
+	atlas->buckets[bucket] = index;
+
+	return entry;
+}
+
+uint32_t wlf_glyph_atlas_get_generation(const struct wlf_glyph_atlas *atlas) {
+	return atlas->generation;
+}
+
+const uint8_t *wlf_glyph_atlas_get_data(const struct wlf_glyph_atlas *atlas,
+		uint32_t *width, uint32_t *height) {
+	*width = atlas->width;
+	*height = atlas->height;
+	return atlas->pixels;
+}
+
+bool wlf_glyph_atlas_take_damage(struct wlf_glyph_atlas *atlas,
+		uint32_t *y, uint32_t *height) {
+	if (atlas->damage_y1 == atlas->damage_y2) {
+		return false;
+	}
+
+	*y = atlas->damage_y1;
+	*height = atlas->damage_y2 - atlas->damage_y1;
+	atlas->damage_y1 = atlas->damage_y2 = 0;
+	return true;
+}
@@ -0,0 +1,70 @@
+#include "wlf/pass/wlf_text_pass.h"
+#include "wlf/utils/wlf_linked_list.h"
+#include "wlf/config.h"
+#include "wlf/utils/wlf_log.h"
+#if WLF_HAS_LINUX_PLATFORM
+#include "wlf/pass/gles/text_pass.h"
+#include "wlf/pass/pixman/text_pass.h"
+#include "wlf/renderer/gles/renderer.h"
+#include "wlf/renderer/pixman/renderer.h"
+#endif
+
+#include <assert.h>
+
+struct wlf_text_pass *wlf_text_pass_auto_create(struct wlf_renderer *renderer) {
+	struct wlf_text_pass *pass = NULL;
+#if WLF_HAS_LINUX_PLATFORM
+	if (wlf_renderer_is_gles(renderer)) {
+		pass = wlf_gles_text_pass_create();
+	} else if (wlf_renderer_is_pixman(renderer)) {
+		pass = wlf_pixman_text_pass_create();
+	} else {
+		wlf_log(WLF_ERROR, "Scene rendering is unsupported by this renderer");
+	}
+#endif
+	if (pass == NULL) {
+		return NULL;
+	}
+
+	pass->atlas = wlf_glyph_atlas_create(WLF_TEXT_PASS_ATLAS_SIZE,
+		WLF_TEXT_PASS_ATLAS_SIZE);
+	if (pass->atlas == NULL) {
+		wlf_text_pass_destroy(pass);
+		return NULL;
+	}
+
+	return pass;
+}
+
+void wlf_text_pass_init(struct wlf_text_pass *pass,
+		const struct wlf_text_pass_impl *impl) {
+	assert(pass != NULL);
+	assert(impl != NULL && impl->destroy != NULL && impl->render != NULL);
+	*pass = (struct wlf_text_pass){ .impl = impl };
+	wlf_signal_init(&pass->events.destroy);
+}
+
+void wlf_text_pass_destroy(struct wlf_text_pass *pass) {
+	if (pass == NULL) {
+		return;
+	}
+	wlf_signal_emit_mutable(&pass->events.destroy, pass);
+	assert(wlf_linked_list_empty(&pass->events.destroy.listener_list));
+	struct wlf_glyph_atlas *atlas = pass->atlas;
+	pass->impl->destroy(pass);
+	wlf_glyph_atlas_destroy(atlas);
+}
+
+void wlf_render_pass_add_glyphs(struct wlf_text_pass *pass,
+		struct wlf_render_target_info *render_target_info,
+		const struct wlf_render_text_options *options) {
+	assert(pass != NULL && render_target_info != NULL && options != NULL);
+	assert(pass->atlas != NULL);
+	assert(options->quads != NULL || options->quad_count == 0);
+	assert(options->opacity >= 0.0f && options->opacity <= 1.0f);
+	if (options->quad_count == 0 || options->color.a <= 0 ||
+			options->opacity <= 0.0f) {
+		return;
+	}
+	pass->impl->render(pass, render_target_info, options);
+}
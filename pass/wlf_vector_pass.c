@@ -10,6 +10,19 @@
 #endif
 
 #include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+static uint16_t channel(double value) {
+	if (value <= 0) {
+		return 0;
+	}
+	if (value >= 1) {
+		return UINT16_MAX;
+	}
+	return value * UINT16_MAX + 0.5;
+}
 
 struct wlf_vector_pass *wlf_vector_pass_auto_create(struct wlf_renderer *renderer) {
 	struct wlf_vector_pass *pass = NULL;
@@ -53,3 +66,75 @@ void wlf_render_pass_add_triangles(struct wlf_vector_pass *pass,
 	}
 	pass->impl->render(pass, render_target_info, options);
 }
+
+void wlf_vector_pass_composite_pixman(pixman_image_t *image,
+		const struct wlf_render_target_info *render_target_info,
+		const struct wlf_vector_options *options) {
+	struct wlf_color color = wlf_color_clamp(&options->color);
+	pixman_color_t solid_color = {
+		.red = channel(color.r * color.a),
+		.green = channel(color.g * color.a),
+		.blue = channel(color.b * color.a),
+		.alpha = channel(color.a),
+	};
+	pixman_image_t *solid = pixman_image_create_solid_fill(&solid_color);
+	if (solid == NULL) {
+		return;
+	}
+
+	size_t triangle_count = 0;
+	for (size_t i = 0; i < options->vertex_count; i += 3) {
+		if (options->vertices[i].coverage >= 1 &&
+				options->vertices[i + 1].coverage >= 1 &&
+				options->vertices[i + 2].coverage >= 1) triangle_count++;
+	}
+	if (triangle_count == 0) {
+		pixman_image_unref(solid);
+		return;
+	}
+	if (triangle_count > INT_MAX) {
+		wlf_log(WLF_ERROR, "Too many triangles for pixman vector pass");
+		pixman_image_unref(solid);
+		return;
+	}
+	pixman_triangle_t *triangles = malloc(triangle_count * sizeof(*triangles));
+	if (triangles == NULL) {
+		pixman_image_unref(solid);
+		return;
+	}
+	size_t triangle_index = 0;
+	for (size_t i = 0; i < options->vertex_count; i += 3) {
+		const struct wlf_vector_vertex *v = &options->vertices[i];
+		if (v[0].coverage < 1 || v[1].coverage < 1 || v[2].coverage < 1) continue;
+		double scale = render_target_info->scale;
+		triangles[triangle_index++] = (pixman_triangle_t){
+			.p1 = { pixman_double_to_fixed(v[0].x * scale),
+				pixman_double_to_fixed(v[0].y * scale) },
+			.p2 = { pixman_double_to_fixed(v[1].x * scale),
+				pixman_double_to_fixed(v[1].y * scale) },
+			.p3 = { pixman_double_to_fixed(v[2].x * scale),
+				pixman_double_to_fixed(v[2].y * scale) },
+		};
+	}
+
+	pixman_region32_t scaled_clip;
+	pixman_region32_init(&scaled_clip);
+	if (options->clip != NULL) {
+		wlf_render_target_info_scale_region(render_target_info,
+			options->clip, &scaled_clip);
+		pixman_image_set_clip_region32(image,
+			&scaled_clip);
+	}
+	pixman_composite_triangles(
+		options->blend_mode == WLF_RENDER_BLEND_MODE_NONE ? PIXMAN_OP_SRC : PIXMAN_OP_OVER,
+		solid, image, PIXMAN_a8, 0, 0, 0, 0,
+		(int)triangle_count, triangles);
+	if (options->clip != NULL) {
+		pixman_image_set_clip_region32(image, NULL);
+	}
+	pixman_region32_fini(&scaled_clip);
+
+	free(triangles);
+	pixman_image_unref(solid);
+}
+
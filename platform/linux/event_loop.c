@@ -0,0 +1,552 @@
+#include "wlf/platform/linux/event_loop.h"
+
+#include "wlf/utils/wlf_linked_list.h"
+#include "wlf/utils/wlf_log.h"
+#include "wlf/utils/wlf_time.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#define EVENT_LOOP_MAX_EVENTS 32
+#define TIMER_HEAP_NONE SIZE_MAX
+
+enum event_source_type {
+	EVENT_SOURCE_FD,
+	EVENT_SOURCE_TIMER,
+	EVENT_SOURCE_IDLE,
+};
+
+struct wlf_event_source {
+	struct wlf_event_loop *loop;
+	enum event_source_type type;
+	/* In the loop's source list while registered, then in its destroy list
+	 * until the current dispatch can no longer reference the source. */
+	struct wlf_linked_list link;
+	struct wlf_linked_list idle_link; /* In the idle list while pending */
+	bool removed;
+	void *data;
+
+	int fd;
+	wlf_event_loop_fd_func_t fd_func;
+	wlf_event_loop_func_t func; /* Timer and idle callback */
+
+	int64_t deadline; /* CLOCK_MONOTONIC expiry in nanoseconds */
+	size_t heap_index; /* Slot in the timer heap, TIMER_HEAP_NONE if disarmed */
+};
+
+struct event_loop_task {
+	struct event_loop_task *next;
+	wlf_event_loop_func_t func;
+	void *data;
+};
+
+struct wlf_event_loop {
+	int epoll_fd;
+	int timer_fd;
+	struct wlf_event_source *timer_source; /* Watches timer_fd */
+	int64_t timer_fd_deadline; /* Deadline timer_fd is armed for, 0 if none */
+
+	/* Tasks posted from any thread, newest first. Producers push with a
+	 * compare-and-swap; the loop takes the whole stack with one exchange. */
+	_Atomic(struct event_loop_task *) posted;
+	int post_fd; /* eventfd signalled when a task lands on an empty stack */
+	struct wlf_event_source *post_source; /* Watches post_fd */
+
+	/* Armed timers, ordered as a binary min-heap on their deadline. */
+	struct wlf_event_source **timers;
+	size_t timer_count;
+	size_t timer_capacity;
+
+	struct wlf_linked_list sources;
+	struct wlf_linked_list idle_list;
+	struct wlf_linked_list destroy_list;
+};
+
+static int64_t monotonic_nsec(void) {
+	struct timespec now;
+	wlf_get_monotonic_time(&now);
+	return timespec_to_nsec(&now);
+}
+
+static void timer_heap_set(struct wlf_event_loop *loop, size_t index,
+		struct wlf_event_source *source) {
+	loop->timers[index] = source;
+	source->heap_index = index;
+}
+
+static void timer_heap_sift_up(struct wlf_event_loop *loop, size_t index) {
+	struct wlf_event_source *source = loop->timers[index];
+	while (index > 0) {
+		size_t parent = (index - 1) / 2;
+		if (loop->timers[parent]->deadline <= source->deadline) {
+			break;
+		}
+		timer_heap_set(loop, index, loop->timers[parent]);
+		index = parent;
+	}
+	timer_heap_set(loop, index, source);
+}
+
+static void timer_heap_sift_down(struct wlf_event_loop *loop, size_t index) {
+	struct wlf_event_source *source = loop->timers[index];
+	for (;;) {
+		size_t child = index * 2 + 1;
+		if (child >= loop->timer_count) {
+			break;
+		}
+		if (child + 1 < loop->timer_count &&
+				loop->timers[child + 1]->deadline < loop->timers[child]->deadline) {
+			child++;
+		}
+		if (source->deadline <= loop->timers[child]->deadline) {
+			break;
+		}
+		timer_heap_set(loop, index, loop->timers[child]);
+		index = child;
+	}
+	timer_heap_set(loop, index, source);
+}
+
+static bool timer_heap_insert(struct wlf_event_loop *loop,
+		struct wlf_event_source *source) {
+	if (loop->timer_count == loop->timer_capacity) {
+		size_t capacity = loop->timer_capacity == 0 ? 8 : loop->timer_capacity * 2;
+		struct wlf_event_source **timers = realloc(loop->timers,
+			capacity * sizeof(*timers));
+		if (timers == NULL) {
+			wlf_log_errno(WLF_ERROR, "Failed to grow event loop timer heap");
+			return false;
+		}
+		loop->timers = timers;
+		loop->timer_capacity = capacity;
+	}
+
+	timer_heap_set(loop, loop->timer_count++, source);
+	timer_heap_sift_up(loop, source->heap_index);
+	return true;
+}
+
+static void timer_heap_remove(struct wlf_event_loop *loop,
+		struct wlf_event_source *source) {
+	size_t index = source->heap_index;
+	assert(index < loop->timer_count && loop->timers[index] == source);
+	source->heap_index = TIMER_HEAP_NONE;
+
+	struct wlf_event_source *last = loop->timers[--loop->timer_count];
+	if (last == source) {
+		return;
+	}
+	timer_heap_set(loop, index, last);
+	timer_heap_sift_up(loop, index);
+	timer_heap_sift_down(loop, last->heap_index);
+}
+
+/* Points timer_fd at the earliest deadline, touching it only when that
+ * deadline changed so that re-arming a later timer costs no syscall. */
+static void update_timer_fd(struct wlf_event_loop *loop) {
+	int64_t deadline = loop->timer_count > 0 ? loop->timers[0]->deadline : 0;
+	if (deadline == loop->timer_fd_deadline) {
+		return;
+	}
+
+	struct itimerspec its = {0};
+	if (deadline != 0) {
+		timespec_from_nsec(&its.it_value, deadline);
+	}
+	if (timerfd_settime(loop->timer_fd, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+		wlf_log_errno(WLF_ERROR, "Failed to arm event loop timerfd");
+		return;
+	}
+	loop->timer_fd_deadline = deadline;
+}
+
+static void handle_timer_fd(int fd, uint32_t mask, void *data) {
+	(void)mask;
+	struct wlf_event_loop *loop = data;
+
+	uint64_t expirations;
+	if (read(fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) {
+		wlf_log_errno(WLF_ERROR, "Failed to read event loop timerfd");
+	}
+	/* The timerfd is one-shot, so it is disarmed once it has fired. */
+	loop->timer_fd_deadline = 0;
+
+	int64_t now = monotonic_nsec();
+	while (loop->timer_count > 0 && loop->timers[0]->deadline <= now) {
+		struct wlf_event_source *source = loop->timers[0];
+		timer_heap_remove(loop, source);
+		source->func(source->data);
+	}
+
+	update_timer_fd(loop);
+}
+
+static void handle_post_fd(int fd, uint32_t mask, void *data) {
+	(void)mask;
+	struct wlf_event_loop *loop = data;
+
+	/* Read before taking the stack: a post racing with the exchange then
+	 * leaves the eventfd set, costing at most one empty wakeup. */
+	uint64_t count;
+	if (read(fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+		wlf_log_errno(WLF_ERROR, "Failed to read event loop eventfd");
+	}
+
+	struct event_loop_task *task = atomic_exchange_explicit(&loop->posted,
+		NULL, memory_order_acquire);
+	struct event_loop_task *ordered = NULL;
+	while (task != NULL) {
+		struct event_loop_task *next = task->next;
+		task->next = ordered;
+		ordered = task;
+		task = next;
+	}
+
+	while (ordered != NULL) {
+		struct event_loop_task *next = ordered->next;
+		ordered->func(ordered->data);
+		free(ordered);
+		ordered = next;
+	}
+}
+
+static struct wlf_event_source *event_source_create(
+		struct wlf_event_loop *loop, enum event_source_type type, void *data) {
+	struct wlf_event_source *source = calloc(1, sizeof(*source));
+	if (source == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate event source");
+		return NULL;
+	}
+
+	source->loop = loop;
+	source->type = type;
+	source->data = data;
+	source->fd = -1;
+	source->heap_index = TIMER_HEAP_NONE;
+	wlf_linked_list_init(&source->idle_link);
+	wlf_linked_list_insert(&loop->sources, &source->link);
+	return source;
+}
+
+static void destroy_removed_sources(struct wlf_event_loop *loop) {
+	struct wlf_event_source *source, *tmp;
+	wlf_linked_list_for_each_safe(source, tmp, &loop->destroy_list, link) {
+		wlf_linked_list_remove(&source->link);
+		free(source);
+	}
+}
+
+struct wlf_event_loop *wlf_event_loop_create(void) {
+	struct wlf_event_loop *loop = calloc(1, sizeof(*loop));
+	if (loop == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate event loop");
+		return NULL;
+	}
+
+	loop->timer_fd = -1;
+	loop->post_fd = -1;
+	atomic_init(&loop->posted, NULL);
+	wlf_linked_list_init(&loop->sources);
+	wlf_linked_list_init(&loop->idle_list);
+	wlf_linked_list_init(&loop->destroy_list);
+
+	loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (loop->epoll_fd < 0) {
+		wlf_log_errno(WLF_ERROR, "Failed to create event loop epoll fd");
+		goto failed;
+	}
+
+	loop->timer_fd = timerfd_create(CLOCK_MONOTONIC,
+		TFD_CLOEXEC | TFD_NONBLOCK);
+	if (loop->timer_fd < 0) {
+		wlf_log_errno(WLF_ERROR, "Failed to create event loop timerfd");
+		goto failed;
+	}
+
+	loop->timer_source = wlf_event_loop_add_fd(loop, loop->timer_fd, EPOLLIN,
+		handle_timer_fd, loop);
+	if (loop->timer_source == NULL) {
+		goto failed;
+	}
+
+	loop->post_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (loop->post_fd < 0) {
+		wlf_log_errno(WLF_ERROR, "Failed to create event loop eventfd");
+		goto failed;
+	}
+
+	loop->post_source = wlf_event_loop_add_fd(loop, loop->post_fd, EPOLLIN,
+		handle_post_fd, loop);
+	if (loop->post_source == NULL) {
+		goto failed;
+	}
+
+	return loop;
+
+failed:
+	wlf_event_loop_destroy(loop);
+	return NULL;
+}
+
+void wlf_event_loop_destroy(struct wlf_event_loop *loop) {
+	if (loop == NULL) {
+		return;
+	}
+
+	struct wlf_event_source *source, *tmp;
+	wlf_linked_list_for_each_safe(source, tmp, &loop->sources, link) {
+		wlf_event_source_remove(source);
+	}
+	destroy_removed_sources(loop);
+
+	struct event_loop_task *task = atomic_load_explicit(&loop->posted,
+		memory_order_acquire);
+	while (task != NULL) {
+		struct event_loop_task *next = task->next;
+		free(task);
+		task = next;
+	}
+
+	free(loop->timers);
+	if (loop->post_fd >= 0) {
+		close(loop->post_fd);
+	}
+	if (loop->timer_fd >= 0) {
+		close(loop->timer_fd);
+	}
+	if (loop->epoll_fd >= 0) {
+		close(loop->epoll_fd);
+	}
+	free(loop);
+}
+
+int wlf_event_loop_get_fd(const struct wlf_event_loop *loop) {
+	assert(loop != NULL);
+	return loop->epoll_fd;
+}
+
+struct wlf_event_source *wlf_event_loop_add_fd(struct wlf_event_loop *loop,
+		int fd, uint32_t mask, wlf_event_loop_fd_func_t func, void *data) {
+	assert(loop != NULL && func != NULL);
+	if (fd < 0) {
+		wlf_log(WLF_ERROR, "Invalid fd for event loop source");
+		return NULL;
+	}
+
+	struct wlf_event_source *source = event_source_create(loop,
+		EVENT_SOURCE_FD, data);
+	if (source == NULL) {
+		return NULL;
+	}
+	source->fd = fd;
+	source->fd_func = func;
+
+	struct epoll_event event = {
+		.events = mask,
+		.data.ptr = source,
+	};
+	if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+		wlf_log_errno(WLF_ERROR, "Failed to add fd %d to event loop", fd);
+		wlf_linked_list_remove(&source->link);
+		free(source);
+		return NULL;
+	}
+
+	return source;
+}
+
+bool wlf_event_source_fd_update(struct wlf_event_source *source,
+		uint32_t mask) {
+	assert(source != NULL && source->type == EVENT_SOURCE_FD);
+	if (source->removed) {
+		return false;
+	}
+
+	struct epoll_event event = {
+		.events = mask,
+		.data.ptr = source,
+	};
+	if (epoll_ctl(source->loop->epoll_fd, EPOLL_CTL_MOD, source->fd,
+			&event) < 0) {
+		wlf_log_errno(WLF_ERROR, "Failed to update event loop fd %d",
+			source->fd);
+		return false;
+	}
+
+	return true;
+}
+
+struct wlf_event_source *wlf_event_loop_add_timer(struct wlf_event_loop *loop,
+		wlf_event_loop_func_t func, void *data) {
+	assert(loop != NULL && func != NULL);
+
+	struct wlf_event_source *source = event_source_create(loop,
+		EVENT_SOURCE_TIMER, data);
+	if (source == NULL) {
+		return NULL;
+	}
+	source->func = func;
+
+	return source;
+}
+
+bool wlf_event_source_timer_update(struct wlf_event_source *source,
+		int ms_delay) {
+	assert(source != NULL && source->type == EVENT_SOURCE_TIMER);
+	if (source->removed) {
+		return false;
+	}
+
+	struct wlf_event_loop *loop = source->loop;
+	if (ms_delay <= 0) {
+		if (source->heap_index != TIMER_HEAP_NONE) {
+			timer_heap_remove(loop, source);
+			update_timer_fd(loop);
+		}
+		return true;
+	}
+
+	source->deadline = monotonic_nsec() + (int64_t)ms_delay * 1000000;
+	if (source->heap_index != TIMER_HEAP_NONE) {
+		timer_heap_sift_up(loop, source->heap_index);
+		timer_heap_sift_down(loop, source->heap_index);
+	} else if (!timer_heap_insert(loop, source)) {
+		return false;
+	}
+
+	update_timer_fd(loop);
+	return true;
+}
+
+struct wlf_event_source *wlf_event_loop_add_idle(struct wlf_event_loop *loop,
+		wlf_event_loop_func_t func, void *data) {
+	assert(loop != NULL && func != NULL);
+
+	struct wlf_event_source *source = event_source_create(loop,
+		EVENT_SOURCE_IDLE, data);
+	if (source == NULL) {
+		return NULL;
+	}
+	source->func = func;
+	wlf_linked_list_insert(loop->idle_list.prev, &source->idle_link);
+
+	return source;
+}
+
+bool wlf_event_loop_post(struct wlf_event_loop *loop,
+		wlf_event_loop_func_t func, void *data) {
+	assert(loop != NULL && func != NULL);
+
+	struct event_loop_task *task = malloc(sizeof(*task));
+	if (task == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate event loop task");
+		return false;
+	}
+	task->func = func;
+	task->data = data;
+
+	struct event_loop_task *head = atomic_load_explicit(&loop->posted,
+		memory_order_relaxed);
+	do {
+		task->next = head;
+	} while (!atomic_compare_exchange_weak_explicit(&loop->posted, &head,
+		task, memory_order_release, memory_order_relaxed));
+
+	/* Only the post that finds the stack empty wakes the loop; tasks posted
+	 * until the loop takes the stack ride on the same wakeup. */
+	if (head == NULL) {
+		uint64_t one = 1;
+		if (write(loop->post_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+			wlf_log_errno(WLF_ERROR, "Failed to wake up event loop");
+		}
+	}
+
+	return true;
+}
+
+void wlf_event_source_remove(struct wlf_event_source *source) {
+	if (source == NULL || source->removed) {
+		return;
+	}
+
+	struct wlf_event_loop *loop = source->loop;
+	switch (source->type) {
+	case EVENT_SOURCE_FD:
+		if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_DEL, source->fd, NULL) < 0) {
+			wlf_log_errno(WLF_ERROR, "Failed to remove fd %d from event loop",
+				source->fd);
+		}
+		source->fd = -1;
+		break;
+	case EVENT_SOURCE_TIMER:
+		if (source->heap_index != TIMER_HEAP_NONE) {
+			timer_heap_remove(loop, source);
+			update_timer_fd(loop);
+		}
+		break;
+	case EVENT_SOURCE_IDLE:
+		wlf_linked_list_remove(&source->idle_link);
+		wlf_linked_list_init(&source->idle_link);
+		break;
+	}
+
+	/* Events already returned by epoll_wait() may still point at the
+	 * source, so it is only freed once the current dispatch is over. */
+	source->removed = true;
+	wlf_linked_list_remove(&source->link);
+	wlf_linked_list_insert(&loop->destroy_list, &source->link);
+}
+
+bool wlf_event_loop_dispatch(struct wlf_event_loop *loop, int timeout) {
+	assert(loop != NULL);
+	if (!wlf_linked_list_empty(&loop->idle_list)) {
+		timeout = 0;
+	}
+
+	struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+	int count = epoll_wait(loop->epoll_fd, events, EVENT_LOOP_MAX_EVENTS,
+		timeout);
+	if (count < 0) {
+		if (errno == EINTR) {
+			return true;
+		}
+		wlf_log_errno(WLF_ERROR, "epoll_wait() failed in event loop");
+		return false;
+	}
+
+	for (int i = 0; i < count; i++) {
+		struct wlf_event_source *source = events[i].data.ptr;
+		if (!source->removed) {
+			source->fd_func(source->fd, events[i].events, source->data);
+		}
+	}
+
+	destroy_removed_sources(loop);
+	return true;
+}
+
+void wlf_event_loop_dispatch_idle(struct wlf_event_loop *loop) {
+	assert(loop != NULL);
+
+	while (!wlf_linked_list_empty(&loop->idle_list)) {
+		struct wlf_event_source *source = wlf_container_of(
+			loop->idle_list.next, source, idle_link);
+		wlf_event_source_remove(source);
+		source->func(source->data);
+	}
+
+	destroy_removed_sources(loop);
+}
+
+bool wlf_event_loop_has_idle(const struct wlf_event_loop *loop) {
+	assert(loop != NULL);
+	return !wlf_linked_list_empty(&loop->idle_list);
+}
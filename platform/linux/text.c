@@ -1,5 +1,7 @@
 #include "wlf/platform/linux/text.h"
 
+#include "wlf/utils/wlf_hash.h"
+#include "wlf/utils/wlf_linked_list.h"
 #include "wlf/utils/wlf_log.h"
 
 #include <cairo/cairo.h>
@@ -7,6 +9,7 @@
 #include <math.h>
 #include <pango/pangocairo.h>
 #include <stdlib.h>
+#include <string.h>
 
 static PangoStyle to_pango_style(enum wlf_text_font_slant slant) {
 	switch (slant) {
@@ -25,39 +28,73 @@ static PangoWeight to_pango_weight(enum wlf_text_font_weight weight) {
 		PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL;
 }
 
-static PangoLayout *create_layout(cairo_t *cr,
-		const struct wlf_text_options *options) {
-	PangoLayout *layout = pango_cairo_create_layout(cr);
-	if (layout == NULL) {
-		return NULL;
+static void linux_text_font_finish(struct wlf_linux_text_font *font) {
+	if (font->description != NULL) {
+		pango_font_description_free(font->description);
 	}
+	free(font->family);
+	*font = (struct wlf_linux_text_font){0};
+}
 
-	PangoFontDescription *font = pango_font_description_new();
-	if (font == NULL) {
-		g_object_unref(layout);
+static PangoFontDescription *linux_text_create_description(const char *family,
+		int size, enum wlf_text_font_slant slant,
+		enum wlf_text_font_weight weight) {
+	PangoFontDescription *description = pango_font_description_new();
+	if (description == NULL) {
 		return NULL;
 	}
+	pango_font_description_set_family(description, family);
+	pango_font_description_set_absolute_size(description, size);
+	pango_font_description_set_style(description, to_pango_style(slant));
+	pango_font_description_set_weight(description, to_pango_weight(weight));
+	return description;
+}
 
-	double pixel_size = options->font_size * options->raster_scale;
-	if (!isfinite(pixel_size) || pixel_size <= 0 ||
-			pixel_size > INT_MAX / (double)PANGO_SCALE) {
-		pango_font_description_free(font);
-		g_object_unref(layout);
-		return NULL;
+/* Returns the cached description for a font key, replacing the least
+ * recently used slot on a miss. The description stays owned by the cache. */
+static struct wlf_linux_text_font *linux_text_get_font(struct wlf_linux_text *text,
+		const char *family, int size, enum wlf_text_font_slant slant,
+		enum wlf_text_font_weight weight) {
+	struct wlf_linux_text_font *victim = &text->fonts[0];
+	text->font_use_counter++;
+	for (size_t i = 0; i < WLF_LINUX_TEXT_FONT_CACHE_SIZE; i++) {
+		struct wlf_linux_text_font *font = &text->fonts[i];
+		if (font->family == NULL) {
+			victim = font;
+			continue;
+		}
+		if (font->size == size && font->slant == slant &&
+				font->weight == weight && strcmp(font->family, family) == 0) {
+			font->last_used = text->font_use_counter;
+			return font;
+		}
+		if (victim->family != NULL && font->last_used < victim->last_used) {
+			victim = font;
+		}
 	}
 
-	pango_font_description_set_family(font,
-		options->font_family != NULL ? options->font_family : "sans-serif");
-	pango_font_description_set_absolute_size(font,
-		pixel_size * PANGO_SCALE);
-	pango_font_description_set_style(font, to_pango_style(options->slant));
-	pango_font_description_set_weight(font, to_pango_weight(options->weight));
-	pango_layout_set_font_description(layout, font);
-	pango_font_description_free(font);
+	char *copy = strdup(family);
+	PangoFontDescription *description =
+		linux_text_create_description(family, size, slant, weight);
+	if (copy == NULL || description == NULL) {
+		free(copy);
+		if (description != NULL) {
+			pango_font_description_free(description);
+		}
+		return NULL;
+	}
 
-	pango_layout_set_text(layout, options->text, -1);
-	pango_layout_set_auto_dir(layout, true);
-	return layout;
+	linux_text_font_finish(victim);
+	*victim = (struct wlf_linux_text_font){
+		.family = copy,
+		.size = size,
+		.slant = slant,
+		.weight = weight,
+		.description = description,
+		.id = ++text->next_font_id,
+		.last_used = text->font_use_counter,
+	};
+	return victim;
 }
 
 static void measure_layout(PangoLayout *layout,
@@ -80,6 +117,281 @@ static void measure_layout(PangoLayout *layout,
 	};
 }
 
+/* Every raster is an image surface with an identity transform, so the font
+ * options of one image surface apply to all of them. Pango keys its fontset
+ * cache on these options, so the warm-up context must be set up alike. */
+static PangoContext *linux_text_create_context(PangoFontMap *font_map) {
+	PangoContext *context = pango_font_map_create_context(font_map);
+	if (context == NULL) {
+		return NULL;
+	}
+
+	cairo_surface_t *surface = cairo_image_surface_create(
+		CAIRO_FORMAT_ARGB32, 1, 1);
+	cairo_t *cr = cairo_create(surface);
+	pango_cairo_update_context(cr, context);
+	cairo_destroy(cr);
+	cairo_surface_destroy(surface);
+	return context;
+}
+
+/* Loads the fontconfig configuration and resolves every warmed font into a
+ * font map of its own, which Pango would otherwise do while laying out the
+ * first text. The event loop thread adopts the font map once it joins the
+ * thread, so the matches stay in Pango's fontset cache. */
+static gpointer linux_text_warm_up_thread(gpointer data) {
+	struct wlf_linux_text *text = data;
+	text->warm_font_map = pango_cairo_font_map_new();
+	if (text->warm_font_map == NULL) {
+		return NULL;
+	}
+	text->warm_context = linux_text_create_context(text->warm_font_map);
+	if (text->warm_context == NULL) {
+		return NULL;
+	}
+
+	PangoLanguage *language = pango_language_get_default();
+	for (size_t i = 0; i < text->warm_font_count; i++) {
+		struct wlf_linux_text_warm_font *warm = &text->warm_fonts[i];
+		PangoFontDescription *description = linux_text_create_description(
+			warm->family, warm->size, warm->slant, warm->weight);
+		if (description == NULL) {
+			continue;
+		}
+		warm->fontset = pango_font_map_load_fontset(text->warm_font_map,
+			text->warm_context, description, language);
+		pango_font_description_free(description);
+		if (warm->fontset == NULL) {
+			continue;
+		}
+		/* Loading is lazy; looking up a glyph matches and opens the
+		 * primary font. */
+		PangoFont *font = pango_fontset_get_font(warm->fontset, 'A');
+		if (font != NULL) {
+			g_object_unref(font);
+		}
+	}
+	return NULL;
+}
+
+/* Switches to the font map of a finished warm-up. Layouts are bound to the
+ * old context, so the cached ones are dropped and recreated on demand. */
+static void linux_text_adopt_font_map(struct wlf_linux_text *text,
+		PangoFontMap *font_map, PangoContext *context) {
+	for (size_t i = 0; i < WLF_LINUX_TEXT_LAYOUT_CACHE_SIZE; i++) {
+		free(text->layouts[i].text);
+		if (text->layouts[i].layout != NULL) {
+			g_object_unref(text->layouts[i].layout);
+		}
+		text->layouts[i] = (struct wlf_linux_text_layout){0};
+	}
+	if (text->wrap_layout != NULL) {
+		g_object_unref(text->wrap_layout);
+		text->wrap_layout = NULL;
+	}
+
+	g_object_unref(text->context);
+	g_object_unref(text->font_map);
+	text->font_map = font_map;
+	text->context = context;
+}
+
+/* Joins the warm-up thread and adopts its font map. The fontsets stay
+ * referenced so that Pango keeps them cached. */
+static void linux_text_finish_warm_up(struct wlf_linux_text *text) {
+	if (text->warm_up_thread == NULL) {
+		return;
+	}
+	g_thread_join(text->warm_up_thread);
+	text->warm_up_thread = NULL;
+
+	if (text->warm_context != NULL) {
+		linux_text_adopt_font_map(text, text->warm_font_map,
+			text->warm_context);
+	} else if (text->warm_font_map != NULL) {
+		g_object_unref(text->warm_font_map);
+	}
+	text->warm_font_map = NULL;
+	text->warm_context = NULL;
+}
+
+static void linux_text_release_warm_fonts(struct wlf_linux_text *text) {
+	linux_text_finish_warm_up(text);
+	for (size_t i = 0; i < text->warm_font_count; i++) {
+		if (text->warm_fonts[i].fontset != NULL) {
+			g_object_unref(text->warm_fonts[i].fontset);
+		}
+		free(text->warm_fonts[i].family);
+	}
+	free(text->warm_fonts);
+	text->warm_fonts = NULL;
+	text->warm_font_count = 0;
+}
+
+static bool linux_text_warm_up(struct wlf_text *wlf_text,
+		const struct wlf_text_font *fonts, size_t count) {
+	struct wlf_linux_text *text = wlf_container_of(wlf_text, text, base);
+	linux_text_release_warm_fonts(text);
+
+	struct wlf_linux_text_warm_font *warm_fonts =
+		calloc(count, sizeof(*warm_fonts));
+	if (warm_fonts == NULL) {
+		wlf_log_errno(WLF_ERROR, "failed to allocate warmed fonts");
+		return false;
+	}
+	text->warm_fonts = warm_fonts;
+	text->warm_font_count = count;
+	for (size_t i = 0; i < count; i++) {
+		double scale = fonts[i].scale > 0 ? fonts[i].scale : 1.0;
+		double pixel_size = fonts[i].size * scale;
+		if (pixel_size > INT_MAX / (double)PANGO_SCALE) {
+			linux_text_release_warm_fonts(text);
+			return false;
+		}
+		warm_fonts[i] = (struct wlf_linux_text_warm_font){
+			.family = strdup(fonts[i].family != NULL ?
+				fonts[i].family : "sans-serif"),
+			.size = (int)(pixel_size * PANGO_SCALE),
+			.slant = fonts[i].slant,
+			.weight = fonts[i].weight,
+		};
+		if (warm_fonts[i].family == NULL) {
+			wlf_log_errno(WLF_ERROR, "failed to allocate warmed font");
+			linux_text_release_warm_fonts(text);
+			return false;
+		}
+	}
+
+	text->warm_up_thread = g_thread_try_new("wlf-linux-text-warm-up",
+		linux_text_warm_up_thread, text, NULL);
+	if (text->warm_up_thread == NULL) {
+		wlf_log(WLF_ERROR, "failed to start font warm-up thread");
+		linux_text_release_warm_fonts(text);
+		return false;
+	}
+	return true;
+}
+
+static struct wlf_linux_text_font *linux_text_get_options_font(
+		struct wlf_linux_text *text, const struct wlf_text_options *options) {
+	linux_text_finish_warm_up(text);
+	double pixel_size = options->font_size * options->raster_scale;
+	if (!isfinite(pixel_size) || pixel_size <= 0 ||
+			pixel_size > INT_MAX / (double)PANGO_SCALE) {
+		return NULL;
+	}
+
+	return linux_text_get_font(text,
+		options->font_family != NULL ? options->font_family : "sans-serif",
+		(int)(pixel_size * PANGO_SCALE), options->slant, options->weight);
+}
+
+/* Returns the shaped layout for @p options from the cache, shaping it into
+ * the least recently used slot on a miss. Measuring a string and then
+ * rasterizing or shaping it thus shapes it once. */
+static struct wlf_linux_text_layout *linux_text_get_layout(
+		struct wlf_linux_text *text, const struct wlf_text_options *options) {
+	struct wlf_linux_text_font *font =
+		linux_text_get_options_font(text, options);
+	if (font == NULL) {
+		return NULL;
+	}
+
+	uint64_t hash = wlf_hash_string(WLF_HASH_INIT, options->text);
+	struct wlf_linux_text_layout *victim = &text->layouts[0];
+	for (size_t i = 0; i < WLF_LINUX_TEXT_LAYOUT_CACHE_SIZE; i++) {
+		struct wlf_linux_text_layout *entry = &text->layouts[i];
+		if (entry->text == NULL) {
+			victim = entry;
+			continue;
+		}
+		if (entry->hash == hash && entry->font == font->id &&
+				strcmp(entry->text, options->text) == 0) {
+			entry->last_used = text->font_use_counter;
+			return entry;
+		}
+		if (victim->text != NULL && entry->last_used < victim->last_used) {
+			victim = entry;
+		}
+	}
+
+	char *copy = strdup(options->text);
+	if (copy == NULL) {
+		return NULL;
+	}
+	if (victim->layout == NULL) {
+		victim->layout = pango_layout_new(text->context);
+		if (victim->layout == NULL) {
+			free(copy);
+			return NULL;
+		}
+		pango_layout_set_auto_dir(victim->layout, true);
+	}
+	free(victim->text);
+	victim->text = copy;
+	victim->hash = hash;
+	victim->font = font->id;
+	victim->last_used = text->font_use_counter;
+	pango_layout_set_font_description(victim->layout, font->description);
+	pango_layout_set_text(victim->layout, options->text, -1);
+	measure_layout(victim->layout, &victim->metrics);
+	return victim;
+}
+
+static bool linux_text_measure(struct wlf_text *wlf_text,
+		const struct wlf_text_options *options,
+		struct wlf_text_metrics *metrics) {
+	struct wlf_linux_text *text = wlf_container_of(wlf_text, text, base);
+	struct wlf_linux_text_layout *entry = linux_text_get_layout(text, options);
+	if (entry == NULL) {
+		return false;
+	}
+	*metrics = entry->metrics;
+	return true;
+}
+
+/* Wrapping uses a layout of its own, so wrapping a long document does not
+ * evict the shaped layouts of the text on screen. */
+static bool linux_text_wrap(struct wlf_text *wlf_text,
+		const struct wlf_text_options *options, struct wlf_array *lines) {
+	struct wlf_linux_text *text = wlf_container_of(wlf_text, text, base);
+	double width = options->max_width * options->raster_scale * PANGO_SCALE;
+	if (width > INT_MAX) {
+		return false;
+	}
+	struct wlf_linux_text_font *font =
+		linux_text_get_options_font(text, options);
+	if (font == NULL) {
+		return false;
+	}
+
+	if (text->wrap_layout == NULL) {
+		text->wrap_layout = pango_layout_new(text->context);
+		if (text->wrap_layout == NULL) {
+			return false;
+		}
+		pango_layout_set_auto_dir(text->wrap_layout, true);
+		pango_layout_set_wrap(text->wrap_layout, PANGO_WRAP_WORD_CHAR);
+	}
+	pango_layout_set_font_description(text->wrap_layout, font->description);
+	pango_layout_set_width(text->wrap_layout, (int)width);
+	pango_layout_set_text(text->wrap_layout, options->text, -1);
+
+	for (GSList *link = pango_layout_get_lines_readonly(text->wrap_layout);
+			link != NULL; link = link->next) {
+		const PangoLayoutLine *layout_line = link->data;
+		struct wlf_text_line *line = wlf_array_add(lines, sizeof(*line));
+		if (line == NULL) {
+			return false;
+		}
+		*line = (struct wlf_text_line){
+			.start = (size_t)layout_line->start_index,
+			.length = (size_t)layout_line->length,
+		};
+	}
+	return true;
+}
+
 static void linux_text_raster_destroy(struct wlf_text *text,
 		struct wlf_text_raster *raster) {
 	(void)text;
@@ -89,39 +401,25 @@ static void linux_text_raster_destroy(struct wlf_text *text,
 	*raster = (struct wlf_text_raster){0};
 }
 
-static bool linux_text_rasterize(struct wlf_text *text,
+static bool linux_text_rasterize(struct wlf_text *wlf_text,
 		const struct wlf_text_options *options,
 		struct wlf_text_raster *raster) {
-	(void)text;
-
-	cairo_surface_t *measure_surface = cairo_image_surface_create(
-		CAIRO_FORMAT_ARGB32, 1, 1);
-	if (cairo_surface_status(measure_surface) != CAIRO_STATUS_SUCCESS) {
-		cairo_surface_destroy(measure_surface);
+	struct wlf_linux_text *text = wlf_container_of(wlf_text, text, base);
+	struct wlf_linux_text_layout *entry = linux_text_get_layout(text, options);
+	if (entry == NULL) {
 		return false;
 	}
-	cairo_t *measure = cairo_create(measure_surface);
-	PangoLayout *layout = create_layout(measure, options);
-	struct wlf_text_metrics metrics = {0};
-	if (layout != NULL) {
-		measure_layout(layout, &metrics);
-	}
-	bool measured = layout != NULL &&
-		cairo_status(measure) == CAIRO_STATUS_SUCCESS;
-	cairo_destroy(measure);
-	cairo_surface_destroy(measure_surface);
-	if (!measured || metrics.width < 0 || metrics.height < 0 ||
+
+	PangoLayout *layout = entry->layout;
+	struct wlf_text_metrics metrics = entry->metrics;
+	if (metrics.width < 0 || metrics.height < 0 ||
 			metrics.width > INT32_MAX || metrics.height > INT32_MAX) {
-		if (layout != NULL) {
-			g_object_unref(layout);
-		}
 		return false;
 	}
 
 	raster->metrics = metrics;
 	if (options->text[0] == '\0' || metrics.width <= 0 ||
 			metrics.height <= 0) {
-		g_object_unref(layout);
 		return true;
 	}
 
@@ -130,7 +428,6 @@ static bool linux_text_rasterize(struct wlf_text *text,
 	if (options->max_width > 0) {
 		double max_pixel_width = options->max_width * options->raster_scale;
 		if (!isfinite(max_pixel_width) || max_pixel_width < 0) {
-			g_object_unref(layout);
 			return false;
 		}
 		if (max_pixel_width < width) {
@@ -138,31 +435,25 @@ static bool linux_text_rasterize(struct wlf_text *text,
 		}
 	}
 	if (width <= 0 || height <= 0) {
-		g_object_unref(layout);
 		return true;
 	}
 
+	/* Coverage only; the color is applied when the raster is drawn. */
 	cairo_surface_t *surface = cairo_image_surface_create(
-		CAIRO_FORMAT_ARGB32, width, height);
+		CAIRO_FORMAT_A8, width, height);
 	if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
 		wlf_log(WLF_ERROR, "failed to create Cairo text surface: %s",
 			cairo_status_to_string(cairo_surface_status(surface)));
-		g_object_unref(layout);
 		cairo_surface_destroy(surface);
 		return false;
 	}
 
 	cairo_t *cr = cairo_create(surface);
-	cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
-	cairo_paint(cr);
-	cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
-	struct wlf_color color = wlf_color_clamp(&options->color);
-	cairo_set_source_rgba(cr, color.r, color.g, color.b, color.a);
+	cairo_set_source_rgba(cr, 0, 0, 0, 1);
 	cairo_move_to(cr, -metrics.left, -metrics.top);
 	pango_cairo_update_layout(cr, layout);
 	pango_cairo_show_layout(cr, layout);
 	bool drawn = cairo_status(cr) == CAIRO_STATUS_SUCCESS;
-	g_object_unref(layout);
 	cairo_destroy(cr);
 	if (!drawn) {
 		wlf_log(WLF_ERROR, "failed to rasterize text node");
@@ -179,14 +470,228 @@ static bool linux_text_rasterize(struct wlf_text *text,
 	return true;
 }
 
-static void linux_text_destroy(struct wlf_text *text) {
+/* Returns the identifier of a shaped font. Identifiers are never reused, so
+ * glyph caches keyed by them stay valid when a slot is recycled. */
+static uint32_t linux_text_glyph_font_id(struct wlf_linux_text *text,
+		PangoFont *font) {
+	struct wlf_linux_text_glyph_font *victim = &text->glyph_fonts[0];
+	text->font_use_counter++;
+	for (size_t i = 0; i < WLF_LINUX_TEXT_GLYPH_FONT_COUNT; i++) {
+		struct wlf_linux_text_glyph_font *slot = &text->glyph_fonts[i];
+		if (slot->font == font) {
+			slot->last_used = text->font_use_counter;
+			return slot->id;
+		}
+		if (slot->last_used < victim->last_used) {
+			victim = slot;
+		}
+	}
+
+	if (victim->font != NULL) {
+		g_object_unref(victim->font);
+	}
+	*victim = (struct wlf_linux_text_glyph_font){
+		.font = g_object_ref(font),
+		.id = ++text->next_glyph_font_id,
+		.last_used = text->font_use_counter,
+	};
+	return victim->id;
+}
+
+static PangoFont *linux_text_glyph_font(struct wlf_linux_text *text,
+		uint32_t id) {
+	for (size_t i = 0; i < WLF_LINUX_TEXT_GLYPH_FONT_COUNT; i++) {
+		if (text->glyph_fonts[i].font != NULL &&
+				text->glyph_fonts[i].id == id) {
+			return text->glyph_fonts[i].font;
+		}
+	}
+	return NULL;
+}
+
+static bool glyph_run_add(struct wlf_text_glyph_run *run, size_t *capacity,
+		const struct wlf_text_glyph *glyph) {
+	if (run->glyph_count == *capacity) {
+		size_t new_capacity = *capacity == 0 ? 32 : *capacity * 2;
+		struct wlf_text_glyph *glyphs = realloc(run->glyphs,
+			new_capacity * sizeof(*glyphs));
+		if (glyphs == NULL) {
+			wlf_log_errno(WLF_ERROR, "failed to grow glyph run");
+			return false;
+		}
+		run->glyphs = glyphs;
+		*capacity = new_capacity;
+	}
+	run->glyphs[run->glyph_count++] = *glyph;
+	return true;
+}
+
+static bool linux_text_shape(struct wlf_text *wlf_text,
+		const struct wlf_text_options *options,
+		struct wlf_text_glyph_run *run) {
+	struct wlf_linux_text *text = wlf_container_of(wlf_text, text, base);
+	struct wlf_linux_text_layout *entry = linux_text_get_layout(text, options);
+	if (entry == NULL) {
+		return false;
+	}
+
+	run->metrics = entry->metrics;
+
+	/* Hexadecimal boxes drawn for unknown glyphs have no glyph to cache;
+	 * they are skipped like glyphs without ink. */
+	size_t capacity = 0;
+	bool ok = true;
+	PangoLayoutIter *iter = pango_layout_get_iter(entry->layout);
+	do {
+		PangoLayoutRun *layout_run = pango_layout_iter_get_run_readonly(iter);
+		if (layout_run == NULL) {
+			continue;
+		}
+
+		PangoRectangle logical;
+		pango_layout_iter_get_run_extents(iter, NULL, &logical);
+		int baseline = pango_layout_iter_get_baseline(iter);
+		uint32_t font = linux_text_glyph_font_id(text,
+			layout_run->item->analysis.font);
+		PangoGlyphString *glyphs = layout_run->glyphs;
+		int x = logical.x;
+		for (int i = 0; ok && i < glyphs->num_glyphs; i++) {
+			const PangoGlyphInfo *info = &glyphs->glyphs[i];
+			if (info->glyph != PANGO_GLYPH_EMPTY &&
+					(info->glyph & PANGO_GLYPH_UNKNOWN_FLAG) == 0) {
+				ok = glyph_run_add(run, &capacity, &(struct wlf_text_glyph){
+					.font = font,
+					.index = info->glyph,
+					.x = (float)((x + info->geometry.x_offset) /
+						(double)PANGO_SCALE - run->metrics.left),
+					.y = (float)((baseline + info->geometry.y_offset) /
+						(double)PANGO_SCALE - run->metrics.top),
+				});
+			}
+			x += info->geometry.width;
+		}
+	} while (ok && pango_layout_iter_next_run(iter));
+	pango_layout_iter_free(iter);
+
+	return ok;
+}
+
+static void linux_text_glyph_image_destroy(struct wlf_text *text,
+		struct wlf_text_glyph_image *image) {
+	(void)text;
+	if (image->private_data != NULL) {
+		cairo_surface_destroy(image->private_data);
+	}
+	*image = (struct wlf_text_glyph_image){0};
+}
+
+static bool linux_text_rasterize_glyph(struct wlf_text *wlf_text,
+		uint32_t font_id, uint32_t index, float subpixel_x,
+		struct wlf_text_glyph_image *image) {
+	struct wlf_linux_text *text = wlf_container_of(wlf_text, text, base);
+	PangoFont *font = linux_text_glyph_font(text, font_id);
+	if (font == NULL || !PANGO_IS_CAIRO_FONT(font)) {
+		return false;
+	}
+	cairo_scaled_font_t *scaled_font =
+		pango_cairo_font_get_scaled_font(PANGO_CAIRO_FONT(font));
+	if (scaled_font == NULL ||
+			cairo_scaled_font_status(scaled_font) != CAIRO_STATUS_SUCCESS) {
+		return false;
+	}
+
+	cairo_glyph_t glyph = {
+		.index = index,
+		.x = subpixel_x,
+		.y = 0,
+	};
+	cairo_text_extents_t extents;
+	cairo_scaled_font_glyph_extents(scaled_font, &glyph, 1, &extents);
+	if (extents.width <= 0 || extents.height <= 0) {
+		return true;
+	}
+
+	/* One pixel of margin keeps antialiased edges inside the mask. */
+	double left = floor(subpixel_x + extents.x_bearing) - 1;
+	double top = floor(extents.y_bearing) - 1;
+	double right = ceil(subpixel_x + extents.x_bearing + extents.width) + 1;
+	double bottom = ceil(extents.y_bearing + extents.height) + 1;
+	if (right - left > INT16_MAX || bottom - top > INT16_MAX) {
+		return false;
+	}
+	int width = (int)(right - left);
+	int height = (int)(bottom - top);
+
+	cairo_surface_t *surface = cairo_image_surface_create(
+		CAIRO_FORMAT_A8, width, height);
+	if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+		cairo_surface_destroy(surface);
+		return false;
+	}
+	cairo_t *cr = cairo_create(surface);
+	cairo_set_scaled_font(cr, scaled_font);
+	glyph.x = subpixel_x - left;
+	glyph.y = -top;
+	cairo_show_glyphs(cr, &glyph, 1);
+	bool drawn = cairo_status(cr) == CAIRO_STATUS_SUCCESS;
+	cairo_destroy(cr);
+	if (!drawn) {
+		cairo_surface_destroy(surface);
+		return false;
+	}
+
+	cairo_surface_flush(surface);
+	*image = (struct wlf_text_glyph_image){
+		.left = (int32_t)left,
+		.top = (int32_t)top,
+		.width = (uint32_t)width,
+		.height = (uint32_t)height,
+		.stride = (uint32_t)cairo_image_surface_get_stride(surface),
+		.data = cairo_image_surface_get_data(surface),
+		.private_data = surface,
+	};
+	return true;
+}
+
+static void linux_text_destroy(struct wlf_text *wlf_text) {
+	struct wlf_linux_text *text = wlf_container_of(wlf_text, text, base);
+	linux_text_release_warm_fonts(text);
+	for (size_t i = 0; i < WLF_LINUX_TEXT_FONT_CACHE_SIZE; i++) {
+		linux_text_font_finish(&text->fonts[i]);
+	}
+	for (size_t i = 0; i < WLF_LINUX_TEXT_GLYPH_FONT_COUNT; i++) {
+		if (text->glyph_fonts[i].font != NULL) {
+			g_object_unref(text->glyph_fonts[i].font);
+		}
+	}
+	for (size_t i = 0; i < WLF_LINUX_TEXT_LAYOUT_CACHE_SIZE; i++) {
+		free(text->layouts[i].text);
+		if (text->layouts[i].layout != NULL) {
+			g_object_unref(text->layouts[i].layout);
+		}
+	}
+	if (text->wrap_layout != NULL) {
+		g_object_unref(text->wrap_layout);
+	}
+	if (text->context != NULL) {
+		g_object_unref(text->context);
+	}
+	if (text->font_map != NULL) {
+		g_object_unref(text->font_map);
+	}
 	free(text);
 }
 
 static const struct wlf_text_impl linux_text_impl = {
 	.name = "linux-cairo-pango-harfbuzz",
+	.measure = linux_text_measure,
+	.wrap = linux_text_wrap,
+	.warm_up = linux_text_warm_up,
 	.rasterize = linux_text_rasterize,
 	.destroy_raster = linux_text_raster_destroy,
+	.shape = linux_text_shape,
+	.rasterize_glyph = linux_text_rasterize_glyph,
+	.destroy_glyph_image = linux_text_glyph_image_destroy,
 	.destroy = linux_text_destroy,
 };
 
@@ -198,5 +703,18 @@ struct wlf_linux_text *wlf_linux_text_create(void) {
 	}
 
 	wlf_text_init(&text->base, &linux_text_impl);
+
+	/* A private font map rather than the per-thread default one, so the
+	 * object does not depend on the thread that created it. */
+	text->font_map = pango_cairo_font_map_new();
+	if (text->font_map != NULL) {
+		text->context = linux_text_create_context(text->font_map);
+	}
+	if (text->context == NULL) {
+		wlf_log(WLF_ERROR, "failed to create Pango context");
+		linux_text_destroy(&text->base);
+		return NULL;
+	}
+
 	return text;
 }
@@ -1,5 +1,6 @@
 #include "wlf/platform/macos/backend.h"
 #include "wlf/platform/wlf_backend.h"
+#include "wlf/utils/wlf_linked_list.h"
 #include "wlf/utils/wlf_log.h"
 #include "wlf/utils/wlf_utils.h"
 
@@ -29,55 +30,73 @@ static bool backend_ensure_appkit(struct wlf_backend_macos *macos) {
 	return true;
 }
 
+/* Looks a source up again before each dispatch, as an earlier callback of
+ * the same iteration may have removed it. */
+static struct wlf_backend_event_source *backend_find_event_source(
+		struct wlf_backend *backend, int fd, void *data) {
+	struct wlf_backend_event_source *source;
+	wlf_linked_list_for_each(source, &backend->event_sources, link) {
+		if (source->fd == fd && source->data == data) {
+			return source;
+		}
+	}
+
+	return NULL;
+}
+
 static void backend_dispatch_event_sources(struct wlf_backend *backend,
 		int timeout_ms) {
-	if (backend->event_source_count == 0) {
+	size_t count = (size_t)wlf_linked_list_length(&backend->event_sources);
+	if (count == 0) {
 		if (timeout_ms > 0) {
 			(void)poll(NULL, 0, timeout_ms);
 		}
 		return;
 	}
 
-	struct pollfd *fds = calloc(backend->event_source_count, sizeof(*fds));
-	if (fds == NULL) {
+	struct pollfd *fds = calloc(count, sizeof(*fds));
+	void **data = calloc(count, sizeof(*data));
+	if (fds == NULL || data == NULL) {
 		wlf_log_errno(WLF_ERROR, "Failed to allocate pollfd array");
 		backend->running = false;
+		free(fds);
+		free(data);
 		return;
 	}
 
-	for (size_t i = 0; i < backend->event_source_count; ++i) {
-		fds[i].fd = backend->event_sources[i].fd;
-		fds[i].events = backend->event_sources[i].events;
+	size_t i = 0;
+	struct wlf_backend_event_source *source;
+	wlf_linked_list_for_each(source, &backend->event_sources, link) {
+		fds[i].fd = source->fd;
+		fds[i].events = source->events;
+		data[i] = source->data;
+		i++;
 	}
 
-	int poll_ret = poll(fds, backend->event_source_count, timeout_ms);
+	int poll_ret = poll(fds, count, timeout_ms);
 	if (poll_ret < 0) {
 		if (errno != EINTR) {
 			wlf_log_errno(WLF_ERROR, "poll() failed in macOS event loop");
 			backend->running = false;
 		}
-		free(fds);
-		return;
-	}
-
-	if (poll_ret == 0) {
-		free(fds);
-		return;
+		goto out;
 	}
 
-	for (size_t i = 0; i < backend->event_source_count; ++i) {
-		if (fds[i].revents == 0 || backend->event_sources[i].dispatch == NULL) {
+	for (i = 0; poll_ret > 0 && i < count; ++i) {
+		if (fds[i].revents == 0) {
 			continue;
 		}
 
-		backend->event_sources[i].dispatch(
-			backend,
-			backend->event_sources[i].fd,
-			(uint32_t)fds[i].revents,
-			backend->event_sources[i].data);
+		source = backend_find_event_source(backend, fds[i].fd, data[i]);
+		if (source != NULL) {
+			source->dispatch(backend, source->fd, (uint32_t)fds[i].revents,
+				source->data);
+		}
 	}
 
+out:
 	free(fds);
+	free(data);
 }
 
 static bool backend_process_appkit_events(struct wlf_backend_macos *macos) {
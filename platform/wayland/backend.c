@@ -1,4 +1,5 @@
 #include "wlf/platform/wayland/backend.h"
+#include "wlf/platform/linux/event_loop.h"
 #include "wlf/wayland/wlf_wl_seat.h"
 #include "wlf/platform/wlf_backend.h"
 #include "wlf/utils/wlf_linked_list.h"
@@ -939,6 +940,9 @@ static void backend_destroy(struct wlf_backend *backend) {
 		wl_display_disconnect(wayland->display);
 	}
 
+	wlf_event_loop_destroy(backend->event_loop);
+	backend->event_loop = NULL;
+
 	free(wayland);
 }
 
@@ -951,8 +955,19 @@ static void backend_exe(struct wlf_backend *backend) {
 		return;
 	}
 
+	/* Every other source sits behind the event loop's epoll fd, so a wakeup
+	 * polls two fds however many sources are registered. The display is
+	 * read before any source is dispatched, as callbacks may use it. */
+	struct wlf_event_loop *loop = backend->event_loop;
+	struct pollfd fds[2] = {
+		{ .fd = wayland_fd, .events = POLLIN },
+		{ .fd = wlf_event_loop_get_fd(loop), .events = POLLIN },
+	};
+
 	backend->running = true;
 	while (backend->running) {
+		wlf_event_loop_dispatch_idle(loop);
+
 		if (wl_display_dispatch_pending(wayland_backend->display) == -1) {
 			wlf_log(WLF_ERROR, "Failed to dispatch Wayland pending events");
 			break;
@@ -970,61 +985,33 @@ static void backend_exe(struct wlf_backend *backend) {
 			}
 		}
 
-		size_t nfds = 1 + backend->event_source_count;
-		struct pollfd *fds = calloc(nfds, sizeof(struct pollfd));
-		if (fds == NULL) {
-			wlf_log_errno(WLF_ERROR, "Failed to allocate pollfd array");
-			wl_display_cancel_read(wayland_backend->display);
-			break;
-		}
-
-		fds[0].fd = wayland_fd;
-		fds[0].events = POLLIN;
-
-		for (size_t i = 0; i < backend->event_source_count; ++i) {
-			fds[i + 1].fd = backend->event_sources[i].fd;
-			fds[i + 1].events = backend->event_sources[i].events;
-		}
-
-		int poll_ret = poll(fds, nfds, -1);
+		/* Idle callbacks queued by Wayland events run before blocking. */
+		int timeout = wlf_event_loop_has_idle(loop) ? 0 : -1;
+		int poll_ret = poll(fds, 2, timeout);
 		if (poll_ret < 0) {
 			if (errno == EINTR) {
 				wl_display_cancel_read(wayland_backend->display);
-				free(fds);
 				continue;
 			}
 
 			wlf_log_errno(WLF_ERROR, "poll() failed in Wayland event loop");
 			wl_display_cancel_read(wayland_backend->display);
-			free(fds);
 			break;
 		}
 
 		if ((fds[0].revents & (POLLIN | POLLERR | POLLHUP | POLLNVAL)) != 0) {
 			if (wl_display_read_events(wayland_backend->display) == -1) {
 				wlf_log(WLF_ERROR, "Failed to read Wayland events");
-				free(fds);
 				break;
 			}
 		} else {
 			wl_display_cancel_read(wayland_backend->display);
 		}
 
-		for (size_t i = 0; i < backend->event_source_count; ++i) {
-			if (fds[i + 1].revents == 0) {
-				continue;
-			}
-
-			if (backend->event_sources[i].dispatch != NULL) {
-				backend->event_sources[i].dispatch(
-					backend,
-					backend->event_sources[i].fd,
-					(uint32_t)fds[i + 1].revents,
-					backend->event_sources[i].data);
-			}
+		if ((fds[1].revents & POLLIN) != 0 &&
+				!wlf_event_loop_dispatch(loop, 0)) {
+			break;
 		}
-
-		free(fds);
 	}
 
 out:
@@ -1054,6 +1041,11 @@ struct wlf_backend *wayland_backend_create(void) {
 
 	wlf_backend_init(&backend->base, &wayland_backend_impl);
 	wlf_linked_list_init(&backend->interfaces);
+	backend->base.event_loop = wlf_event_loop_create();
+	if (backend->base.event_loop == NULL) {
+		goto failed;
+	}
+
 	backend->display = wl_display_connect(NULL);
 	if (backend->display == NULL) {
 		wlf_log(WLF_ERROR, "No Wayland display connection");
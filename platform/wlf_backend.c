@@ -1,11 +1,13 @@
 #include "wlf/platform/wlf_backend.h"
 #include "wlf/config.h"
+#include "wlf/platform/wlf_text.h"
 #include "wlf/platform/wlf_theme.h"
 #include "wlf/utils/wlf_linked_list.h"
 #include "wlf/utils/wlf_log.h"
 #include "wlf/utils/wlf_env.h"
 #include "wlf/utils/wlf_signal.h"
 #if WLF_HAS_LINUX_PLATFORM
+#include "wlf/platform/linux/event_loop.h"
 #include "wlf/platform/wayland/backend.h"
 #elif WLF_HAS_MACOS_PLATFORM
 #include "wlf/platform/macos/backend.h"
@@ -17,6 +19,22 @@
 #include <string.h>
 #include <assert.h>
 
+#if WLF_HAS_LINUX_PLATFORM
+static void handle_event_source(int fd, uint32_t mask, void *data) {
+	struct wlf_backend_event_source *source = data;
+	source->dispatch(source->backend, fd, mask, source->data);
+}
+#endif
+
+static void backend_event_source_destroy(
+		struct wlf_backend_event_source *source) {
+#if WLF_HAS_LINUX_PLATFORM
+	wlf_event_source_remove(source->source);
+#endif
+	wlf_linked_list_remove(&source->link);
+	free(source);
+}
+
 void wlf_backend_init(struct wlf_backend *backend,
 		const struct wlf_backend_impl *impl) {
 	assert(impl->destroy != NULL &&
@@ -32,6 +50,7 @@ void wlf_backend_init(struct wlf_backend *backend,
 	wlf_signal_init(&backend->events.output_added);
 	wlf_signal_init(&backend->events.output_removed);
 	wlf_linked_list_init(&backend->outputs);
+	wlf_linked_list_init(&backend->event_sources);
 }
 
 struct wlf_backend *wlf_backend_autocreate(void) {
@@ -61,6 +80,7 @@ struct wlf_backend *wlf_backend_autocreate(void) {
 
 	if (backend != NULL) {
 		(void)wlf_backend_init_theme(backend);
+		(void)wlf_backend_warm_up_text(backend, NULL, 0);
 	}
 	return backend;
 }
@@ -79,6 +99,63 @@ bool wlf_backend_init_theme(struct wlf_backend *backend) {
 	return true;
 }
 
+struct wlf_text *wlf_backend_get_text(struct wlf_backend *backend) {
+	assert(backend != NULL);
+	if (backend->text == NULL) {
+		backend->text = wlf_text_autocreate();
+		if (backend->text == NULL) {
+			wlf_log(WLF_ERROR, "No text implementation is available for this platform");
+		}
+	}
+	return backend->text;
+}
+
+/* The titlebar font, and the monospace family at the same size. */
+static const struct wlf_text_font default_warm_up_fonts[] = {
+	{ .family = "sans-serif", .size = 16 },
+	{ .family = "monospace", .size = 16 },
+};
+
+static bool backend_warm_up_default_text(struct wlf_backend *backend,
+		double scale) {
+	size_t count = sizeof(default_warm_up_fonts) /
+		sizeof(default_warm_up_fonts[0]);
+	struct wlf_text_font fonts[sizeof(default_warm_up_fonts) /
+		sizeof(default_warm_up_fonts[0])];
+	for (size_t i = 0; i < count; i++) {
+		fonts[i] = default_warm_up_fonts[i];
+		fonts[i].scale = scale;
+	}
+
+	backend->text_warm_up_scale = scale;
+	struct wlf_text *text = wlf_backend_get_text(backend);
+	return text != NULL && wlf_text_warm_up(text, fonts, count);
+}
+
+bool wlf_backend_warm_up_text(struct wlf_backend *backend,
+		const struct wlf_text_font *fonts, size_t count) {
+	assert(backend != NULL);
+	if (fonts == NULL) {
+		/* No window has reported its scale yet. */
+		return backend_warm_up_default_text(backend, 1.0);
+	}
+
+	backend->text_warm_up_scale = 0.0;
+	struct wlf_text *text = wlf_backend_get_text(backend);
+	return text != NULL && wlf_text_warm_up(text, fonts, count);
+}
+
+void wlf_backend_warm_up_text_scale(struct wlf_backend *backend,
+		double scale) {
+	assert(backend != NULL);
+	if (backend->text_warm_up_scale == 0.0 ||
+			backend->text_warm_up_scale == scale) {
+		return;
+	}
+
+	(void)backend_warm_up_default_text(backend, scale);
+}
+
 void wlf_backend_destroy(struct wlf_backend *backend) {
 	if (backend == NULL) {
 		return;
@@ -89,10 +166,12 @@ void wlf_backend_destroy(struct wlf_backend *backend) {
 	wlf_signal_emit_mutable(&backend->events.destroy, backend);
 	wlf_theme_destroy(backend->theme);
 	backend->theme = NULL;
-	free(backend->event_sources);
-	backend->event_sources = NULL;
-	backend->event_source_count = 0;
-	backend->event_source_capacity = 0;
+	wlf_text_destroy(backend->text);
+	backend->text = NULL;
+	struct wlf_backend_event_source *source, *tmp;
+	wlf_linked_list_for_each_safe(source, tmp, &backend->event_sources, link) {
+		backend_event_source_destroy(source);
+	}
 
 	if (backend->impl && backend->impl->destroy) {
 		backend->impl->destroy(backend);
@@ -117,24 +196,31 @@ bool wlf_backend_add_event_source(struct wlf_backend *backend,
 		return false;
 	}
 
-	if (backend->event_source_count == backend->event_source_capacity) {
-		size_t new_capacity = backend->event_source_capacity == 0 ? 4 : backend->event_source_capacity * 2;
-		void *new_sources = realloc(backend->event_sources,
-			new_capacity * sizeof(*backend->event_sources));
-		if (new_sources == NULL) {
-			wlf_log_errno(WLF_ERROR, "Failed to grow backend event source array");
+	struct wlf_backend_event_source *source = calloc(1, sizeof(*source));
+	if (source == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate backend event source");
+		return false;
+	}
+
+	source->backend = backend;
+	source->fd = fd;
+	source->events = events;
+	source->dispatch = dispatch;
+	source->data = data;
+
+#if WLF_HAS_LINUX_PLATFORM
+	if (backend->event_loop != NULL) {
+		/* The poll(2) flags share their values with the epoll(7) ones. */
+		source->source = wlf_event_loop_add_fd(backend->event_loop, fd,
+			(uint16_t)events, handle_event_source, source);
+		if (source->source == NULL) {
+			free(source);
 			return false;
 		}
-
-		backend->event_sources = new_sources;
-		backend->event_source_capacity = new_capacity;
 	}
+#endif
 
-	backend->event_sources[backend->event_source_count].fd = fd;
-	backend->event_sources[backend->event_source_count].events = events;
-	backend->event_sources[backend->event_source_count].dispatch = dispatch;
-	backend->event_sources[backend->event_source_count].data = data;
-	backend->event_source_count++;
+	wlf_linked_list_insert(backend->event_sources.prev, &source->link);
 
 	return true;
 }
@@ -143,15 +229,10 @@ bool wlf_backend_remove_event_source(struct wlf_backend *backend,
 		int fd, void *data) {
 	assert(backend != NULL);
 
-	for (size_t i = 0; i < backend->event_source_count; ++i) {
-		if (backend->event_sources[i].fd == fd && backend->event_sources[i].data == data) {
-			if (i + 1 < backend->event_source_count) {
-				memmove(&backend->event_sources[i],
-					&backend->event_sources[i + 1],
-					(backend->event_source_count - i - 1) * sizeof(*backend->event_sources));
-			}
-
-			backend->event_source_count--;
+	struct wlf_backend_event_source *source;
+	wlf_linked_list_for_each(source, &backend->event_sources, link) {
+		if (source->fd == fd && source->data == data) {
+			backend_event_source_destroy(source);
 			return true;
 		}
 	}
@@ -159,6 +240,27 @@ bool wlf_backend_remove_event_source(struct wlf_backend *backend,
 	return false;
 }
 
+struct wlf_event_loop *wlf_backend_get_event_loop(struct wlf_backend *backend) {
+	assert(backend != NULL);
+	return backend->event_loop;
+}
+
+bool wlf_backend_post(struct wlf_backend *backend,
+		wlf_backend_task_func_t func, void *data) {
+	assert(backend != NULL);
+	assert(func != NULL);
+
+#if WLF_HAS_LINUX_PLATFORM
+	if (backend->event_loop != NULL) {
+		return wlf_event_loop_post(backend->event_loop, func, data);
+	}
+#endif
+
+	wlf_log(WLF_ERROR, "%s backend cannot run posted tasks",
+		backend->impl->name);
+	return false;
+}
+
 void wlf_backend_quit(struct wlf_backend *backend) {
 	backend->running = false;
 }
@@ -19,6 +19,8 @@ void wlf_text_init(struct wlf_text *text,
 	assert(impl->rasterize != NULL);
 	assert(impl->destroy_raster != NULL);
 	assert(impl->destroy != NULL);
+	assert((impl->shape == NULL) == (impl->rasterize_glyph == NULL));
+	assert(impl->rasterize_glyph == NULL || impl->destroy_glyph_image != NULL);
 
 	text->impl = impl;
 }
@@ -51,6 +53,104 @@ void wlf_text_destroy(struct wlf_text *text) {
 	}
 }
 
+static bool text_options_valid(const struct wlf_text_options *options) {
+	return options != NULL && options->text != NULL &&
+		options->font_size > 0 && isfinite(options->font_size) &&
+		options->raster_scale > 0 && isfinite(options->raster_scale) &&
+		wlf_text_is_valid_utf8(options->text);
+}
+
+bool wlf_text_warm_up(struct wlf_text *text, const struct wlf_text_font *fonts,
+		size_t count) {
+	if (text == NULL || text->impl == NULL || text->impl->warm_up == NULL ||
+			fonts == NULL || count == 0) {
+		return false;
+	}
+	for (size_t i = 0; i < count; i++) {
+		if (fonts[i].size <= 0 || !isfinite(fonts[i].size) ||
+				fonts[i].scale < 0 || !isfinite(fonts[i].scale)) {
+			return false;
+		}
+	}
+
+	return text->impl->warm_up(text, fonts, count);
+}
+
+bool wlf_text_measure(struct wlf_text *text,
+		const struct wlf_text_options *options,
+		struct wlf_text_metrics *metrics) {
+	if (metrics == NULL) {
+		return false;
+	}
+	*metrics = (struct wlf_text_metrics){0};
+
+	if (text == NULL || text->impl == NULL || !text_options_valid(options)) {
+		return false;
+	}
+
+	if (text->impl->measure != NULL) {
+		return text->impl->measure(text, options, metrics);
+	}
+
+	struct wlf_text_options unclipped = *options;
+	unclipped.max_width = 0;
+	struct wlf_text_raster raster;
+	if (!wlf_text_rasterize(text, &unclipped, &raster)) {
+		return false;
+	}
+	*metrics = raster.metrics;
+	wlf_text_raster_destroy(text, &raster);
+	return true;
+}
+
+uint32_t wlf_text_line_height(struct wlf_text *text,
+		const char *font_family, double font_size) {
+	struct wlf_text_metrics metrics;
+	if (!wlf_text_measure(text, &(struct wlf_text_options){
+			.text = "",
+			.font_family = font_family,
+			.font_size = font_size,
+			.raster_scale = 1.0,
+		}, &metrics) || metrics.height <= 0) {
+		return (uint32_t)ceil(font_size * 1.2);
+	}
+	return (uint32_t)ceil(metrics.height);
+}
+
+static bool split_lines(const char *text, struct wlf_array *lines) {
+	size_t start = 0;
+	for (;;) {
+		const char *newline = strchr(&text[start], '\n');
+		size_t end = newline != NULL ?
+			(size_t)(newline - text) : start + strlen(&text[start]);
+		struct wlf_text_line *line = wlf_array_add(lines, sizeof(*line));
+		if (line == NULL) {
+			return false;
+		}
+		*line = (struct wlf_text_line){
+			.start = start,
+			.length = end - start,
+		};
+		if (newline == NULL) {
+			return true;
+		}
+		start = end + 1;
+	}
+}
+
+bool wlf_text_wrap(struct wlf_text *text,
+		const struct wlf_text_options *options, struct wlf_array *lines) {
+	if (text == NULL || text->impl == NULL || lines == NULL ||
+			!text_options_valid(options)) {
+		return false;
+	}
+
+	if (options->max_width <= 0 || text->impl->wrap == NULL) {
+		return split_lines(options->text, lines);
+	}
+	return text->impl->wrap(text, options, lines);
+}
+
 bool wlf_text_rasterize(struct wlf_text *text,
 		const struct wlf_text_options *options,
 		struct wlf_text_raster *raster) {
@@ -59,11 +159,7 @@ bool wlf_text_rasterize(struct wlf_text *text,
 	}
 	*raster = (struct wlf_text_raster){0};
 
-	if (text == NULL || text->impl == NULL || options == NULL ||
-			options->text == NULL || options->font_size <= 0 ||
-			!isfinite(options->font_size) || options->raster_scale <= 0 ||
-			!isfinite(options->raster_scale) ||
-			!wlf_text_is_valid_utf8(options->text)) {
+	if (text == NULL || text->impl == NULL || !text_options_valid(options)) {
 		return false;
 	}
 
@@ -88,6 +184,69 @@ void wlf_text_raster_destroy(struct wlf_text *text,
 	}
 }
 
+bool wlf_text_supports_glyphs(const struct wlf_text *text) {
+	return text != NULL && text->impl != NULL && text->impl->shape != NULL;
+}
+
+bool wlf_text_shape(struct wlf_text *text,
+		const struct wlf_text_options *options,
+		struct wlf_text_glyph_run *run) {
+	if (run == NULL) {
+		return false;
+	}
+	*run = (struct wlf_text_glyph_run){0};
+
+	if (!wlf_text_supports_glyphs(text) || !text_options_valid(options)) {
+		return false;
+	}
+
+	if (!text->impl->shape(text, options, run)) {
+		wlf_text_glyph_run_finish(run);
+		return false;
+	}
+	return true;
+}
+
+void wlf_text_glyph_run_finish(struct wlf_text_glyph_run *run) {
+	if (run == NULL) {
+		return;
+	}
+
+	free(run->glyphs);
+	*run = (struct wlf_text_glyph_run){0};
+}
+
+bool wlf_text_rasterize_glyph(struct wlf_text *text, uint32_t font,
+		uint32_t index, float subpixel_x, struct wlf_text_glyph_image *image) {
+	if (image == NULL) {
+		return false;
+	}
+	*image = (struct wlf_text_glyph_image){0};
+
+	if (!wlf_text_supports_glyphs(text) || !isfinite(subpixel_x) ||
+			subpixel_x < 0 || subpixel_x >= 1) {
+		return false;
+	}
+
+	if (!text->impl->rasterize_glyph(text, font, index, subpixel_x, image)) {
+		wlf_text_glyph_image_destroy(text, image);
+		return false;
+	}
+	return true;
+}
+
+void wlf_text_glyph_image_destroy(struct wlf_text *text,
+		struct wlf_text_glyph_image *image) {
+	if (image == NULL) {
+		return;
+	}
+
+	if (wlf_text_supports_glyphs(text)) {
+		text->impl->destroy_glyph_image(text, image);
+	}
+	*image = (struct wlf_text_glyph_image){0};
+}
+
 static bool utf8_continuation(unsigned char byte) {
 	return (byte & 0xc0) == 0x80;
 }
@@ -182,6 +182,8 @@ struct wlf_renderer *wlf_gles_renderer_create_from_backend(
 			wlf_egl_check_ext(renderer->exts_str, "GL_EXT_texture_norm16");
 		renderer->exts.EXT_disjoint_timer_query =
 			wlf_egl_check_ext(renderer->exts_str, "GL_EXT_disjoint_timer_query");
+		renderer->exts.EXT_unpack_subimage =
+			wlf_egl_check_ext(renderer->exts_str, "GL_EXT_unpack_subimage");
 	}
 
 	load_gl_procs(renderer);
@@ -0,0 +1,570 @@
+#include "wlf/scene/wlf_animated_image_node.h"
+
+#include "wlf/image/wlf_gif_image.h"
+#include "wlf/image/wlf_webp_image.h"
+#include "wlf/scene/wlf_scene.h"
+#include "wlf/types/wlf_pixel_format.h"
+#include "wlf/utils/wlf_log.h"
+#include "wlf/utils/wlf_time.h"
+#include "wlf/window/wlf_window.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Delays below this are treated like browsers do, as "as fast as possible"
+ * encodings that would otherwise spin through frames every refresh. */
+#define ANIMATED_IMAGE_MIN_DELAY_MS 20
+#define ANIMATED_IMAGE_DEFAULT_DELAY_MS 100
+
+static void scene_node_render(struct wlf_render_list_entry *entry,
+	const struct wlf_render_data *data);
+
+static bool animated_image_node_invisible(struct wlf_scene_node *node) {
+	struct wlf_animated_image_node *image_node =
+		wlf_animated_image_node_from_node(node);
+	return !node->state.enabled || image_node->texture == NULL ||
+		node->state.width <= 0 || node->state.height <= 0 ||
+		node->state.opacity <= 0;
+}
+
+static void animated_image_node_get_size(struct wlf_scene_node *node,
+		uint32_t *width, uint32_t *height) {
+	*width = node->state.width;
+	*height = node->state.height;
+}
+
+static void scene_node_opaque_region(struct wlf_scene_node *node,
+		int x, int y, pixman_region32_t *opaque) {
+	(void)node;
+	(void)x;
+	(void)y;
+	(void)opaque;
+}
+
+static void animated_image_node_visibility(struct wlf_scene_node *node,
+		pixman_region32_t *visible) {
+	if (!node->state.enabled) {
+		return;
+	}
+	pixman_region32_union(visible, visible, &node->state.visible);
+}
+
+static struct wlf_scene_node *animated_image_node_at(
+		struct wlf_scene_node *node, double lx, double ly,
+		double *nx, double *ny) {
+	if (animated_image_node_invisible(node) || lx < 0 || ly < 0 ||
+			lx >= node->state.width || ly >= node->state.height) {
+		return NULL;
+	}
+	if (nx != NULL) {
+		*nx = lx;
+	}
+	if (ny != NULL) {
+		*ny = ly;
+	}
+	return node;
+}
+
+static void animated_image_node_bounds(struct wlf_scene_node *node,
+		int x, int y, pixman_region32_t *visible) {
+	if (!animated_image_node_invisible(node)) {
+		pixman_region32_union_rect(visible, visible, x, y,
+			node->state.width, node->state.height);
+	}
+}
+
+static bool animated_image_node_in_box(struct wlf_scene_node *node,
+		struct wlf_frect *box, scene_node_box_iterator_func_t iterator,
+		void *user_data) {
+	if (animated_image_node_invisible(node)) {
+		return false;
+	}
+	int x, y;
+	if (!wlf_scene_node_coords(node, &x, &y)) {
+		return false;
+	}
+	if (x >= box->x + box->width || x + node->state.width <= box->x ||
+			y >= box->y + box->height || y + node->state.height <= box->y) {
+		return false;
+	}
+	return iterator(node, x, y, user_data);
+}
+
+static uint32_t animated_image_frame_count(struct wlf_image *image,
+		uint32_t *loop_count) {
+	if (wlf_image_is_gif(image)) {
+		struct wlf_gif_image *gif = wlf_gif_image_from_image(image);
+		*loop_count = gif->loop_count;
+		return gif->frames != NULL ? gif->frame_count : 1;
+	}
+
+	if (wlf_image_is_webp(image)) {
+		struct wlf_webp_image *webp = wlf_webp_image_from_image(image);
+		if (webp->ani_info != NULL && webp->ani_info->frame_count > 0) {
+			*loop_count = (uint32_t)webp->ani_info->loop_count;
+			return (uint32_t)webp->ani_info->frame_count;
+		}
+	}
+
+	*loop_count = 0;
+	return 1;
+}
+
+static int64_t animated_image_frame_delay(struct wlf_animated_image_node *node,
+		uint32_t index) {
+	int64_t delay = 0;
+	if (wlf_image_is_gif(node->image)) {
+		delay = wlf_gif_image_from_image(node->image)->frames[index].delay_ms;
+	} else {
+		/* WebP timestamps mark the end of each frame. */
+		const struct wlf_webp_frame *frames =
+			wlf_webp_image_from_image(node->image)->ani_info->frames;
+		delay = frames[index].timestamp -
+			(index > 0 ? frames[index - 1].timestamp : 0);
+	}
+
+	return delay < ANIMATED_IMAGE_MIN_DELAY_MS ?
+		ANIMATED_IMAGE_DEFAULT_DELAY_MS : delay;
+}
+
+static bool animated_image_select_frame(struct wlf_animated_image_node *node,
+		uint32_t index, struct wlf_rect *damage) {
+	struct wlf_image *image = node->image;
+	if (wlf_image_is_gif(image)) {
+		return wlf_gif_image_seek_frame(wlf_gif_image_from_image(image),
+			index, damage);
+	}
+
+	image->data = wlf_webp_image_from_image(image)->ani_info->frames[index].pixels;
+	*damage = wlf_rect_make(0, 0, (int)image->width, (int)image->height);
+	return true;
+}
+
+/*
+ * Converts @p rect of the image's straight-alpha RGBA frame into the node's
+ * premultiplied copy and shrinks @p rect to the pixels that actually changed.
+ * Full-canvas damage from non-streaming sources thereby still yields a tight
+ * upload and damage rectangle.
+ */
+static void animated_image_convert_rect(struct wlf_animated_image_node *node,
+		struct wlf_rect *rect) {
+	const struct wlf_image *image = node->image;
+	int min_x = rect->x + rect->width;
+	int min_y = rect->y + rect->height;
+	int max_x = rect->x;
+	int max_y = rect->y;
+
+	for (int y = rect->y; y < rect->y + rect->height; y++) {
+		const uint8_t *src = image->data + (size_t)y * image->stride;
+		uint32_t *dst = (uint32_t *)(node->pixels + (size_t)y * node->stride);
+		for (int x = rect->x; x < rect->x + rect->width; x++) {
+			const uint8_t *p = src + (size_t)x * 4;
+			uint8_t a = p[3];
+			uint8_t premultiplied[4] = {
+				(uint8_t)((p[0] * a + 127) / 255),
+				(uint8_t)((p[1] * a + 127) / 255),
+				(uint8_t)((p[2] * a + 127) / 255),
+				a,
+			};
+			uint32_t value;
+			memcpy(&value, premultiplied, sizeof(value));
+			if (dst[x] == value) {
+				continue;
+			}
+			dst[x] = value;
+			if (x < min_x) {
+				min_x = x;
+			}
+			if (x >= max_x) {
+				max_x = x + 1;
+			}
+			if (y < min_y) {
+				min_y = y;
+			}
+			max_y = y + 1;
+		}
+	}
+
+	if (max_x <= min_x || max_y <= min_y) {
+		*rect = wlf_rect_make(0, 0, 0, 0);
+		return;
+	}
+	*rect = wlf_rect_make(min_x, min_y, max_x - min_x, max_y - min_y);
+}
+
+static void animated_image_node_set_texture(
+		struct wlf_animated_image_node *node, struct wlf_texture *texture) {
+	wlf_texture_destroy(node->texture);
+	node->texture = texture;
+}
+
+static void animated_image_node_damage(struct wlf_animated_image_node *node,
+		const struct wlf_rect *rect) {
+	int x, y;
+	if (node->base.scene == NULL ||
+			!wlf_scene_node_coords(&node->base, &x, &y)) {
+		return;
+	}
+
+	/* Map the changed image pixels onto the node's destination box. */
+	int64_t width = node->base.state.width;
+	int64_t height = node->base.state.height;
+	int64_t image_width = node->image->width;
+	int64_t image_height = node->image->height;
+	int64_t x1 = rect->x * width / image_width;
+	int64_t y1 = rect->y * height / image_height;
+	int64_t x2 = ((int64_t)(rect->x + rect->width) * width +
+		image_width - 1) / image_width;
+	int64_t y2 = ((int64_t)(rect->y + rect->height) * height +
+		image_height - 1) / image_height;
+	if (width != image_width || height != image_height) {
+		/* Bilinear filtering samples one neighbouring pixel. */
+		x1--;
+		y1--;
+		x2++;
+		y2++;
+	}
+
+	pixman_region32_t damage;
+	pixman_region32_init_rect(&damage, x + (int)x1, y + (int)y1,
+		(unsigned int)(x2 - x1), (unsigned int)(y2 - y1));
+	pixman_region32_intersect(&damage, &damage, &node->base.state.visible);
+	wlf_scene_damage(node->base.scene, &damage);
+	pixman_region32_fini(&damage);
+}
+
+static void animated_image_node_upload(struct wlf_animated_image_node *node,
+		struct wlf_rect rect) {
+	struct wlf_rect bounds = wlf_rect_make(0, 0,
+		(int)node->image->width, (int)node->image->height);
+	rect = wlf_rect_intersection(&rect, &bounds);
+	if (wlf_rect_is_empty(&rect)) {
+		return;
+	}
+
+	animated_image_convert_rect(node, &rect);
+	if (wlf_rect_is_empty(&rect) || node->renderer == NULL) {
+		return;
+	}
+
+	bool updated = false;
+	if (node->texture != NULL) {
+		struct wlf_readonly_data_buffer *buffer =
+			wlf_readonly_data_buffer_create(WLF_FORMAT_ABGR8888, node->stride,
+				node->image->width, node->image->height, node->pixels);
+		if (buffer != NULL) {
+			pixman_region32_t region;
+			pixman_region32_init_rect(&region, rect.x, rect.y,
+				(unsigned int)rect.width, (unsigned int)rect.height);
+			updated = wlf_texture_update_from_buffer(node->texture,
+				&buffer->base, &region);
+			pixman_region32_fini(&region);
+			wlf_readonly_data_buffer_drop(buffer);
+		}
+	}
+
+	if (!updated) {
+		/* The renderer cannot update in place; upload the whole frame. */
+		struct wlf_texture *texture = wlf_texture_from_pixels(node->renderer,
+			WLF_FORMAT_ABGR8888, node->stride, node->image->width,
+			node->image->height, node->pixels);
+		if (texture == NULL) {
+			wlf_log(WLF_ERROR, "failed to upload animated image frame");
+			return;
+		}
+		animated_image_node_set_texture(node, texture);
+	}
+
+	animated_image_node_damage(node, &rect);
+}
+
+static bool animated_image_node_show_frame(struct wlf_animated_image_node *node,
+		uint32_t index) {
+	struct wlf_rect damage = wlf_rect_make(0, 0, 0, 0);
+	bool ok = animated_image_select_frame(node, index, &damage);
+	if (!ok) {
+		wlf_log(WLF_ERROR, "failed to decode animated image frame %u", index);
+	} else {
+		node->current_frame = index;
+	}
+
+	/* A failed streaming seek still leaves a valid canvas to present. */
+	animated_image_node_upload(node, damage);
+	return ok;
+}
+
+static bool animated_image_node_active(struct wlf_animated_image_node *node) {
+	return node->playing && node->frame_count > 1 &&
+		!animated_image_node_invisible(&node->base) &&
+		!pixman_region32_empty(&node->base.state.visible);
+}
+
+static int64_t animated_image_duration(struct wlf_animated_image_node *node) {
+	int64_t duration = 0;
+	for (uint32_t i = 0; i < node->frame_count; i++) {
+		duration += animated_image_frame_delay(node, i);
+	}
+	return duration;
+}
+
+static void handle_frame_done(struct wlf_listener *listener, void *data) {
+	struct wlf_animated_image_node *node =
+		wlf_container_of(listener, node, frame_done);
+	const struct timespec *when = data;
+
+	if (!animated_image_node_active(node)) {
+		/* Offscreen or paused: stop the clock and stop requesting frames. */
+		node->has_last_frame = false;
+		return;
+	}
+
+	int64_t now = timespec_to_msec(when);
+	if (!node->has_last_frame) {
+		node->has_last_frame = true;
+		node->last_frame_ms = now;
+		wlf_scene_schedule_frame(node->base.scene);
+		return;
+	}
+
+	node->frame_elapsed_ms += now > node->last_frame_ms ?
+		now - node->last_frame_ms : 0;
+	node->last_frame_ms = now;
+
+	if (node->loop_count == 0) {
+		int64_t duration = animated_image_duration(node);
+		if (node->frame_elapsed_ms > duration) {
+			node->frame_elapsed_ms %= duration;
+		}
+	}
+
+	uint32_t target = node->current_frame;
+	int64_t delay;
+	while (node->frame_elapsed_ms >=
+			(delay = animated_image_frame_delay(node, target))) {
+		node->frame_elapsed_ms -= delay;
+		if (target + 1 < node->frame_count) {
+			target++;
+			continue;
+		}
+		if (node->loop_count != 0 &&
+				++node->loops_played >= node->loop_count) {
+			node->playing = false;
+			node->has_last_frame = false;
+			node->frame_elapsed_ms = 0;
+			break;
+		}
+		target = 0;
+	}
+
+	if (target != node->current_frame) {
+		animated_image_node_show_frame(node, target);
+	}
+	if (node->playing) {
+		wlf_scene_schedule_frame(node->base.scene);
+	}
+}
+
+static void handle_renderer_destroy(struct wlf_listener *listener, void *data) {
+	(void)data;
+	struct wlf_animated_image_node *node =
+		wlf_container_of(listener, node, renderer_destroy);
+	wlf_linked_list_remove(&node->renderer_destroy.link);
+	wlf_linked_list_init(&node->renderer_destroy.link);
+	animated_image_node_set_texture(node, NULL);
+	node->renderer = NULL;
+}
+
+static void animated_image_node_destroy(struct wlf_scene_node *base) {
+	struct wlf_animated_image_node *node =
+		wlf_animated_image_node_from_node(base);
+	wlf_linked_list_remove(&node->frame_done.link);
+	wlf_linked_list_remove(&node->renderer_destroy.link);
+	animated_image_node_set_texture(node, NULL);
+	wlf_image_finish(node->image);
+	free(node->image);
+	free(node->pixels);
+	free(node);
+}
+
+static const struct wlf_scene_node_impl animated_image_node_impl = {
+	.destroy = animated_image_node_destroy,
+	.get_size = animated_image_node_get_size,
+	.opaque_region = scene_node_opaque_region,
+	.invisible = animated_image_node_invisible,
+	.visibility = animated_image_node_visibility,
+	.at = animated_image_node_at,
+	.bounds = animated_image_node_bounds,
+	.in_box = animated_image_node_in_box,
+	.construct_render_list_iterator =
+		wlf_scene_node_add_render_list_entry,
+	.render = scene_node_render,
+};
+
+struct wlf_animated_image_node *wlf_animated_image_node_create(
+		struct wlf_scene_node *parent, struct wlf_image *image,
+		int x, int y, uint32_t width, uint32_t height) {
+	if (parent == NULL || parent->scene == NULL || parent->window == NULL ||
+			parent->window->state.renderer == NULL || image == NULL ||
+			image->data == NULL || image->width == 0 || image->height == 0) {
+		return NULL;
+	}
+	if ((!wlf_image_is_gif(image) && !wlf_image_is_webp(image)) ||
+			image->format != WLF_COLOR_TYPE_RGBA ||
+			image->bit_depth != WLF_IMAGE_BIT_DEPTH_8 ||
+			image->width > INT32_MAX / 4 || image->height > INT32_MAX) {
+		wlf_log(WLF_ERROR, "animated image node requires an 8-bit RGBA GIF or WebP image");
+		return NULL;
+	}
+
+	struct wlf_animated_image_node *node = calloc(1, sizeof(*node));
+	if (node == NULL) {
+		wlf_log_errno(WLF_ERROR, "failed to allocate wlf_animated_image_node");
+		return NULL;
+	}
+	node->stride = image->width * 4;
+	node->pixels = calloc(image->height, node->stride);
+	if (node->pixels == NULL) {
+		wlf_log_errno(WLF_ERROR, "failed to allocate animated image frame");
+		free(node);
+		return NULL;
+	}
+
+	node->image = image;
+	node->frame_count = animated_image_frame_count(image, &node->loop_count);
+	if (wlf_image_is_gif(image)) {
+		node->current_frame = wlf_gif_image_from_image(image)->current_frame;
+	}
+
+	struct wlf_rect rect = wlf_rect_make(0, 0,
+		(int)image->width, (int)image->height);
+	animated_image_convert_rect(node, &rect);
+	node->texture = wlf_texture_from_pixels(parent->window->state.renderer,
+		WLF_FORMAT_ABGR8888, node->stride, image->width, image->height,
+		node->pixels);
+	if (node->texture == NULL) {
+		wlf_log(WLF_ERROR, "failed to create renderer texture for animated image");
+		free(node->pixels);
+		free(node);
+		return NULL;
+	}
+
+	wlf_scene_node_init(&node->base, &animated_image_node_impl, parent);
+	node->base.state.x = x;
+	node->base.state.y = y;
+	node->base.state.width = width > 0 ? width : image->width;
+	node->base.state.height = height > 0 ? height : image->height;
+	node->playing = true;
+	node->renderer = parent->window->state.renderer;
+	node->renderer_destroy.notify = handle_renderer_destroy;
+	wlf_signal_add(&node->renderer->events.destroy, &node->renderer_destroy);
+	node->frame_done.notify = handle_frame_done;
+	wlf_signal_add(&node->base.scene->events.frame_done, &node->frame_done);
+	wlf_scene_node_update(&node->base, NULL);
+	if (node->frame_count > 1) {
+		wlf_scene_schedule_frame(node->base.scene);
+	}
+	return node;
+}
+
+void wlf_animated_image_node_set_playing(struct wlf_animated_image_node *node,
+		bool playing) {
+	if (node == NULL || node->playing == playing) {
+		return;
+	}
+
+	node->playing = playing;
+	node->has_last_frame = false;
+	if (playing) {
+		if (node->loop_count != 0 && node->loops_played >= node->loop_count) {
+			node->loops_played = 0;
+		}
+		wlf_scene_schedule_frame(node->base.scene);
+	}
+}
+
+bool wlf_animated_image_node_seek(struct wlf_animated_image_node *node,
+		uint32_t index) {
+	if (node == NULL || index >= node->frame_count) {
+		return false;
+	}
+
+	node->frame_elapsed_ms = 0;
+	if (index == node->current_frame) {
+		return true;
+	}
+	return animated_image_node_show_frame(node, index);
+}
+
+void wlf_animated_image_node_set_dest_size(struct wlf_animated_image_node *node,
+		uint32_t width, uint32_t height) {
+	if (node == NULL) {
+		return;
+	}
+	node->base.state.width = width > 0 ? width : node->image->width;
+	node->base.state.height = height > 0 ? height : node->image->height;
+	wlf_scene_node_update(&node->base, NULL);
+}
+
+bool wlf_scene_node_is_animated_image(const struct wlf_scene_node *node) {
+	return node != NULL && node->impl == &animated_image_node_impl;
+}
+
+struct wlf_animated_image_node *wlf_animated_image_node_from_node(
+		struct wlf_scene_node *node) {
+	assert(wlf_scene_node_is_animated_image(node));
+	struct wlf_animated_image_node *image_node =
+		wlf_container_of(node, image_node, base);
+	return image_node;
+}
+
+static void animated_image_node_render_at(struct wlf_animated_image_node *node,
+		struct wlf_texture_pass *pass,
+		struct wlf_render_target_info *render_target_info,
+		const pixman_region32_t *clip, double x, double y) {
+	if (node == NULL || pass == NULL ||
+			animated_image_node_invisible(&node->base)) {
+		return;
+	}
+
+	wlf_render_pass_add_texture(pass, render_target_info,
+		&(struct wlf_render_texture_options){
+			.texture = node->texture,
+			.dst_box = {
+				.x = x,
+				.y = y,
+				.width = node->base.state.width,
+				.height = node->base.state.height,
+			},
+			.opacity = node->base.state.opacity,
+			.clip = clip,
+			.filter_mode = WLF_SCALE_FILTER_BILINEAR,
+			.blend_mode = WLF_RENDER_BLEND_MODE_PREMULTIPLIED,
+		});
+}
+
+void wlf_animated_image_node_render(struct wlf_animated_image_node *node,
+		struct wlf_texture_pass *pass,
+		struct wlf_render_target_info *render_target_info,
+		const pixman_region32_t *clip) {
+	int x = 0;
+	int y = 0;
+	if (!wlf_scene_node_coords(&node->base, &x, &y)) {
+		return;
+	}
+	animated_image_node_render_at(node, pass, render_target_info, clip, x, y);
+}
+
+static void scene_node_render(struct wlf_render_list_entry *entry,
+		const struct wlf_render_data *data) {
+	pixman_region32_t render_region;
+	if (!wlf_scene_node_init_render_region(entry, data, &render_region)) {
+		pixman_region32_fini(&render_region);
+		return;
+	}
+	animated_image_node_render_at(wlf_animated_image_node_from_node(entry->node),
+		data->scene->texture_pass, data->target, &render_region,
+		entry->x, entry->y);
+	pixman_region32_fini(&render_region);
+}
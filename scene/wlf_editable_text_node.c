@@ -0,0 +1,322 @@
+#include "wlf/scene/wlf_editable_text_node.h"
+
+#include "wlf/platform/wlf_backend.h"
+#include "wlf/platform/wlf_text.h"
+#include "wlf/scene/wlf_scene_container.h"
+#include "wlf/utils/wlf_log.h"
+#include "wlf/window/wlf_window.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool utf8_boundary(const char *text, size_t length, size_t offset) {
+	return offset == length ||
+		(offset < length && ((unsigned char)text[offset] & 0xc0) != 0x80);
+}
+
+/* Returns the index of the line containing byte @p offset. */
+static size_t line_at(const struct wlf_editable_text_node *node,
+		size_t offset) {
+	size_t low = 0;
+	size_t high = node->line_count;
+	while (high - low > 1) {
+		size_t mid = low + (high - low) / 2;
+		if (node->lines[mid].start <= offset) {
+			low = mid;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+static bool reserve_text(struct wlf_editable_text_node *node, size_t size) {
+	if (size <= node->capacity) {
+		return true;
+	}
+	size_t capacity = node->capacity == 0 ? 64 : node->capacity;
+	while (capacity < size) {
+		capacity *= 2;
+	}
+	char *text = realloc(node->text, capacity);
+	if (text == NULL) {
+		wlf_log_errno(WLF_ERROR, "failed to grow editable text");
+		return false;
+	}
+	node->text = text;
+	node->capacity = capacity;
+	return true;
+}
+
+static bool reserve_lines(struct wlf_editable_text_node *node, size_t count) {
+	if (count <= node->line_capacity) {
+		return true;
+	}
+	size_t capacity = node->line_capacity == 0 ? 16 : node->line_capacity;
+	while (capacity < count) {
+		capacity *= 2;
+	}
+	struct wlf_editable_text_line *lines = realloc(node->lines,
+		capacity * sizeof(*lines));
+	if (lines == NULL) {
+		wlf_log_errno(WLF_ERROR, "failed to grow editable text lines");
+		return false;
+	}
+	node->lines = lines;
+	node->line_capacity = capacity;
+	return true;
+}
+
+/* Points the text node of a line at its current text. Unchanged text is a
+ * no-op in wlf_text_node_set_text(), so only edited lines are reshaped. */
+static void update_line(struct wlf_editable_text_node *node, size_t index) {
+	struct wlf_editable_text_line *line = &node->lines[index];
+	char *end = &node->text[line->start + line->length];
+	char saved = *end;
+	*end = '\0';
+	if (line->node != NULL) {
+		wlf_text_node_set_text(line->node, &node->text[line->start]);
+	} else {
+		line->node = wlf_text_node_create(&node->base, 0,
+			(int)(index * node->line_height), &node->text[line->start],
+			node->font_family, node->font_size, &node->color);
+		if (line->node == NULL) {
+			wlf_log(WLF_ERROR, "failed to create editable text line");
+		} else {
+			wlf_scene_node_set_opacity(&line->node->base,
+				node->base.state.opacity);
+		}
+	}
+	*end = saved;
+}
+
+static void update_size(struct wlf_editable_text_node *node) {
+	uint32_t width = 0;
+	for (size_t i = 0; i < node->line_count; i++) {
+		const struct wlf_text_node *line = node->lines[i].node;
+		if (line != NULL && line->base.state.width > width) {
+			width = line->base.state.width;
+		}
+	}
+	node->base.state.width = width;
+	node->base.state.height = (uint32_t)(node->line_count * node->line_height);
+}
+
+/* Moves the lines from @p first on to their row after the line count
+ * changed and damages the rows they covered before and after. */
+static void move_lines(struct wlf_editable_text_node *node, size_t first,
+		size_t old_line_count, uint32_t old_width) {
+	for (size_t i = first; i < node->line_count; i++) {
+		struct wlf_text_node *line = node->lines[i].node;
+		if (line != NULL) {
+			line->base.state.y = (int)(i * node->line_height);
+		}
+	}
+
+	size_t rows = old_line_count > node->line_count ?
+		old_line_count : node->line_count;
+	uint32_t width = old_width > node->base.state.width ?
+		old_width : node->base.state.width;
+	wlf_scene_container_damage_band(&node->base,
+		(int)(first * node->line_height), width,
+		(uint32_t)((rows - first) * node->line_height));
+}
+
+/* Replaces @p removed bytes at @p offset with @p inserted. Only the lines
+ * overlapping the edit are rebuilt; the lines after it are shifted. */
+static bool replace_text(struct wlf_editable_text_node *node, size_t offset,
+		size_t removed, const char *inserted, size_t inserted_length) {
+	size_t first = line_at(node, offset);
+	size_t last = line_at(node, offset + removed);
+	size_t region_start = node->lines[first].start;
+	size_t region_end = node->lines[last].start + node->lines[last].length -
+		removed + inserted_length;
+
+	size_t new_count = 1;
+	for (size_t i = 0; i < inserted_length; i++) {
+		new_count += inserted[i] == '\n';
+	}
+	/* Removed line breaks join the first and last line. */
+	size_t old_count = last - first + 1;
+	size_t line_count = node->line_count - old_count + new_count;
+	if (!reserve_text(node, node->length - removed + inserted_length + 1) ||
+			!reserve_lines(node, line_count)) {
+		return false;
+	}
+
+	memmove(&node->text[offset + inserted_length],
+		&node->text[offset + removed], node->length - offset - removed + 1);
+	memcpy(&node->text[offset], inserted, inserted_length);
+	node->length = node->length - removed + inserted_length;
+
+	for (size_t i = first + new_count; i < first + old_count; i++) {
+		if (node->lines[i].node != NULL) {
+			wlf_scene_node_destroy(&node->lines[i].node->base);
+		}
+	}
+	size_t old_line_count = node->line_count;
+	memmove(&node->lines[first + new_count], &node->lines[last + 1],
+		(node->line_count - last - 1) * sizeof(*node->lines));
+	for (size_t i = first + old_count; i < first + new_count; i++) {
+		node->lines[i].node = NULL;
+	}
+	node->line_count = line_count;
+	for (size_t i = first + new_count; i < line_count; i++) {
+		node->lines[i].start = node->lines[i].start - removed +
+			inserted_length;
+	}
+
+	size_t start = region_start;
+	for (size_t i = first; i < first + new_count; i++) {
+		const char *newline = memchr(&node->text[start], '\n',
+			region_end - start);
+		size_t end = newline != NULL ?
+			(size_t)(newline - node->text) : region_end;
+		node->lines[i].start = start;
+		node->lines[i].length = end - start;
+		update_line(node, i);
+		start = end + 1;
+	}
+
+	uint32_t old_width = node->base.state.width;
+	update_size(node);
+	if (new_count != old_count) {
+		move_lines(node, first + new_count, old_line_count, old_width);
+	}
+	return true;
+}
+
+static void scene_node_destroy(struct wlf_scene_node *base) {
+	struct wlf_editable_text_node *node =
+		wlf_editable_text_node_from_node(base);
+	wlf_scene_container_destroy_children(base);
+	free(node->lines);
+	free(node->font_family);
+	free(node->text);
+	free(node);
+}
+
+static struct wlf_linked_list *scene_node_get_children(
+		struct wlf_scene_node *base) {
+	return &wlf_editable_text_node_from_node(base)->children;
+}
+
+static const struct wlf_scene_node_impl scene_node_impl = {
+	.destroy = scene_node_destroy,
+	.set_opacity = wlf_scene_container_set_opacity,
+	.get_size = wlf_scene_container_get_size,
+	.get_children = scene_node_get_children,
+	.invisible = wlf_scene_container_invisible,
+	.visibility = wlf_scene_container_visibility,
+	.at = wlf_scene_container_at,
+	.bounds = wlf_scene_container_bounds,
+	.in_box = wlf_scene_container_in_box,
+};
+
+struct wlf_editable_text_node *wlf_editable_text_node_create(
+		struct wlf_scene_node *parent, int x, int y, const char *text,
+		const char *font_family, double font_size,
+		const struct wlf_color *color) {
+	const char *text_value = text != NULL ? text : "";
+	if (parent == NULL || parent->window == NULL || font_size <= 0 ||
+			!isfinite(font_size) || !wlf_text_is_valid_utf8(text_value)) {
+		return NULL;
+	}
+	struct wlf_text *text_context =
+		wlf_backend_get_text(parent->window->state.backend);
+	if (text_context == NULL) {
+		return NULL;
+	}
+
+	struct wlf_editable_text_node *node = calloc(1, sizeof(*node));
+	if (node == NULL) {
+		wlf_log_errno(WLF_ERROR, "failed to allocate wlf_editable_text_node");
+		return NULL;
+	}
+	wlf_scene_node_init(&node->base, &scene_node_impl, parent);
+	wlf_linked_list_init(&node->children);
+	node->base.state.x = x;
+	node->base.state.y = y;
+	node->font_family = strdup(font_family != NULL ?
+		font_family : "sans-serif");
+	node->font_size = font_size;
+	node->color = color != NULL ? *color : WLF_COLOR_WHITE;
+	if (node->font_family == NULL || !reserve_text(node, 1) ||
+			!reserve_lines(node, 1)) {
+		wlf_scene_node_destroy(&node->base);
+		return NULL;
+	}
+	node->line_height = wlf_text_line_height(text_context, node->font_family,
+		font_size);
+	node->text[0] = '\0';
+	node->lines[0] = (struct wlf_editable_text_line){0};
+	node->line_count = 1;
+	update_line(node, 0);
+
+	if (!replace_text(node, 0, 0, text_value, strlen(text_value))) {
+		wlf_scene_node_destroy(&node->base);
+		return NULL;
+	}
+	wlf_scene_node_update(&node->base, NULL);
+	return node;
+}
+
+bool wlf_editable_text_node_insert(struct wlf_editable_text_node *node,
+		size_t offset, const char *text) {
+	if (node == NULL || text == NULL ||
+			!utf8_boundary(node->text, node->length, offset) ||
+			!wlf_text_is_valid_utf8(text)) {
+		return false;
+	}
+	size_t length = strlen(text);
+	if (length == 0) {
+		return true;
+	}
+	return replace_text(node, offset, 0, text, length);
+}
+
+bool wlf_editable_text_node_delete(struct wlf_editable_text_node *node,
+		size_t offset, size_t length) {
+	if (node == NULL || offset > node->length ||
+			length > node->length - offset ||
+			!utf8_boundary(node->text, node->length, offset) ||
+			!utf8_boundary(node->text, node->length, offset + length)) {
+		return false;
+	}
+	if (length == 0) {
+		return true;
+	}
+	return replace_text(node, offset, length, "", 0);
+}
+
+const char *wlf_editable_text_node_get_text(
+		const struct wlf_editable_text_node *node) {
+	return node != NULL ? node->text : NULL;
+}
+
+void wlf_editable_text_node_set_color(struct wlf_editable_text_node *node,
+		const struct wlf_color *color) {
+	if (node == NULL || color == NULL || wlf_color_equal(&node->color, color)) {
+		return;
+	}
+	node->color = *color;
+	for (size_t i = 0; i < node->line_count; i++) {
+		if (node->lines[i].node != NULL) {
+			wlf_text_node_set_color(node->lines[i].node, color);
+		}
+	}
+}
+
+bool wlf_scene_node_is_editable_text(const struct wlf_scene_node *node) {
+	return node != NULL && node->impl == &scene_node_impl;
+}
+
+struct wlf_editable_text_node *wlf_editable_text_node_from_node(
+		struct wlf_scene_node *node) {
+	assert(wlf_scene_node_is_editable_text(node));
+	struct wlf_editable_text_node *text_node =
+		wlf_container_of(node, text_node, base);
+	return text_node;
+}
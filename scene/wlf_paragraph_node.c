@@ -0,0 +1,392 @@
+#include "wlf/scene/wlf_paragraph_node.h"
+
+#include "wlf/platform/wlf_backend.h"
+#include "wlf/platform/wlf_text.h"
+#include "wlf/scene/wlf_scene_container.h"
+#include "wlf/utils/wlf_log.h"
+#include "wlf/window/wlf_window.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+static size_t get_line_count(const struct wlf_paragraph_node *node) {
+	return node->lines.size / sizeof(struct wlf_text_line);
+}
+
+static const struct wlf_text_line *get_line(
+		const struct wlf_paragraph_node *node, size_t index) {
+	const struct wlf_text_line *lines = node->lines.data;
+	return &lines[index];
+}
+
+/* Appends the wrapped lines of the paragraph between @p start and @p end,
+ * which contains no line break. */
+static bool wrap_paragraph(struct wlf_paragraph_node *node,
+		struct wlf_array *lines, size_t start, size_t end) {
+	if (node->view_width <= 0 || start == end) {
+		struct wlf_text_line *line = wlf_array_add(lines, sizeof(*line));
+		if (line == NULL) {
+			return false;
+		}
+		*line = (struct wlf_text_line){
+			.start = start,
+			.length = end - start,
+		};
+		return true;
+	}
+
+	/* Lines are broken at scale 1, like the line height, so the wrapping
+	 * does not change with the window scale. */
+	size_t first = lines->size / sizeof(struct wlf_text_line);
+	char saved = node->text[end];
+	node->text[end] = '\0';
+	bool ok = wlf_text_wrap(node->text_context, &(struct wlf_text_options){
+		.text = &node->text[start],
+		.font_family = node->font_family,
+		.font_size = node->font_size,
+		.raster_scale = 1.0,
+		.max_width = node->view_width,
+	}, lines);
+	node->text[end] = saved;
+	if (!ok) {
+		return false;
+	}
+
+	struct wlf_text_line *added = lines->data;
+	size_t count = lines->size / sizeof(*added);
+	for (size_t i = first; i < count; i++) {
+		added[i].start += start;
+	}
+	return true;
+}
+
+static bool wrap_text(struct wlf_paragraph_node *node) {
+	struct wlf_array lines;
+	wlf_array_init(&lines);
+	size_t start = 0;
+	for (;;) {
+		const char *newline = strchr(&node->text[start], '\n');
+		size_t end = newline != NULL ? (size_t)(newline - node->text) :
+			start + strlen(&node->text[start]);
+		if (!wrap_paragraph(node, &lines, start, end)) {
+			wlf_log(WLF_ERROR, "failed to wrap paragraph text");
+			wlf_array_release(&lines);
+			return false;
+		}
+		if (newline == NULL) {
+			break;
+		}
+		start = end + 1;
+	}
+
+	wlf_array_release(&node->lines);
+	node->lines = lines;
+	return true;
+}
+
+/* Forgets which line every row shows, so the next layout sets them all;
+ * rows whose text did not change are still not reshaped. */
+static void invalidate_rows(struct wlf_paragraph_node *node) {
+	for (size_t i = 0; i < node->row_count; i++) {
+		node->rows[i].line = SIZE_MAX;
+	}
+}
+
+static bool set_row_count(struct wlf_paragraph_node *node) {
+	size_t count = node->view_height / node->line_height;
+	if (count == 0) {
+		count = 1;
+	}
+	if (count == node->row_count) {
+		return true;
+	}
+
+	struct wlf_paragraph_row *rows = calloc(count, sizeof(*rows));
+	if (rows == NULL) {
+		wlf_log_errno(WLF_ERROR, "failed to allocate paragraph rows");
+		return false;
+	}
+	for (size_t i = 0; i < node->row_count; i++) {
+		if (node->rows[i].node != NULL) {
+			wlf_scene_node_destroy(&node->rows[i].node->base);
+		}
+	}
+	free(node->rows);
+	node->rows = rows;
+	node->row_count = count;
+	invalidate_rows(node);
+	return true;
+}
+
+static void show_row(struct wlf_paragraph_node *node,
+		struct wlf_paragraph_row *row, size_t index, int y) {
+	row->line = index;
+	if (row->node == NULL && index == SIZE_MAX) {
+		return;
+	}
+
+	const char *text = "";
+	char *end = NULL;
+	char saved = '\0';
+	if (index != SIZE_MAX) {
+		const struct wlf_text_line *line = get_line(node, index);
+		text = &node->text[line->start];
+		end = &node->text[line->start + line->length];
+		saved = *end;
+		*end = '\0';
+	}
+	if (row->node != NULL) {
+		row->node->base.state.y = y;
+		wlf_text_node_set_text(row->node, text);
+	} else {
+		row->node = wlf_text_node_create(&node->base, 0, y, text,
+			node->font_family, node->font_size, &node->color);
+		if (row->node == NULL) {
+			wlf_log(WLF_ERROR, "failed to create paragraph row");
+		} else {
+			wlf_scene_node_set_opacity(&row->node->base,
+				node->base.state.opacity);
+			if (node->view_width > 0) {
+				wlf_text_node_set_max_width(row->node, node->view_width);
+			}
+		}
+	}
+	if (end != NULL) {
+		*end = saved;
+	}
+}
+
+static void update_size(struct wlf_paragraph_node *node) {
+	uint32_t width = node->view_width > 0 ? (uint32_t)node->view_width : 0;
+	if (node->view_width <= 0) {
+		for (size_t i = 0; i < node->row_count; i++) {
+			const struct wlf_text_node *row = node->rows[i].node;
+			if (row != NULL && row->base.state.width > width) {
+				width = row->base.state.width;
+			}
+		}
+	}
+	node->base.state.width = width;
+	node->base.state.height = node->view_height;
+}
+
+/* Shows the lines from first_line on. A row keeps its line while the line
+ * stays in view, so scrolling only moves it. */
+static void show_lines(struct wlf_paragraph_node *node, uint32_t old_width,
+		uint32_t old_height) {
+	size_t count = get_line_count(node);
+	for (size_t i = node->first_line;
+			i < node->first_line + node->row_count; i++) {
+		struct wlf_paragraph_row *row = &node->rows[i % node->row_count];
+		size_t line = i < count ? i : SIZE_MAX;
+		int y = (int)((i - node->first_line) * node->line_height);
+		if (row->line != line) {
+			show_row(node, row, line, y);
+		}
+		if (row->node != NULL) {
+			row->node->base.state.y = y;
+		}
+	}
+	update_size(node);
+
+	wlf_scene_container_damage_band(&node->base, 0,
+		old_width > node->base.state.width ?
+			old_width : node->base.state.width,
+		old_height > node->base.state.height ?
+			old_height : node->base.state.height);
+}
+
+static size_t clamp_first_line(const struct wlf_paragraph_node *node,
+		size_t line) {
+	size_t count = get_line_count(node);
+	size_t last = count > node->row_count ? count - node->row_count : 0;
+	return line < last ? line : last;
+}
+
+static void scene_node_destroy(struct wlf_scene_node *base) {
+	struct wlf_paragraph_node *node = wlf_paragraph_node_from_node(base);
+	wlf_scene_container_destroy_children(base);
+	wlf_array_release(&node->lines);
+	free(node->rows);
+	free(node->font_family);
+	free(node->text);
+	free(node);
+}
+
+static struct wlf_linked_list *scene_node_get_children(
+		struct wlf_scene_node *base) {
+	return &wlf_paragraph_node_from_node(base)->children;
+}
+
+static const struct wlf_scene_node_impl scene_node_impl = {
+	.destroy = scene_node_destroy,
+	.set_opacity = wlf_scene_container_set_opacity,
+	.get_size = wlf_scene_container_get_size,
+	.get_children = scene_node_get_children,
+	.invisible = wlf_scene_container_invisible,
+	.visibility = wlf_scene_container_visibility,
+	.at = wlf_scene_container_at,
+	.bounds = wlf_scene_container_bounds,
+	.in_box = wlf_scene_container_in_box,
+};
+
+struct wlf_paragraph_node *wlf_paragraph_node_create(
+		struct wlf_scene_node *parent, int x, int y, int width,
+		uint32_t height, const char *text, const char *font_family,
+		double font_size, const struct wlf_color *color) {
+	const char *text_value = text != NULL ? text : "";
+	if (parent == NULL || parent->window == NULL || width < 0 ||
+			height == 0 || font_size <= 0 || !isfinite(font_size) ||
+			!wlf_text_is_valid_utf8(text_value)) {
+		return NULL;
+	}
+	struct wlf_text *text_context =
+		wlf_backend_get_text(parent->window->state.backend);
+	if (text_context == NULL) {
+		return NULL;
+	}
+
+	struct wlf_paragraph_node *node = calloc(1, sizeof(*node));
+	if (node == NULL) {
+		wlf_log_errno(WLF_ERROR, "failed to allocate wlf_paragraph_node");
+		return NULL;
+	}
+	wlf_scene_node_init(&node->base, &scene_node_impl, parent);
+	wlf_linked_list_init(&node->children);
+	wlf_array_init(&node->lines);
+	node->base.state.x = x;
+	node->base.state.y = y;
+	node->text_context = text_context;
+	node->text = strdup(text_value);
+	node->font_family = strdup(font_family != NULL ?
+		font_family : "sans-serif");
+	node->font_size = font_size;
+	node->color = color != NULL ? *color : WLF_COLOR_WHITE;
+	node->view_width = width;
+	node->view_height = height;
+	if (node->text == NULL || node->font_family == NULL) {
+		wlf_log_errno(WLF_ERROR, "failed to allocate paragraph text");
+		wlf_scene_node_destroy(&node->base);
+		return NULL;
+	}
+	node->line_height = wlf_text_line_height(text_context, node->font_family,
+		font_size);
+	if (!wrap_text(node) || !set_row_count(node)) {
+		wlf_scene_node_destroy(&node->base);
+		return NULL;
+	}
+
+	show_lines(node, 0, 0);
+	return node;
+}
+
+bool wlf_paragraph_node_set_text(struct wlf_paragraph_node *node,
+		const char *text) {
+	const char *text_value = text != NULL ? text : "";
+	if (node == NULL || !wlf_text_is_valid_utf8(text_value)) {
+		return false;
+	}
+	if (strcmp(node->text, text_value) == 0) {
+		return true;
+	}
+
+	char *copy = strdup(text_value);
+	if (copy == NULL) {
+		wlf_log_errno(WLF_ERROR, "failed to allocate paragraph text");
+		return false;
+	}
+	char *old_text = node->text;
+	node->text = copy;
+	if (!wrap_text(node)) {
+		node->text = old_text;
+		free(copy);
+		return false;
+	}
+	free(old_text);
+
+	invalidate_rows(node);
+	node->first_line = clamp_first_line(node, node->first_line);
+	show_lines(node, node->base.state.width, node->base.state.height);
+	return true;
+}
+
+bool wlf_paragraph_node_set_size(struct wlf_paragraph_node *node,
+		int width, uint32_t height) {
+	if (node == NULL || width < 0 || height == 0) {
+		return false;
+	}
+	if (width == node->view_width && height == node->view_height) {
+		return true;
+	}
+
+	uint32_t old_width = node->base.state.width;
+	uint32_t old_height = node->base.state.height;
+	if (width != node->view_width) {
+		int old_view_width = node->view_width;
+		node->view_width = width;
+		if (!wrap_text(node)) {
+			node->view_width = old_view_width;
+			return false;
+		}
+		for (size_t i = 0; i < node->row_count; i++) {
+			if (node->rows[i].node != NULL) {
+				wlf_text_node_set_max_width(node->rows[i].node, width);
+			}
+		}
+		invalidate_rows(node);
+	}
+	node->view_height = height;
+	if (!set_row_count(node)) {
+		return false;
+	}
+
+	node->first_line = clamp_first_line(node, node->first_line);
+	show_lines(node, old_width, old_height);
+	return true;
+}
+
+void wlf_paragraph_node_scroll_to_line(struct wlf_paragraph_node *node,
+		size_t line) {
+	if (node == NULL) {
+		return;
+	}
+	line = clamp_first_line(node, line);
+	if (line == node->first_line) {
+		return;
+	}
+	node->first_line = line;
+	show_lines(node, node->base.state.width, node->base.state.height);
+}
+
+size_t wlf_paragraph_node_get_line_count(
+		const struct wlf_paragraph_node *node) {
+	return node != NULL ? get_line_count(node) : 0;
+}
+
+void wlf_paragraph_node_set_color(struct wlf_paragraph_node *node,
+		const struct wlf_color *color) {
+	if (node == NULL || color == NULL || wlf_color_equal(&node->color, color)) {
+		return;
+	}
+	node->color = *color;
+	for (size_t i = 0; i < node->row_count; i++) {
+		if (node->rows[i].node != NULL) {
+			wlf_text_node_set_color(node->rows[i].node, color);
+		}
+	}
+}
+
+bool wlf_scene_node_is_paragraph(const struct wlf_scene_node *node) {
+	return node != NULL && node->impl == &scene_node_impl;
+}
+
+struct wlf_paragraph_node *wlf_paragraph_node_from_node(
+		struct wlf_scene_node *node) {
+	assert(wlf_scene_node_is_paragraph(node));
+	struct wlf_paragraph_node *paragraph =
+		wlf_container_of(node, paragraph, base);
+	return paragraph;
+}
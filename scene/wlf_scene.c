@@ -7,8 +7,10 @@
 #include "wlf/pass/wlf_poly_pass.h"
 #include "wlf/pass/wlf_rect_shape_pass.h"
 #include "wlf/pass/wlf_rect_pass.h"
+#include "wlf/pass/wlf_text_pass.h"
 #include "wlf/pass/wlf_texture_pass.h"
 #include "wlf/scene/wlf_scene_tree.h"
+#include "wlf/scene/wlf_text_node.h"
 #include "wlf/utils/wlf_log.h"
 #include "wlf/utils/wlf_env.h"
 #include "wlf/utils/wlf_time.h"
@@ -119,6 +121,8 @@ static bool create_passes(struct wlf_scene *scene) {
 	scene->line_pass = wlf_line_pass_create(wlf_vector_pass_auto_create(renderer));
 	scene->poly_pass = wlf_poly_pass_create(wlf_vector_pass_auto_create(renderer));
 	scene->path_pass = wlf_path_pass_create(wlf_vector_pass_auto_create(renderer));
+	/* Optional: text nodes rasterize whole strings without it. */
+	scene->text_pass = wlf_text_pass_auto_create(renderer);
 
 	return scene->rect_pass != NULL && scene->texture_pass != NULL &&
 		scene->rect_shape_pass != NULL && scene->circle_pass != NULL &&
@@ -127,6 +131,7 @@ static bool create_passes(struct wlf_scene *scene) {
 }
 
 static void destroy_passes(struct wlf_scene *scene) {
+	wlf_text_pass_destroy(scene->text_pass);
 	wlf_render_path_pass_destroy(scene->path_pass);
 	wlf_render_poly_pass_destroy(scene->poly_pass);
 	wlf_render_line_pass_destroy(scene->line_pass);
@@ -294,10 +299,7 @@ static void handle_window_expose(struct wlf_listener *listener, void *data) {
 		wlf_container_of(listener, scene, window_expose);
 	scene->frame_scheduled = false;
 	if (wlf_scene_needs_frame(scene) && !wlf_scene_commit(scene)) {
-		if (!scene->frame_scheduled) {
-			scene->frame_scheduled = true;
-			wlf_window_schedule_frame(scene->window);
-		}
+		wlf_scene_schedule_frame(scene);
 		return;
 	}
 
@@ -353,6 +355,7 @@ struct wlf_scene *wlf_scene_create(struct wlf_window *window) {
 		window->state.geometry.width, window->state.geometry.height);
 	wlf_linked_list_init(&scene->damage_highlight_regions);
 	wlf_array_init(&scene->render_list);
+	wlf_linked_list_init(&scene->stale_text);
 	scene->calculate_visibility =
 		!wlf_env_parse_bool("WLF_SCENE_DISABLE_VISIBILITY");
 	scene->highlight_transparent_region =
@@ -448,9 +451,8 @@ void wlf_scene_damage(struct wlf_scene *scene,
 	bool has_damage = !pixman_region32_empty(&clipped);
 	pixman_region32_fini(&clipped);
 
-	if (has_damage && !scene->frame_scheduled) {
-		scene->frame_scheduled = true;
-		wlf_window_schedule_frame(scene->window);
+	if (has_damage) {
+		wlf_scene_schedule_frame(scene);
 	}
 }
 
@@ -484,8 +486,8 @@ void wlf_scene_set_debug_damage(struct wlf_scene *scene,
 }
 
 bool wlf_scene_needs_frame(const struct wlf_scene *scene) {
-	return scene != NULL && (!pixman_region32_empty(
-		(pixman_region32_t *)&scene->damage) ||
+	return scene != NULL && (scene->stale_text_visible ||
+		!pixman_region32_empty((pixman_region32_t *)&scene->damage) ||
 		(scene->debug_damage_option == WLF_SCENE_DEBUG_DAMAGE_HIGHLIGHT &&
 		!wlf_linked_list_empty(&scene->damage_highlight_regions)));
 }
@@ -494,6 +496,35 @@ struct scene_state {
 	pixman_region32_t damage;
 };
 
+/* Rasterizes on-screen text nodes left stale by a scale change, up to the
+ * per-frame budget. Off-screen nodes stay queued and are checked again on
+ * every commit, so they are rasterized once they scroll into view. */
+static void refresh_stale_text(struct wlf_scene *scene) {
+	size_t budget = WLF_SCENE_STALE_TEXT_BUDGET;
+	struct wlf_text_node *node, *tmp;
+	wlf_linked_list_for_each_safe(node, tmp, &scene->stale_text, stale_link) {
+		if (budget == 0) {
+			return;
+		}
+		if (!pixman_region32_empty(&node->base.state.visible)) {
+			wlf_text_node_update_scale(node);
+			budget--;
+		}
+	}
+}
+
+/* Checks after a frame whether stale text is still on screen, either over
+ * budget or made visible by the render list rebuild, and needs a frame. */
+static bool stale_text_on_screen(const struct wlf_scene *scene) {
+	struct wlf_text_node *node;
+	wlf_linked_list_for_each(node, &scene->stale_text, stale_link) {
+		if (!pixman_region32_empty(&node->base.state.visible)) {
+			return true;
+		}
+	}
+	return false;
+}
+
 static bool scene_build_state(struct wlf_scene *scene,
 		struct scene_state *state) {
 	struct wlf_window *window = scene->window;
@@ -567,8 +598,12 @@ static bool scene_build_state(struct wlf_scene *scene,
 }
 
 bool wlf_scene_commit(struct wlf_scene *scene) {
-	if (scene == NULL || !wlf_scene_needs_frame(scene)) {
-		return scene != NULL;
+	if (scene == NULL) {
+		return false;
+	}
+	refresh_stale_text(scene);
+	if (!wlf_scene_needs_frame(scene)) {
+		return true;
 	}
 
 	struct scene_state state;
@@ -590,16 +625,24 @@ bool wlf_scene_commit(struct wlf_scene *scene) {
 	pixman_region32_copy(&scene->previous_damage, &state.damage);
 	pixman_region32_clear(&scene->damage);
 	pixman_region32_fini(&state.damage);
-	if (scene->debug_damage_option == WLF_SCENE_DEBUG_DAMAGE_HIGHLIGHT &&
-			!wlf_linked_list_empty(&scene->damage_highlight_regions)) {
-		if (!scene->frame_scheduled) {
-			scene->frame_scheduled = true;
-			wlf_window_schedule_frame(scene->window);
-		}
+	scene->stale_text_visible = stale_text_on_screen(scene);
+	if (scene->stale_text_visible ||
+			(scene->debug_damage_option == WLF_SCENE_DEBUG_DAMAGE_HIGHLIGHT &&
+			!wlf_linked_list_empty(&scene->damage_highlight_regions))) {
+		wlf_scene_schedule_frame(scene);
 	}
 	return true;
 }
 
+void wlf_scene_schedule_frame(struct wlf_scene *scene) {
+	if (scene == NULL || scene->frame_scheduled) {
+		return;
+	}
+
+	scene->frame_scheduled = true;
+	wlf_window_schedule_frame(scene->window);
+}
+
 void wlf_scene_send_frame_done(struct wlf_scene *scene,
 		const struct timespec *when) {
 	if (scene != NULL && when != NULL) {
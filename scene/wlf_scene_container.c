@@ -0,0 +1,120 @@
+#include "wlf/scene/wlf_scene_container.h"
+#include "wlf/scene/wlf_scene.h"
+#include "wlf/utils/wlf_linked_list.h"
+
+void wlf_scene_container_destroy_children(struct wlf_scene_node *node) {
+	struct wlf_linked_list *children = wlf_scene_node_get_children(node);
+	struct wlf_scene_node *child, *tmp;
+	wlf_linked_list_for_each_safe(child, tmp, children, link) {
+		wlf_scene_node_destroy(child);
+	}
+}
+
+void wlf_scene_container_damage_band(struct wlf_scene_node *node, int y,
+		uint32_t width, uint32_t height) {
+	int lx, ly;
+	struct wlf_scene *scene = node->scene;
+	if (scene == NULL || !wlf_scene_node_coords(node, &lx, &ly)) {
+		return;
+	}
+	pixman_region32_t damage;
+	pixman_region32_init_rect(&damage, lx, ly + y, width, height);
+	wlf_scene_recalculate_visibility(scene);
+	wlf_scene_damage(scene, &damage);
+	pixman_region32_fini(&damage);
+}
+
+void wlf_scene_container_set_opacity(struct wlf_scene_node *node,
+		float opacity) {
+	node->state.opacity = opacity;
+	struct wlf_linked_list *children = wlf_scene_node_get_children(node);
+	struct wlf_scene_node *child;
+	wlf_linked_list_for_each(child, children, link) {
+		wlf_scene_node_set_opacity(child, opacity);
+	}
+}
+
+void wlf_scene_container_get_size(struct wlf_scene_node *node,
+		uint32_t *width, uint32_t *height) {
+	*width = node->state.width;
+	*height = node->state.height;
+}
+
+bool wlf_scene_container_invisible(struct wlf_scene_node *node) {
+	(void)node;
+	return true;
+}
+
+void wlf_scene_container_visibility(struct wlf_scene_node *node,
+		pixman_region32_t *visible) {
+	if (!node->state.enabled) {
+		return;
+	}
+	struct wlf_linked_list *children = wlf_scene_node_get_children(node);
+	struct wlf_scene_node *child;
+	wlf_linked_list_for_each(child, children, link) {
+		wlf_scene_node_visibility(child, visible);
+	}
+}
+
+static bool node_at_iterator(struct wlf_scene_node *node,
+		int lx, int ly, void *data) {
+	struct wlf_node_at_data *at = data;
+	at->rx = at->lx - lx;
+	at->ry = at->ly - ly;
+	at->node = node;
+	return true;
+}
+
+struct wlf_scene_node *wlf_scene_container_at(struct wlf_scene_node *node,
+		double lx, double ly, double *nx, double *ny) {
+	struct wlf_frect box = {
+		.x = lx,
+		.y = ly,
+		.width = 1,
+		.height = 1,
+	};
+	struct wlf_node_at_data data = {
+		.lx = lx,
+		.ly = ly,
+	};
+	if (!wlf_scene_node_nodes_in_box(node, &box, node_at_iterator, &data)) {
+		return NULL;
+	}
+	if (nx != NULL) {
+		*nx = data.rx;
+	}
+	if (ny != NULL) {
+		*ny = data.ry;
+	}
+	return data.node;
+}
+
+void wlf_scene_container_bounds(struct wlf_scene_node *node,
+		int x, int y, pixman_region32_t *visible) {
+	if (!node->state.enabled) {
+		return;
+	}
+	struct wlf_linked_list *children = wlf_scene_node_get_children(node);
+	struct wlf_scene_node *child;
+	wlf_linked_list_for_each(child, children, link) {
+		wlf_scene_node_bounds(child, x + child->state.x,
+			y + child->state.y, visible);
+	}
+}
+
+bool wlf_scene_container_in_box(struct wlf_scene_node *node,
+		struct wlf_frect *box, scene_node_box_iterator_func_t iterator,
+		void *user_data) {
+	if (!node->state.enabled) {
+		return false;
+	}
+	struct wlf_linked_list *children = wlf_scene_node_get_children(node);
+	struct wlf_scene_node *child;
+	wlf_linked_list_for_each_reverse(child, children, link) {
+		if (wlf_scene_node_nodes_in_box(child, box, iterator, user_data)) {
+			return true;
+		}
+	}
+	return false;
+}
@@ -1,12 +1,20 @@
 #include "wlf/scene/wlf_svg_node.h"
 
+#include "wlf/pass/wlf_circle_pass.h"
+#include "wlf/pass/wlf_ellipse_pass.h"
+#include "wlf/pass/wlf_line_pass.h"
+#include "wlf/pass/wlf_path_pass.h"
+#include "wlf/pass/wlf_poly_pass.h"
+#include "wlf/pass/wlf_rect_shape_pass.h"
 #include "wlf/scene/wlf_circle_node.h"
 #include "wlf/scene/wlf_ellipse_node.h"
 #include "wlf/scene/wlf_line_node.h"
 #include "wlf/scene/wlf_path_node.h"
 #include "wlf/scene/wlf_poly_node.h"
 #include "wlf/scene/wlf_rect_shape_node.h"
+#include "wlf/scene/wlf_scene_container.h"
 #include "wlf/scene/wlf_text_node.h"
+#include "wlf/scene/wlf_texture_node.h"
 #include "wlf/shapes/wlf_circle_shape.h"
 #include "wlf/shapes/wlf_ellipse_shape.h"
 #include "wlf/shapes/wlf_line_shape.h"
@@ -14,11 +22,16 @@
 #include "wlf/shapes/wlf_poly_shape.h"
 #include "wlf/shapes/wlf_rect_shape.h"
 #include "wlf/shapes/wlf_text_shape.h"
+#include "wlf/svg/wlf_svg_cache.h"
 #include "wlf/types/wlf_gradient.h"
+#include "wlf/types/wlf_pixel_format.h"
 #include "wlf/utils/wlf_log.h"
+#include "wlf/window/wlf_window.h"
 
 #include <assert.h>
 #include <math.h>
+#include <pixman.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 static struct wlf_shape_state *shape_state(struct wlf_shape *shape) {
@@ -120,8 +133,9 @@ static bool geometry_origin(struct wlf_shape *shape, double *x, double *y) {
 	return false;
 }
 
-static struct wlf_scene_node *create_geometry_node(
-		struct wlf_svg_node *svg_node, struct wlf_svg_shape *svg_shape) {
+/* Copies an SVG shape's geometry with its paint resolved into the state.
+ * The copy borrows the gradients of @p svg_shape. */
+static struct wlf_shape *clone_geometry(struct wlf_svg_shape *svg_shape) {
 	struct wlf_shape *geometry = wlf_shape_clone(svg_shape->geometry);
 	if (geometry == NULL) {
 		return NULL;
@@ -146,12 +160,24 @@ static struct wlf_scene_node *create_geometry_node(
 		state->fill_opacity = 1.0f;
 		state->stroke_opacity = 1.0f;
 	}
+	return geometry;
+}
+
+static struct wlf_scene_node *create_geometry_node(
+		struct wlf_svg_node *svg_node, struct wlf_svg_shape *svg_shape,
+		float dx, float dy) {
+	struct wlf_shape *geometry = clone_geometry(svg_shape);
+	if (geometry == NULL) {
+		return NULL;
+	}
 
 	double x, y;
 	if (!geometry_origin(geometry, &x, &y)) {
 		wlf_shape_destroy(geometry);
 		return NULL;
 	}
+	x += dx;
+	y += dy;
 	struct wlf_scene_node *node = NULL;
 	if (wlf_shape_is_rect(geometry)) {
 		struct wlf_rect_shape_node *rect = wlf_rect_shape_node_create(
@@ -192,7 +218,7 @@ static struct wlf_scene_node *create_geometry_node(
 }
 
 static struct wlf_scene_node *create_text_node(struct wlf_svg_node *svg_node,
-		struct wlf_svg_shape *svg_shape) {
+		struct wlf_svg_shape *svg_shape, float dx, float dy) {
 	struct wlf_text_shape *shape =
 		wlf_text_shape_from_shape(svg_shape->geometry);
 	struct wlf_color color = WLF_COLOR_TRANSPARENT;
@@ -205,159 +231,364 @@ static struct wlf_scene_node *create_text_node(struct wlf_svg_node *svg_node,
 	}
 
 	struct wlf_text_node *text = wlf_text_node_create(&svg_node->base,
-		(int)shape->x, (int)shape->y, shape->text, shape->font_family,
+		(int)(shape->x + dx), (int)(shape->y + dy), shape->text, shape->font_family,
 		shape->font_size, &color);
 	if (text == NULL) {
 		return NULL;
 	}
 
-	double x = shape->x;
+	double x = shape->x + dx;
 	if (shape->text_anchor == WLF_TEXT_ANCHOR_MIDDLE) {
 		x -= text->natural_width / 2.0;
 	} else if (shape->text_anchor == WLF_TEXT_ANCHOR_END) {
 		x -= text->natural_width;
 	}
 	wlf_scene_node_set_position(&text->base, (int)x,
-		(int)(shape->y - text->baseline));
+		(int)(shape->y + dy - text->baseline));
 	return &text->base;
 }
 
-static bool create_children(struct wlf_svg_node *node) {
-	for (struct wlf_shape *base = node->image->shapes; base != NULL;) {
-		struct wlf_svg_shape *svg_shape = wlf_svg_shape_from_shape(base);
-		base = (struct wlf_shape *)svg_shape->next;
-		if (!(svg_shape->flags & WLF_SVG_FLAGS_VISIBLE) ||
-				svg_shape->geometry == NULL) {
-			continue;
-		}
+/* <use> instances share the symbol's shapes; each one becomes its own
+ * child placed at the instance offset. */
+static bool create_child_iterator(struct wlf_svg_shape *svg_shape,
+		float x, float y, void *data) {
+	struct wlf_svg_node *node = data;
+	if (!(svg_shape->flags & WLF_SVG_FLAGS_VISIBLE) ||
+			svg_shape->geometry == NULL) {
+		return true;
+	}
 
-		struct wlf_scene_node *child;
-		if (wlf_shape_is_text(svg_shape->geometry)) {
-			child = create_text_node(node, svg_shape);
-		} else {
-			child = create_geometry_node(node, svg_shape);
-		}
-		if (child == NULL) {
-			wlf_log(WLF_ERROR, "failed to create SVG scene child");
-			return false;
-		}
+	struct wlf_scene_node *child;
+	if (wlf_shape_is_text(svg_shape->geometry)) {
+		child = create_text_node(node, svg_shape, x, y);
+	} else {
+		child = create_geometry_node(node, svg_shape, x, y);
+	}
+	if (child == NULL) {
+		wlf_log(WLF_ERROR, "failed to create SVG scene child");
+		return false;
 	}
+	wlf_scene_node_set_opacity(child, node->base.state.opacity);
 	return true;
 }
 
-static void scene_node_destroy(struct wlf_scene_node *base) {
-	struct wlf_svg_node *node = wlf_svg_node_from_node(base);
+static bool create_children(struct wlf_svg_node *node) {
+	return wlf_svg_for_each_shape(node->image, create_child_iterator, node);
+}
+
+/* Destroys every child except @p keep, which may be NULL. */
+static void destroy_children(struct wlf_svg_node *node,
+		struct wlf_scene_node *keep) {
 	struct wlf_scene_node *child, *tmp;
 	wlf_linked_list_for_each_safe(child, tmp, &node->children, link) {
-		wlf_scene_node_destroy(child);
+		if (child != keep) {
+			wlf_scene_node_destroy(child);
+		}
 	}
-	wlf_svg_destroy(node->image);
-	free(node);
 }
 
-static void scene_node_get_size(struct wlf_scene_node *base,
-		uint32_t *width, uint32_t *height) {
-	*width = base->state.width;
-	*height = base->state.height;
+/*
+ * CPU rasterization. The regular shape passes tessellate the geometry and
+ * hand triangles to a private vector pass, which composites them into an
+ * offscreen image with the pixman vector pass's rasterizer, so the result
+ * matches the scene rendering of the shape-node subtree.
+ */
+struct svg_raster_target {
+	struct wlf_render_target_info base;
+	pixman_image_t *image;
+};
+
+static void raster_target_destroy(struct wlf_render_target_info *base) {
+	/* Targets live on the stack of svg_rasterize(). */
+	(void)base;
 }
 
-static struct wlf_linked_list *scene_node_get_children(
-		struct wlf_scene_node *base) {
-	return &wlf_svg_node_from_node(base)->children;
+static const struct wlf_render_target_info_impl raster_target_impl = {
+	.destroy = raster_target_destroy,
+};
+
+static void raster_pass_destroy(struct wlf_vector_pass *pass) {
+	free(pass);
 }
 
-static bool scene_node_invisible(struct wlf_scene_node *base) {
-	(void)base;
-	return true;
+static void raster_pass_render(struct wlf_vector_pass *pass,
+		struct wlf_render_target_info *render_target_info,
+		const struct wlf_vector_options *options) {
+	(void)pass;
+	assert(render_target_info->impl == &raster_target_impl);
+	struct svg_raster_target *target =
+		wlf_container_of(render_target_info, target, base);
+	wlf_vector_pass_composite_pixman(target->image, render_target_info,
+		options);
 }
 
-static void scene_node_visibility(struct wlf_scene_node *base,
-		pixman_region32_t *visible) {
-	if (!base->state.enabled) {
-		return;
+static const struct wlf_vector_pass_impl raster_pass_impl = {
+	.destroy = raster_pass_destroy,
+	.render = raster_pass_render,
+};
+
+static struct wlf_vector_pass *raster_pass_create(void) {
+	struct wlf_vector_pass *pass = malloc(sizeof(*pass));
+	if (pass == NULL) {
+		return NULL;
 	}
-	struct wlf_svg_node *node = wlf_svg_node_from_node(base);
-	struct wlf_scene_node *child;
-	wlf_linked_list_for_each(child, &node->children, link) {
-		wlf_scene_node_visibility(child, visible);
+	wlf_vector_pass_init(pass, &raster_pass_impl);
+	return pass;
+}
+
+struct svg_raster_passes {
+	struct wlf_rect_shape_pass *rect_shape;
+	struct wlf_circle_pass *circle;
+	struct wlf_ellipse_pass *ellipse;
+	struct wlf_line_pass *line;
+	struct wlf_poly_pass *poly;
+	struct wlf_path_pass *path;
+};
+
+static void raster_passes_finish(struct svg_raster_passes *passes) {
+	wlf_render_path_pass_destroy(passes->path);
+	wlf_render_poly_pass_destroy(passes->poly);
+	wlf_render_line_pass_destroy(passes->line);
+	wlf_render_ellipse_pass_destroy(passes->ellipse);
+	wlf_render_circle_pass_destroy(passes->circle);
+	wlf_render_rect_shape_pass_destroy(passes->rect_shape);
+}
+
+static bool raster_passes_init(struct svg_raster_passes *passes) {
+	*passes = (struct svg_raster_passes){
+		.rect_shape = wlf_rect_shape_pass_create(raster_pass_create()),
+		.circle = wlf_circle_pass_create(raster_pass_create()),
+		.ellipse = wlf_ellipse_pass_create(raster_pass_create()),
+		.line = wlf_line_pass_create(raster_pass_create()),
+		.poly = wlf_poly_pass_create(raster_pass_create()),
+		.path = wlf_path_pass_create(raster_pass_create()),
+	};
+	if (passes->rect_shape == NULL || passes->circle == NULL ||
+			passes->ellipse == NULL || passes->line == NULL ||
+			passes->poly == NULL || passes->path == NULL) {
+		raster_passes_finish(passes);
+		return false;
+	}
+	return true;
+}
+
+static void raster_geometry(struct svg_raster_passes *passes,
+		struct wlf_render_target_info *target, struct wlf_shape *geometry,
+		double dx, double dy) {
+	if (wlf_shape_is_rect(geometry)) {
+		wlf_render_pass_add_rect_shape(passes->rect_shape, target,
+			&(struct wlf_render_rect_shape_options){
+				.shape = wlf_rect_shape_from_shape(geometry),
+				.offset_x = dx,
+				.offset_y = dy,
+				.opacity = 1.0f,
+			});
+	} else if (wlf_shape_is_circle(geometry)) {
+		wlf_render_pass_add_circle(passes->circle, target,
+			&(struct wlf_render_circle_options){
+				.shape = wlf_circle_shape_from_shape(geometry),
+				.offset_x = dx,
+				.offset_y = dy,
+				.opacity = 1.0f,
+			});
+	} else if (wlf_shape_is_ellipse(geometry)) {
+		wlf_render_pass_add_ellipse(passes->ellipse, target,
+			&(struct wlf_render_ellipse_options){
+				.shape = wlf_ellipse_shape_from_shape(geometry),
+				.offset_x = dx,
+				.offset_y = dy,
+				.opacity = 1.0f,
+			});
+	} else if (wlf_shape_is_line(geometry)) {
+		wlf_render_pass_add_line(passes->line, target,
+			&(struct wlf_render_line_options){
+				.shape = wlf_line_shape_from_shape(geometry),
+				.offset_x = dx,
+				.offset_y = dy,
+				.opacity = 1.0f,
+			});
+	} else if (wlf_shape_is_poly(geometry)) {
+		wlf_render_pass_add_poly(passes->poly, target,
+			&(struct wlf_render_poly_options){
+				.shape = wlf_poly_shape_from_shape(geometry),
+				.offset_x = dx,
+				.offset_y = dy,
+				.opacity = 1.0f,
+			});
+	} else if (wlf_shape_is_path(geometry)) {
+		wlf_render_pass_add_path(passes->path, target,
+			&(struct wlf_render_path_options){
+				.shape = wlf_path_shape_from_shape(geometry),
+				.offset_x = dx,
+				.offset_y = dy,
+				.opacity = 1.0f,
+			});
 	}
 }
 
-static bool node_at_iterator(struct wlf_scene_node *node,
-		int lx, int ly, void *data) {
-	struct wlf_node_at_data *at = data;
-	at->rx = at->lx - lx;
-	at->ry = at->ly - ly;
-	at->node = node;
+static bool raster_check_iterator(struct wlf_svg_shape *svg_shape,
+		float x, float y, void *data) {
+	(void)x;
+	(void)y;
+	(void)data;
+	return !(svg_shape->flags & WLF_SVG_FLAGS_VISIBLE) ||
+		svg_shape->geometry == NULL ||
+		!wlf_shape_is_text(svg_shape->geometry);
+}
+
+struct svg_raster_state {
+	struct svg_raster_passes *passes;
+	struct wlf_render_target_info *target;
+};
+
+static bool raster_shape_iterator(struct wlf_svg_shape *svg_shape,
+		float x, float y, void *data) {
+	struct svg_raster_state *state = data;
+	if (!(svg_shape->flags & WLF_SVG_FLAGS_VISIBLE) ||
+			svg_shape->geometry == NULL) {
+		return true;
+	}
+	struct wlf_shape *geometry = clone_geometry(svg_shape);
+	if (geometry == NULL) {
+		return false;
+	}
+	raster_geometry(state->passes, state->target, geometry, x, y);
+	wlf_shape_destroy(geometry);
 	return true;
 }
 
-static struct wlf_scene_node *scene_node_at(struct wlf_scene_node *base,
-		double lx, double ly, double *nx, double *ny) {
-	struct wlf_frect box = {
-		.x = lx,
-		.y = ly,
-		.width = 1,
-		.height = 1,
+/* Returns a premultiplied a8r8g8b8 image of @p image at @p scale, or NULL
+ * when it cannot be rasterized. Text needs the platform text renderer and
+ * is not supported here. */
+static pixman_image_t *svg_rasterize(struct wlf_svg_image *image,
+		double scale) {
+	if (!wlf_svg_for_each_shape(image, raster_check_iterator, NULL)) {
+		return NULL;
+	}
+
+	int width = (int)ceil(image->width * scale);
+	int height = (int)ceil(image->height * scale);
+	if (width <= 0 || height <= 0) {
+		return NULL;
+	}
+
+	struct svg_raster_passes passes;
+	if (!raster_passes_init(&passes)) {
+		return NULL;
+	}
+	struct svg_raster_target target = {
+		.image = pixman_image_create_bits(PIXMAN_a8r8g8b8,
+			width, height, NULL, 0),
 	};
-	struct wlf_node_at_data data = {
-		.lx = lx,
-		.ly = ly,
+	if (target.image == NULL) {
+		raster_passes_finish(&passes);
+		return NULL;
+	}
+	wlf_render_target_info_init(&target.base, &raster_target_impl);
+	target.base.logical_width = (int)ceil(image->width);
+	target.base.logical_height = (int)ceil(image->height);
+	target.base.buffer_width = width;
+	target.base.buffer_height = height;
+	target.base.scale = scale;
+
+	struct svg_raster_state state = {
+		.passes = &passes,
+		.target = &target.base,
 	};
-	if (!wlf_scene_node_nodes_in_box(base, &box, node_at_iterator, &data)) {
+	if (!wlf_svg_for_each_shape(image, raster_shape_iterator, &state)) {
+		pixman_image_unref(target.image);
+		raster_passes_finish(&passes);
 		return NULL;
 	}
-	if (nx != NULL) {
-		*nx = data.rx;
+
+	raster_passes_finish(&passes);
+	return target.image;
+}
+
+static bool svg_node_rasterize(struct wlf_svg_node *node) {
+	struct wlf_window *window = node->base.window;
+	if (window == NULL || window->state.renderer == NULL) {
+		return false;
+	}
+
+	pixman_image_t *pixels = svg_rasterize(node->image, node->raster_scale);
+	if (pixels == NULL) {
+		return false;
+	}
+	struct wlf_texture *texture = wlf_texture_from_pixels(
+		window->state.renderer, WLF_FORMAT_ARGB8888,
+		(uint32_t)pixman_image_get_stride(pixels),
+		(uint32_t)pixman_image_get_width(pixels),
+		(uint32_t)pixman_image_get_height(pixels),
+		pixman_image_get_data(pixels));
+	pixman_image_unref(pixels);
+	if (texture == NULL) {
+		wlf_log(WLF_ERROR, "failed to create renderer texture for SVG node");
+		return false;
 	}
-	if (ny != NULL) {
-		*ny = data.ry;
+
+	if (node->raster != NULL) {
+		wlf_texture_node_set_texture(node->raster, texture);
+		return true;
 	}
-	return data.node;
+
+	struct wlf_texture_node *raster = wlf_texture_node_create(&node->base,
+		texture, 0, 0, node->base.state.width, node->base.state.height);
+	if (raster == NULL) {
+		wlf_texture_destroy(texture);
+		return false;
+	}
+	destroy_children(node, &raster->base);
+	node->raster = raster;
+	wlf_scene_node_set_opacity(&raster->base, node->base.state.opacity);
+	return true;
 }
 
-static void scene_node_bounds(struct wlf_scene_node *base,
-		int x, int y, pixman_region32_t *visible) {
-	if (!base->state.enabled) {
+static void handle_window_scale(struct wlf_listener *listener, void *data) {
+	struct wlf_svg_node *node =
+		wlf_container_of(listener, node, window_scale);
+	struct wlf_window *window = data;
+	if (node->raster_scale == window->state.scale) {
 		return;
 	}
-	struct wlf_svg_node *node = wlf_svg_node_from_node(base);
-	struct wlf_scene_node *child;
-	wlf_linked_list_for_each(child, &node->children, link) {
-		wlf_scene_node_bounds(child, x + child->state.x,
-			y + child->state.y, visible);
+	node->raster_scale = window->state.scale;
+	if (!svg_node_rasterize(node)) {
+		wlf_log(WLF_ERROR, "failed to rerasterize SVG after scale change");
 	}
 }
 
-static bool scene_nodes_in_box(struct wlf_scene_node *base,
-		struct wlf_frect *box, scene_node_box_iterator_func_t iterator,
-		void *user_data) {
-	if (!base->state.enabled) {
-		return false;
-	}
+static void scene_node_destroy(struct wlf_scene_node *base) {
 	struct wlf_svg_node *node = wlf_svg_node_from_node(base);
-	struct wlf_scene_node *child;
-	wlf_linked_list_for_each_reverse(child, &node->children, link) {
-		if (wlf_scene_node_nodes_in_box(child, box, iterator, user_data)) {
-			return true;
-		}
+	wlf_linked_list_remove(&node->window_scale.link);
+	destroy_children(node, NULL);
+	if (node->document != NULL) {
+		wlf_svg_document_unref(node->document);
+	} else {
+		wlf_svg_destroy(node->image);
 	}
-	return false;
+	free(node);
+}
+
+static struct wlf_linked_list *scene_node_get_children(
+		struct wlf_scene_node *base) {
+	return &wlf_svg_node_from_node(base)->children;
 }
 
 static const struct wlf_scene_node_impl scene_node_impl = {
 	.destroy = scene_node_destroy,
-	.get_size = scene_node_get_size,
+	.set_opacity = wlf_scene_container_set_opacity,
+	.get_size = wlf_scene_container_get_size,
 	.get_children = scene_node_get_children,
-	.invisible = scene_node_invisible,
-	.visibility = scene_node_visibility,
-	.at = scene_node_at,
-	.bounds = scene_node_bounds,
-	.in_box = scene_nodes_in_box,
+	.invisible = wlf_scene_container_invisible,
+	.visibility = wlf_scene_container_visibility,
+	.at = wlf_scene_container_at,
+	.bounds = wlf_scene_container_bounds,
+	.in_box = wlf_scene_container_in_box,
 };
 
-struct wlf_svg_node *wlf_svg_node_create(struct wlf_scene_node *parent,
-		int x, int y, struct wlf_svg_image *image) {
+static struct wlf_svg_node *svg_node_create(struct wlf_scene_node *parent,
+		int x, int y, struct wlf_svg_image *image,
+		struct wlf_svg_document *document) {
 	if (parent == NULL || image == NULL ||
 			!isfinite(image->width) || !isfinite(image->height) ||
 			image->width < 0 || image->height < 0) {
@@ -376,9 +607,13 @@ struct wlf_svg_node *wlf_svg_node_create(struct wlf_scene_node *parent,
 	node->base.state.width = (uint32_t)ceil(image->width);
 	node->base.state.height = (uint32_t)ceil(image->height);
 	node->image = image;
+	node->document = document;
+	wlf_linked_list_init(&node->window_scale.link);
 
 	if (!create_children(node)) {
+		/* Ownership of the image stays with the caller. */
 		node->image = NULL;
+		node->document = NULL;
 		wlf_scene_node_destroy(&node->base);
 		return NULL;
 	}
@@ -386,6 +621,61 @@ struct wlf_svg_node *wlf_svg_node_create(struct wlf_scene_node *parent,
 	return node;
 }
 
+struct wlf_svg_node *wlf_svg_node_create(struct wlf_scene_node *parent,
+		int x, int y, struct wlf_svg_image *image) {
+	return svg_node_create(parent, x, y, image, NULL);
+}
+
+struct wlf_svg_node *wlf_svg_node_create_from_document(
+		struct wlf_scene_node *parent, int x, int y,
+		struct wlf_svg_document *document) {
+	if (document == NULL) {
+		return NULL;
+	}
+	struct wlf_svg_node *node = svg_node_create(parent, x, y,
+		wlf_svg_document_get_image(document), document);
+	if (node != NULL) {
+		wlf_svg_document_ref(document);
+	}
+	return node;
+}
+
+bool wlf_svg_node_set_rasterized(struct wlf_svg_node *node, bool rasterized) {
+	if (node == NULL) {
+		return false;
+	}
+	if (rasterized == (node->raster != NULL)) {
+		return true;
+	}
+
+	if (rasterized) {
+		struct wlf_window *window = node->base.window;
+		if (window == NULL) {
+			return false;
+		}
+		node->raster_scale = window->state.scale;
+		if (!svg_node_rasterize(node)) {
+			return false;
+		}
+		node->window_scale.notify = handle_window_scale;
+		wlf_signal_add(&window->events.scale, &node->window_scale);
+	} else {
+		/* The shape children are built next to the texture child, which is
+		 * only dropped once they all exist. */
+		struct wlf_scene_node *raster = &node->raster->base;
+		if (!create_children(node)) {
+			destroy_children(node, raster);
+			return false;
+		}
+		wlf_linked_list_remove(&node->window_scale.link);
+		wlf_linked_list_init(&node->window_scale.link);
+		wlf_scene_node_destroy(raster);
+		node->raster = NULL;
+	}
+	wlf_scene_node_update(&node->base, NULL);
+	return true;
+}
+
 struct wlf_svg_node *wlf_svg_node_create_from_file(
 		struct wlf_scene_node *parent, int x, int y,
 		const char *filename, const char *units, float dpi) {
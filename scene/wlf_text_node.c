@@ -1,5 +1,6 @@
 #include "wlf/scene/wlf_text_node.h"
 
+#include "wlf/pass/wlf_text_pass.h"
 #include "wlf/platform/wlf_text.h"
 #include "wlf/scene/wlf_scene.h"
 #include "wlf/types/wlf_pixel_format.h"
@@ -18,7 +19,9 @@ static bool text_node_rasterize(struct wlf_text_node *node);
 
 static bool text_node_invisible(struct wlf_scene_node *base) {
 	struct wlf_text_node *node = wlf_text_node_from_node(base);
-	return !base->state.enabled || node->texture == NULL ||
+	bool empty = node->use_glyph_atlas ?
+		node->glyph_run.glyph_count == 0 : node->texture == NULL;
+	return !base->state.enabled || empty ||
 		base->state.width <= 0 || base->state.height <= 0 ||
 		base->state.opacity <= 0 || node->color.a <= 0;
 }
@@ -106,38 +109,123 @@ static void handle_renderer_destroy(struct wlf_listener *listener, void *data) {
 	node->renderer = NULL;
 }
 
+static bool text_node_is_stale(const struct wlf_text_node *node) {
+	return !wlf_linked_list_empty(&node->stale_link);
+}
+
+/* Takes the node off the stale list; the next rasterization uses the
+ * current window scale. */
+static void text_node_clear_stale(struct wlf_text_node *node) {
+	if (!text_node_is_stale(node)) {
+		return;
+	}
+	wlf_linked_list_remove(&node->stale_link);
+	wlf_linked_list_init(&node->stale_link);
+	node->raster_scale = node->base.window->state.scale;
+}
+
+/* Rasterizing every text node of a window inside the scale event stalls
+ * for long with many labels. Nodes in a scene are queued on it instead
+ * and keep drawing their old raster until it rasterizes them. */
 static void handle_window_scale(struct wlf_listener *listener, void *data) {
 	struct wlf_text_node *node =
 		wlf_container_of(listener, node, window_scale);
 	struct wlf_window *window = data;
+	struct wlf_scene *scene = node->base.scene;
 	if (node->raster_scale == window->state.scale) {
+		if (text_node_is_stale(node)) {
+			wlf_linked_list_remove(&node->stale_link);
+			wlf_linked_list_init(&node->stale_link);
+		}
 		return;
 	}
-	node->raster_scale = window->state.scale;
-	if (!text_node_rasterize(node)) {
-		wlf_log(WLF_ERROR, "failed to rerasterize text after scale change");
+	if (scene == NULL) {
+		node->raster_scale = window->state.scale;
+		if (!text_node_rasterize(node)) {
+			wlf_log(WLF_ERROR, "failed to rerasterize text after scale change");
+		}
+		return;
 	}
+
+	if (!text_node_is_stale(node)) {
+		wlf_linked_list_insert(&scene->stale_text, &node->stale_link);
+	}
+	scene->stale_text_visible = true;
+	wlf_scene_schedule_frame(scene);
+}
+
+static void text_node_get_options(struct wlf_text_node *node,
+		struct wlf_text_options *options) {
+	*options = (struct wlf_text_options){
+		.text = node->text,
+		.font_family = node->font_family,
+		.font_size = node->font_size,
+		.raster_scale = node->raster_scale,
+		.color = node->color,
+		.max_width = node->max_width,
+		.slant = node->font_slant,
+		.weight = node->font_weight,
+	};
+}
+
+/* Replaces the glyph run without touching the node geometry. */
+static bool text_node_reshape(struct wlf_text_node *node) {
+	struct wlf_text_options options;
+	text_node_get_options(node, &options);
+	struct wlf_text_glyph_run run = {0};
+	if (!wlf_text_shape(node->text_context, &options, &run)) {
+		wlf_log(WLF_ERROR, "failed to shape text node");
+		return false;
+	}
+
+	wlf_text_glyph_run_finish(&node->glyph_run);
+	node->glyph_run = run;
+	node->quads_valid = false;
+	return true;
+}
+
+static bool text_node_shape(struct wlf_text_node *node) {
+	if (!text_node_reshape(node)) {
+		return false;
+	}
+
+	const struct wlf_text_metrics *metrics = &node->glyph_run.metrics;
+	node->natural_width = metrics->width / node->raster_scale;
+	node->baseline = metrics->baseline / node->raster_scale;
+
+	double width = metrics->width;
+	if (node->max_width > 0 && node->max_width * node->raster_scale < width) {
+		width = ceil(node->max_width * node->raster_scale);
+	}
+	if (node->text[0] == '\0' || node->glyph_run.glyph_count == 0 ||
+			width <= 0 || metrics->height <= 0) {
+		node->base.state.width = 0;
+		node->base.state.height = 0;
+	} else {
+		node->base.state.width = (uint32_t)ceil(width / node->raster_scale);
+		node->base.state.height =
+			(uint32_t)ceil(metrics->height / node->raster_scale);
+	}
+	wlf_scene_node_update(&node->base, NULL);
+	return true;
 }
 
 static bool text_node_rasterize(struct wlf_text_node *node) {
+	text_node_clear_stale(node);
+	if (node->use_glyph_atlas) {
+		return text_node_shape(node);
+	}
+
 	struct wlf_renderer *renderer = node->renderer;
 	if (renderer == NULL || renderer->impl->texture_from_buffer == NULL ||
 			node->text_context == NULL) {
 		return false;
 	}
 
+	struct wlf_text_options options;
+	text_node_get_options(node, &options);
 	struct wlf_text_raster raster = {0};
-	if (!wlf_text_rasterize(node->text_context,
-			&(struct wlf_text_options){
-				.text = node->text,
-				.font_family = node->font_family,
-				.font_size = node->font_size,
-				.raster_scale = node->raster_scale,
-				.color = node->color,
-				.max_width = node->max_width,
-				.slant = node->font_slant,
-				.weight = node->font_weight,
-			}, &raster)) {
+	if (!wlf_text_rasterize(node->text_context, &options, &raster)) {
 		wlf_log(WLF_ERROR, "failed to measure text node");
 		return false;
 	}
@@ -154,10 +242,12 @@ static bool text_node_rasterize(struct wlf_text_node *node) {
 		return true;
 	}
 
+	/* Padded rows become texture columns, so the mask is uploaded without
+	 * a repack; texture_box selects the inked part of it. */
 	uint32_t raster_width = raster.width;
 	uint32_t raster_height = raster.height;
 	struct wlf_texture *texture = wlf_texture_from_pixels(renderer,
-		WLF_FORMAT_ARGB8888, raster.stride, raster.width, raster.height,
+		WLF_FORMAT_R8, raster.stride, raster.stride, raster.height,
 		raster.data);
 	wlf_text_raster_destroy(node->text_context, &raster);
 	if (texture == NULL) {
@@ -166,6 +256,10 @@ static bool text_node_rasterize(struct wlf_text_node *node) {
 	}
 
 	text_node_set_texture(node, texture);
+	node->texture_box = (struct wlf_frect){
+		.width = raster_width,
+		.height = raster_height,
+	};
 	node->base.state.width =
 		(uint32_t)ceil(raster_width / node->raster_scale);
 	node->base.state.height =
@@ -174,12 +268,124 @@ static bool text_node_rasterize(struct wlf_text_node *node) {
 	return true;
 }
 
+static bool text_node_add_quad(struct wlf_text_node *node,
+		const struct wlf_text_quad *quad) {
+	if (node->quad_count == node->quad_capacity) {
+		size_t capacity = node->quad_capacity == 0 ?
+			16 : node->quad_capacity * 2;
+		struct wlf_text_quad *quads = realloc(node->quads,
+			capacity * sizeof(*quads));
+		if (quads == NULL) {
+			wlf_log_errno(WLF_ERROR, "failed to allocate text quads");
+			return false;
+		}
+		node->quads = quads;
+		node->quad_capacity = capacity;
+	}
+	node->quads[node->quad_count++] = *quad;
+	return true;
+}
+
+/* Rasterizes missing glyphs into the atlas and emits one quad per inked
+ * glyph. Pen positions are snapped to a quarter pixel horizontally and to
+ * whole pixels vertically, so every mask maps 1:1 onto target pixels. */
+static bool text_node_collect_quads(struct wlf_text_node *node,
+		struct wlf_glyph_atlas *atlas) {
+	double scale = node->raster_scale;
+	double clip_width = node->base.state.width * scale;
+	node->quad_count = 0;
+	for (size_t i = 0; i < node->glyph_run.glyph_count; i++) {
+		const struct wlf_text_glyph *glyph = &node->glyph_run.glyphs[i];
+		double pen = floor(glyph->x);
+		uint32_t subpixel = (uint32_t)lround((glyph->x - pen) *
+			WLF_GLYPH_ATLAS_SUBPIXEL_STEPS);
+		if (subpixel == WLF_GLYPH_ATLAS_SUBPIXEL_STEPS) {
+			pen += 1;
+			subpixel = 0;
+		}
+
+		struct wlf_glyph_key key = {
+			.font = glyph->font,
+			.index = glyph->index,
+			.subpixel = subpixel,
+		};
+		const struct wlf_glyph_atlas_entry *entry =
+			wlf_glyph_atlas_get(atlas, &key);
+		if (entry == NULL) {
+			struct wlf_text_glyph_image image;
+			if (!wlf_text_rasterize_glyph(node->text_context,
+					glyph->font, glyph->index,
+					(float)subpixel / WLF_GLYPH_ATLAS_SUBPIXEL_STEPS,
+					&image)) {
+				return false;
+			}
+			entry = wlf_glyph_atlas_add(atlas, &key, image.left, image.top,
+				image.width, image.height, image.stride, image.data);
+			wlf_text_glyph_image_destroy(node->text_context, &image);
+			if (entry == NULL) {
+				continue;
+			}
+		}
+		if (entry->box.width <= 0 || entry->box.height <= 0) {
+			continue;
+		}
+
+		double x = pen + entry->left;
+		double y = round(glyph->y) + entry->top;
+		if (x >= clip_width) {
+			continue;
+		}
+		if (!text_node_add_quad(node, &(struct wlf_text_quad){
+				.dst_box = {
+					.x = x / scale,
+					.y = y / scale,
+					.width = entry->box.width / scale,
+					.height = entry->box.height / scale,
+				},
+				.src_box = entry->box,
+			})) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Quads stay valid until the atlas is cleared or the text is reshaped. */
+static bool text_node_build_quads(struct wlf_text_node *node,
+		struct wlf_glyph_atlas *atlas) {
+	if (node->quads_valid &&
+			node->quad_generation == wlf_glyph_atlas_get_generation(atlas)) {
+		return true;
+	}
+
+	/* A full atlas is cleared while glyphs are added, which invalidates the
+	 * quads collected before it; collecting again then fits unless the text
+	 * alone needs more than the whole atlas. */
+	for (int attempt = 0; attempt < 2; attempt++) {
+		uint32_t generation = wlf_glyph_atlas_get_generation(atlas);
+		if (!text_node_collect_quads(node, atlas)) {
+			return false;
+		}
+		if (wlf_glyph_atlas_get_generation(atlas) == generation) {
+			node->quad_generation = generation;
+			node->quads_valid = true;
+			return true;
+		}
+	}
+
+	wlf_log(WLF_ERROR, "text node needs more glyphs than the atlas holds");
+	node->quad_count = 0;
+	return false;
+}
+
 static void text_node_destroy(struct wlf_scene_node *base) {
 	struct wlf_text_node *node = wlf_text_node_from_node(base);
 	wlf_linked_list_remove(&node->renderer_destroy.link);
 	wlf_linked_list_remove(&node->window_scale.link);
+	wlf_linked_list_remove(&node->stale_link);
 	text_node_set_texture(node, NULL);
-	wlf_text_destroy(node->text_context);
+	wlf_text_glyph_run_finish(&node->glyph_run);
+	free(node->quads);
 	free(node->font_family);
 	free(node->text);
 	free(node);
@@ -223,14 +429,16 @@ struct wlf_text_node *wlf_text_node_create(struct wlf_scene_node *parent,
 		free(node);
 		return NULL;
 	}
-	node->text_context = wlf_text_autocreate();
+	node->text_context = wlf_backend_get_text(parent->window->state.backend);
 	if (node->text_context == NULL) {
-		wlf_log(WLF_ERROR, "no text implementation is available for this platform");
 		free(node->font_family);
 		free(node->text);
 		free(node);
 		return NULL;
 	}
+	node->use_glyph_atlas = parent->scene != NULL &&
+		parent->scene->text_pass != NULL &&
+		wlf_text_supports_glyphs(node->text_context);
 
 	wlf_scene_node_init(&node->base, &text_node_impl, parent);
 	node->base.state.x = x;
@@ -242,6 +450,7 @@ struct wlf_text_node *wlf_text_node_create(struct wlf_scene_node *parent,
 	node->renderer = parent->window->state.renderer;
 	node->renderer_destroy.notify = handle_renderer_destroy;
 	wlf_signal_add(&node->renderer->events.destroy, &node->renderer_destroy);
+	wlf_linked_list_init(&node->stale_link);
 	node->window_scale.notify = handle_window_scale;
 	wlf_signal_add(&parent->window->events.scale, &node->window_scale);
 	if (!text_node_rasterize(node)) {
@@ -278,7 +487,8 @@ void wlf_text_node_set_color(struct wlf_text_node *node,
 		return;
 	}
 	node->color = *color;
-	text_node_rasterize(node);
+	/* Glyph masks and text rasters are tinted while drawing. */
+	wlf_scene_node_update(&node->base, NULL);
 }
 
 void wlf_text_node_set_font_family(struct wlf_text_node *node,
@@ -330,6 +540,15 @@ void wlf_text_node_set_max_width(struct wlf_text_node *node, int max_width) {
 	text_node_rasterize(node);
 }
 
+void wlf_text_node_update_scale(struct wlf_text_node *node) {
+	if (node == NULL || !text_node_is_stale(node)) {
+		return;
+	}
+	if (!text_node_rasterize(node)) {
+		wlf_log(WLF_ERROR, "failed to rerasterize text after scale change");
+	}
+}
+
 bool wlf_scene_node_is_text(const struct wlf_scene_node *node) {
 	return node != NULL && node->impl == &text_node_impl;
 }
@@ -341,27 +560,72 @@ struct wlf_text_node *wlf_text_node_from_node(struct wlf_scene_node *node) {
 	return text_node;
 }
 
+static void text_node_render_glyphs(struct wlf_text_node *node,
+		struct wlf_text_pass *pass,
+		struct wlf_render_target_info *render_target_info,
+		const pixman_region32_t *clip, double x, double y) {
+	if (!text_node_build_quads(node, pass->atlas)) {
+		/* Fonts of old runs can be released by the text implementation;
+		 * shaping again hands out fonts that can be rasterized. */
+		if (!text_node_reshape(node) ||
+				!text_node_build_quads(node, pass->atlas)) {
+			return;
+		}
+	}
+
+	/* The node box also clips text wider than its maximum width. */
+	pixman_region32_t region;
+	pixman_region32_init_rect(&region, (int)x, (int)y,
+		node->base.state.width, node->base.state.height);
+	if (clip != NULL) {
+		pixman_region32_intersect(&region, &region, clip);
+	}
+	wlf_render_pass_add_glyphs(pass, render_target_info,
+		&(struct wlf_render_text_options){
+			.quads = node->quads,
+			.quad_count = node->quad_count,
+			.offset_x = x,
+			.offset_y = y,
+			.color = node->color,
+			.opacity = node->base.state.opacity,
+			.clip = &region,
+		});
+	pixman_region32_fini(&region);
+}
+
 static void text_node_render_at(struct wlf_text_node *node,
-		struct wlf_texture_pass *pass,
+		struct wlf_texture_pass *pass, struct wlf_text_pass *text_pass,
 		struct wlf_render_target_info *render_target_info,
 		const pixman_region32_t *clip, double x, double y) {
-	if (node == NULL || pass == NULL || text_node_invisible(&node->base)) {
+	if (node == NULL || text_node_invisible(&node->base)) {
+		return;
+	}
+	if (node->use_glyph_atlas) {
+		if (text_pass != NULL) {
+			text_node_render_glyphs(node, text_pass, render_target_info,
+				clip, x, y);
+		}
+		return;
+	}
+	if (pass == NULL) {
 		return;
 	}
 
 	wlf_render_pass_add_texture(pass, render_target_info,
 		&(struct wlf_render_texture_options){
 			.texture = node->texture,
+			.src_box = node->texture_box,
 			.dst_box = {
 				.x = x,
 				.y = y,
-				.width = node->base.state.width,
-				.height = node->base.state.height,
+				.width = node->texture_box.width / node->raster_scale,
+				.height = node->texture_box.height / node->raster_scale,
 			},
 			.opacity = node->base.state.opacity,
 			.clip = clip,
 			.filter_mode = WLF_SCALE_FILTER_BILINEAR,
 			.blend_mode = WLF_RENDER_BLEND_MODE_PREMULTIPLIED,
+			.tint = &node->color,
 		});
 }
 
@@ -374,7 +638,9 @@ void wlf_text_node_render(struct wlf_text_node *node,
 	if (!wlf_scene_node_coords(&node->base, &x, &y)) {
 		return;
 	}
-	text_node_render_at(node, pass, render_target_info, clip, x, y);
+	struct wlf_scene *scene = node->base.scene;
+	text_node_render_at(node, pass, scene != NULL ? scene->text_pass : NULL,
+		render_target_info, clip, x, y);
 }
 
 static void scene_node_render(struct wlf_render_list_entry *entry,
@@ -385,7 +651,7 @@ static void scene_node_render(struct wlf_render_list_entry *entry,
 		return;
 	}
 	text_node_render_at(wlf_text_node_from_node(entry->node),
-		data->scene->texture_pass, data->target, &render_region,
-		entry->x, entry->y);
+		data->scene->texture_pass, data->scene->text_pass, data->target,
+		&render_region, entry->x, entry->y);
 	pixman_region32_fini(&render_region);
 }
@@ -1,6 +1,7 @@
 #include "wlf/scene/wlf_texture_node.h"
 
 #include "wlf/scene/wlf_scene.h"
+#include "wlf/image/wlf_image_cache.h"
 #include "wlf/utils/wlf_log.h"
 
 #include <assert.h>
@@ -82,7 +83,13 @@ static void texture_node_set_texture_internal(struct wlf_texture_node *node,
 		struct wlf_texture *texture) {
 	wlf_linked_list_remove(&node->renderer_destroy.link);
 	wlf_linked_list_init(&node->renderer_destroy.link);
-	wlf_texture_destroy(node->texture);
+	if (node->cache_entry != NULL) {
+		/* The texture belongs to the cache entry. */
+		wlf_image_cache_entry_unref(node->cache_entry);
+		node->cache_entry = NULL;
+	} else {
+		wlf_texture_destroy(node->texture);
+	}
 	node->texture = texture;
 	if (texture != NULL) {
 		wlf_signal_add(&texture->renderer->events.destroy,
@@ -144,6 +151,30 @@ struct wlf_texture_node *wlf_texture_node_create(
 	return node;
 }
 
+struct wlf_texture_node *wlf_texture_node_create_from_cache(
+		struct wlf_scene_node *parent, struct wlf_image_cache_entry *entry,
+		struct wlf_renderer *renderer, int x, int y,
+		uint32_t width, uint32_t height) {
+	if (entry == NULL || renderer == NULL) {
+		return NULL;
+	}
+	struct wlf_texture *texture =
+		wlf_image_cache_entry_get_texture(entry, renderer);
+	if (texture == NULL) {
+		return NULL;
+	}
+
+	wlf_image_cache_entry_ref(entry);
+	struct wlf_texture_node *node =
+		wlf_texture_node_create(parent, texture, x, y, width, height);
+	if (node == NULL) {
+		wlf_image_cache_entry_unref(entry);
+		return NULL;
+	}
+	node->cache_entry = entry;
+	return node;
+}
+
 void wlf_texture_node_set_texture(struct wlf_texture_node *node,
 		struct wlf_texture *texture) {
 	if (node == NULL || node->texture == texture) {
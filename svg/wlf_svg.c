@@ -4,6 +4,8 @@
  */
 
 #include "wlf/svg/wlf_svg.h"
+#include "wlf/utils/wlf_file_source.h"
+#include "wlf/utils/wlf_hash.h"
 #include "wlf/utils/wlf_log.h"
 #include "wlf/shapes/wlf_circle_shape.h"
 #include "wlf/shapes/wlf_ellipse_shape.h"
@@ -20,6 +22,8 @@
 #include "wlf/utils/wlf_linked_list.h"
 #include "wlf/utils/wlf_utils.h"
 
+#include <limits.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -314,37 +318,6 @@ static void wlf_svg_parse_element(char* s,
 		(*endelCb)(ud, name);
 }
 
-static int wlf_svg_parse_xml(char* input,
-				   void (*startelCb)(void* ud, const char* el, const char** attr),
-				   void (*endelCb)(void* ud, const char* el),
-				   void (*contentCb)(void* ud, const char* s),
-				   void* ud)
-{
-	char* s = input;
-	char* mark = s;
-	int state = WLF_SVG_XML_CONTENT;
-	while (*s) {
-		if (*s == '<' && state == WLF_SVG_XML_CONTENT) {
-			// Start of a tag
-			*s++ = '\0';
-			wlf_svg_parse_content(mark, contentCb, ud);
-			mark = s;
-			state = WLF_SVG_XML_TAG;
-		} else if (*s == '>' && state == WLF_SVG_XML_TAG) {
-			// Start of a content or new tag.
-			*s++ = '\0';
-			wlf_svg_parse_element(mark, startelCb, endelCb, ud);
-			mark = s;
-			state = WLF_SVG_XML_CONTENT;
-		} else {
-			s++;
-		}
-	}
-
-	return 1;
-}
-
-
 static void wlf_svg_xform_identity(float* t)
 {
 	t[0] = 1.0f; t[1] = 0.0f;
@@ -502,6 +475,39 @@ static void wlf_svg_curve_bounds(float* bounds, float* curve)
 	}
 }
 
+// Bounds of a path of 1 + 3n cubic bezier points.
+static void wlf_svg_path_bounds(struct wlf_path* path)
+{
+	float bounds[4];
+	int i;
+
+	for (i = 0; i < path->npts-1; i += 3) {
+		wlf_svg_curve_bounds(bounds, &path->pts[i*2]);
+		if (i == 0) {
+			memcpy(path->bounds, bounds, sizeof path->bounds);
+		} else {
+			path->bounds[0] = wlf_svg_minf(path->bounds[0], bounds[0]);
+			path->bounds[1] = wlf_svg_minf(path->bounds[1], bounds[1]);
+			path->bounds[2] = wlf_svg_maxf(path->bounds[2], bounds[2]);
+			path->bounds[3] = wlf_svg_maxf(path->bounds[3], bounds[3]);
+		}
+	}
+}
+
+// Union of the path bounds of a shape with at least one path.
+static void wlf_svg_shape_bounds(struct wlf_svg_shape* shape)
+{
+	struct wlf_path* path;
+
+	memcpy(shape->bounds, shape->paths->bounds, sizeof shape->bounds);
+	for (path = shape->paths->next; path != NULL; path = path->next) {
+		shape->bounds[0] = wlf_svg_minf(shape->bounds[0], path->bounds[0]);
+		shape->bounds[1] = wlf_svg_minf(shape->bounds[1], path->bounds[1]);
+		shape->bounds[2] = wlf_svg_maxf(shape->bounds[2], path->bounds[2]);
+		shape->bounds[3] = wlf_svg_maxf(shape->bounds[3], path->bounds[3]);
+	}
+}
+
 static unsigned char wlf_svg_encode_paint_order(enum wlf_svg_paint_order a, enum wlf_svg_paint_order b, enum wlf_svg_paint_order c) {
     return (a & 0x03) | ((b & 0x03) << 2) | ((c & 0x03) << 4);
 }
@@ -536,8 +542,88 @@ static float wlf_svg_shape_stroke_alpha(const struct wlf_svg_shape *shape)
 	return shape->opacity * shape->stroke_opacity;
 }
 
+/*
+ * Everything a parsed image owns directly (the image itself, its shapes,
+ * paths, point arrays, symbols and uses) is carved out of a few large blocks
+ * and released in one go by wlf_svg_destroy(). Blocks come from calloc and
+ * are never reused, so allocations are zeroed.
+ */
+#define WLF_SVG_ARENA_MIN_BLOCK 4096
+#define WLF_SVG_ARENA_MAX_BLOCK 65536
+
+struct wlf_svg_arena_block {
+	struct wlf_svg_arena_block *next;
+	size_t size;
+	size_t used;
+	max_align_t data[];
+};
+
+struct wlf_svg_arena {
+	struct wlf_svg_arena_block *blocks; /* Head is the block being filled. */
+	size_t next_block_size;
+};
+
+static struct wlf_svg_arena* wlf_svg_arena_create(void)
+{
+	struct wlf_svg_arena* arena = calloc(1, sizeof(*arena));
+	if (arena == NULL) {
+		wlf_log_errno(WLF_ERROR, "failed to allocate SVG arena");
+		return NULL;
+	}
+	arena->next_block_size = WLF_SVG_ARENA_MIN_BLOCK;
+	return arena;
+}
+
+static void wlf_svg_arena_destroy(struct wlf_svg_arena* arena)
+{
+	struct wlf_svg_arena_block *block, *next;
+	if (arena == NULL) return;
+	for (block = arena->blocks; block != NULL; block = next) {
+		next = block->next;
+		free(block);
+	}
+	free(arena);
+}
+
+static void* wlf_svg_arena_alloc(struct wlf_svg_arena* arena, size_t size)
+{
+	struct wlf_svg_arena_block* block = arena->blocks;
+	void* ptr;
+
+	size = (size + _Alignof(max_align_t) - 1) & ~(_Alignof(max_align_t) - 1);
+	if (block == NULL || block->size - block->used < size) {
+		// Large requests get a block of their own behind the current one,
+		// so the space left in the current block is not wasted.
+		int dedicated = block != NULL && size > arena->next_block_size / 4;
+		size_t block_size = arena->next_block_size;
+		if (dedicated || size > block_size)
+			block_size = size;
+
+		block = calloc(1, sizeof(*block) + block_size);
+		if (block == NULL) {
+			wlf_log_errno(WLF_ERROR, "failed to grow SVG arena");
+			return NULL;
+		}
+		block->size = block_size;
+		if (dedicated) {
+			block->next = arena->blocks->next;
+			arena->blocks->next = block;
+		} else {
+			block->next = arena->blocks;
+			arena->blocks = block;
+			if (arena->next_block_size < WLF_SVG_ARENA_MAX_BLOCK)
+				arena->next_block_size *= 2;
+		}
+	}
+
+	ptr = (unsigned char*)block->data + block->used;
+	block->used += size;
+	return ptr;
+}
+
 static struct wlf_svg_parser *wlf_svg_create_parser(void)
 {
+	struct wlf_svg_arena* arena = NULL;
 	struct wlf_svg_parser *p = malloc(sizeof(struct wlf_svg_parser));
 	if (p == NULL) {
 		wlf_log_errno(WLF_ERROR, "failed to allocate wlf_svg_parser");
@@ -545,9 +631,11 @@ static struct wlf_svg_parser *wlf_svg_create_parser(void)
 	}
 	memset(p, 0, sizeof(struct wlf_svg_parser));
 
-	p->image = (struct wlf_svg_image*)malloc(sizeof(struct wlf_svg_image));
+	arena = wlf_svg_arena_create();
+	if (arena == NULL) goto error;
+	p->image = wlf_svg_arena_alloc(arena, sizeof(struct wlf_svg_image));
 	if (p->image == NULL) goto error;
-	memset(p->image, 0, sizeof(struct wlf_svg_image));
+	p->image->arena = arena;
 
 	// Init style
 	wlf_svg_xform_identity(p->attr[0].xform);
@@ -574,18 +662,11 @@ static struct wlf_svg_parser *wlf_svg_create_parser(void)
 	return p;
 
 error:
-	if (p) {
-		if (p->image) free(p->image);
-		free(p);
-	}
+	wlf_svg_arena_destroy(arena);
+	free(p);
 	return NULL;
 }
 
-static void wlf_svg_delete_paths(struct wlf_path* path)
-{
-	wlf_path_destroy_list(path);
-}
-
 static struct wlf_color wlf_svg_color_to_wlf(unsigned int color)
 {
 	uint8_t r = color & 0xFFu;
@@ -598,13 +679,8 @@ static struct wlf_color wlf_svg_color_to_wlf(unsigned int color)
 	return wlf_color_from_rgba8(r, g, b, a);
 }
 
-static struct wlf_gradient *wlf_svg_create_solid_gradient(unsigned int color, float opacity_scale)
+static struct wlf_gradient *wlf_svg_create_solid_paint(struct wlf_color c)
 {
-	struct wlf_color c = wlf_svg_color_to_wlf(color);
-	c.a *= opacity_scale;
-	if (c.a < 0.0) c.a = 0.0;
-	if (c.a > 1.0) c.a = 1.0;
-
 	struct wlf_gradient_stop stops[2] = {
 		{ .offset = 0.0, .color = c },
 		{ .offset = 1.0, .color = c },
@@ -618,44 +694,23 @@ static struct wlf_gradient *wlf_svg_create_solid_gradient(unsigned int color, fl
 	return &linear->base;
 }
 
-static struct wlf_gradient *wlf_svg_clone_gradient(struct wlf_gradient *grad)
+static struct wlf_gradient *wlf_svg_create_solid_gradient(unsigned int color, float opacity_scale)
 {
-	if (grad == NULL || grad->stop_count == 0)
-		return NULL;
-
-	struct wlf_gradient_stop *stops =
-		calloc(grad->stop_count, sizeof(*stops));
-	if (stops == NULL)
-		return NULL;
-	memcpy(stops, grad->stops, grad->stop_count * sizeof(*stops));
-
-	struct wlf_gradient *copy = NULL;
-	if (wlf_gradient_is_linear(grad)) {
-		struct wlf_linear_gradient *lin = wlf_linear_gradient_from_gradient(grad);
-		copy = (struct wlf_gradient *)wlf_linear_gradient_create(
-			lin->start, lin->end, stops, grad->stop_count);
-	} else if (wlf_gradient_is_radial(grad)) {
-		struct wlf_radial_gradient *rad = wlf_radial_gradient_from_gradient(grad);
-		copy = (struct wlf_gradient *)wlf_radial_gradient_create(
-			rad->center, rad->focal, rad->radius, stops, grad->stop_count);
-	}
-
-	free(stops);
-
-	if (copy && grad->has_xform) {
-		wlf_gradient_set_transform(copy, grad->xform);
-	}
-	return copy;
+	struct wlf_color c = wlf_svg_color_to_wlf(color);
+	c.a *= opacity_scale;
+	if (c.a < 0.0) c.a = 0.0;
+	if (c.a > 1.0) c.a = 1.0;
+	return wlf_svg_create_solid_paint(c);
 }
 
+// Shapes live in the image arena together with their paths; only the
+// geometry and paints are allocated separately.
 static void wlf_svg_shape_destroy(struct wlf_shape *shape)
 {
 	struct wlf_svg_shape *svg = wlf_svg_shape_from_shape(shape);
-	wlf_path_destroy_list(svg->paths);
 	wlf_gradient_destroy(svg->fill);
 	wlf_gradient_destroy(svg->stroke);
 	wlf_shape_destroy(svg->geometry);
-	free(svg);
 }
 
 static const struct wlf_shape_impl wlf_svg_shape_impl = {
@@ -689,7 +744,7 @@ static void wlf_svg_delete_gradient_data(struct wlf_svg_gradient_data* grad)
 	}
 }
 
-static void wlf_svg_delete_symbol_data(struct wlf_svg_symbol_data *sym)
+static void wlf_svg_delete_symbol_data(struct wlf_svg_symbol_data *sym, int in_arena)
 {
 	struct wlf_shape *shape, *snext;
 	struct wlf_svg_symbol_data *next;
@@ -702,7 +757,8 @@ static void wlf_svg_delete_symbol_data(struct wlf_svg_symbol_data *sym)
 			wlf_shape_destroy(shape);
 			shape = snext;
 		}
-		free(sym);
+		if (!in_arena)
+			free(sym);
 		sym = next;
 	}
 }
@@ -716,15 +772,85 @@ static void wlf_svg_delete_use_data(struct wlf_svg_use_data *use)
 	}
 }
 
+static unsigned int wlf_svg_hash_id(const char* id)
+{
+	return (unsigned int)wlf_hash_string(WLF_HASH_INIT, id);
+}
+
+static struct wlf_svg_id_map_entry* wlf_svg_id_map_slot(struct wlf_svg_id_map_entry* entries,
+	unsigned int capacity, const char* id, unsigned int hash)
+{
+	unsigned int i = hash & (capacity - 1);
+	while (entries[i].id != NULL) {
+		if (entries[i].hash == hash && strcmp(entries[i].id, id) == 0)
+			break;
+		i = (i + 1) & (capacity - 1);
+	}
+	return &entries[i];
+}
+
+// Indexes a definition by its id. A later definition with the same id
+// replaces the earlier one, matching the newest-first definition lists.
+static int wlf_svg_id_map_insert(struct wlf_svg_id_map* map, const char* id, void* value)
+{
+	struct wlf_svg_id_map_entry* slot;
+	unsigned int hash, i;
+
+	if (id == NULL || *id == '\0')
+		return 1;
+
+	// Keep the load factor under 3/4.
+	if ((map->count + 1) * 4 > map->capacity * 3) {
+		unsigned int capacity = map->capacity ? map->capacity * 2 : 16;
+		struct wlf_svg_id_map_entry* entries = calloc(capacity, sizeof(*entries));
+		if (entries == NULL) {
+			wlf_log_errno(WLF_ERROR, "failed to grow SVG id map");
+			return 0;
+		}
+		for (i = 0; i < map->capacity; i++) {
+			if (map->entries[i].id == NULL)
+				continue;
+			*wlf_svg_id_map_slot(entries, capacity, map->entries[i].id,
+				map->entries[i].hash) = map->entries[i];
+		}
+		free(map->entries);
+		map->entries = entries;
+		map->capacity = capacity;
+	}
+
+	hash = wlf_svg_hash_id(id);
+	slot = wlf_svg_id_map_slot(map->entries, map->capacity, id, hash);
+	if (slot->id == NULL)
+		map->count++;
+	slot->id = id;
+	slot->hash = hash;
+	slot->value = value;
+	return 1;
+}
+
+static void* wlf_svg_id_map_find(const struct wlf_svg_id_map* map, const char* id)
+{
+	unsigned int hash;
+
+	if (map->count == 0 || id == NULL || *id == '\0')
+		return NULL;
+	hash = wlf_svg_hash_id(id);
+	return wlf_svg_id_map_slot(map->entries, map->capacity, id, hash)->value;
+}
+
 static void wlf_svg_delete_parser(struct wlf_svg_parser *p)
 {
 	if (p != NULL) {
-		wlf_svg_delete_paths(p->plist);
+		// Pending paths live in the image arena.
 		wlf_shape_destroy(p->shape_geometry);
 		wlf_svg_delete_gradient_data(p->gradients);
-		wlf_svg_delete_symbol_data(p->symbols);
-		wlf_svg_delete_use_data(p->uses);
-		wlf_svg_destroy(p->image);
+		free(p->gradient_ids.entries);
+		free(p->symbol_ids.entries);
+		if (p->image != NULL) {
+			p->image->symbols = p->symbols;
+			p->image->uses = p->uses;
+			wlf_svg_destroy(p->image);
+		}
 		free(p->pts);
 		free(p);
 	}
@@ -846,15 +972,7 @@ static float wlf_svg_convert_to_pixels(struct wlf_svg_parser *p, struct wlf_svg_
 
 static struct wlf_svg_gradient_data* wlf_svg_find_gradient_data(struct wlf_svg_parser *p, const char* id)
 {
-	struct wlf_svg_gradient_data* grad = p->gradients;
-	if (id == NULL || *id == '\0')
-		return NULL;
-	while (grad != NULL) {
-		if (strcmp(grad->id, id) == 0)
-			return grad;
-		grad = grad->next;
-	}
-	return NULL;
+	return wlf_svg_id_map_find(&p->gradient_ids, id);
 }
 
 static float wlf_svg_get_average_scale(float* t);
@@ -1019,31 +1137,38 @@ static void wlf_svg_get_local_bounds(float* bounds, struct wlf_svg_shape *shape,
 	}
 }
 
+static struct wlf_shape_state* wlf_svg_geometry_state(struct wlf_shape* geometry)
+{
+	if (wlf_shape_is_rect(geometry))
+		return &wlf_rect_shape_from_shape(geometry)->state;
+	if (wlf_shape_is_circle(geometry))
+		return &wlf_circle_shape_from_shape(geometry)->state;
+	if (wlf_shape_is_ellipse(geometry))
+		return &wlf_ellipse_shape_from_shape(geometry)->state;
+	if (wlf_shape_is_line(geometry))
+		return &wlf_line_shape_from_shape(geometry)->state;
+	if (wlf_shape_is_poly(geometry))
+		return &wlf_poly_shape_from_shape(geometry)->state;
+	if (wlf_shape_is_path(geometry))
+		return &wlf_path_shape_from_shape(geometry)->state;
+	if (wlf_shape_is_text(geometry))
+		return &wlf_text_shape_from_shape(geometry)->state;
+	return NULL;
+}
+
 static void wlf_svg_apply_paint_to_geometry(struct wlf_shape *geometry,
 	const struct wlf_svg_attrib *attr, float stroke_width,
 	struct wlf_gradient *fill_gradient,
 	struct wlf_gradient *stroke_gradient)
 {
-	struct wlf_shape_state *paint = NULL;
+	struct wlf_shape_state *paint;
 
-	if (geometry == NULL || attr == NULL) {
+	// Text takes its color from the fill paint instead.
+	if (geometry == NULL || attr == NULL || wlf_shape_is_text(geometry)) {
 		return;
 	}
 
-	if (wlf_shape_is_rect(geometry)) {
-		paint = &wlf_rect_shape_from_shape(geometry)->state;
-	} else if (wlf_shape_is_circle(geometry)) {
-		paint = &wlf_circle_shape_from_shape(geometry)->state;
-	} else if (wlf_shape_is_ellipse(geometry)) {
-		paint = &wlf_ellipse_shape_from_shape(geometry)->state;
-	} else if (wlf_shape_is_line(geometry)) {
-		paint = &wlf_line_shape_from_shape(geometry)->state;
-	} else if (wlf_shape_is_poly(geometry)) {
-		paint = &wlf_poly_shape_from_shape(geometry)->state;
-	} else if (wlf_shape_is_path(geometry)) {
-		paint = &wlf_path_shape_from_shape(geometry)->state;
-	}
-
+	paint = wlf_svg_geometry_state(geometry);
 	if (paint == NULL) {
 		return;
 	}
@@ -1067,7 +1192,6 @@ static void wlf_svg_add_shape(struct wlf_svg_parser *p)
 	struct wlf_svg_attrib* attr = wlf_svg_get_attr(p);
 	float scale = 1.0f;
 	struct wlf_svg_shape* shape;
-	struct wlf_path* path = NULL;
 	int i;
 
 	if (p->plist == NULL)
@@ -1077,9 +1201,8 @@ static void wlf_svg_add_shape(struct wlf_svg_parser *p)
 		return;
 	}
 
-	shape = (struct wlf_svg_shape*)malloc(sizeof(struct wlf_svg_shape));
+	shape = wlf_svg_arena_alloc(p->image->arena, sizeof(struct wlf_svg_shape));
 	if (shape == NULL) goto error;
-	memset(shape, 0, sizeof(struct wlf_svg_shape));
 	wlf_shape_init(&shape->base, &wlf_svg_shape_impl);
 
 	memcpy(shape->id, attr->id, sizeof shape->id);
@@ -1106,17 +1229,7 @@ static void wlf_svg_add_shape(struct wlf_svg_parser *p)
 	shape->geometry = p->shape_geometry;
 	p->shape_geometry = NULL;
 
-	// Calculate shape bounds
-	shape->bounds[0] = shape->paths->bounds[0];
-	shape->bounds[1] = shape->paths->bounds[1];
-	shape->bounds[2] = shape->paths->bounds[2];
-	shape->bounds[3] = shape->paths->bounds[3];
-	for (path = shape->paths->next; path != NULL; path = path->next) {
-		shape->bounds[0] = wlf_svg_minf(shape->bounds[0], path->bounds[0]);
-		shape->bounds[1] = wlf_svg_minf(shape->bounds[1], path->bounds[1]);
-		shape->bounds[2] = wlf_svg_maxf(shape->bounds[2], path->bounds[2]);
-		shape->bounds[3] = wlf_svg_maxf(shape->bounds[3], path->bounds[3]);
-	}
+	wlf_svg_shape_bounds(shape);
 
 	// Set fill
 	if (attr->hasFill == 1) {
@@ -1172,8 +1285,6 @@ error:
 static void wlf_svg_add_path(struct wlf_svg_parser *p, char closed)
 {
 	struct wlf_svg_attrib* attr = wlf_svg_get_attr(p);
-	float bounds[4];
-	float* curve;
 	int i;
 
 	if (p->npts < 4)
@@ -1186,12 +1297,11 @@ static void wlf_svg_add_path(struct wlf_svg_parser *p, char closed)
 	if ((p->npts % 3) != 1)
 		return;
 
-	struct wlf_path* path = malloc(sizeof(struct wlf_path));
-	if (path == NULL) goto error;
-	memset(path, 0, sizeof(struct wlf_path));
+	struct wlf_path* path = wlf_svg_arena_alloc(p->image->arena, sizeof(struct wlf_path));
+	if (path == NULL) return;
 
-	path->pts = (float*)malloc(p->npts*2*sizeof(float));
-	if (path->pts == NULL) goto error;
+	path->pts = wlf_svg_arena_alloc(p->image->arena, p->npts*2*sizeof(float));
+	if (path->pts == NULL) return;
 	path->closed = closed;
 	path->npts = p->npts;
 
@@ -1199,167 +1309,139 @@ static void wlf_svg_add_path(struct wlf_svg_parser *p, char closed)
 	for (i = 0; i < p->npts; ++i)
 		wlf_svg_xform_point(&path->pts[i*2], &path->pts[i*2+1], p->pts[i*2], p->pts[i*2+1], attr->xform);
 
-	// Find bounds
-	for (i = 0; i < path->npts-1; i += 3) {
-		curve = &path->pts[i*2];
-		wlf_svg_curve_bounds(bounds, curve);
-		if (i == 0) {
-			path->bounds[0] = bounds[0];
-			path->bounds[1] = bounds[1];
-			path->bounds[2] = bounds[2];
-			path->bounds[3] = bounds[3];
-		} else {
-			path->bounds[0] = wlf_svg_minf(path->bounds[0], bounds[0]);
-			path->bounds[1] = wlf_svg_minf(path->bounds[1], bounds[1]);
-			path->bounds[2] = wlf_svg_maxf(path->bounds[2], bounds[2]);
-			path->bounds[3] = wlf_svg_maxf(path->bounds[3], bounds[3]);
-		}
-	}
+	wlf_svg_path_bounds(path);
 
 	path->next = p->plist;
 	p->plist = path;
-
-	return;
-
-error:
-	if (path != NULL) {
-		if (path->pts != NULL) free(path->pts);
-		free(path);
-	}
 }
 
-// We roll our own string to float because the std library one uses locale and messes things up.
-static double wlf_svg_atof(const char* s)
+static int wlf_svg_is_coordinate(const char* s)
 {
-	char* cur = (char*)s;
-	char* end = NULL;
-	double res = 0.0, sign = 1.0;
-	long long intPart = 0, fracPart = 0;
-	char hasIntPart = 0, hasFracPart = 0;
-
-	// Parse optional sign
-	if (*cur == '+') {
-		cur++;
-	} else if (*cur == '-') {
-		sign = -1;
-		cur++;
-	}
-
-	// Parse integer part
-	if (wlf_svg_isdigit(*cur)) {
-		// Parse digit sequence
-		intPart = strtoll(cur, &end, 10);
-		if (cur != end) {
-			res = (double)intPart;
-			hasIntPart = 1;
-			cur = end;
-		}
-	}
-
-	// Parse fractional part.
-	if (*cur == '.') {
-		cur++; // Skip '.'
-		if (wlf_svg_isdigit(*cur)) {
-			// Parse digit sequence
-			fracPart = strtoll(cur, &end, 10);
-			if (cur != end) {
-				res += (double)fracPart / pow(10.0, (double)(end - cur));
-				hasFracPart = 1;
-				cur = end;
-			}
-		}
-	}
-
-	// A valid number should have integer or fractional part.
-	if (!hasIntPart && !hasFracPart)
-		return 0.0;
-
-	// Parse optional exponent
-	if (*cur == 'e' || *cur == 'E') {
-		long expPart = 0;
-		cur++; // skip 'E'
-		expPart = strtol(cur, &end, 10); // Parse digit sequence with sign
-		if (cur != end) {
-			res *= pow(10.0, (double)expPart);
-		}
-	}
-
-	return res * sign;
+	// optional sign
+	if (*s == '-' || *s == '+')
+		s++;
+	// must have at least one digit, or start by a dot
+	return (wlf_svg_isdigit(*s) || *s == '.');
 }
 
+// Powers of ten that are exact in a double.
+static const double wlf_svg_pow10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
 
-static const char* wlf_svg_parse_number(const char* s, char* it, const int size)
-{
-	const int last = size-1;
-	int i = 0;
+// Reads a number straight from the source in one pass. We roll our own
+// because the std library one uses locale and messes things up. Up to 19
+// significant digits are gathered into an integer; when it fits in 53 bits
+// and the decimal exponent is within +-22 a single multiplication or
+// division by an exact power of ten gives the correctly rounded result,
+// which covers practically every number found in SVG files.
+// Returns the first character after the number. A lone sign or dot is
+// consumed and reads as 0, as is an exponent marker without digits; "em"
+// and "ex" are left alone as units.
+static const char* wlf_svg_parse_number(const char* s, double* value)
+{
+	uint64_t mant = 0;
+	int digits = 0, exp10 = 0, any = 0, neg = 0;
+	double v;
 
 	// sign
 	if (*s == '-' || *s == '+') {
-		if (i < last) it[i++] = *s;
+		neg = *s == '-';
 		s++;
 	}
 	// integer part
-	while (*s && wlf_svg_isdigit(*s)) {
-		if (i < last) it[i++] = *s;
-		s++;
+	for (; wlf_svg_isdigit(*s); s++) {
+		any = 1;
+		if (digits < 19) {
+			mant = mant * 10 + (uint64_t)(*s - '0');
+			if (mant != 0) digits++;
+		} else {
+			exp10++;
+		}
 	}
 	if (*s == '.') {
-		// decimal point
-		if (i < last) it[i++] = *s;
-		s++;
 		// fraction part
-		while (*s && wlf_svg_isdigit(*s)) {
-			if (i < last) it[i++] = *s;
-			s++;
+		for (s++; wlf_svg_isdigit(*s); s++) {
+			any = 1;
+			if (digits < 19) {
+				mant = mant * 10 + (uint64_t)(*s - '0');
+				if (mant != 0) digits++;
+				exp10--;
+			}
 		}
 	}
 	// exponent
 	if ((*s == 'e' || *s == 'E') && (s[1] != 'm' && s[1] != 'x')) {
-		if (i < last) it[i++] = *s;
+		int eneg = 0, e = 0;
 		s++;
 		if (*s == '-' || *s == '+') {
-			if (i < last) it[i++] = *s;
+			eneg = *s == '-';
 			s++;
 		}
-		while (*s && wlf_svg_isdigit(*s)) {
-			if (i < last) it[i++] = *s;
-			s++;
+		for (; wlf_svg_isdigit(*s); s++) {
+			if (e < 100000) e = e * 10 + (*s - '0');
 		}
+		exp10 += eneg ? -e : e;
 	}
-	it[i] = '\0';
 
+	if (!any || mant == 0)
+		v = 0.0;
+	else if (mant <= ((uint64_t)1 << 53) && exp10 >= -22 && exp10 <= 22)
+		v = exp10 < 0 ? (double)mant / wlf_svg_pow10[-exp10] : (double)mant * wlf_svg_pow10[exp10];
+	else if (exp10 < 0)
+		v = (double)mant / pow(10.0, -exp10);
+	else
+		v = (double)mant * pow(10.0, exp10);
+
+	*value = any && neg ? -v : v;
 	return s;
 }
 
-static const char* wlf_svg_get_next_path_item_when_arc_flag(const char* s, char* it)
+static double wlf_svg_atof(const char* s)
 {
-	it[0] = '\0';
-	while (*s && (wlf_svg_isspace(*s) || *s == ',')) s++;
-	if (!*s) return s;
-	if (*s == '0' || *s == '1') {
-		it[0] = *s++;
-		it[1] = '\0';
-		return s;
-	}
-	return s;
+	double v;
+	wlf_svg_parse_number(s, &v);
+	return v;
 }
 
-static const char* wlf_svg_get_next_path_item(const char* s, char* it)
+// Reads the next item of path or points data without copying it.
+// Returns the command character, 0 for a number stored in @p value, or -1
+// at the end of the data; @p value is 0 unless a number was read.
+static int wlf_svg_get_next_path_item(const char** str, float* value)
 {
-	it[0] = '\0';
+	const char* s = *str;
+	double v;
+
+	*value = 0.0f;
 	// Skip white spaces and commas
 	while (*s && (wlf_svg_isspace(*s) || *s == ',')) s++;
-	if (!*s) return s;
-	if (*s == '-' || *s == '+' || *s == '.' || wlf_svg_isdigit(*s)) {
-		s = wlf_svg_parse_number(s, it, 64);
-	} else {
-		// Parse command
-		it[0] = *s++;
-		it[1] = '\0';
-		return s;
+	if (!*s) {
+		*str = s;
+		return -1;
+	}
+	if (wlf_svg_is_coordinate(s)) {
+		*str = wlf_svg_parse_number(s, &v);
+		*value = (float)v;
+		return 0;
 	}
+	// Parse command
+	*str = s + 1;
+	return (unsigned char)*s;
+}
 
-	return s;
+// Arc flags may be written without separators, e.g. "a1 1 0 00 1 1".
+// Returns 0 with the flag in @p value, or -1 if no flag follows.
+static int wlf_svg_get_next_arc_flag(const char** str, float* value)
+{
+	const char* s = *str;
+	while (*s && (wlf_svg_isspace(*s) || *s == ',')) s++;
+	*str = s;
+	if (*s != '0' && *s != '1')
+		return -1;
+	*value = (float)(*s - '0');
+	*str = s + 1;
+	return 0;
 }
 
 static unsigned int wlf_svg_parse_color_hex(const char* str)
@@ -1476,21 +1558,12 @@ static int wlf_svg_parse_units(const char* units)
 	return WLF_SVG_UNITS_USER;
 }
 
-static int wlf_svg_is_coordinate(const char* s)
-{
-	// optional sign
-	if (*s == '-' || *s == '+')
-		s++;
-	// must have at least one digit, or start by a dot
-	return (wlf_svg_isdigit(*s) || *s == '.');
-}
-
 static struct wlf_svg_coordinate wlf_svg_parse_coordinate_raw(const char* str)
 {
 	struct wlf_svg_coordinate coord = {0, WLF_SVG_UNITS_USER};
-	char buf[64];
-	coord.units = wlf_svg_parse_units(wlf_svg_parse_number(str, buf, 64));
-	coord.value = (float)wlf_svg_atof(buf);
+	double value;
+	coord.units = wlf_svg_parse_units(wlf_svg_parse_number(str, &value));
+	coord.value = (float)value;
 	return coord;
 }
 
@@ -1510,7 +1583,7 @@ static int wlf_svg_parse_transform_args(const char* str, float* args, int maxNa,
 {
 	const char* end;
 	const char* ptr;
-	char it[64];
+	double value;
 
 	*na = 0;
 	ptr = str;
@@ -1525,8 +1598,8 @@ static int wlf_svg_parse_transform_args(const char* str, float* args, int maxNa,
 	while (ptr < end) {
 		if (*ptr == '-' || *ptr == '+' || *ptr == '.' || wlf_svg_isdigit(*ptr)) {
 			if (*na >= maxNa) return 0;
-			ptr = wlf_svg_parse_number(ptr, it, 64);
-			args[(*na)++] = (float)wlf_svg_atof(it);
+			ptr = wlf_svg_parse_number(ptr, &value);
+			args[(*na)++] = (float)value;
 		} else {
 			++ptr;
 		}
@@ -1677,83 +1750,6 @@ static void wlf_svg_parse_url(char* id, const char* str)
 	id[i] = '\0';
 }
 
-static const struct wlf_svg_name_map wlf_svg_attr_name_map[] = {
-	{ "style", WLF_SVG_ATTR_STYLE },
-	{ "display", WLF_SVG_ATTR_DISPLAY },
-	{ "fill", WLF_SVG_ATTR_FILL },
-	{ "opacity", WLF_SVG_ATTR_OPACITY },
-	{ "fill-opacity", WLF_SVG_ATTR_FILL_OPACITY },
-	{ "stroke", WLF_SVG_ATTR_STROKE },
-	{ "stroke-width", WLF_SVG_ATTR_STROKE_WIDTH },
-	{ "stroke-dasharray", WLF_SVG_ATTR_STROKE_DASHARRAY },
-	{ "stroke-dashoffset", WLF_SVG_ATTR_STROKE_DASHOFFSET },
-	{ "stroke-opacity", WLF_SVG_ATTR_STROKE_OPACITY },
-	{ "stroke-linecap", WLF_SVG_ATTR_STROKE_LINECAP },
-	{ "stroke-linejoin", WLF_SVG_ATTR_STROKE_LINEJOIN },
-	{ "stroke-miterlimit", WLF_SVG_ATTR_STROKE_MITERLIMIT },
-	{ "fill-rule", WLF_SVG_ATTR_FILL_RULE },
-	{ "font-size", WLF_SVG_ATTR_FONT_SIZE },
-	{ "transform", WLF_SVG_ATTR_TRANSFORM },
-	{ "stop-color", WLF_SVG_ATTR_STOP_COLOR },
-	{ "stop-opacity", WLF_SVG_ATTR_STOP_OPACITY },
-	{ "offset", WLF_SVG_ATTR_OFFSET },
-	{ "paint-order", WLF_SVG_ATTR_PAINT_ORDER },
-	{ "id", WLF_SVG_ATTR_ID },
-};
-
-static const struct wlf_svg_name_map wlf_svg_element_name_map[] = {
-	{ "g", WLF_SVG_EL_G },
-	{ "path", WLF_SVG_EL_PATH },
-	{ "rect", WLF_SVG_EL_RECT },
-	{ "circle", WLF_SVG_EL_CIRCLE },
-	{ "ellipse", WLF_SVG_EL_ELLIPSE },
-	{ "line", WLF_SVG_EL_LINE },
-	{ "polyline", WLF_SVG_EL_POLYLINE },
-	{ "polygon", WLF_SVG_EL_POLYGON },
-	{ "linearGradient", WLF_SVG_EL_LINEAR_GRADIENT },
-	{ "radialGradient", WLF_SVG_EL_RADIAL_GRADIENT },
-	{ "stop", WLF_SVG_EL_STOP },
-	{ "defs", WLF_SVG_EL_DEFS },
-	{ "svg", WLF_SVG_EL_SVG },
-	{ "symbol", WLF_SVG_EL_SYMBOL },
-	{ "use", WLF_SVG_EL_USE },
-	{ "text", WLF_SVG_EL_TEXT },
-};
-
-static const struct wlf_svg_name_map wlf_svg_gradient_attr_name_map[] = {
-	{ "id", WLF_SVG_GRADIENT_ATTR_ID },
-	{ "gradientUnits", WLF_SVG_GRADIENT_ATTR_GRADIENT_UNITS },
-	{ "gradientTransform", WLF_SVG_GRADIENT_ATTR_GRADIENT_TRANSFORM },
-	{ "cx", WLF_SVG_GRADIENT_ATTR_CX },
-	{ "cy", WLF_SVG_GRADIENT_ATTR_CY },
-	{ "r", WLF_SVG_GRADIENT_ATTR_R },
-	{ "fx", WLF_SVG_GRADIENT_ATTR_FX },
-	{ "fy", WLF_SVG_GRADIENT_ATTR_FY },
-	{ "x1", WLF_SVG_GRADIENT_ATTR_X1 },
-	{ "y1", WLF_SVG_GRADIENT_ATTR_Y1 },
-	{ "x2", WLF_SVG_GRADIENT_ATTR_X2 },
-	{ "y2", WLF_SVG_GRADIENT_ATTR_Y2 },
-	{ "spreadMethod", WLF_SVG_GRADIENT_ATTR_SPREAD_METHOD },
-	{ "xlink:href", WLF_SVG_GRADIENT_ATTR_XLINK_HREF },
-};
-
-static const struct wlf_svg_name_map wlf_svg_root_attr_name_map[] = {
-	{ "width", WLF_SVG_ROOT_ATTR_WIDTH },
-	{ "height", WLF_SVG_ROOT_ATTR_HEIGHT },
-	{ "viewBox", WLF_SVG_ROOT_ATTR_VIEWBOX },
-	{ "preserveAspectRatio", WLF_SVG_ROOT_ATTR_PRESERVE_ASPECT_RATIO },
-};
-
-static int wlf_svg_lookup_name_value(const struct wlf_svg_name_map* map, int map_count, const char* name)
-{
-	int i;
-	for (i = 0; i < map_count; ++i) {
-		if (strcmp(map[i].name, name) == 0)
-			return map[i].value;
-	}
-	return 0;
-}
-
 static int wlf_svg_lookup_char_value(const struct wlf_svg_char_name_map* map, int map_count, const char* name, char* out)
 {
 	int i;
@@ -1778,38 +1774,160 @@ static int wlf_svg_lookup_uchar_value(const struct wlf_svg_uchar_name_map* map,
 	return 0;
 }
 
+/*
+ * Keyword lookups run for every attribute of every element, so they switch on
+ * the name length first and compare against the few keywords of that length.
+ * The compare includes the terminating NUL.
+ */
+#define WLF_SVG_KEYWORD(name, keyword, value) \
+	if (memcmp((name), (keyword), sizeof(keyword)) == 0) \
+		return (value)
+
 static enum wlf_svg_attr_name wlf_svg_lookup_attr_name(const char* name)
 {
-	return (enum wlf_svg_attr_name)wlf_svg_lookup_name_value(
-		wlf_svg_attr_name_map,
-		(int)(sizeof(wlf_svg_attr_name_map) / sizeof(wlf_svg_attr_name_map[0])),
-		name);
+	switch (strlen(name)) {
+	case 2:
+		WLF_SVG_KEYWORD(name, "id", WLF_SVG_ATTR_ID);
+		break;
+	case 4:
+		WLF_SVG_KEYWORD(name, "fill", WLF_SVG_ATTR_FILL);
+		break;
+	case 5:
+		WLF_SVG_KEYWORD(name, "style", WLF_SVG_ATTR_STYLE);
+		break;
+	case 6:
+		WLF_SVG_KEYWORD(name, "stroke", WLF_SVG_ATTR_STROKE);
+		WLF_SVG_KEYWORD(name, "offset", WLF_SVG_ATTR_OFFSET);
+		break;
+	case 7:
+		WLF_SVG_KEYWORD(name, "display", WLF_SVG_ATTR_DISPLAY);
+		WLF_SVG_KEYWORD(name, "opacity", WLF_SVG_ATTR_OPACITY);
+		break;
+	case 9:
+		WLF_SVG_KEYWORD(name, "fill-rule", WLF_SVG_ATTR_FILL_RULE);
+		WLF_SVG_KEYWORD(name, "font-size", WLF_SVG_ATTR_FONT_SIZE);
+		WLF_SVG_KEYWORD(name, "transform", WLF_SVG_ATTR_TRANSFORM);
+		break;
+	case 10:
+		WLF_SVG_KEYWORD(name, "stop-color", WLF_SVG_ATTR_STOP_COLOR);
+		break;
+	case 11:
+		WLF_SVG_KEYWORD(name, "paint-order", WLF_SVG_ATTR_PAINT_ORDER);
+		break;
+	case 12:
+		WLF_SVG_KEYWORD(name, "fill-opacity", WLF_SVG_ATTR_FILL_OPACITY);
+		WLF_SVG_KEYWORD(name, "stroke-width", WLF_SVG_ATTR_STROKE_WIDTH);
+		WLF_SVG_KEYWORD(name, "stop-opacity", WLF_SVG_ATTR_STOP_OPACITY);
+		break;
+	case 14:
+		WLF_SVG_KEYWORD(name, "stroke-opacity", WLF_SVG_ATTR_STROKE_OPACITY);
+		WLF_SVG_KEYWORD(name, "stroke-linecap", WLF_SVG_ATTR_STROKE_LINECAP);
+		break;
+	case 15:
+		WLF_SVG_KEYWORD(name, "stroke-linejoin", WLF_SVG_ATTR_STROKE_LINEJOIN);
+		break;
+	case 16:
+		WLF_SVG_KEYWORD(name, "stroke-dasharray", WLF_SVG_ATTR_STROKE_DASHARRAY);
+		break;
+	case 17:
+		WLF_SVG_KEYWORD(name, "stroke-dashoffset", WLF_SVG_ATTR_STROKE_DASHOFFSET);
+		WLF_SVG_KEYWORD(name, "stroke-miterlimit", WLF_SVG_ATTR_STROKE_MITERLIMIT);
+		break;
+	}
+	return 0;
 }
 
 static enum wlf_svg_element_name wlf_svg_lookup_element_name(const char* name)
 {
-	return (enum wlf_svg_element_name)wlf_svg_lookup_name_value(
-		wlf_svg_element_name_map,
-		(int)(sizeof(wlf_svg_element_name_map) / sizeof(wlf_svg_element_name_map[0])),
-		name);
+	switch (strlen(name)) {
+	case 1:
+		WLF_SVG_KEYWORD(name, "g", WLF_SVG_EL_G);
+		break;
+	case 3:
+		WLF_SVG_KEYWORD(name, "svg", WLF_SVG_EL_SVG);
+		WLF_SVG_KEYWORD(name, "use", WLF_SVG_EL_USE);
+		break;
+	case 4:
+		WLF_SVG_KEYWORD(name, "path", WLF_SVG_EL_PATH);
+		WLF_SVG_KEYWORD(name, "rect", WLF_SVG_EL_RECT);
+		WLF_SVG_KEYWORD(name, "line", WLF_SVG_EL_LINE);
+		WLF_SVG_KEYWORD(name, "stop", WLF_SVG_EL_STOP);
+		WLF_SVG_KEYWORD(name, "defs", WLF_SVG_EL_DEFS);
+		WLF_SVG_KEYWORD(name, "text", WLF_SVG_EL_TEXT);
+		break;
+	case 6:
+		WLF_SVG_KEYWORD(name, "circle", WLF_SVG_EL_CIRCLE);
+		WLF_SVG_KEYWORD(name, "symbol", WLF_SVG_EL_SYMBOL);
+		break;
+	case 7:
+		WLF_SVG_KEYWORD(name, "ellipse", WLF_SVG_EL_ELLIPSE);
+		WLF_SVG_KEYWORD(name, "polygon", WLF_SVG_EL_POLYGON);
+		break;
+	case 8:
+		WLF_SVG_KEYWORD(name, "polyline", WLF_SVG_EL_POLYLINE);
+		break;
+	case 14:
+		WLF_SVG_KEYWORD(name, "linearGradient", WLF_SVG_EL_LINEAR_GRADIENT);
+		WLF_SVG_KEYWORD(name, "radialGradient", WLF_SVG_EL_RADIAL_GRADIENT);
+		break;
+	}
+	return 0;
 }
 
 static enum wlf_svg_gradient_attr_name wlf_svg_lookup_gradient_attr_name(const char* name)
 {
-	return (enum wlf_svg_gradient_attr_name)wlf_svg_lookup_name_value(
-		wlf_svg_gradient_attr_name_map,
-		(int)(sizeof(wlf_svg_gradient_attr_name_map) / sizeof(wlf_svg_gradient_attr_name_map[0])),
-		name);
+	switch (strlen(name)) {
+	case 1:
+		WLF_SVG_KEYWORD(name, "r", WLF_SVG_GRADIENT_ATTR_R);
+		break;
+	case 2:
+		WLF_SVG_KEYWORD(name, "id", WLF_SVG_GRADIENT_ATTR_ID);
+		WLF_SVG_KEYWORD(name, "cx", WLF_SVG_GRADIENT_ATTR_CX);
+		WLF_SVG_KEYWORD(name, "cy", WLF_SVG_GRADIENT_ATTR_CY);
+		WLF_SVG_KEYWORD(name, "fx", WLF_SVG_GRADIENT_ATTR_FX);
+		WLF_SVG_KEYWORD(name, "fy", WLF_SVG_GRADIENT_ATTR_FY);
+		WLF_SVG_KEYWORD(name, "x1", WLF_SVG_GRADIENT_ATTR_X1);
+		WLF_SVG_KEYWORD(name, "y1", WLF_SVG_GRADIENT_ATTR_Y1);
+		WLF_SVG_KEYWORD(name, "x2", WLF_SVG_GRADIENT_ATTR_X2);
+		WLF_SVG_KEYWORD(name, "y2", WLF_SVG_GRADIENT_ATTR_Y2);
+		break;
+	case 10:
+		WLF_SVG_KEYWORD(name, "xlink:href", WLF_SVG_GRADIENT_ATTR_XLINK_HREF);
+		break;
+	case 12:
+		WLF_SVG_KEYWORD(name, "spreadMethod", WLF_SVG_GRADIENT_ATTR_SPREAD_METHOD);
+		break;
+	case 13:
+		WLF_SVG_KEYWORD(name, "gradientUnits", WLF_SVG_GRADIENT_ATTR_GRADIENT_UNITS);
+		break;
+	case 17:
+		WLF_SVG_KEYWORD(name, "gradientTransform", WLF_SVG_GRADIENT_ATTR_GRADIENT_TRANSFORM);
+		break;
+	}
+	return 0;
 }
 
 static enum wlf_svg_root_attr_name wlf_svg_lookup_root_attr_name(const char* name)
 {
-	return (enum wlf_svg_root_attr_name)wlf_svg_lookup_name_value(
-		wlf_svg_root_attr_name_map,
-		(int)(sizeof(wlf_svg_root_attr_name_map) / sizeof(wlf_svg_root_attr_name_map[0])),
-		name);
+	switch (strlen(name)) {
+	case 5:
+		WLF_SVG_KEYWORD(name, "width", WLF_SVG_ROOT_ATTR_WIDTH);
+		break;
+	case 6:
+		WLF_SVG_KEYWORD(name, "height", WLF_SVG_ROOT_ATTR_HEIGHT);
+		break;
+	case 7:
+		WLF_SVG_KEYWORD(name, "viewBox", WLF_SVG_ROOT_ATTR_VIEWBOX);
+		break;
+	case 19:
+		WLF_SVG_KEYWORD(name, "preserveAspectRatio", WLF_SVG_ROOT_ATTR_PRESERVE_ASPECT_RATIO);
+		break;
+	}
+	return 0;
 }
 
+#undef WLF_SVG_KEYWORD
+
 static char wlf_svg_parse_line_cap(const char* str)
 {
 	char value = WLF_SVG_CAP_BUTT;
@@ -2424,8 +2542,8 @@ static void wlf_svg_parse_path(struct wlf_svg_parser *p, const char** attr)
 	float cpx, cpy, cpx2, cpy2;
 	const char* tmp[4];
 	char closedFlag;
-	int i;
-	char item[64];
+	int i, item;
+	float value;
 
 	for (i = 0; attr[i]; i += 2) {
 		if (strcmp(attr[i], "d") == 0) {
@@ -2448,15 +2566,18 @@ static void wlf_svg_parse_path(struct wlf_svg_parser *p, const char** attr)
 		nargs = 0;
 
 		while (*s) {
-			item[0] = '\0';
+			item = -1;
 			if ((cmd == 'A' || cmd == 'a') && (nargs == 3 || nargs == 4))
-				s = wlf_svg_get_next_path_item_when_arc_flag(s, item);
-			if (!*item)
-				s = wlf_svg_get_next_path_item(s, item);
-			if (!*item) break;
-			if (cmd != '\0' && wlf_svg_is_coordinate(item)) {
+				item = wlf_svg_get_next_arc_flag(&s, &value);
+			if (item < 0)
+				item = wlf_svg_get_next_path_item(&s, &value);
+			if (item < 0) break;
+			if (item == 0) {
+				// Numbers are ignored until a valid command is seen.
+				if (cmd == '\0')
+					continue;
 				if (nargs < 10)
-					args[nargs++] = (float)wlf_svg_atof(item);
+					args[nargs++] = value;
 				if (nargs >= rargs) {
 					switch (cmd) {
 						case 'm':
@@ -2516,7 +2637,7 @@ static void wlf_svg_parse_path(struct wlf_svg_parser *p, const char** attr)
 					nargs = 0;
 				}
 			} else {
-				cmd = item[0];
+				cmd = (char)item;
 				if (cmd == 'M' || cmd == 'm') {
 					// Commit path.
 					if (p->npts > 0)
@@ -2719,7 +2840,6 @@ static void wlf_svg_parse_poly(struct wlf_svg_parser *p, const char** attr, int
 	const char* s;
 	float args[2];
 	int nargs, npts = 0;
-	char item[64];
 	float *points = NULL;
 	int points_count = 0;
 	int points_cap = 0;
@@ -2732,8 +2852,8 @@ static void wlf_svg_parse_poly(struct wlf_svg_parser *p, const char** attr, int
 				s = attr[i + 1];
 				nargs = 0;
 				while (*s) {
-					s = wlf_svg_get_next_path_item(s, item);
-					args[nargs++] = (float)wlf_svg_atof(item);
+					// Stray commands read as 0, as they always did.
+					wlf_svg_get_next_path_item(&s, &args[nargs++]);
 					if (nargs >= 2) {
 						if (points_count >= points_cap) {
 							int new_cap = points_cap ? points_cap * 2 : 8;
@@ -2894,24 +3014,24 @@ static void wlf_svg_parse_svg(struct wlf_svg_parser *p, const char** attr)
 				break;
 			case WLF_SVG_ROOT_ATTR_VIEWBOX: {
 				const char *s = attr[i + 1];
-				char buf[64];
+				double value;
 				strncpy(p->image->view_box, attr[i + 1],
 					sizeof(p->image->view_box) - 1);
 				p->image->view_box[sizeof(p->image->view_box) - 1] = '\0';
-				s = wlf_svg_parse_number(s, buf, 64);
-				p->viewMinx = (float)wlf_svg_atof(buf);
+				s = wlf_svg_parse_number(s, &value);
+				p->viewMinx = (float)value;
 				while (*s && (wlf_svg_isspace(*s) || *s == '%' || *s == ',')) s++;
 				if (!*s) return;
-				s = wlf_svg_parse_number(s, buf, 64);
-				p->viewMiny = (float)wlf_svg_atof(buf);
+				s = wlf_svg_parse_number(s, &value);
+				p->viewMiny = (float)value;
 				while (*s && (wlf_svg_isspace(*s) || *s == '%' || *s == ',')) s++;
 				if (!*s) return;
-				s = wlf_svg_parse_number(s, buf, 64);
-				p->viewWidth = (float)wlf_svg_atof(buf);
+				s = wlf_svg_parse_number(s, &value);
+				p->viewWidth = (float)value;
 				while (*s && (wlf_svg_isspace(*s) || *s == '%' || *s == ',')) s++;
 				if (!*s) return;
-				s = wlf_svg_parse_number(s, buf, 64);
-				p->viewHeight = (float)wlf_svg_atof(buf);
+				s = wlf_svg_parse_number(s, &value);
+				p->viewHeight = (float)value;
 				break;
 			}
 			case WLF_SVG_ROOT_ATTR_PRESERVE_ASPECT_RATIO:
@@ -3041,6 +3161,7 @@ static void wlf_svg_parse_gradient(struct wlf_svg_parser *p, const char** attr,
 
 	grad->next = p->gradients;
 	p->gradients = grad;
+	wlf_svg_id_map_insert(&p->gradient_ids, grad->id, grad);
 }
 
 static void wlf_svg_parse_gradient_stop(struct wlf_svg_parser *p, const char** attr)
@@ -3087,213 +3208,35 @@ static void wlf_svg_parse_gradient_stop(struct wlf_svg_parser *p, const char** a
 
 /* ---- <symbol> / <use> helpers ---- */
 
-static struct wlf_path *wlf_svg_clone_path_translated(const struct wlf_path *src,
-	float tx, float ty)
+/* Start collecting shapes for a new <symbol>. */
+static void wlf_svg_parse_symbol(struct wlf_svg_parser *p, const char **attr)
 {
+	struct wlf_svg_symbol_data *sym;
 	int i;
-	struct wlf_path *dst = malloc(sizeof(struct wlf_path));
-	if (!dst) return NULL;
-	memset(dst, 0, sizeof(*dst));
-	dst->npts = src->npts;
-	dst->closed = src->closed;
-	dst->pts = (float *)malloc(src->npts * 2 * sizeof(float));
-	if (!dst->pts) { free(dst); return NULL; }
-	for (i = 0; i < src->npts; i++) {
-		dst->pts[i * 2]     = src->pts[i * 2]     + tx;
-		dst->pts[i * 2 + 1] = src->pts[i * 2 + 1] + ty;
-	}
-	dst->bounds[0] = src->bounds[0] + tx;
-	dst->bounds[1] = src->bounds[1] + ty;
-	dst->bounds[2] = src->bounds[2] + tx;
-	dst->bounds[3] = src->bounds[3] + ty;
-	return dst;
-}
-
-static void wlf_svg_translate_gradient(struct wlf_gradient *grad,
-	float tx, float ty)
-{
-	if (grad == NULL)
-		return;
 
-	if (wlf_gradient_is_linear(grad)) {
-		struct wlf_linear_gradient *linear =
-			wlf_linear_gradient_from_gradient(grad);
-		linear->start.x += tx;
-		linear->start.y += ty;
-		linear->end.x += tx;
-		linear->end.y += ty;
-	} else if (wlf_gradient_is_radial(grad)) {
-		struct wlf_radial_gradient *radial =
-			wlf_radial_gradient_from_gradient(grad);
-		radial->center.x += tx;
-		radial->center.y += ty;
-		radial->focal.x += tx;
-		radial->focal.y += ty;
-	}
-}
-
-static struct wlf_shape *wlf_svg_clone_geometry_translated(
-	struct wlf_shape *geometry, float tx, float ty)
-{
-	if (geometry == NULL)
-		return NULL;
-
-	if (wlf_shape_is_rect(geometry)) {
-		struct wlf_rect_shape *rect = wlf_rect_shape_from_shape(geometry);
-		return wlf_rect_shape_create(rect->x + tx, rect->y + ty,
-			rect->width, rect->height, rect->rx, rect->ry);
-	}
-	if (wlf_shape_is_circle(geometry)) {
-		struct wlf_circle_shape *circle = wlf_circle_shape_from_shape(geometry);
-		return wlf_circle_shape_create(circle->cx + tx, circle->cy + ty, circle->r);
-	}
-	if (wlf_shape_is_ellipse(geometry)) {
-		struct wlf_ellipse_shape *ellipse = wlf_ellipse_shape_from_shape(geometry);
-		return wlf_ellipse_shape_create(ellipse->cx + tx, ellipse->cy + ty,
-			ellipse->rx, ellipse->ry);
-	}
-	if (wlf_shape_is_line(geometry)) {
-		struct wlf_line_shape *line = wlf_line_shape_from_shape(geometry);
-		return wlf_line_shape_create(line->x1 + tx, line->y1 + ty,
-			line->x2 + tx, line->y2 + ty);
-	}
-	if (wlf_shape_is_poly(geometry)) {
-		struct wlf_poly_shape *poly = wlf_poly_shape_from_shape(geometry);
-		float *points = calloc((size_t)poly->count * 2, sizeof(*points));
-		if (points == NULL)
-			return NULL;
-		for (int i = 0; i < poly->count; i++) {
-			points[i * 2] = poly->points[i * 2] + tx;
-			points[i * 2 + 1] = poly->points[i * 2 + 1] + ty;
-		}
-		struct wlf_shape *out =
-			wlf_poly_shape_create(points, poly->count, poly->closed);
-		free(points);
-		return out;
-	}
-	if (wlf_shape_is_path(geometry)) {
-		struct wlf_path_shape *path_shape =
-			wlf_path_shape_from_shape(geometry);
-		struct wlf_path *paths = NULL;
-		struct wlf_path *tail = NULL;
-		for (struct wlf_path *p = path_shape->paths; p != NULL; p = p->next) {
-			struct wlf_path *clone = wlf_svg_clone_path_translated(p, tx, ty);
-			if (!clone) {
-				wlf_path_destroy_list(paths);
-				return NULL;
-			}
-			if (paths == NULL)
-				paths = clone;
-			else
-				tail->next = clone;
-			tail = clone;
-		}
-		return wlf_path_shape_create(paths, true);
-	}
-	if (wlf_shape_is_text(geometry)) {
-		struct wlf_text_shape *text = wlf_text_shape_from_shape(geometry);
-		return wlf_text_shape_create(text->x + tx, text->y + ty,
-			text->text, text->font_family, text->font_size, text->text_anchor);
-	}
-
-	return NULL;
-}
-
-static struct wlf_svg_shape *wlf_svg_clone_shape_translated(const struct wlf_svg_shape *src,
-	float tx, float ty)
-{
-	struct wlf_svg_shape *dst;
-	struct wlf_path *sp, *dp, *dtail = NULL;
-
-	dst = (struct wlf_svg_shape *)malloc(sizeof(struct wlf_svg_shape));
-	if (!dst) return NULL;
-	memset(dst, 0, sizeof(*dst));
-	wlf_shape_init(&dst->base, &wlf_svg_shape_impl);
-	memcpy(dst->id, src->id, sizeof dst->id);
-	memcpy(dst->fill_gradient, src->fill_gradient, sizeof dst->fill_gradient);
-	memcpy(dst->stroke_gradient, src->stroke_gradient, sizeof dst->stroke_gradient);
-	memcpy(dst->xform, src->xform, sizeof dst->xform);
-	dst->opacity = src->opacity;
-	dst->fill_opacity = src->fill_opacity;
-	dst->stroke_opacity = src->stroke_opacity;
-	dst->stroke_width = src->stroke_width;
-	dst->stroke_dash_offset = src->stroke_dash_offset;
-	dst->stroke_dash_count = src->stroke_dash_count;
-	memcpy(dst->stroke_dash_array, src->stroke_dash_array,
-		sizeof dst->stroke_dash_array);
-	dst->stroke_line_join = src->stroke_line_join;
-	dst->stroke_line_cap = src->stroke_line_cap;
-	dst->miter_limit = src->miter_limit;
-	dst->fill_rule = src->fill_rule;
-	dst->paint_order = src->paint_order;
-	dst->flags = src->flags;
-	dst->next = NULL;
-	dst->paths = NULL;
-	dst->geometry = NULL;
-
-	dst->fill = wlf_svg_clone_gradient(src->fill);
-	dst->stroke = wlf_svg_clone_gradient(src->stroke);
-	if ((src->fill && !dst->fill) || (src->stroke && !dst->stroke)) {
-		wlf_shape_destroy(&dst->base);
-		return NULL;
-	}
-	wlf_svg_translate_gradient(dst->fill, tx, ty);
-	wlf_svg_translate_gradient(dst->stroke, tx, ty);
-
-	dst->geometry = wlf_svg_clone_geometry_translated(src->geometry, tx, ty);
-	if (src->geometry && !dst->geometry) {
-		wlf_shape_destroy(&dst->base);
-		return NULL;
-	}
-
-	for (sp = src->paths; sp != NULL; sp = sp->next) {
-		dp = wlf_svg_clone_path_translated(sp, tx, ty);
-		if (!dp) {
-			wlf_shape_destroy(&dst->base);
-			return NULL;
-		}
-		if (!dst->paths) dst->paths = dp;
-		else dtail->next = dp;
-		dtail = dp;
-	}
-
-	dst->bounds[0] = src->bounds[0] + tx;
-	dst->bounds[1] = src->bounds[1] + ty;
-	dst->bounds[2] = src->bounds[2] + tx;
-	dst->bounds[3] = src->bounds[3] + ty;
-	return dst;
-}
-
-/* Start collecting shapes for a new <symbol>. */
-static void wlf_svg_parse_symbol(struct wlf_svg_parser *p, const char **attr)
-{
-	struct wlf_svg_symbol_data *sym;
-	int i;
-
-	sym = (struct wlf_svg_symbol_data *)calloc(1, sizeof(struct wlf_svg_symbol_data));
-	if (!sym) return;
-
-	for (i = 0; attr[i]; i += 2) {
-		if (strcmp(attr[i], "id") == 0) {
-			strncpy(sym->id, attr[i + 1], 63);
-			sym->id[63] = '\0';
-		}
+	sym = wlf_svg_arena_alloc(p->image->arena, sizeof(struct wlf_svg_symbol_data));
+	if (!sym) return;
+
+	for (i = 0; attr[i]; i += 2) {
+		if (strcmp(attr[i], "id") == 0) {
+			strncpy(sym->id, attr[i + 1], 63);
+			sym->id[63] = '\0';
+		}
 	}
 
 	sym->next = p->symbols;
 	p->symbols = sym;
+	wlf_svg_id_map_insert(&p->symbol_ids, sym->id, sym);
 	p->current_symbol = sym;
 	wlf_svg_push_attr(p);
 }
 
-/* Clone symbol shapes into image->shapes with x/y offset from <use>. */
+/* Record a <use> as an instance of its symbol, placed after the shapes
+ * parsed so far. The symbol shapes are shared, not copied. */
 static void wlf_svg_parse_use(struct wlf_svg_parser *p, const char **attr)
 {
 	float x = 0.0f, y = 0.0f;
 	const char *href = NULL;
-	struct wlf_svg_symbol_data *sym;
-	struct wlf_svg_shape *src, *clone;
-	struct wlf_shape *base;
 	int i;
 
 	for (i = 0; attr[i]; i += 2) {
@@ -3308,39 +3251,19 @@ static void wlf_svg_parse_use(struct wlf_svg_parser *p, const char **attr)
 	if (!href) return;
 	if (href[0] == '#') href++;
 
-	struct wlf_svg_use_data *use = calloc(1, sizeof(*use));
+	struct wlf_svg_use_data *use = wlf_svg_arena_alloc(p->image->arena, sizeof(*use));
 	if (use != NULL) {
 		strncpy(use->href, href, sizeof(use->href) - 1);
 		use->href[sizeof(use->href) - 1] = '\0';
 		use->x = x;
 		use->y = y;
-		if (p->uses == NULL) {
+		use->symbol = wlf_svg_id_map_find(&p->symbol_ids, href);
+		use->after = p->image->shapes != NULL ? p->shapesTail : NULL;
+		if (p->uses == NULL)
 			p->uses = use;
-		} else {
-			struct wlf_svg_use_data *tail = p->uses;
-			while (tail->next != NULL) {
-				tail = tail->next;
-			}
-			tail->next = use;
-		}
-	}
-
-	for (sym = p->symbols; sym != NULL; sym = sym->next) {
-		if (strcmp(sym->id, href) == 0) break;
-	}
-	if (!sym) return;
-
-	for (base = sym->shapes; base != NULL;
-		base = (struct wlf_shape *)wlf_svg_shape_from_shape(base)->next) {
-		src = wlf_svg_shape_from_shape(base);
-		clone = wlf_svg_clone_shape_translated(src, x, y);
-		if (!clone) continue;
-		clone->flags |= WLF_SVG_FLAGS_FROM_USE;
-		if (p->image->shapes == NULL)
-			p->image->shapes = &clone->base;
 		else
-			wlf_svg_shape_from_shape(p->shapesTail)->next = clone;
-		p->shapesTail = &clone->base;
+			p->uses_tail->next = use;
+		p->uses_tail = use;
 	}
 }
 
@@ -3542,25 +3465,83 @@ static void wlf_svg_content(void* ud, const char* s)
 	strncat(p->textContent, s, cap);
 }
 
-static void wlf_svg_image_bounds(struct wlf_svg_parser *p, float* bounds)
+static bool wlf_svg_visit_symbol(const struct wlf_svg_use_data *use,
+	wlf_svg_shape_iterator_func_t iterator, void *data)
 {
-	struct wlf_shape *base = p->image->shapes;
+	struct wlf_shape *base;
 	struct wlf_svg_shape *shape;
-	if (base == NULL) {
-		bounds[0] = bounds[1] = bounds[2] = bounds[3] = 0.0;
-		return;
+
+	if (use->symbol == NULL)
+		return true;
+	for (base = use->symbol->shapes; base != NULL; base = (struct wlf_shape *)shape->next) {
+		shape = wlf_svg_shape_from_shape(base);
+		if (!iterator(shape, use->x, use->y, data))
+			return false;
 	}
-	shape = wlf_svg_shape_from_shape(base);
-	bounds[0] = shape->bounds[0];
-	bounds[1] = shape->bounds[1];
-	bounds[2] = shape->bounds[2];
-	bounds[3] = shape->bounds[3];
-	for (shape = shape->next; shape != NULL; shape = shape->next) {
-		bounds[0] = wlf_svg_minf(bounds[0], shape->bounds[0]);
-		bounds[1] = wlf_svg_minf(bounds[1], shape->bounds[1]);
-		bounds[2] = wlf_svg_maxf(bounds[2], shape->bounds[2]);
-		bounds[3] = wlf_svg_maxf(bounds[3], shape->bounds[3]);
+	return true;
+}
+
+// Walks @p shapes and the instances in @p uses in document order: each
+// instance is visited right after the shape it was recorded behind.
+static bool wlf_svg_visit_shapes(struct wlf_shape *shapes, const struct wlf_svg_use_data *uses,
+	wlf_svg_shape_iterator_func_t iterator, void *data)
+{
+	const struct wlf_svg_use_data *use = uses;
+	struct wlf_shape *base = NULL;
+	struct wlf_svg_shape *shape = NULL;
+
+	for (;;) {
+		for (; use != NULL && use->after == base; use = use->next) {
+			if (!wlf_svg_visit_symbol(use, iterator, data))
+				return false;
+		}
+		base = shape == NULL ? shapes : (struct wlf_shape *)shape->next;
+		if (base == NULL)
+			break;
+		shape = wlf_svg_shape_from_shape(base);
+		if (!iterator(shape, 0.0f, 0.0f, data))
+			return false;
 	}
+	return true;
+}
+
+bool wlf_svg_for_each_shape(const struct wlf_svg_image *image,
+	wlf_svg_shape_iterator_func_t iterator, void *data)
+{
+	return wlf_svg_visit_shapes(image->shapes, image->uses, iterator, data);
+}
+
+struct wlf_svg_bounds_data {
+	float* bounds;
+	int first;
+};
+
+static bool wlf_svg_add_shape_bounds(struct wlf_svg_shape *shape, float x, float y, void *data)
+{
+	struct wlf_svg_bounds_data* acc = data;
+	float* bounds = acc->bounds;
+	if (acc->first) {
+		bounds[0] = shape->bounds[0] + x;
+		bounds[1] = shape->bounds[1] + y;
+		bounds[2] = shape->bounds[2] + x;
+		bounds[3] = shape->bounds[3] + y;
+		acc->first = 0;
+	} else {
+		bounds[0] = wlf_svg_minf(bounds[0], shape->bounds[0] + x);
+		bounds[1] = wlf_svg_minf(bounds[1], shape->bounds[1] + y);
+		bounds[2] = wlf_svg_maxf(bounds[2], shape->bounds[2] + x);
+		bounds[3] = wlf_svg_maxf(bounds[3], shape->bounds[3] + y);
+	}
+	return true;
+}
+
+static void wlf_svg_image_bounds(struct wlf_svg_parser *p, float* bounds)
+{
+	struct wlf_svg_bounds_data acc = { bounds, 1 };
+
+	// Instances are not attached to the image until parsing finishes.
+	bounds[0] = bounds[1] = bounds[2] = bounds[3] = 0.0;
+	wlf_svg_visit_shapes(p->image->shapes, p->uses, wlf_svg_add_shape_bounds, &acc);
 }
 
 static float wlf_svg_view_align(float content, float container, int type)
@@ -3672,14 +3653,51 @@ static void wlf_svg_transform_geometry(struct wlf_shape *geometry,
 	}
 }
 
+static void wlf_svg_scale_shape(struct wlf_svg_shape* shape,
+	float tx, float ty, float sx, float sy, float avgs)
+{
+	struct wlf_path* path;
+	float* pt;
+	int i;
+
+	shape->bounds[0] = (shape->bounds[0] + tx) * sx;
+	shape->bounds[1] = (shape->bounds[1] + ty) * sy;
+	shape->bounds[2] = (shape->bounds[2] + tx) * sx;
+	shape->bounds[3] = (shape->bounds[3] + ty) * sy;
+	for (path = shape->paths; path != NULL; path = path->next) {
+		path->bounds[0] = (path->bounds[0] + tx) * sx;
+		path->bounds[1] = (path->bounds[1] + ty) * sy;
+		path->bounds[2] = (path->bounds[2] + tx) * sx;
+		path->bounds[3] = (path->bounds[3] + ty) * sy;
+		for (i =0; i < path->npts; i++) {
+			pt = &path->pts[i*2];
+			pt[0] = (pt[0] + tx) * sx;
+			pt[1] = (pt[1] + ty) * sy;
+		}
+	}
+
+	wlf_svg_transform_geometry(shape->geometry, tx, ty, sx, sy);
+	wlf_svg_scale_gradient(shape->fill, tx, ty, sx, sy);
+	wlf_svg_scale_gradient(shape->stroke, tx, ty, sx, sy);
+
+	shape->stroke_width *= avgs;
+	shape->stroke_dash_offset *= avgs;
+	for (i = 0; i < shape->stroke_dash_count; i++)
+		shape->stroke_dash_array[i] *= avgs;
+	// The geometry paint was set from the unscaled stroke width.
+	if (shape->geometry != NULL && !wlf_shape_is_text(shape->geometry)) {
+		struct wlf_shape_state* state = wlf_svg_geometry_state(shape->geometry);
+		if (state != NULL)
+			state->stroke_width = shape->stroke_width;
+	}
+}
+
 static void wlf_svg_scale_to_viewbox(struct wlf_svg_parser *p, const char* units)
 {
 	struct wlf_shape *base;
-	struct wlf_svg_shape* shape;
-	struct wlf_path* path;
+	struct wlf_svg_symbol_data *sym;
+	struct wlf_svg_use_data *use;
 	float tx, ty, sx, sy, us, bounds[4], avgs;
-	int i;
-	float* pt;
 
 	// Guess image size if not set completely.
 	wlf_svg_image_bounds(p, bounds);
@@ -3730,136 +3748,252 @@ static void wlf_svg_scale_to_viewbox(struct wlf_svg_parser *p, const char* units
 	sy *= us;
 	avgs = (sx+sy) / 2.0f;
 	for (base = p->image->shapes; base != NULL;
-		base = (struct wlf_shape *)wlf_svg_shape_from_shape(base)->next) {
-		shape = wlf_svg_shape_from_shape(base);
-		shape->bounds[0] = (shape->bounds[0] + tx) * sx;
-		shape->bounds[1] = (shape->bounds[1] + ty) * sy;
-		shape->bounds[2] = (shape->bounds[2] + tx) * sx;
-		shape->bounds[3] = (shape->bounds[3] + ty) * sy;
-		for (path = shape->paths; path != NULL; path = path->next) {
-			path->bounds[0] = (path->bounds[0] + tx) * sx;
-			path->bounds[1] = (path->bounds[1] + ty) * sy;
-			path->bounds[2] = (path->bounds[2] + tx) * sx;
-			path->bounds[3] = (path->bounds[3] + ty) * sy;
-			for (i =0; i < path->npts; i++) {
-				pt = &path->pts[i*2];
-				pt[0] = (pt[0] + tx) * sx;
-				pt[1] = (pt[1] + ty) * sy;
-			}
+		base = (struct wlf_shape *)wlf_svg_shape_from_shape(base)->next)
+		wlf_svg_scale_shape(wlf_svg_shape_from_shape(base), tx, ty, sx, sy, avgs);
+	for (sym = p->symbols; sym != NULL; sym = sym->next) {
+		for (base = sym->shapes; base != NULL;
+			base = (struct wlf_shape *)wlf_svg_shape_from_shape(base)->next)
+			wlf_svg_scale_shape(wlf_svg_shape_from_shape(base), tx, ty, sx, sy, avgs);
+	}
+	// Instance offsets are distances, so they only scale.
+	for (use = p->uses; use != NULL; use = use->next) {
+		use->x *= sx;
+		use->y *= sy;
+	}
+}
+
+static void wlf_svg_create_shape_gradients(struct wlf_svg_parser *p,
+	struct wlf_svg_shape *shape)
+{
+	if (shape->fill_gradient[0] != '\0') {
+		float inv[6], localBounds[4];
+		float opacity_scale = wlf_svg_shape_fill_alpha(shape);
+		wlf_svg_xform_inverse(inv, shape->xform);
+		wlf_svg_get_local_bounds(localBounds, shape, inv);
+		struct wlf_gradient *grad =
+			wlf_svg_create_gradient(p, shape->fill_gradient,
+				localBounds, shape->xform, opacity_scale);
+		if (grad != NULL) {
+			wlf_gradient_destroy(shape->fill);
+			shape->fill = grad;
 		}
+	}
 
-		wlf_svg_transform_geometry(shape->geometry, tx, ty, sx, sy);
-		wlf_svg_scale_gradient(shape->fill, tx, ty, sx, sy);
-		wlf_svg_scale_gradient(shape->stroke, tx, ty, sx, sy);
-
-		shape->stroke_width *= avgs;
-		shape->stroke_dash_offset *= avgs;
-		for (i = 0; i < shape->stroke_dash_count; i++)
-			shape->stroke_dash_array[i] *= avgs;
+	if (shape->stroke_gradient[0] != '\0') {
+		float inv[6], localBounds[4];
+		float opacity_scale = wlf_svg_shape_stroke_alpha(shape);
+		wlf_svg_xform_inverse(inv, shape->xform);
+		wlf_svg_get_local_bounds(localBounds, shape, inv);
+		struct wlf_gradient *grad =
+			wlf_svg_create_gradient(p, shape->stroke_gradient,
+				localBounds, shape->xform, opacity_scale);
+		if (grad != NULL) {
+			wlf_gradient_destroy(shape->stroke);
+			shape->stroke = grad;
+		}
 	}
 }
 
 static void wlf_svg_create_gradients(struct wlf_svg_parser *p)
 {
 	struct wlf_shape *base;
-	struct wlf_svg_shape *shape;
+	struct wlf_svg_symbol_data *sym;
 
 	for (base = p->image->shapes; base != NULL;
-		base = (struct wlf_shape *)wlf_svg_shape_from_shape(base)->next) {
-		shape = wlf_svg_shape_from_shape(base);
+		base = (struct wlf_shape *)wlf_svg_shape_from_shape(base)->next)
+		wlf_svg_create_shape_gradients(p, wlf_svg_shape_from_shape(base));
 
-		if (shape->fill_gradient[0] != '\0') {
-			float inv[6], localBounds[4];
-			float opacity_scale = wlf_svg_shape_fill_alpha(shape);
-			wlf_svg_xform_inverse(inv, shape->xform);
-			wlf_svg_get_local_bounds(localBounds, shape, inv);
-			struct wlf_gradient *grad =
-				wlf_svg_create_gradient(p, shape->fill_gradient,
-					localBounds, shape->xform, opacity_scale);
-			if (grad != NULL) {
-				wlf_gradient_destroy(shape->fill);
-				shape->fill = grad;
-			}
-		}
+	// Symbol shapes are shared by all their instances.
+	for (sym = p->symbols; sym != NULL; sym = sym->next) {
+		for (base = sym->shapes; base != NULL;
+			base = (struct wlf_shape *)wlf_svg_shape_from_shape(base)->next)
+			wlf_svg_create_shape_gradients(p, wlf_svg_shape_from_shape(base));
+	}
+}
 
-		if (shape->stroke_gradient[0] != '\0') {
-			float inv[6], localBounds[4];
-			float opacity_scale = wlf_svg_shape_stroke_alpha(shape);
-			wlf_svg_xform_inverse(inv, shape->xform);
-			wlf_svg_get_local_bounds(localBounds, shape, inv);
-			struct wlf_gradient *grad =
-				wlf_svg_create_gradient(p, shape->stroke_gradient,
-					localBounds, shape->xform, opacity_scale);
-			if (grad != NULL) {
-				wlf_gradient_destroy(shape->stroke);
-				shape->stroke = grad;
-			}
+/*
+ * The XML tokenizer collects each tag or text run into a scratch buffer and
+ * tokenizes it there, so input is never written to and may arrive in chunks
+ * split at arbitrary byte offsets. Only the largest single tag is buffered.
+ */
+struct wlf_svg_stream {
+	struct wlf_svg_parser *parser;
+	char *units;
+	int state;                  /* WLF_SVG_XML_TAG or WLF_SVG_XML_CONTENT */
+	char *token;
+	size_t token_len;
+	size_t token_cap;
+	bool failed;
+};
+
+static bool wlf_svg_stream_append(struct wlf_svg_stream *stream,
+		const char *data, size_t size) {
+	size_t needed = stream->token_len + size + 1;
+	if (needed > stream->token_cap) {
+		size_t cap = stream->token_cap ? stream->token_cap : 256;
+		while (cap < needed) {
+			cap *= 2;
+		}
+		char *token = realloc(stream->token, cap);
+		if (token == NULL) {
+			wlf_log_errno(WLF_ERROR, "Failed to grow SVG token buffer");
+			return false;
 		}
+		stream->token = token;
+		stream->token_cap = cap;
 	}
+
+	memcpy(stream->token + stream->token_len, data, size);
+	stream->token_len += size;
+
+	return true;
 }
 
-struct wlf_svg_image *wlf_svg_parse_from_file(const char *filename,
-		const char *units, float dpi) {
-	FILE* fp = NULL;
-	size_t size;
-	char* data = NULL;
-	struct wlf_svg_image* image = NULL;
-
-	fp = fopen(filename, "rb");
-	if (!fp) goto error;
-	fseek(fp, 0, SEEK_END);
-	size = ftell(fp);
-	fseek(fp, 0, SEEK_SET);
-	data = (char*)malloc(size+1);
-	if (data == NULL) goto error;
-	if (fread(data, 1, size, fp) != size) goto error;
-	data[size] = '\0';	// Must be null terminated.
-	fclose(fp);
-	image = wlf_svg_parse(data, units, dpi);
-	free(data);
+struct wlf_svg_stream *wlf_svg_stream_create(const char *units, float dpi) {
+	struct wlf_svg_stream *stream = calloc(1, sizeof(*stream));
+	if (stream == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate wlf_svg_stream");
+		return NULL;
+	}
 
-	return image;
+	stream->units = strdup(units != NULL ? units : "px");
+	stream->parser = wlf_svg_create_parser();
+	if (stream->units == NULL || stream->parser == NULL) {
+		wlf_svg_stream_destroy(stream);
+		return NULL;
+	}
+	stream->parser->dpi = dpi;
+	stream->state = WLF_SVG_XML_CONTENT;
 
-error:
-	if (fp) fclose(fp);
-	if (data) free(data);
-	if (image) wlf_svg_destroy(image);
-	return NULL;
+	return stream;
 }
 
-struct wlf_svg_image *wlf_svg_parse(char *input, const char *units, float dpi) {
-	struct wlf_svg_parser *p;
-	struct wlf_svg_image* ret = 0;
+void wlf_svg_stream_destroy(struct wlf_svg_stream *stream) {
+	if (stream == NULL) {
+		return;
+	}
 
-	p = wlf_svg_create_parser();
-	if (p == NULL) {
-		return NULL;
+	wlf_svg_delete_parser(stream->parser);
+	free(stream->token);
+	free(stream->units);
+	free(stream);
+}
+
+bool wlf_svg_stream_feed(struct wlf_svg_stream *stream,
+		const char *data, size_t size) {
+	if (stream->failed) {
+		return false;
+	}
+	if (size == 0) {
+		return true;
 	}
-	p->dpi = dpi;
 
-	wlf_svg_parse_xml(input, wlf_svg_start_element, wlf_svg_end_element, wlf_svg_content, p);
+	const char *end = data + size;
 
-	// Create gradients after all definitions have been parsed
-	wlf_svg_create_gradients(p);
+	while (data < end) {
+		/* Leading white space of a text run is trimmed anyway, so the runs
+		 * between tags are skipped without being copied. */
+		if (stream->state == WLF_SVG_XML_CONTENT && stream->token_len == 0) {
+			while (data < end && wlf_svg_isspace(*data)) {
+				data++;
+			}
+			if (data == end) {
+				break;
+			}
+		}
 
-	// Scale to viewBox
-	wlf_svg_scale_to_viewbox(p, units);
+		char delim = stream->state == WLF_SVG_XML_CONTENT ? '<' : '>';
+		const char *hit = memchr(data, delim, (size_t)(end - data));
+		size_t length = (size_t)((hit != NULL ? hit : end) - data);
+		if (!wlf_svg_stream_append(stream, data, length)) {
+			stream->failed = true;
+			return false;
+		}
+		if (hit == NULL) {
+			break;
+		}
+		data = hit + 1;
+
+		stream->token[stream->token_len] = '\0';
+		if (stream->state == WLF_SVG_XML_CONTENT) {
+			wlf_svg_parse_content(stream->token, wlf_svg_content,
+				stream->parser);
+			stream->state = WLF_SVG_XML_TAG;
+		} else {
+			wlf_svg_parse_element(stream->token, wlf_svg_start_element,
+				wlf_svg_end_element, stream->parser);
+			stream->state = WLF_SVG_XML_CONTENT;
+		}
+		stream->token_len = 0;
+	}
+
+	return true;
+}
 
-	ret = p->image;
-	p->image = NULL;
+struct wlf_svg_image *wlf_svg_stream_finish(struct wlf_svg_stream *stream) {
+	struct wlf_svg_parser *p = stream->parser;
+	struct wlf_svg_image *ret = NULL;
 
-	if (ret != NULL) {
-		ret->symbols = p->symbols;
-		ret->uses = p->uses;
-		p->symbols = NULL;
-		p->uses = NULL;
+	/* An unterminated trailing tag or text run is ignored. */
+	if (!stream->failed) {
+		// Create gradients after all definitions have been parsed
+		wlf_svg_create_gradients(p);
+
+		// Scale to viewBox
+		wlf_svg_scale_to_viewbox(p, stream->units);
+
+		ret = p->image;
+		p->image = NULL;
+
+		if (ret != NULL) {
+			ret->symbols = p->symbols;
+			ret->uses = p->uses;
+			p->symbols = NULL;
+			p->uses = NULL;
+		}
 	}
 
-	wlf_svg_delete_parser(p);
+	wlf_svg_stream_destroy(stream);
 
 	return ret;
 }
 
+struct wlf_svg_image *wlf_svg_parse_buffer(const char *data, size_t size,
+		const char *units, float dpi) {
+	struct wlf_svg_stream *stream = wlf_svg_stream_create(units, dpi);
+	if (stream == NULL) {
+		return NULL;
+	}
+
+	if (!wlf_svg_stream_feed(stream, data, size)) {
+		wlf_svg_stream_destroy(stream);
+		return NULL;
+	}
+
+	return wlf_svg_stream_finish(stream);
+}
+
+struct wlf_svg_image *wlf_svg_parse_from_file(const char *filename,
+		const char *units, float dpi) {
+	struct wlf_file_source source;
+	struct wlf_svg_image *image = NULL;
+
+	if (!wlf_file_source_init_from_file(&source, filename)) {
+		return NULL;
+	}
+
+	/* The mapped file is parsed directly, without a writable copy. */
+	image = wlf_svg_parse_buffer((const char *)source.data, source.size,
+		units, dpi);
+	wlf_file_source_finish(&source);
+
+	return image;
+}
+
+struct wlf_svg_image *wlf_svg_parse(char *input, const char *units, float dpi) {
+	return wlf_svg_parse_buffer(input, strlen(input), units, dpi);
+}
+
 struct wlf_path *wlf_svg_path_duplicate(struct wlf_path *path) {
 	return wlf_path_duplicate(path);
 }
@@ -4166,16 +4300,13 @@ static void wlf_svg_write_shape(FILE *fp, const struct wlf_svg_shape *s,
 }
 
 static void wlf_svg_write_shape_list(FILE *fp, const struct wlf_shape *list,
-	int indent, bool skip_from_use)
+	int indent)
 {
 	for (const struct wlf_shape *base = list; base != NULL;
 		base = (const struct wlf_shape *)wlf_svg_shape_from_shape(
 			(struct wlf_shape *)base)->next) {
 		const struct wlf_svg_shape *s =
 			wlf_svg_shape_from_shape((struct wlf_shape *)base);
-		if (skip_from_use && (s->flags & WLF_SVG_FLAGS_FROM_USE)) {
-			continue;
-		}
 		wlf_svg_write_shape(fp, s, indent);
 	}
 }
@@ -4290,14 +4421,14 @@ bool wlf_svg_save(const struct wlf_svg_image *image, const char *filename)
 				fprintf(fp, "\"");
 			}
 			fprintf(fp, ">\n");
-			wlf_svg_write_shape_list(fp, sym->shapes, 6, false);
+			wlf_svg_write_shape_list(fp, sym->shapes, 6);
 			wlf_svg_write_indent(fp, 4);
 			fprintf(fp, "</symbol>\n");
 		}
 		fprintf(fp, "  </defs>\n");
 	}
 
-	wlf_svg_write_shape_list(fp, image->shapes, 2, true);
+	wlf_svg_write_shape_list(fp, image->shapes, 2);
 	for (struct wlf_svg_use_data *use = image->uses; use != NULL;
 		use = use->next) {
 		wlf_svg_write_indent(fp, 2);
@@ -4313,6 +4444,783 @@ bool wlf_svg_save(const struct wlf_svg_image *image, const char *filename)
 	return true;
 }
 
+/*
+ * Binary images store a parsed image with everything already resolved:
+ * viewBox scaling, transforms, flattened paths and gradients. Loading one
+ * only copies data into the arena and recreates geometry and paints.
+ *
+ * Only what cannot be derived is stored. Path and shape bounds are
+ * recomputed from the points, the geometry paint from the shape, and the
+ * raw root attributes and gradient ids, which only matter while parsing,
+ * are left out. Colors are RGBA8.
+ *
+ * All values are little endian. Strings are a u8 length followed by the
+ * bytes, lists a u32 count followed by the items.
+ */
+#define WLF_SVG_BINARY_MAGIC "WSVB"
+#define WLF_SVG_BINARY_VERSION 2
+
+enum wlf_svg_binary_paint {
+	WLF_SVG_BINARY_PAINT_NONE = 0,
+	WLF_SVG_BINARY_PAINT_LINEAR = 1,
+	WLF_SVG_BINARY_PAINT_RADIAL = 2,
+	WLF_SVG_BINARY_PAINT_SOLID = 3,
+};
+
+enum wlf_svg_binary_geometry {
+	WLF_SVG_BINARY_GEOMETRY_NONE = 0,
+	WLF_SVG_BINARY_GEOMETRY_RECT,
+	WLF_SVG_BINARY_GEOMETRY_CIRCLE,
+	WLF_SVG_BINARY_GEOMETRY_ELLIPSE,
+	WLF_SVG_BINARY_GEOMETRY_LINE,
+	WLF_SVG_BINARY_GEOMETRY_POLY,
+	WLF_SVG_BINARY_GEOMETRY_PATH,
+	WLF_SVG_BINARY_GEOMETRY_TEXT,
+};
+
+static void wlf_svg_put_u8(FILE* fp, unsigned int v)
+{
+	fputc((int)(v & 0xFFu), fp);
+}
+
+static void wlf_svg_put_u32(FILE* fp, uint32_t v)
+{
+	unsigned char b[4] = { v & 0xFF, (v >> 8) & 0xFF, (v >> 16) & 0xFF, v >> 24 };
+	fwrite(b, 1, sizeof b, fp);
+}
+
+static void wlf_svg_put_f32(FILE* fp, float v)
+{
+	uint32_t u;
+	memcpy(&u, &v, sizeof u);
+	wlf_svg_put_u32(fp, u);
+}
+
+static void wlf_svg_put_floats(FILE* fp, const float* v, size_t n)
+{
+#if WLF_LITTLE_ENDIAN
+	fwrite(v, sizeof(float), n, fp);
+#else
+	for (size_t i = 0; i < n; i++)
+		wlf_svg_put_f32(fp, v[i]);
+#endif
+}
+
+// Every string field of the image is shorter than 256 bytes.
+static void wlf_svg_put_str(FILE* fp, const char* s)
+{
+	size_t n = strlen(s);
+	wlf_svg_put_u8(fp, (unsigned int)n);
+	fwrite(s, 1, n, fp);
+}
+
+static void wlf_svg_put_color(FILE* fp, const struct wlf_color* color)
+{
+	struct wlf_color c = wlf_color_clamp(color);
+	wlf_svg_put_u8(fp, (unsigned int)(c.r * 255.0 + 0.5));
+	wlf_svg_put_u8(fp, (unsigned int)(c.g * 255.0 + 0.5));
+	wlf_svg_put_u8(fp, (unsigned int)(c.b * 255.0 + 0.5));
+	wlf_svg_put_u8(fp, (unsigned int)(c.a * 255.0 + 0.5));
+}
+
+static void wlf_svg_put_paint(FILE* fp, const struct wlf_gradient* grad)
+{
+	struct wlf_color solid;
+
+	if (wlf_svg_gradient_is_solid(grad, &solid)) {
+		wlf_svg_put_u8(fp, WLF_SVG_BINARY_PAINT_SOLID);
+		wlf_svg_put_color(fp, &solid);
+		return;
+	} else if (grad != NULL && wlf_gradient_is_linear(grad)) {
+		const struct wlf_linear_gradient *linear =
+			wlf_linear_gradient_from_gradient((struct wlf_gradient *)grad);
+		wlf_svg_put_u8(fp, WLF_SVG_BINARY_PAINT_LINEAR);
+		wlf_svg_put_f32(fp, (float)linear->start.x);
+		wlf_svg_put_f32(fp, (float)linear->start.y);
+		wlf_svg_put_f32(fp, (float)linear->end.x);
+		wlf_svg_put_f32(fp, (float)linear->end.y);
+	} else if (grad != NULL && wlf_gradient_is_radial(grad)) {
+		const struct wlf_radial_gradient *radial =
+			wlf_radial_gradient_from_gradient((struct wlf_gradient *)grad);
+		wlf_svg_put_u8(fp, WLF_SVG_BINARY_PAINT_RADIAL);
+		wlf_svg_put_f32(fp, (float)radial->center.x);
+		wlf_svg_put_f32(fp, (float)radial->center.y);
+		wlf_svg_put_f32(fp, (float)radial->focal.x);
+		wlf_svg_put_f32(fp, (float)radial->focal.y);
+		wlf_svg_put_f32(fp, (float)radial->radius);
+	} else {
+		wlf_svg_put_u8(fp, WLF_SVG_BINARY_PAINT_NONE);
+		return;
+	}
+
+	wlf_svg_put_u8(fp, grad->has_xform);
+	if (grad->has_xform)
+		wlf_svg_put_floats(fp, grad->xform, 6);
+	wlf_svg_put_u32(fp, (uint32_t)grad->stop_count);
+	for (size_t i = 0; i < grad->stop_count; i++) {
+		wlf_svg_put_f32(fp, (float)grad->stops[i].offset);
+		wlf_svg_put_color(fp, &grad->stops[i].color);
+	}
+}
+
+// The paint of the geometry is not stored, it is derived from its shape.
+static void wlf_svg_put_geometry(FILE* fp, struct wlf_shape* geometry)
+{
+	if (geometry == NULL) {
+		wlf_svg_put_u8(fp, WLF_SVG_BINARY_GEOMETRY_NONE);
+		return;
+	}
+
+	if (wlf_shape_is_rect(geometry)) {
+		struct wlf_rect_shape *rect = wlf_rect_shape_from_shape(geometry);
+		wlf_svg_put_u8(fp, WLF_SVG_BINARY_GEOMETRY_RECT);
+		wlf_svg_put_f32(fp, rect->x);
+		wlf_svg_put_f32(fp, rect->y);
+		wlf_svg_put_f32(fp, rect->width);
+		wlf_svg_put_f32(fp, rect->height);
+		wlf_svg_put_f32(fp, rect->rx);
+		wlf_svg_put_f32(fp, rect->ry);
+	} else if (wlf_shape_is_circle(geometry)) {
+		struct wlf_circle_shape *circle = wlf_circle_shape_from_shape(geometry);
+		wlf_svg_put_u8(fp, WLF_SVG_BINARY_GEOMETRY_CIRCLE);
+		wlf_svg_put_f32(fp, circle->cx);
+		wlf_svg_put_f32(fp, circle->cy);
+		wlf_svg_put_f32(fp, circle->r);
+	} else if (wlf_shape_is_ellipse(geometry)) {
+		struct wlf_ellipse_shape *ellipse = wlf_ellipse_shape_from_shape(geometry);
+		wlf_svg_put_u8(fp, WLF_SVG_BINARY_GEOMETRY_ELLIPSE);
+		wlf_svg_put_f32(fp, ellipse->cx);
+		wlf_svg_put_f32(fp, ellipse->cy);
+		wlf_svg_put_f32(fp, ellipse->rx);
+		wlf_svg_put_f32(fp, ellipse->ry);
+	} else if (wlf_shape_is_line(geometry)) {
+		struct wlf_line_shape *line = wlf_line_shape_from_shape(geometry);
+		wlf_svg_put_u8(fp, WLF_SVG_BINARY_GEOMETRY_LINE);
+		wlf_svg_put_f32(fp, line->x1);
+		wlf_svg_put_f32(fp, line->y1);
+		wlf_svg_put_f32(fp, line->x2);
+		wlf_svg_put_f32(fp, line->y2);
+	} else if (wlf_shape_is_poly(geometry)) {
+		struct wlf_poly_shape *poly = wlf_poly_shape_from_shape(geometry);
+		wlf_svg_put_u8(fp, WLF_SVG_BINARY_GEOMETRY_POLY);
+		wlf_svg_put_u8(fp, poly->closed);
+		wlf_svg_put_u32(fp, (uint32_t)poly->count);
+		wlf_svg_put_floats(fp, poly->points, (size_t)poly->count * 2);
+	} else if (wlf_shape_is_path(geometry)) {
+		// Path geometry always wraps the paths of its shape.
+		wlf_svg_put_u8(fp, WLF_SVG_BINARY_GEOMETRY_PATH);
+	} else if (wlf_shape_is_text(geometry)) {
+		struct wlf_text_shape *text = wlf_text_shape_from_shape(geometry);
+		wlf_svg_put_u8(fp, WLF_SVG_BINARY_GEOMETRY_TEXT);
+		wlf_svg_put_f32(fp, text->x);
+		wlf_svg_put_f32(fp, text->y);
+		wlf_svg_put_f32(fp, text->font_size);
+		wlf_svg_put_u8(fp, text->text_anchor);
+		wlf_svg_put_str(fp, text->font_family);
+		wlf_svg_put_str(fp, text->text);
+	} else {
+		wlf_svg_put_u8(fp, WLF_SVG_BINARY_GEOMETRY_NONE);
+	}
+}
+
+static void wlf_svg_put_shape(FILE* fp, const struct wlf_svg_shape* shape)
+{
+	const struct wlf_path* path;
+	uint32_t npaths = 0;
+
+	wlf_svg_put_str(fp, shape->id);
+	wlf_svg_put_f32(fp, shape->opacity);
+	wlf_svg_put_f32(fp, shape->fill_opacity);
+	wlf_svg_put_f32(fp, shape->stroke_opacity);
+	wlf_svg_put_f32(fp, shape->stroke_width);
+	wlf_svg_put_f32(fp, shape->stroke_dash_offset);
+	wlf_svg_put_u8(fp, (unsigned char)shape->stroke_dash_count);
+	wlf_svg_put_floats(fp, shape->stroke_dash_array, (size_t)shape->stroke_dash_count);
+	wlf_svg_put_u8(fp, (unsigned char)shape->stroke_line_join);
+	wlf_svg_put_u8(fp, (unsigned char)shape->stroke_line_cap);
+	wlf_svg_put_f32(fp, shape->miter_limit);
+	wlf_svg_put_u8(fp, (unsigned char)shape->fill_rule);
+	wlf_svg_put_u8(fp, shape->paint_order);
+	wlf_svg_put_u8(fp, shape->flags);
+	wlf_svg_put_paint(fp, shape->fill);
+	wlf_svg_put_paint(fp, shape->stroke);
+
+	for (path = shape->paths; path != NULL; path = path->next)
+		npaths++;
+	wlf_svg_put_u32(fp, npaths);
+	for (path = shape->paths; path != NULL; path = path->next) {
+		wlf_svg_put_u8(fp, (unsigned char)path->closed);
+		wlf_svg_put_u32(fp, (uint32_t)path->npts);
+		wlf_svg_put_floats(fp, path->pts, (size_t)path->npts * 2);
+	}
+
+	wlf_svg_put_geometry(fp, shape->geometry);
+}
+
+static void wlf_svg_put_shape_list(FILE* fp, const struct wlf_shape* list)
+{
+	const struct wlf_svg_shape* shape;
+	uint32_t count = 0;
+
+	for (shape = list ? wlf_svg_shape_from_shape((struct wlf_shape*)list) : NULL;
+		shape != NULL; shape = shape->next)
+		count++;
+	wlf_svg_put_u32(fp, count);
+	for (shape = list ? wlf_svg_shape_from_shape((struct wlf_shape*)list) : NULL;
+		shape != NULL; shape = shape->next)
+		wlf_svg_put_shape(fp, shape);
+}
+
+// Position of @p shape in @p list counted from 1, or 0 if it is absent.
+static uint32_t wlf_svg_shape_position(const struct wlf_shape* list, const struct wlf_shape* shape)
+{
+	const struct wlf_svg_shape* s;
+	uint32_t i = 1;
+
+	if (list == NULL || shape == NULL)
+		return 0;
+	for (s = wlf_svg_shape_from_shape((struct wlf_shape*)list); s != NULL; s = s->next, i++) {
+		if (&s->base == shape)
+			return i;
+	}
+	return 0;
+}
+
+bool wlf_svg_save_binary(const struct wlf_svg_image *image, const char *filename)
+{
+	const struct wlf_svg_symbol_data* sym;
+	const struct wlf_svg_use_data* use;
+	uint32_t count;
+	bool ok;
+
+	if (image == NULL || filename == NULL)
+		return false;
+
+	FILE *fp = fopen(filename, "wb");
+	if (fp == NULL) {
+		wlf_log_errno(WLF_ERROR, "failed to open %s", filename);
+		return false;
+	}
+
+	fwrite(WLF_SVG_BINARY_MAGIC, 1, 4, fp);
+	wlf_svg_put_u32(fp, WLF_SVG_BINARY_VERSION);
+	wlf_svg_put_f32(fp, image->width);
+	wlf_svg_put_f32(fp, image->height);
+
+	wlf_svg_put_shape_list(fp, image->shapes);
+
+	count = 0;
+	for (sym = image->symbols; sym != NULL; sym = sym->next)
+		count++;
+	wlf_svg_put_u32(fp, count);
+	for (sym = image->symbols; sym != NULL; sym = sym->next) {
+		wlf_svg_put_str(fp, sym->id);
+		wlf_svg_put_shape_list(fp, sym->shapes);
+	}
+
+	// Uses refer to their symbol and preceding shape by position.
+	count = 0;
+	for (use = image->uses; use != NULL; use = use->next)
+		count++;
+	wlf_svg_put_u32(fp, count);
+	for (use = image->uses; use != NULL; use = use->next) {
+		uint32_t symbol = 0, i = 1;
+		for (sym = image->symbols; sym != NULL; sym = sym->next, i++) {
+			if (sym == use->symbol) {
+				symbol = i;
+				break;
+			}
+		}
+		wlf_svg_put_str(fp, use->href);
+		wlf_svg_put_f32(fp, use->x);
+		wlf_svg_put_f32(fp, use->y);
+		wlf_svg_put_u32(fp, symbol);
+		wlf_svg_put_u32(fp, wlf_svg_shape_position(image->shapes, use->after));
+	}
+
+	ok = !ferror(fp);
+	if (fclose(fp) != 0)
+		ok = false;
+	if (!ok)
+		wlf_log_errno(WLF_ERROR, "failed to write %s", filename);
+	return ok;
+}
+
+struct wlf_svg_reader {
+	struct wlf_file_source source;
+	struct wlf_svg_arena* arena;
+	bool failed;
+};
+
+static const unsigned char* wlf_svg_get_bytes(struct wlf_svg_reader* r, size_t n)
+{
+	const unsigned char* bytes;
+	if (r->failed)
+		return NULL;
+	if (n == 0)
+		return (const unsigned char*)"";
+	bytes = wlf_file_source_take(&r->source, n);
+	if (bytes == NULL)
+		r->failed = true;
+	return bytes;
+}
+
+static unsigned int wlf_svg_get_u8(struct wlf_svg_reader* r)
+{
+	const unsigned char* b = wlf_svg_get_bytes(r, 1);
+	return b != NULL ? b[0] : 0;
+}
+
+static uint32_t wlf_svg_get_u32(struct wlf_svg_reader* r)
+{
+	const unsigned char* b = wlf_svg_get_bytes(r, 4);
+	if (b == NULL)
+		return 0;
+	return (uint32_t)b[0] | (uint32_t)b[1] << 8 | (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24;
+}
+
+static float wlf_svg_get_f32(struct wlf_svg_reader* r)
+{
+	uint32_t u = wlf_svg_get_u32(r);
+	float v;
+	memcpy(&v, &u, sizeof v);
+	return v;
+}
+
+static void wlf_svg_get_floats(struct wlf_svg_reader* r, float* v, size_t n)
+{
+#if WLF_LITTLE_ENDIAN
+	const unsigned char* b = wlf_svg_get_bytes(r, n * sizeof(float));
+	if (b != NULL)
+		memcpy(v, b, n * sizeof(float));
+#else
+	for (size_t i = 0; i < n; i++)
+		v[i] = wlf_svg_get_f32(r);
+#endif
+}
+
+// Reads a count of items at least @p item_size bytes each, failing early
+// on counts the remaining data cannot hold.
+static uint32_t wlf_svg_get_count(struct wlf_svg_reader* r, size_t item_size)
+{
+	uint32_t count = wlf_svg_get_u32(r);
+	if (item_size > 0 && count > wlf_file_source_remaining(&r->source) / item_size) {
+		r->failed = true;
+		return 0;
+	}
+	return count;
+}
+
+static void wlf_svg_get_str(struct wlf_svg_reader* r, char* dst, size_t size)
+{
+	size_t n = wlf_svg_get_u8(r);
+	const unsigned char* b;
+
+	if (n >= size) {
+		r->failed = true;
+		return;
+	}
+	b = wlf_svg_get_bytes(r, n);
+	if (b == NULL)
+		return;
+	memcpy(dst, b, n);
+	dst[n] = '\0';
+}
+
+static struct wlf_color wlf_svg_get_color(struct wlf_svg_reader* r)
+{
+	const unsigned char* b = wlf_svg_get_bytes(r, 4);
+	if (b == NULL)
+		return WLF_COLOR_TRANSPARENT;
+	return wlf_color_from_rgba8(b[0], b[1], b[2], b[3]);
+}
+
+static struct wlf_gradient* wlf_svg_get_paint(struct wlf_svg_reader* r)
+{
+	struct wlf_gradient_stop* stops = NULL;
+	struct wlf_gradient* grad = NULL;
+	struct wlf_fpoint a, b;
+	float xform[6];
+	double radius = 0.0;
+	unsigned int type, has_xform;
+	uint32_t i, nstops;
+
+	type = wlf_svg_get_u8(r);
+	if (type == WLF_SVG_BINARY_PAINT_NONE)
+		return NULL;
+	if (type == WLF_SVG_BINARY_PAINT_SOLID) {
+		struct wlf_color color = wlf_svg_get_color(r);
+		if (r->failed)
+			return NULL;
+		grad = wlf_svg_create_solid_paint(color);
+		if (grad == NULL)
+			r->failed = true;
+		return grad;
+	}
+	if (type != WLF_SVG_BINARY_PAINT_LINEAR && type != WLF_SVG_BINARY_PAINT_RADIAL) {
+		r->failed = true;
+		return NULL;
+	}
+
+	a.x = wlf_svg_get_f32(r);
+	a.y = wlf_svg_get_f32(r);
+	b.x = wlf_svg_get_f32(r);
+	b.y = wlf_svg_get_f32(r);
+	if (type == WLF_SVG_BINARY_PAINT_RADIAL)
+		radius = wlf_svg_get_f32(r);
+	has_xform = wlf_svg_get_u8(r);
+	if (has_xform)
+		wlf_svg_get_floats(r, xform, 6);
+	nstops = wlf_svg_get_count(r, sizeof(float) + 4);
+	if (r->failed)
+		return NULL;
+
+	if (nstops > 0) {
+		stops = malloc(nstops * sizeof(*stops));
+		if (stops == NULL) {
+			wlf_log_errno(WLF_ERROR, "failed to allocate gradient stops");
+			r->failed = true;
+			return NULL;
+		}
+	}
+	for (i = 0; i < nstops; i++) {
+		stops[i].offset = wlf_svg_get_f32(r);
+		stops[i].color = wlf_svg_get_color(r);
+	}
+
+	if (!r->failed) {
+		if (type == WLF_SVG_BINARY_PAINT_LINEAR) {
+			struct wlf_linear_gradient *linear =
+				wlf_linear_gradient_create(a, b, stops, nstops);
+			grad = linear != NULL ? &linear->base : NULL;
+		} else {
+			struct wlf_radial_gradient *radial =
+				wlf_radial_gradient_create(a, b, radius, stops, nstops);
+			grad = radial != NULL ? &radial->base : NULL;
+		}
+		if (grad != NULL) {
+			if (has_xform)
+				memcpy(grad->xform, xform, sizeof grad->xform);
+			grad->has_xform = has_xform != 0;
+		} else {
+			r->failed = true;
+		}
+	}
+	free(stops);
+	return grad;
+}
+
+static struct wlf_shape* wlf_svg_get_geometry(struct wlf_svg_reader* r,
+	struct wlf_svg_shape* shape)
+{
+	struct wlf_shape* geometry = NULL;
+	struct wlf_shape_state* state;
+	float v[6];
+	unsigned int kind = wlf_svg_get_u8(r);
+
+	switch (kind) {
+	case WLF_SVG_BINARY_GEOMETRY_NONE:
+		return NULL;
+	case WLF_SVG_BINARY_GEOMETRY_RECT:
+		wlf_svg_get_floats(r, v, 6);
+		if (!r->failed)
+			geometry = wlf_rect_shape_create(v[0], v[1], v[2], v[3], v[4], v[5]);
+		break;
+	case WLF_SVG_BINARY_GEOMETRY_CIRCLE:
+		wlf_svg_get_floats(r, v, 3);
+		if (!r->failed)
+			geometry = wlf_circle_shape_create(v[0], v[1], v[2]);
+		break;
+	case WLF_SVG_BINARY_GEOMETRY_ELLIPSE:
+		wlf_svg_get_floats(r, v, 4);
+		if (!r->failed)
+			geometry = wlf_ellipse_shape_create(v[0], v[1], v[2], v[3]);
+		break;
+	case WLF_SVG_BINARY_GEOMETRY_LINE:
+		wlf_svg_get_floats(r, v, 4);
+		if (!r->failed)
+			geometry = wlf_line_shape_create(v[0], v[1], v[2], v[3]);
+		break;
+	case WLF_SVG_BINARY_GEOMETRY_POLY: {
+		unsigned int closed = wlf_svg_get_u8(r);
+		uint32_t count = wlf_svg_get_count(r, 2 * sizeof(float));
+		float* points = NULL;
+		if (r->failed)
+			break;
+		if (count > 0) {
+			points = malloc((size_t)count * 2 * sizeof(float));
+			if (points == NULL) {
+				wlf_log_errno(WLF_ERROR, "failed to allocate polygon points");
+				r->failed = true;
+				break;
+			}
+		}
+		wlf_svg_get_floats(r, points, (size_t)count * 2);
+		if (!r->failed)
+			geometry = wlf_poly_shape_create(points, (int)count, closed != 0);
+		free(points);
+		break;
+	}
+	case WLF_SVG_BINARY_GEOMETRY_PATH:
+		geometry = wlf_path_shape_create(shape->paths, false);
+		break;
+	case WLF_SVG_BINARY_GEOMETRY_TEXT: {
+		char family[64], text[256];
+		unsigned int anchor;
+		wlf_svg_get_floats(r, v, 3);
+		anchor = wlf_svg_get_u8(r);
+		wlf_svg_get_str(r, family, sizeof family);
+		wlf_svg_get_str(r, text, sizeof text);
+		if (!r->failed)
+			geometry = wlf_text_shape_create(v[0], v[1], text, family, v[2],
+				(enum wlf_text_anchor)anchor);
+		break;
+	}
+	default:
+		r->failed = true;
+		return NULL;
+	}
+
+	if (geometry == NULL) {
+		r->failed = true;
+		return NULL;
+	}
+
+	// Same paint as wlf_svg_apply_paint_to_geometry(); the paints already
+	// carry the effective alpha.
+	if (!wlf_shape_is_text(geometry)) {
+		state = wlf_svg_geometry_state(geometry);
+		state->fill_color = wlf_svg_gradient_fallback_color(shape->fill);
+		state->stroke_color = wlf_svg_gradient_fallback_color(shape->stroke);
+		state->stroke_width = shape->stroke_width;
+		state->opacity = shape->opacity;
+		state->fill_opacity = shape->fill_opacity;
+		state->stroke_opacity = shape->stroke_opacity;
+		state->has_fill = shape->fill != NULL;
+		state->has_stroke = shape->stroke != NULL;
+		state->fill_gradient = shape->fill;
+		state->stroke_gradient = shape->stroke;
+	}
+	return geometry;
+}
+
+static struct wlf_svg_shape* wlf_svg_get_shape(struct wlf_svg_reader* r)
+{
+	struct wlf_svg_shape* shape;
+	struct wlf_path **tail;
+	uint32_t i, npaths;
+
+	shape = wlf_svg_arena_alloc(r->arena, sizeof(struct wlf_svg_shape));
+	if (shape == NULL) {
+		r->failed = true;
+		return NULL;
+	}
+	wlf_shape_init(&shape->base, &wlf_svg_shape_impl);
+
+	wlf_svg_get_str(r, shape->id, sizeof shape->id);
+	shape->opacity = wlf_svg_get_f32(r);
+	shape->fill_opacity = wlf_svg_get_f32(r);
+	shape->stroke_opacity = wlf_svg_get_f32(r);
+	shape->stroke_width = wlf_svg_get_f32(r);
+	shape->stroke_dash_offset = wlf_svg_get_f32(r);
+	shape->stroke_dash_count = (char)wlf_svg_get_u8(r);
+	if (shape->stroke_dash_count < 0 || shape->stroke_dash_count > WLF_SVG_MAX_DASHES)
+		r->failed = true;
+	else
+		wlf_svg_get_floats(r, shape->stroke_dash_array, (size_t)shape->stroke_dash_count);
+	shape->stroke_line_join = (char)wlf_svg_get_u8(r);
+	shape->stroke_line_cap = (char)wlf_svg_get_u8(r);
+	shape->miter_limit = wlf_svg_get_f32(r);
+	shape->fill_rule = (char)wlf_svg_get_u8(r);
+	shape->paint_order = (unsigned char)wlf_svg_get_u8(r);
+	shape->flags = (unsigned char)wlf_svg_get_u8(r);
+	shape->fill = wlf_svg_get_paint(r);
+	shape->stroke = wlf_svg_get_paint(r);
+
+	npaths = wlf_svg_get_count(r, 1 + 4);
+	tail = &shape->paths;
+	for (i = 0; i < npaths && !r->failed; i++) {
+		struct wlf_path* path = wlf_svg_arena_alloc(r->arena, sizeof(struct wlf_path));
+		uint32_t npts;
+		if (path == NULL) {
+			r->failed = true;
+			break;
+		}
+		path->closed = (char)wlf_svg_get_u8(r);
+		npts = wlf_svg_get_count(r, 2 * sizeof(float));
+		if (!r->failed && (npts < 4 || npts % 3 != 1 || npts > INT_MAX))
+			r->failed = true;
+		if (r->failed)
+			break;
+		path->npts = (int)npts;
+		path->pts = wlf_svg_arena_alloc(r->arena, (size_t)npts * 2 * sizeof(float));
+		if (path->pts == NULL) {
+			r->failed = true;
+			break;
+		}
+		wlf_svg_get_floats(r, path->pts, (size_t)npts * 2);
+		wlf_svg_path_bounds(path);
+		*tail = path;
+		tail = &path->next;
+	}
+	if (!r->failed && shape->paths != NULL)
+		wlf_svg_shape_bounds(shape);
+
+	if (!r->failed)
+		shape->geometry = wlf_svg_get_geometry(r, shape);
+	if (r->failed) {
+		wlf_shape_destroy(&shape->base);
+		return NULL;
+	}
+	return shape;
+}
+
+// Reads a shape list into @p head, keeping the shapes in @p table when given.
+static void wlf_svg_get_shape_list(struct wlf_svg_reader* r, struct wlf_shape** head,
+	struct wlf_shape** tail, struct wlf_shape*** table, uint32_t* count)
+{
+	struct wlf_svg_shape* prev = NULL;
+	uint32_t i, n;
+
+	n = wlf_svg_get_count(r, 1);
+	if (table != NULL && n > 0 && !r->failed) {
+		*table = malloc(n * sizeof(**table));
+		if (*table == NULL) {
+			wlf_log_errno(WLF_ERROR, "failed to allocate SVG shape table");
+			r->failed = true;
+			return;
+		}
+		*count = n;
+	}
+
+	for (i = 0; i < n && !r->failed; i++) {
+		struct wlf_svg_shape* shape = wlf_svg_get_shape(r);
+		if (shape == NULL)
+			break;
+		if (prev == NULL)
+			*head = &shape->base;
+		else
+			prev->next = shape;
+		prev = shape;
+		if (table != NULL)
+			(*table)[i] = &shape->base;
+	}
+	if (tail != NULL && prev != NULL)
+		*tail = &prev->base;
+}
+
+static bool wlf_svg_get_image(struct wlf_svg_reader* r, struct wlf_svg_image* image)
+{
+	struct wlf_shape** shapes = NULL;
+	struct wlf_svg_symbol_data** symbols = NULL;
+	struct wlf_svg_symbol_data** sym_tail = &image->symbols;
+	struct wlf_svg_use_data** use_tail = &image->uses;
+	uint32_t i, nshapes = 0, nsymbols;
+	const unsigned char* magic;
+
+	magic = wlf_svg_get_bytes(r, 4);
+	if (magic == NULL || memcmp(magic, WLF_SVG_BINARY_MAGIC, 4) != 0) {
+		wlf_log(WLF_ERROR, "not a binary SVG image");
+		return false;
+	}
+	if (wlf_svg_get_u32(r) != WLF_SVG_BINARY_VERSION) {
+		wlf_log(WLF_ERROR, "unsupported binary SVG version");
+		return false;
+	}
+
+	image->width = wlf_svg_get_f32(r);
+	image->height = wlf_svg_get_f32(r);
+
+	wlf_svg_get_shape_list(r, &image->shapes, NULL, &shapes, &nshapes);
+
+	nsymbols = wlf_svg_get_count(r, 1 + 4);
+	if (nsymbols > 0 && !r->failed) {
+		symbols = malloc(nsymbols * sizeof(*symbols));
+		if (symbols == NULL) {
+			wlf_log_errno(WLF_ERROR, "failed to allocate SVG symbol table");
+			r->failed = true;
+		}
+	}
+	for (i = 0; i < nsymbols && !r->failed; i++) {
+		struct wlf_svg_symbol_data* sym =
+			wlf_svg_arena_alloc(r->arena, sizeof(struct wlf_svg_symbol_data));
+		if (sym == NULL) {
+			r->failed = true;
+			break;
+		}
+		*sym_tail = sym;
+		sym_tail = &sym->next;
+		symbols[i] = sym;
+		wlf_svg_get_str(r, sym->id, sizeof sym->id);
+		wlf_svg_get_shape_list(r, &sym->shapes, &sym->shapes_tail, NULL, NULL);
+	}
+
+	for (i = wlf_svg_get_count(r, 1 + 4 * 4); i > 0 && !r->failed; i--) {
+		struct wlf_svg_use_data* use =
+			wlf_svg_arena_alloc(r->arena, sizeof(struct wlf_svg_use_data));
+		uint32_t symbol, after;
+		if (use == NULL) {
+			r->failed = true;
+			break;
+		}
+		wlf_svg_get_str(r, use->href, sizeof use->href);
+		use->x = wlf_svg_get_f32(r);
+		use->y = wlf_svg_get_f32(r);
+		symbol = wlf_svg_get_u32(r);
+		after = wlf_svg_get_u32(r);
+		if (symbol > nsymbols || after > nshapes) {
+			r->failed = true;
+			break;
+		}
+		use->symbol = symbol > 0 ? symbols[symbol - 1] : NULL;
+		use->after = after > 0 ? shapes[after - 1] : NULL;
+		*use_tail = use;
+		use_tail = &use->next;
+	}
+
+	free(symbols);
+	free(shapes);
+	if (r->failed)
+		wlf_log(WLF_ERROR, "truncated or corrupt binary SVG image");
+	return !r->failed;
+}
+
+struct wlf_svg_image *wlf_svg_load_binary(const void *data, size_t size)
+{
+	struct wlf_svg_reader reader = {0};
+	struct wlf_svg_image *image;
+
+	reader.arena = wlf_svg_arena_create();
+	if (reader.arena == NULL)
+		return NULL;
+	image = wlf_svg_arena_alloc(reader.arena, sizeof(struct wlf_svg_image));
+	if (image == NULL) {
+		wlf_svg_arena_destroy(reader.arena);
+		return NULL;
+	}
+	image->arena = reader.arena;
+
+	wlf_file_source_init_from_memory(&reader.source, data, size);
+	if (!wlf_svg_get_image(&reader, image)) {
+		wlf_svg_destroy(image);
+		return NULL;
+	}
+	return image;
+}
+
+struct wlf_svg_image *wlf_svg_load_binary_from_file(const char *filename)
+{
+	struct wlf_file_source source;
+	struct wlf_svg_image *image;
+
+	if (!wlf_file_source_init_from_file(&source, filename))
+		return NULL;
+
+	image = wlf_svg_load_binary(source.data, source.size);
+	wlf_file_source_finish(&source);
+	return image;
+}
+
 void wlf_svg_destroy(struct wlf_svg_image *image) {
 	struct wlf_shape *shape, *snext;
 	if (image == NULL) return;
@@ -4323,17 +5231,39 @@ void wlf_svg_destroy(struct wlf_svg_image *image) {
 		wlf_shape_destroy(shape);
 		shape = snext;
 	}
-	wlf_svg_delete_symbol_data(image->symbols);
+	wlf_svg_delete_symbol_data(image->symbols, image->arena != NULL);
+	if (image->arena != NULL) {
+		// The image itself is one of the arena allocations.
+		wlf_svg_arena_destroy(image->arena);
+		return;
+	}
 	wlf_svg_delete_use_data(image->uses);
 	free(image);
 }
 
-void wlf_svg_get_info(const struct wlf_svg_image *image, struct wlf_svg_info *info) {
-	struct wlf_shape *base;
-	struct wlf_svg_shape *shape;
+static bool wlf_svg_add_shape_info(struct wlf_svg_shape *shape, float x, float y, void *data)
+{
+	struct wlf_svg_info *info = data;
 	struct wlf_path *path;
-	int first = 1;
 
+	info->n_shapes++;
+	for (path = shape->paths; path != NULL; path = path->next) {
+		if (info->n_paths++ == 0) {
+			info->bounds[0] = path->bounds[0] + x;
+			info->bounds[1] = path->bounds[1] + y;
+			info->bounds[2] = path->bounds[2] + x;
+			info->bounds[3] = path->bounds[3] + y;
+		} else {
+			info->bounds[0] = wlf_svg_minf(info->bounds[0], path->bounds[0] + x);
+			info->bounds[1] = wlf_svg_minf(info->bounds[1], path->bounds[1] + y);
+			info->bounds[2] = wlf_svg_maxf(info->bounds[2], path->bounds[2] + x);
+			info->bounds[3] = wlf_svg_maxf(info->bounds[3], path->bounds[3] + y);
+		}
+	}
+	return true;
+}
+
+void wlf_svg_get_info(const struct wlf_svg_image *image, struct wlf_svg_info *info) {
 	if (!image || !info)
 		return;
 
@@ -4341,26 +5271,7 @@ void wlf_svg_get_info(const struct wlf_svg_image *image, struct wlf_svg_info *in
 	info->width = image->width;
 	info->height = image->height;
 
-	for (base = image->shapes; base != NULL;
-		base = (struct wlf_shape *)wlf_svg_shape_from_shape(base)->next) {
-		shape = wlf_svg_shape_from_shape(base);
-		info->n_shapes++;
-		for (path = shape->paths; path != NULL; path = path->next) {
-			info->n_paths++;
-			if (first) {
-				info->bounds[0] = path->bounds[0];
-				info->bounds[1] = path->bounds[1];
-				info->bounds[2] = path->bounds[2];
-				info->bounds[3] = path->bounds[3];
-				first = 0;
-			} else {
-				if (path->bounds[0] < info->bounds[0]) info->bounds[0] = path->bounds[0];
-				if (path->bounds[1] < info->bounds[1]) info->bounds[1] = path->bounds[1];
-				if (path->bounds[2] > info->bounds[2]) info->bounds[2] = path->bounds[2];
-				if (path->bounds[3] > info->bounds[3]) info->bounds[3] = path->bounds[3];
-			}
-		}
-	}
+	wlf_svg_for_each_shape(image, wlf_svg_add_shape_info, info);
 }
 
 unsigned int wlf_svg_parse_color_name(const char* str)
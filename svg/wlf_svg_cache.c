@@ -0,0 +1,213 @@
+#include "wlf/svg/wlf_svg_cache.h"
+#include "wlf/utils/wlf_hash.h"
+#include "wlf/utils/wlf_log.h"
+#include "wlf/utils/wlf_lru_table.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SVG_CACHE_MIN_BUCKETS 32
+#define SVG_CACHE_UNITS_MAX 8
+
+struct wlf_svg_document {
+	struct wlf_lru_entry base;
+
+	/* Key */
+	char *source;
+	char *variant;                       /* NULL when no variant was given */
+	char units[SVG_CACHE_UNITS_MAX];
+	float dpi;
+
+	struct wlf_svg_image *image;
+};
+
+/* Documents cost 1 each; the capacity only bounds idle documents. */
+struct wlf_svg_cache {
+	struct wlf_lru_table table;
+};
+
+static struct wlf_svg_cache *default_cache;
+
+struct svg_cache_key {
+	const char *source;
+	const char *variant;
+	const char *units;
+	float dpi;
+};
+
+static uint64_t key_hash(const struct svg_cache_key *key) {
+	uint64_t hash = wlf_hash_bytes(WLF_HASH_INIT, key->source,
+		strlen(key->source) + 1);
+	if (key->variant != NULL) {
+		hash = wlf_hash_bytes(hash, key->variant, strlen(key->variant) + 1);
+	}
+	hash = wlf_hash_string(hash, key->units);
+	hash = wlf_hash_bytes(hash, &key->dpi, sizeof(key->dpi));
+	return hash;
+}
+
+static bool document_matches(const struct wlf_lru_entry *base, const void *data) {
+	const struct wlf_svg_document *document =
+		wlf_container_of(base, document, base);
+	const struct svg_cache_key *key = data;
+	if (document->dpi != key->dpi || strcmp(document->units, key->units) != 0) {
+		return false;
+	}
+	if ((document->variant == NULL) != (key->variant == NULL) ||
+			(key->variant != NULL && strcmp(document->variant, key->variant) != 0)) {
+		return false;
+	}
+	return strcmp(document->source, key->source) == 0;
+}
+
+static void document_free(struct wlf_svg_document *document) {
+	wlf_svg_destroy(document->image);
+	free(document->variant);
+	free(document->source);
+	free(document);
+}
+
+static void document_destroy(struct wlf_lru_entry *base) {
+	struct wlf_svg_document *document = wlf_container_of(base, document, base);
+	document_free(document);
+}
+
+static const struct wlf_lru_table_impl svg_cache_impl = {
+	.destroy = document_destroy,
+};
+
+struct wlf_svg_cache *wlf_svg_cache_create(uint32_t capacity) {
+	struct wlf_svg_cache *cache = calloc(1, sizeof(*cache));
+	if (cache == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate wlf_svg_cache");
+		return NULL;
+	}
+
+	if (!wlf_lru_table_init(&cache->table, &svg_cache_impl,
+			SVG_CACHE_MIN_BUCKETS, capacity, true)) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate SVG cache buckets");
+		free(cache);
+		return NULL;
+	}
+
+	return cache;
+}
+
+void wlf_svg_cache_destroy(struct wlf_svg_cache *cache) {
+	if (cache == NULL) {
+		return;
+	}
+
+	if (cache == default_cache) {
+		default_cache = NULL;
+	}
+	wlf_lru_table_finish(&cache->table);
+	free(cache);
+}
+
+struct wlf_svg_cache *wlf_svg_cache_get_default(void) {
+	if (default_cache == NULL) {
+		default_cache = wlf_svg_cache_create(WLF_SVG_CACHE_DEFAULT_CAPACITY);
+	}
+
+	return default_cache;
+}
+
+void wlf_svg_cache_set_capacity(struct wlf_svg_cache *cache, uint32_t capacity) {
+	wlf_lru_table_set_budget(&cache->table, capacity);
+}
+
+static struct wlf_svg_document *document_create(const char *source,
+		const char *variant, const char *units, float dpi) {
+	struct wlf_svg_document *document = calloc(1, sizeof(*document));
+	if (document == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate wlf_svg_document");
+		return NULL;
+	}
+
+	document->source = strdup(source);
+	document->variant = variant != NULL ? strdup(variant) : NULL;
+	if (document->source == NULL ||
+			(variant != NULL && document->variant == NULL)) {
+		wlf_log_errno(WLF_ERROR, "Failed to copy SVG document key");
+		document_free(document);
+		return NULL;
+	}
+
+	document->image = wlf_svg_parse_buffer(source, strlen(source), units, dpi);
+	if (document->image == NULL) {
+		document_free(document);
+		return NULL;
+	}
+
+	snprintf(document->units, sizeof(document->units), "%s", units);
+	document->dpi = dpi;
+
+	return document;
+}
+
+struct wlf_svg_document *wlf_svg_cache_parse(struct wlf_svg_cache *cache,
+		const char *source, const char *variant, const char *units, float dpi) {
+	if (cache == NULL || source == NULL) {
+		return NULL;
+	}
+	if (units == NULL) {
+		units = "px";
+	}
+	if (strlen(units) >= SVG_CACHE_UNITS_MAX) {
+		wlf_log(WLF_ERROR, "Unsupported SVG units '%s'", units);
+		return NULL;
+	}
+
+	struct svg_cache_key key = {
+		.source = source,
+		.variant = variant,
+		.units = units,
+		.dpi = dpi,
+	};
+	uint64_t hash = key_hash(&key);
+	struct wlf_lru_entry *found =
+		wlf_lru_table_find(&cache->table, hash, document_matches, &key);
+	if (found != NULL) {
+		struct wlf_svg_document *document = wlf_container_of(found, document, base);
+		return document;
+	}
+
+	struct wlf_svg_document *document = document_create(source, variant, units, dpi);
+	if (document == NULL) {
+		return NULL;
+	}
+
+	wlf_lru_table_insert(&cache->table, &document->base, hash, 1);
+
+	return document;
+}
+
+void wlf_svg_cache_get_stats(const struct wlf_svg_cache *cache,
+		struct wlf_svg_cache_stats *stats) {
+	const struct wlf_lru_table *table = &cache->table;
+	*stats = (struct wlf_svg_cache_stats) {
+		.hits = table->hits,
+		.misses = table->misses,
+		.evictions = table->evictions,
+		.document_count = table->entry_count,
+		.capacity = (uint32_t)table->budget,
+	};
+}
+
+struct wlf_svg_document *wlf_svg_document_ref(struct wlf_svg_document *document) {
+	wlf_lru_entry_ref(&document->base);
+	return document;
+}
+
+void wlf_svg_document_unref(struct wlf_svg_document *document) {
+	if (document != NULL) {
+		wlf_lru_entry_unref(&document->base);
+	}
+}
+
+struct wlf_svg_image *wlf_svg_document_get_image(
+		const struct wlf_svg_document *document) {
+	return document->image;
+}
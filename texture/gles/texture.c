@@ -16,7 +16,86 @@ static void texture_destroy(struct wlf_texture *base) {
 	free(texture);
 }
 
+static bool texture_update_from_buffer(struct wlf_texture *base,
+		struct wlf_buffer *buffer, const pixman_region32_t *damage) {
+	struct wlf_gles_texture *texture = wlf_gles_texture_from_texture(base);
+	void *data = NULL;
+	uint32_t format = WLF_FORMAT_INVALID;
+	size_t stride = 0;
+	if (!wlf_buffer_begin_data_ptr_access(buffer,
+			WLF_BUFFER_DATA_PTR_ACCESS_READ, &data, &format, &stride)) {
+		return false;
+	}
+
+	const struct wlf_gles_pixel_format *gles_format =
+		wlf_gles_pixel_format_from_wlf(format);
+	const struct wlf_pixel_format_info *format_info =
+		wlf_get_pixel_format_info(format);
+	if (format != texture->drm_format || gles_format == NULL ||
+			format_info == NULL || format_info->block_width != 1 ||
+			stride % format_info->bytes_per_block != 0) {
+		wlf_buffer_end_data_ptr_access(buffer);
+		return false;
+	}
+
+	pixman_box32_t full = {
+		.x2 = (int32_t)base->width,
+		.y2 = (int32_t)base->height,
+	};
+	const pixman_box32_t *rects = &full;
+	int rects_len = 1;
+	if (damage != NULL) {
+		rects = pixman_region32_rectangles((pixman_region32_t *)damage,
+			&rects_len);
+	}
+
+	uint32_t bpp = format_info->bytes_per_block;
+	bool unpack_subimage = texture->renderer->exts.EXT_unpack_subimage;
+	glBindTexture(GL_TEXTURE_2D, texture->tex);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	if (unpack_subimage) {
+		glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, (GLint)(stride / bpp));
+	}
+	for (int i = 0; i < rects_len; i++) {
+		const pixman_box32_t *rect = &rects[i];
+		int32_t width = rect->x2 - rect->x1;
+		if (unpack_subimage) {
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS_EXT, rect->x1);
+			glPixelStorei(GL_UNPACK_SKIP_ROWS_EXT, rect->y1);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, rect->x1, rect->y1,
+				width, rect->y2 - rect->y1,
+				gles_format->gl_format, gles_format->gl_type, data);
+			continue;
+		}
+
+		/* Without GL_EXT_unpack_subimage, rows must be uploaded one at a time. */
+		for (int32_t y = rect->y1; y < rect->y2; y++) {
+			const uint8_t *row = (const uint8_t *)data +
+				(size_t)y * stride + (size_t)rect->x1 * bpp;
+			glTexSubImage2D(GL_TEXTURE_2D, 0, rect->x1, y, width, 1,
+				gles_format->gl_format, gles_format->gl_type, row);
+		}
+	}
+	if (unpack_subimage) {
+		glPixelStorei(GL_UNPACK_ROW_LENGTH_EXT, 0);
+		glPixelStorei(GL_UNPACK_SKIP_PIXELS_EXT, 0);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS_EXT, 0);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	wlf_buffer_end_data_ptr_access(buffer);
+
+	GLenum error = glGetError();
+	if (error != GL_NO_ERROR) {
+		wlf_log(WLF_ERROR, "failed to update GLES texture: %s",
+			wlf_gles_error_str(error));
+		return false;
+	}
+
+	return true;
+}
+
 static const struct wlf_texture_impl texture_impl = {
+	.update_from_buffer = texture_update_from_buffer,
 	.destroy = texture_destroy,
 };
 
@@ -52,6 +131,7 @@ struct wlf_texture *wlf_gles_texture_from_buffer(
 	wlf_texture_init(&texture->base, &renderer->base, &texture_impl,
 		buffer->width, buffer->height);
 	texture->renderer = renderer;
+	texture->drm_format = format;
 
 	glGenTextures(1, &texture->tex);
 	glBindTexture(GL_TEXTURE_2D, texture->tex);
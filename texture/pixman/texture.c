@@ -18,6 +18,57 @@ static void texture_destroy(struct wlf_texture *wlf_texture) {
 	free(texture);
 }
 
+static bool texture_update_from_buffer(struct wlf_texture *wlf_texture,
+		struct wlf_buffer *buffer, const pixman_region32_t *damage) {
+	struct wlf_pixman_texture *texture = wlf_pixman_texture_from_texture(wlf_texture);
+	if (texture->data == NULL) {
+		/* Only textures owning a private pixel copy can be updated in place. */
+		return false;
+	}
+
+	void *data = NULL;
+	uint32_t drm_format;
+	size_t stride;
+	if (!wlf_buffer_begin_data_ptr_access(buffer, WLF_BUFFER_DATA_PTR_ACCESS_READ,
+			&data, &drm_format, &stride)) {
+		return false;
+	}
+	if (drm_format != texture->format_info->format ||
+			texture->format_info->block_width != 1) {
+		wlf_buffer_end_data_ptr_access(buffer);
+		return false;
+	}
+
+	uint32_t bpp = texture->format_info->bytes_per_block;
+	size_t dst_stride = (size_t)pixman_image_get_stride(texture->image);
+	uint8_t *dst = texture->data;
+	const uint8_t *src = data;
+
+	pixman_box32_t full = {
+		.x2 = (int32_t)wlf_texture->width,
+		.y2 = (int32_t)wlf_texture->height,
+	};
+	const pixman_box32_t *rects = &full;
+	int rects_len = 1;
+	if (damage != NULL) {
+		rects = pixman_region32_rectangles((pixman_region32_t *)damage,
+			&rects_len);
+	}
+
+	for (int i = 0; i < rects_len; i++) {
+		const pixman_box32_t *rect = &rects[i];
+		size_t row_size = (size_t)(rect->x2 - rect->x1) * bpp;
+		for (int32_t y = rect->y1; y < rect->y2; y++) {
+			memcpy(dst + (size_t)y * dst_stride + (size_t)rect->x1 * bpp,
+				src + (size_t)y * stride + (size_t)rect->x1 * bpp, row_size);
+		}
+	}
+
+	wlf_buffer_end_data_ptr_access(buffer);
+
+	return true;
+}
+
 static bool texture_read_pixels(struct wlf_texture *wlf_texture,
 		const struct wlf_texture_read_pixels_options *options) {
 	struct wlf_pixman_texture *texture = wlf_pixman_texture_from_texture(wlf_texture);
@@ -53,6 +104,7 @@ static uint32_t pixman_texture_preferred_read_format(struct wlf_texture *wlf_tex
 }
 
 static const struct wlf_texture_impl texture_impl = {
+	.update_from_buffer = texture_update_from_buffer,
 	.read_pixels = texture_read_pixels,
 	.preferred_read_format = pixman_texture_preferred_read_format,
 	.destroy = texture_destroy,
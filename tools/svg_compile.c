@@ -0,0 +1,124 @@
+/**
+ * @file        svg_compile.c
+ * @brief       wlf-svg-compile: precompile SVG icons into binary SVG files.
+ * @details     Parses each SVG once at build time and writes the result with
+ *              wlf_svg_save_binary(), so applications can load it with
+ *              wlf_svg_load_binary_from_file() without parsing XML.
+ *
+ *              From meson:
+ *                  compile = find_program('wlf-svg-compile')
+ *                  custom_target(input: 'icon.svg', output: 'icon.wsvg',
+ *                      command: [compile, '@INPUT@', '@OUTPUT@'])
+ * @author      YaoBing Xiao
+ * @date        2026-10-18
+ * @version     v1.0
+ * @par Copyright(c):
+ * @par History:
+ *      version: v1.0, YaoBing Xiao, 2026-10-18, initial version\n
+ */
+
+#include "wlf/svg/wlf_svg.h"
+#include "wlf/utils/wlf_cmd_parser.h"
+#include "wlf/utils/wlf_log.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static void print_usage(const char *program_name) {
+	printf("Usage: %s [OPTIONS] INPUT.svg OUTPUT\n", program_name);
+	printf("Precompile an SVG file into wlframe's binary SVG format.\n\n");
+	printf("Options:\n");
+	printf("  -u, --units <units>    Output units: px, pt, pc, mm, cm, in (default: px)\n");
+	printf("  -d, --dpi <dpi>        Resolution used for unit conversion (default: 96)\n");
+	printf("  -c, --check            Load the output back and compare shape counts\n");
+	printf("  -v, --verbose          Enable verbose logging\n");
+	printf("  -h, --help             Show this help message\n");
+}
+
+int main(int argc, char *argv[]) {
+	char *units = NULL;
+	char *dpi_arg = NULL;
+	bool check = false;
+	bool verbose = false;
+	bool show_help = false;
+
+	struct wlf_cmd_option options[] = {
+		{ WLF_OPTION_STRING, "units", 'u', &units },
+		{ WLF_OPTION_STRING, "dpi", 'd', &dpi_arg },
+		{ WLF_OPTION_BOOLEAN, "check", 'c', &check },
+		{ WLF_OPTION_BOOLEAN, "verbose", 'v', &verbose },
+		{ WLF_OPTION_BOOLEAN, "help", 'h', &show_help },
+	};
+
+	if (wlf_cmd_parse_options(options, 5, &argc, argv) < 0) {
+		fprintf(stderr, "Error parsing command line options\n");
+		return EXIT_FAILURE;
+	}
+
+	if (show_help || argc != 3) {
+		print_usage(argv[0]);
+		free(units);
+		free(dpi_arg);
+		return show_help ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	wlf_log_init(verbose ? WLF_DEBUG : WLF_ERROR, NULL);
+
+	float dpi = 96.0f;
+	if (dpi_arg != NULL) {
+		char *end;
+		dpi = strtof(dpi_arg, &end);
+		if (*end != '\0' || dpi <= 0.0f) {
+			fprintf(stderr, "Invalid dpi '%s'\n", dpi_arg);
+			free(units);
+			free(dpi_arg);
+			return EXIT_FAILURE;
+		}
+	}
+
+	const char *input = argv[1];
+	const char *output = argv[2];
+	int ret = EXIT_FAILURE;
+
+	struct wlf_svg_image *image = wlf_svg_parse_from_file(input,
+		units != NULL ? units : "px", dpi);
+	if (image == NULL) {
+		fprintf(stderr, "Failed to parse %s\n", input);
+		goto out;
+	}
+
+	if (!wlf_svg_save_binary(image, output)) {
+		fprintf(stderr, "Failed to write %s\n", output);
+		goto out;
+	}
+
+	if (check) {
+		struct wlf_svg_image *loaded = wlf_svg_load_binary_from_file(output);
+		if (loaded == NULL) {
+			fprintf(stderr, "Failed to load back %s\n", output);
+			goto out;
+		}
+
+		struct wlf_svg_info expected, actual;
+		wlf_svg_get_info(image, &expected);
+		wlf_svg_get_info(loaded, &actual);
+		wlf_svg_destroy(loaded);
+		if (expected.n_shapes != actual.n_shapes ||
+				expected.n_paths != actual.n_paths) {
+			fprintf(stderr, "%s: loaded %d shapes and %d paths, expected %d and %d\n",
+				output, actual.n_shapes, actual.n_paths,
+				expected.n_shapes, expected.n_paths);
+			goto out;
+		}
+	}
+
+	wlf_log(WLF_DEBUG, "Compiled %s to %s", input, output);
+	ret = EXIT_SUCCESS;
+
+out:
+	wlf_svg_destroy(image);
+	free(units);
+	free(dpi_arg);
+	return ret;
+}
@@ -0,0 +1,233 @@
+#include "wlf/utils/wlf_file_source.h"
+#include "wlf/utils/wlf_log.h"
+#include "wlf/config.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#if WLF_HAS_LINUX_PLATFORM
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if WLF_HAS_LINUX_PLATFORM
+/* Reads a descriptor that cannot be mapped (pipe, character device, or a
+ * failed mmap) into a heap buffer that grows geometrically. */
+static bool source_read_fd(struct wlf_file_source *source, int fd) {
+	size_t cap = 0;
+	size_t len = 0;
+	uint8_t *buf = NULL;
+
+	for (;;) {
+		if (len == cap) {
+			size_t new_cap = cap == 0 ? 64 * 1024 : cap * 2;
+			if (new_cap < cap) {
+				free(buf);
+				return false;
+			}
+			uint8_t *tmp = realloc(buf, new_cap);
+			if (tmp == NULL) {
+				wlf_log_errno(WLF_ERROR, "Failed to allocate buffer for %s",
+					source->name);
+				free(buf);
+				return false;
+			}
+			buf = tmp;
+			cap = new_cap;
+		}
+
+		ssize_t n = read(fd, buf + len, cap - len);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			wlf_log_errno(WLF_ERROR, "Failed to read %s", source->name);
+			free(buf);
+			return false;
+		}
+		if (n == 0) {
+			break;
+		}
+		len += (size_t)n;
+	}
+
+	source->buffer = buf;
+	source->data = buf;
+	source->size = len;
+
+	return true;
+}
+
+static bool source_open_file(struct wlf_file_source *source, const char *filename) {
+	int fd = open(filename, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		wlf_log_errno(WLF_ERROR, "Open %s failed", filename);
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		wlf_log_errno(WLF_ERROR, "Cannot stat %s", filename);
+		close(fd);
+		return false;
+	}
+
+	if (!S_ISREG(st.st_mode)) {
+		bool ok = source_read_fd(source, fd);
+		close(fd);
+		return ok;
+	}
+
+	if ((uint64_t)st.st_size > SIZE_MAX) {
+		wlf_log(WLF_ERROR, "File %s is too large to map", filename);
+		close(fd);
+		return false;
+	}
+
+	if (st.st_size == 0) {
+		close(fd);
+		return true;
+	}
+
+	size_t size = (size_t)st.st_size;
+	void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED) {
+		wlf_log_errno(WLF_DEBUG, "Cannot map %s, reading it instead", filename);
+		bool ok = source_read_fd(source, fd);
+		close(fd);
+		return ok;
+	}
+	close(fd);
+
+	/* Decoders walk the input front to back; let the kernel read ahead. */
+	posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+
+	source->mapping = map;
+	source->mapping_size = size;
+	source->data = map;
+	source->size = size;
+
+	return true;
+}
+#else
+static bool source_open_file(struct wlf_file_source *source, const char *filename) {
+	FILE *fp = fopen(filename, "rb");
+	if (fp == NULL) {
+		wlf_log_errno(WLF_ERROR, "Open %s failed", filename);
+		return false;
+	}
+
+	if (fseek(fp, 0, SEEK_END) != 0) {
+		fclose(fp);
+		return false;
+	}
+	long fsize = ftell(fp);
+	if (fsize < 0) {
+		fclose(fp);
+		return false;
+	}
+	rewind(fp);
+
+	if (fsize == 0) {
+		fclose(fp);
+		return true;
+	}
+
+	uint8_t *buf = malloc((size_t)fsize);
+	if (buf == NULL) {
+		wlf_log_errno(WLF_ERROR, "Failed to allocate buffer for %s", filename);
+		fclose(fp);
+		return false;
+	}
+
+	size_t n = fread(buf, 1, (size_t)fsize, fp);
+	fclose(fp);
+	if (n != (size_t)fsize) {
+		wlf_log(WLF_ERROR, "Failed to read %s", filename);
+		free(buf);
+		return false;
+	}
+
+	source->buffer = buf;
+	source->data = buf;
+	source->size = n;
+
+	return true;
+}
+#endif
+
+bool wlf_file_source_init_from_file(struct wlf_file_source *source,
+		const char *filename) {
+	*source = (struct wlf_file_source) {
+		.name = filename,
+	};
+
+	if (filename == NULL) {
+		return false;
+	}
+
+	return source_open_file(source, filename);
+}
+
+void wlf_file_source_init_from_memory(struct wlf_file_source *source,
+		const void *data, size_t size) {
+	*source = (struct wlf_file_source) {
+		.data = data,
+		.size = data != NULL ? size : 0,
+		.name = "memory",
+	};
+}
+
+void wlf_file_source_finish(struct wlf_file_source *source) {
+	if (source == NULL) {
+		return;
+	}
+
+#if WLF_HAS_LINUX_PLATFORM
+	if (source->mapping != NULL) {
+		munmap(source->mapping, source->mapping_size);
+	}
+#endif
+	free(source->buffer);
+
+	*source = (struct wlf_file_source) { 0 };
+}
+
+size_t wlf_file_source_read(struct wlf_file_source *source, void *dst, size_t len) {
+	size_t remaining = wlf_file_source_remaining(source);
+	if (len > remaining) {
+		len = remaining;
+	}
+	if (len > 0) {
+		memcpy(dst, source->data + source->offset, len);
+		source->offset += len;
+	}
+
+	return len;
+}
+
+const uint8_t *wlf_file_source_take(struct wlf_file_source *source, size_t len) {
+	if (len > wlf_file_source_remaining(source)) {
+		return NULL;
+	}
+
+	const uint8_t *p = source->data + source->offset;
+	source->offset += len;
+
+	return p;
+}
+
+bool wlf_file_source_seek(struct wlf_file_source *source, size_t offset) {
+	if (offset > source->size) {
+		return false;
+	}
+
+	source->offset = offset;
+
+	return true;
+}
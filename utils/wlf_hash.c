@@ -0,0 +1,20 @@
+#include "wlf/utils/wlf_hash.h"
+
+#define FNV_PRIME UINT64_C(0x100000001b3)
+
+uint64_t wlf_hash_bytes(uint64_t hash, const void *data, size_t size) {
+	const uint8_t *p = data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= p[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+uint64_t wlf_hash_string(uint64_t hash, const char *str) {
+	for (const uint8_t *p = (const uint8_t *)str; *p != '\0'; p++) {
+		hash ^= *p;
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
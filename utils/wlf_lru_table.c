@@ -0,0 +1,200 @@
+#include "wlf/utils/wlf_lru_table.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+static bool table_over_budget(const struct wlf_lru_table *table) {
+	size_t cost = table->budget_idle_only ?
+		table->idle_cost : table->resident_cost;
+	return cost > table->budget;
+}
+
+static void table_unlink(struct wlf_lru_table *table, struct wlf_lru_entry *entry) {
+	struct wlf_lru_entry **link =
+		&table->buckets[entry->hash & (table->bucket_count - 1)];
+	while (*link != entry) {
+		link = &(*link)->hash_next;
+	}
+	*link = entry->hash_next;
+	table->entry_count--;
+}
+
+static void entry_destroy(struct wlf_lru_entry *entry) {
+	entry->table = NULL;
+	entry->hash_next = NULL;
+	entry->impl->destroy(entry);
+}
+
+/* Evicts from the cold end of the LRU list until the table fits its budget. */
+static void table_trim(struct wlf_lru_table *table) {
+	while (table_over_budget(table) && !wlf_linked_list_empty(&table->lru)) {
+		struct wlf_lru_entry *entry =
+			wlf_container_of(table->lru.prev, entry, lru_link);
+		assert(entry->refcount == 0);
+		table_unlink(table, entry);
+		wlf_linked_list_remove(&entry->lru_link);
+		table->resident_cost -= entry->cost;
+		table->idle_cost -= entry->cost;
+		table->evictions++;
+		entry_destroy(entry);
+	}
+}
+
+static bool table_grow(struct wlf_lru_table *table) {
+	size_t bucket_count = table->bucket_count * 2;
+	struct wlf_lru_entry **buckets = calloc(bucket_count, sizeof(*buckets));
+	if (buckets == NULL) {
+		return false;
+	}
+
+	for (size_t i = 0; i < table->bucket_count; i++) {
+		struct wlf_lru_entry *entry = table->buckets[i];
+		while (entry != NULL) {
+			struct wlf_lru_entry *next = entry->hash_next;
+			size_t index = entry->hash & (bucket_count - 1);
+			entry->hash_next = buckets[index];
+			buckets[index] = entry;
+			entry = next;
+		}
+	}
+
+	free(table->buckets);
+	table->buckets = buckets;
+	table->bucket_count = bucket_count;
+
+	return true;
+}
+
+bool wlf_lru_table_init(struct wlf_lru_table *table,
+		const struct wlf_lru_table_impl *impl, size_t bucket_count,
+		size_t budget, bool budget_idle_only) {
+	assert(bucket_count > 0 && (bucket_count & (bucket_count - 1)) == 0);
+	*table = (struct wlf_lru_table) {
+		.impl = impl,
+		.bucket_count = bucket_count,
+		.budget = budget,
+		.budget_idle_only = budget_idle_only,
+	};
+	table->buckets = calloc(bucket_count, sizeof(*table->buckets));
+	if (table->buckets == NULL) {
+		return false;
+	}
+
+	wlf_linked_list_init(&table->lru);
+	return true;
+}
+
+void wlf_lru_table_finish(struct wlf_lru_table *table) {
+	for (size_t i = 0; i < table->bucket_count; i++) {
+		struct wlf_lru_entry *entry = table->buckets[i];
+		while (entry != NULL) {
+			struct wlf_lru_entry *next = entry->hash_next;
+			if (entry->refcount == 0) {
+				wlf_linked_list_remove(&entry->lru_link);
+				entry_destroy(entry);
+			} else {
+				/* Still in use; the last unref destroys it. */
+				entry->table = NULL;
+				entry->hash_next = NULL;
+			}
+			entry = next;
+		}
+	}
+
+	free(table->buckets);
+	table->buckets = NULL;
+	table->bucket_count = 0;
+	table->entry_count = 0;
+}
+
+void wlf_lru_table_set_budget(struct wlf_lru_table *table, size_t budget) {
+	table->budget = budget;
+	table_trim(table);
+}
+
+struct wlf_lru_entry *wlf_lru_table_find(struct wlf_lru_table *table,
+		uint64_t hash, bool (*matches)(const struct wlf_lru_entry *entry,
+		const void *key), const void *key) {
+	struct wlf_lru_entry *entry =
+		table->buckets[hash & (table->bucket_count - 1)];
+	for (; entry != NULL; entry = entry->hash_next) {
+		if (entry->hash == hash && matches(entry, key)) {
+			table->hits++;
+			return wlf_lru_entry_ref(entry);
+		}
+	}
+
+	table->misses++;
+	return NULL;
+}
+
+void wlf_lru_table_insert(struct wlf_lru_table *table,
+		struct wlf_lru_entry *entry, uint64_t hash, size_t cost) {
+	entry->table = table;
+	entry->impl = table->impl;
+	entry->hash = hash;
+	entry->refcount = 1;
+	entry->cost = cost;
+	wlf_linked_list_init(&entry->lru_link);
+
+	/* Keep chains short; a failed grow only costs lookup speed. */
+	if (table->entry_count >= table->bucket_count - table->bucket_count / 4) {
+		table_grow(table);
+	}
+	size_t index = hash & (table->bucket_count - 1);
+	entry->hash_next = table->buckets[index];
+	table->buckets[index] = entry;
+	table->entry_count++;
+
+	table->resident_cost += cost;
+	table_trim(table);
+}
+
+void wlf_lru_entry_set_cost(struct wlf_lru_entry *entry, size_t cost) {
+	struct wlf_lru_table *table = entry->table;
+	size_t old_cost = entry->cost;
+	entry->cost = cost;
+	if (table == NULL) {
+		return;
+	}
+
+	table->resident_cost = table->resident_cost - old_cost + cost;
+	if (entry->refcount == 0) {
+		table->idle_cost = table->idle_cost - old_cost + cost;
+	}
+	if (cost > old_cost) {
+		table_trim(table);
+	}
+}
+
+struct wlf_lru_entry *wlf_lru_entry_ref(struct wlf_lru_entry *entry) {
+	if (entry->refcount++ == 0 && entry->table != NULL) {
+		/* Referenced entries are pinned: take it off the LRU list. */
+		wlf_linked_list_remove(&entry->lru_link);
+		wlf_linked_list_init(&entry->lru_link);
+		entry->table->idle_cost -= entry->cost;
+	}
+
+	return entry;
+}
+
+void wlf_lru_entry_unref(struct wlf_lru_entry *entry) {
+	if (entry == NULL) {
+		return;
+	}
+
+	assert(entry->refcount > 0);
+	if (--entry->refcount > 0) {
+		return;
+	}
+
+	struct wlf_lru_table *table = entry->table;
+	if (table == NULL) {
+		entry_destroy(entry);
+		return;
+	}
+
+	wlf_linked_list_insert(&table->lru, &entry->lru_link);
+	table->idle_cost += entry->cost;
+	table_trim(table);
+}
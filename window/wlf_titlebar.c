@@ -9,6 +9,7 @@
 #include "wlf/scene/wlf_svg_node.h"
 #include "wlf/scene/wlf_text_node.h"
 #include "wlf/svg/wlf_svg.h"
+#include "wlf/svg/wlf_svg_cache.h"
 #include "wlf/types/wlf_color.h"
 #include "wlf/utils/wlf_log.h"
 #include "wlf/window/wlf_window.h"
@@ -120,24 +121,23 @@ static const char window_icon_source[] =
 	"<rect x='4' y='7' width='5' height='5' rx='1' fill='#ffffff'/>"
 	"</svg>";
 
+/* Icons are parsed once per process and shared by every titlebar. */
+static struct wlf_svg_document *parse_icon(const char *source,
+		const char *variant) {
+	return wlf_svg_cache_parse(wlf_svg_cache_get_default(), source, variant,
+		"px", 96.0f);
+}
+
 static struct wlf_svg_node *create_svg_icon(struct wlf_scene_node *parent,
-		const char *source, int x, int y) {
-	if (source == NULL) {
-		return NULL;
-	}
-	char *input = strdup(source);
-	if (input == NULL) {
-		wlf_log_errno(WLF_ERROR, "failed to duplicate titlebar icon SVG");
-		return NULL;
-	}
-	struct wlf_svg_image *image = wlf_svg_parse(input, "px", 96.0f);
-	free(input);
-	if (image == NULL) {
+		struct wlf_svg_document *document, int x, int y) {
+	struct wlf_svg_node *icon =
+		wlf_svg_node_create_from_document(parent, x, y, document);
+	if (icon == NULL) {
 		return NULL;
 	}
-	struct wlf_svg_node *icon = wlf_svg_node_create(parent, x, y, image);
-	if (icon == NULL) {
-		wlf_svg_destroy(image);
+	/* One texture blit per icon; shape children remain the fallback. */
+	if (!wlf_svg_node_set_rasterized(icon, true)) {
+		wlf_log(WLF_DEBUG, "drawing titlebar icon with shape nodes");
 	}
 	return icon;
 }
@@ -291,8 +291,13 @@ static bool create_button(struct wlf_titlebar *titlebar,
 
 	double icon_offset =
 		(TITLEBAR_BUTTON_SIZE - TITLEBAR_ICON_SIZE) / 2.0;
-	button->icon = create_svg_icon(&button->tree->base, icon_source,
+	struct wlf_svg_document *document = parse_icon(icon_source, "light");
+	if (document == NULL) {
+		return false;
+	}
+	button->icon = create_svg_icon(&button->tree->base, document,
 		(int)icon_offset, (int)icon_offset);
+	wlf_svg_document_unref(document);
 	if (button->icon == NULL) {
 		return false;
 	}
@@ -414,10 +419,22 @@ static void set_event_node_box(struct wlf_event_node *node,
 }
 
 static bool replace_button_icon(struct wlf_titlebar_button *button,
-		const char *svg_source) {
+		const char *svg_source, const char *variant) {
+	if (svg_source == NULL) {
+		return false;
+	}
+	struct wlf_svg_document *document = parse_icon(svg_source, variant);
+	if (document == NULL) {
+		return false;
+	}
+	if (button->icon->document == document) {
+		wlf_svg_document_unref(document);
+		return true;
+	}
 	int offset = (TITLEBAR_BUTTON_SIZE - TITLEBAR_ICON_SIZE) / 2;
 	struct wlf_svg_node *icon = create_svg_icon(&button->tree->base,
-		svg_source, offset, offset);
+		document, offset, offset);
+	wlf_svg_document_unref(document);
 	if (icon == NULL) {
 		return false;
 	}
@@ -431,17 +448,18 @@ static void update_default_button_icons(struct wlf_titlebar *titlebar) {
 	struct wlf_theme *theme = titlebar->window->state.backend->theme;
 	bool dark = theme != NULL &&
 		theme->appearance == WLF_THEME_APPEARANCE_DARK;
+	const char *variant = dark ? "dark" : "light";
 	if (!titlebar->minimize_button.custom_icon) {
 		(void)replace_button_icon(&titlebar->minimize_button, dark ?
-			minimize_icon_source_dark : minimize_icon_source);
+			minimize_icon_source_dark : minimize_icon_source, variant);
 	}
 	if (!titlebar->maximize_button.custom_icon) {
 		(void)replace_button_icon(&titlebar->maximize_button, dark ?
-			maximize_icon_source_dark : maximize_icon_source);
+			maximize_icon_source_dark : maximize_icon_source, variant);
 	}
 	if (!titlebar->close_button.custom_icon) {
 		(void)replace_button_icon(&titlebar->close_button, dark ?
-			close_icon_source_dark : close_icon_source);
+			close_icon_source_dark : close_icon_source, variant);
 	}
 }
 
@@ -453,10 +471,7 @@ static void arrange_button(struct wlf_titlebar_button *button,
 
 static void set_button_icon_opacity(struct wlf_titlebar_button *button,
 		float opacity) {
-	struct wlf_scene_node *child;
-	wlf_linked_list_for_each(child, &button->icon->children, link) {
-		wlf_scene_node_set_opacity(child, opacity);
-	}
+	wlf_scene_node_set_opacity(&button->icon->base, opacity);
 }
 
 struct wlf_titlebar_button *wlf_titlebar_get_button(
@@ -599,9 +614,17 @@ void wlf_titlebar_set_active(struct wlf_titlebar *titlebar, bool active) {
 
 bool wlf_titlebar_set_icon(struct wlf_titlebar *titlebar,
 		const char *svg_source) {
+	if (svg_source == NULL) {
+		return false;
+	}
+	struct wlf_svg_document *document = parse_icon(svg_source, NULL);
+	if (document == NULL) {
+		return false;
+	}
 	struct wlf_svg_node *icon = create_svg_icon(&titlebar->content->base,
-		svg_source, TITLEBAR_HORIZONTAL_PADDING,
+		document, TITLEBAR_HORIZONTAL_PADDING,
 		(WLF_TITLEBAR_HEIGHT - TITLEBAR_ICON_SIZE) / 2);
+	wlf_svg_document_unref(document);
 	if (icon == NULL) {
 		return false;
 	}
@@ -647,7 +670,7 @@ bool wlf_titlebar_set_button_icon(struct wlf_titlebar *titlebar,
 	if (button == NULL) {
 		return false;
 	}
-	if (!replace_button_icon(button, svg_source)) {
+	if (!replace_button_icon(button, svg_source, NULL)) {
 		return false;
 	}
 	button->custom_icon = true;
@@ -737,9 +760,13 @@ struct wlf_titlebar *wlf_titlebar_create(struct wlf_scene_node *parent,
 	titlebar->title_text = wlf_text_node_create(&titlebar->content->base,
 		0, 0, window->state.title, "sans-serif", TITLEBAR_FONT_SIZE,
 		&unfocused_text);
-	titlebar->window_icon = create_svg_icon(&titlebar->content->base,
-		window_icon_source, TITLEBAR_HORIZONTAL_PADDING,
-		(WLF_TITLEBAR_HEIGHT - TITLEBAR_ICON_SIZE) / 2);
+	struct wlf_svg_document *window_icon = parse_icon(window_icon_source, NULL);
+	if (window_icon != NULL) {
+		titlebar->window_icon = create_svg_icon(&titlebar->content->base,
+			window_icon, TITLEBAR_HORIZONTAL_PADDING,
+			(WLF_TITLEBAR_HEIGHT - TITLEBAR_ICON_SIZE) / 2);
+		wlf_svg_document_unref(window_icon);
+	}
 	titlebar->move_event_node = wlf_event_node_create(&titlebar->tree->base,
 		0, 0, window->state.geometry.width, WLF_TITLEBAR_HEIGHT);
 	if (titlebar->move_event_node != NULL) {
@@ -322,6 +322,7 @@ void wlf_window_set_scale(struct wlf_window *window, double scale) {
 	}
 
 	window->state.scale = scale;
+	wlf_backend_warm_up_text_scale(window->state.backend, scale);
 	wlf_signal_emit_mutable(&window->events.scale, window);
 	if (window->scene != NULL) {
 		wlf_scene_damage_whole(window->scene);